@@ -67,7 +67,9 @@ namespace kungfu
 
                 int64_t now() const { return app_.now(); }
 
-                void add_timer(int64_t nanotime, const std::function<void(yijinjing::event_ptr)> &callback) {  app_.add_timer(nanotime, callback); }
+                practice::timer_handle add_timer(int64_t nanotime, const std::function<void(yijinjing::event_ptr)> &callback) { return app_.add_timer(nanotime, callback); }
+
+                bool cancel_timer(practice::timer_handle handle) { return app_.cancel_timer(handle); }
 
                 void subscribe(const std::string &source, const std::vector<std::string> &instruments, const std::string &exchange = "");
 
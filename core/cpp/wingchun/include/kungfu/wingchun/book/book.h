@@ -10,6 +10,7 @@
 
 #include <kungfu/practice/apprentice.h>
 #include <kungfu/wingchun/msg.h>
+#include <kungfu/wingchun/registry/instrument.h>
 
 namespace kungfu
 {
@@ -63,6 +64,9 @@ namespace kungfu
 
                 const msg::data::Instrument& get_inst_info(const std::string &symbol, const std::string &exchange_id) const;
 
+                /** by instrument_id stamped in messages, no string hashing */
+                const msg::data::Instrument& get_inst_info(uint32_t instrument_id) const;
+
                 std::vector<msg::data::Instrument> all_inst_info() const;
 
             private:
@@ -76,9 +80,16 @@ namespace kungfu
 
                 yijinjing::data::location_ptr service_location_;
 
+                registry::InstrumentRegistry_ptr registry_;
+
                 std::unordered_map<uint32_t, msg::data::Instrument> instruments_;
 
+                /** indexed by instrument_id, instrument_id 0 for ids without instrument info */
+                std::vector<msg::data::Instrument> instruments_by_id_;
+
                 std::unordered_map<uint32_t, std::set<Book_ptr>> books_;
+
+                std::unordered_map<uint32_t, std::vector<practice::handler_id>> book_handlers_;
             };
         }
     }
@@ -12,6 +12,7 @@
 #include <kungfu/yijinjing/io.h>
 #include <kungfu/practice/apprentice.h>
 #include <kungfu/wingchun/msg.h>
+#include <kungfu/wingchun/registry/instrument.h>
 
 namespace kungfu
 {
@@ -41,6 +42,9 @@ namespace kungfu
                 virtual bool unsubscribe(const std::vector<msg::data::Instrument> &instruments) = 0;
 
             protected:
+                /** ids to stamp into messages written */
+                registry::InstrumentRegistry_ptr instruments_;
+
                 void publish_state(msg::data::BrokerState state)
                 {
                     auto s = static_cast<int32_t>(state);
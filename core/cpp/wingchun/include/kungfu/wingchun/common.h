@@ -346,6 +346,43 @@ namespace kungfu
             }
         }
 
+        /** exact powers of ten representable in int64, index is exponent */
+        constexpr int64_t DECIMAL_SCALES[] = {
+                1LL, 10LL, 100LL, 1000LL, 10000LL, 100000LL, 1000000LL, 10000000LL, 100000000LL, 1000000000LL,
+                10000000000LL, 100000000000LL, 1000000000000LL, 10000000000000LL, 100000000000000LL,
+                1000000000000000LL, 10000000000000000LL, 100000000000000000LL, 1000000000000000000LL
+        };
+
+        constexpr int8_t MAX_DECIMAL_EXPONENT = 18;
+
+        /** value as a multiple of 10^exponent, rounded to nearest */
+        inline int64_t to_fixed_point(double value, int8_t exponent)
+        {
+            return exponent <= 0 ? std::llround(value * DECIMAL_SCALES[-exponent]) :
+                   std::llround(value / DECIMAL_SCALES[exponent]);
+        }
+
+        /** value of mantissa * 10^exponent, dividing keeps decimals like 0.1 correctly rounded */
+        inline double from_fixed_point(int64_t mantissa, int8_t exponent)
+        {
+            return exponent <= 0 ? static_cast<double>(mantissa) / DECIMAL_SCALES[-exponent] :
+                   static_cast<double>(mantissa) * DECIMAL_SCALES[exponent];
+        }
+
+        /** largest exponent whose power of ten divides tick, e.g. -2 for 0.01 and 0.05, 0 for 5 */
+        inline int8_t get_decimal_exponent(double tick)
+        {
+            for (int8_t exponent = MAX_DECIMAL_EXPONENT; exponent > -MAX_DECIMAL_EXPONENT; exponent--)
+            {
+                double scaled = from_fixed_point(to_fixed_point(tick, exponent), exponent);
+                if (tick > 0 and std::fabs(scaled - tick) <= tick * 1e-9)
+                {
+                    return exponent;
+                }
+            }
+            return -MAX_DECIMAL_EXPONENT;
+        }
+
         inline uint32_t get_symbol_id(const std::string &symbol, const std::string &exchange)
         {
             return yijinjing::util::hash_str_32(symbol) ^ yijinjing::util::hash_str_32(exchange);
@@ -15,6 +15,7 @@
 #include <nlohmann/json.hpp>
 #include <kungfu/wingchun/common.h>
 #include <kungfu/yijinjing/journal/journal.h>
+#include <kungfu/yijinjing/journal/archive.h>
 
 namespace kungfu
 {
@@ -30,6 +31,9 @@ namespace kungfu
                     Ticker = 102,
                     Trade = 103,
                     IndexPrice = 104,
+                    CompactDepth = 105,
+                    MarketDataLatency = 106,
+                    FeedLegStats = 107,
                     Bar = 110,
 
                     OrderInput = 201,
@@ -103,6 +107,7 @@ namespace kungfu
                     bool is_trading;                            //当前是否交易
                     double long_margin_ratio;                   //多头保证金率
                     double short_margin_ratio;                  //空头保证金率
+                    uint32_t instrument_id;                     //品种注册ID
 
                     const std::string get_symbol() const
                     { return std::string(symbol); }
@@ -161,6 +166,7 @@ namespace kungfu
                     j["exchange_id"] = std::string(instrument.exchange_id);
                     j["symbol"] = std::string(instrument.symbol);
                     j["instrument_type"] = instrument.instrument_type;
+                    j["instrument_id"] = instrument.instrument_id;
                     j["product_id"] = std::string(instrument.product_id);
                     j["contract_multiplier"] = instrument.contract_multiplier;
                     j["price_tick"] = instrument.price_tick;
@@ -184,6 +190,9 @@ namespace kungfu
                     double bid_volume;                          //买单最优挂单数量
                     double ask_price;                           //卖单最优挂单价格
                     double ask_volume;                          //卖单最优挂单数量
+                    int64_t exchange_time;                      //交易所事件时间, 无则为0
+                    int64_t receive_time;                       //本地收到时间, 写入journal时间为帧的gen_time
+                    uint32_t instrument_id;                     //品种注册ID
 
                     const std::string get_source_id() const
                     { return std::string(source_id); }
@@ -213,6 +222,7 @@ namespace kungfu
                 {
                     j["data_time"] = ticker.data_time;
                     j["instrument_type"] = ticker.instrument_type;
+                    j["instrument_id"] = ticker.instrument_id;
                     j["source_id"] = ticker.get_source_id();
                     j["symbol"] = ticker.get_symbol();
                     j["exchange_id"] = ticker.get_exchange_id();
@@ -221,12 +231,15 @@ namespace kungfu
                     j["ask_price"] = ticker.ask_price;
                     j["bid_volume"] = ticker.bid_volume;
                     j["ask_volume"] = ticker.ask_volume;
+                    j["exchange_time"] = ticker.exchange_time;
+                    j["receive_time"] = ticker.receive_time;
                 }
 
                 inline void from_json(const nlohmann::json &j, Ticker &ticker)
                 {
                     ticker.data_time = j["data_time"];
                     ticker.instrument_type = j["instrument_type"];
+                    ticker.instrument_id = j.value("instrument_id", 0u);
                     ticker.set_source_id(j["source_id"].get<std::string>());
                     ticker.set_symbol(j["symbol"].get<std::string>());
                     ticker.set_exchange_id(j["exchange_id"].get<std::string>());
@@ -235,6 +248,8 @@ namespace kungfu
                     ticker.ask_price = j["ask_price"];
                     ticker.bid_volume = j["bid_volume"];
                     ticker.ask_volume = j["ask_volume"];
+                    ticker.exchange_time = j.value("exchange_time", int64_t(0));
+                    ticker.receive_time = j.value("receive_time", int64_t(0));
                 }
 
 
@@ -253,6 +268,10 @@ namespace kungfu
                     double bid_volume[10];                      //申买量
                     double ask_volume[10];                      //申卖量
 
+                    int64_t exchange_time;                      //交易所事件时间, 无则为0
+                    int64_t receive_time;                       //本地收到时间, 写入journal时间为帧的gen_time
+                    uint32_t instrument_id;                     //品种注册ID
+
                     const std::string get_source_id() const
                     { return std::string(source_id); }
 
@@ -305,6 +324,7 @@ namespace kungfu
                 {
                     j["data_time"] = depth.data_time;
                     j["instrument_type"] = depth.instrument_type;
+                    j["instrument_id"] = depth.instrument_id;
                     j["source_id"] = depth.get_source_id();
                     j["symbol"] = depth.get_symbol();
                     j["exchange_id"] = depth.get_exchange_id();
@@ -313,6 +333,8 @@ namespace kungfu
                     j["ask_price"] = depth.get_ask_price();
                     j["bid_volume"] = depth.get_bid_volume();
                     j["ask_volume"] = depth.get_ask_volume();
+                    j["exchange_time"] = depth.exchange_time;
+                    j["receive_time"] = depth.receive_time;
                 }
 
                 inline void from_json(const nlohmann::json &j, Depth &depth)
@@ -321,11 +343,176 @@ namespace kungfu
                     depth.set_symbol(j["symbol"].get<std::string>());
                     depth.set_exchange_id(j["exchange_id"].get<std::string>());
                     depth.instrument_type = j["instrument_type"];
+                    depth.instrument_id = j.value("instrument_id", 0u);
 
                     depth.set_bid_price(j["bid_price"].get<std::vector<double>>());
                     depth.set_ask_price(j["ask_price"].get<std::vector<double>>());
                     depth.set_bid_volume(j["bid_volume"].get<std::vector<double>>());
                     depth.set_ask_volume(j["ask_volume"].get<std::vector<double>>());
+                    depth.exchange_time = j.value("exchange_time", int64_t(0));
+                    depth.receive_time = j.value("receive_time", int64_t(0));
+                }
+
+                struct DepthLevel
+                {
+                    int64_t price;                              //价格, 乘以 10^price_exponent
+                    int64_t volume;                             //数量, 乘以 10^volume_exponent
+#ifndef _WIN32
+                } __attribute__((packed));
+#else
+                };
+#endif
+
+                //定点深度, 档数可变, 帧长为 length()
+                struct CompactDepth
+                {
+                    uint32_t instrument_id;                     //品种注册ID
+                    int64_t data_time;                          //数据生成时间
+                    InstrumentType instrument_type;             //交易品种类型
+                    int8_t price_exponent;                      //价格精度, 通常由最小变动价位得出
+                    int8_t volume_exponent;                     //数量精度, 通常由最小下单量步长得出
+                    uint16_t bid_levels;                        //买档数
+                    uint16_t ask_levels;                        //卖档数
+                    int64_t exchange_time;                      //交易所事件时间, 无则为0
+                    int64_t receive_time;                       //本地收到时间, 写入journal时间为帧的gen_time
+                    //其后为 bid_levels 档买盘与 ask_levels 档卖盘, 均由优至劣
+
+                    CompactDepth() = default;
+
+                    // levels follow the header in the frame, a copy would lose them
+                    CompactDepth(const CompactDepth &) = delete;
+
+                    CompactDepth &operator=(const CompactDepth &) = delete;
+
+                    static size_t length(uint16_t bid_levels, uint16_t ask_levels)
+                    { return sizeof(CompactDepth) + sizeof(DepthLevel) * (bid_levels + ask_levels); }
+
+                    size_t length() const
+                    { return length(bid_levels, ask_levels); }
+
+                    const DepthLevel *bids() const
+                    { return reinterpret_cast<const DepthLevel *>(this + 1); }
+
+                    DepthLevel *bids()
+                    { return reinterpret_cast<DepthLevel *>(this + 1); }
+
+                    const DepthLevel *asks() const
+                    { return bids() + bid_levels; }
+
+                    DepthLevel *asks()
+                    { return bids() + bid_levels; }
+
+                    double get_price(const DepthLevel &level) const
+                    { return from_fixed_point(level.price, price_exponent); }
+
+                    double get_volume(const DepthLevel &level) const
+                    { return from_fixed_point(level.volume, volume_exponent); }
+
+                    void set_level(DepthLevel &level, double price, double volume) const
+                    {
+                        level.price = to_fixed_point(price, price_exponent);
+                        level.volume = to_fixed_point(volume, volume_exponent);
+                    }
+
+                    std::vector<double> get_bid_price() const
+                    { return get_levels(bids(), bid_levels, &DepthLevel::price, price_exponent); }
+
+                    std::vector<double> get_ask_price() const
+                    { return get_levels(asks(), ask_levels, &DepthLevel::price, price_exponent); }
+
+                    std::vector<double> get_bid_volume() const
+                    { return get_levels(bids(), bid_levels, &DepthLevel::volume, volume_exponent); }
+
+                    std::vector<double> get_ask_volume() const
+                    { return get_levels(asks(), ask_levels, &DepthLevel::volume, volume_exponent); }
+
+                private:
+                    static std::vector<double> get_levels(const DepthLevel *levels, uint16_t n, int64_t DepthLevel::*field, int8_t exponent)
+                    {
+                        std::vector<double> res(n);
+                        for (int i = 0; i < n; i++)
+                        {
+                            res[i] = from_fixed_point(levels[i].*field, exponent);
+                        }
+                        return res;
+                    }
+#ifndef _WIN32
+                } __attribute__((packed));
+#else
+                };
+#endif
+
+                inline void to_json(nlohmann::json &j, const CompactDepth &depth)
+                {
+                    j["data_time"] = depth.data_time;
+                    j["instrument_type"] = depth.instrument_type;
+                    j["instrument_id"] = depth.instrument_id;
+
+                    j["bid_price"] = depth.get_bid_price();
+                    j["ask_price"] = depth.get_ask_price();
+                    j["bid_volume"] = depth.get_bid_volume();
+                    j["ask_volume"] = depth.get_ask_volume();
+                    j["exchange_time"] = depth.exchange_time;
+                    j["receive_time"] = depth.receive_time;
+                }
+
+                /**
+                 * fill compact, which must have room for length(10, 10), from the levels of depth up to the first empty one,
+                 * prices and volumes counted in the decimals of price_tick and volume_step, as get_decimal_exponent gives them
+                 * @return frame length of compact
+                 */
+                inline size_t compact_from_depth(const Depth &depth, uint32_t instrument_id, double price_tick, double volume_step,
+                                                 CompactDepth &compact)
+                {
+                    compact.instrument_id = instrument_id;
+                    compact.data_time = depth.data_time;
+                    compact.instrument_type = depth.instrument_type;
+                    compact.price_exponent = get_decimal_exponent(price_tick);
+                    compact.volume_exponent = get_decimal_exponent(volume_step);
+                    compact.exchange_time = depth.exchange_time;
+                    compact.receive_time = depth.receive_time;
+                    compact.bid_levels = 0;
+                    while (compact.bid_levels < 10 and depth.bid_volume[compact.bid_levels] > 0)
+                    {
+                        compact.bid_levels++;
+                    }
+                    compact.ask_levels = 0;
+                    while (compact.ask_levels < 10 and depth.ask_volume[compact.ask_levels] > 0)
+                    {
+                        compact.ask_levels++;
+                    }
+                    for (int i = 0; i < compact.bid_levels; i++)
+                    {
+                        compact.set_level(compact.bids()[i], depth.bid_price[i], depth.bid_volume[i]);
+                    }
+                    for (int i = 0; i < compact.ask_levels; i++)
+                    {
+                        compact.set_level(compact.asks()[i], depth.ask_price[i], depth.ask_volume[i]);
+                    }
+                    return compact.length();
+                }
+
+                /** fill depth from the best 10 levels of compact, symbol and exchange_id as registered for its instrument id */
+                inline void depth_from_compact(const CompactDepth &compact, const char *symbol, const char *exchange_id, Depth &depth)
+                {
+                    memset(&depth, 0, sizeof(Depth));
+                    strncpy(depth.symbol, symbol, SYMBOL_LEN - 1);
+                    strncpy(depth.exchange_id, exchange_id, EXCHANGE_ID_LEN - 1);
+                    depth.data_time = compact.data_time;
+                    depth.instrument_type = compact.instrument_type;
+                    depth.instrument_id = compact.instrument_id;
+                    depth.exchange_time = compact.exchange_time;
+                    depth.receive_time = compact.receive_time;
+                    for (int i = 0; i < std::min<int>(10, compact.bid_levels); i++)
+                    {
+                        depth.bid_price[i] = compact.get_price(compact.bids()[i]);
+                        depth.bid_volume[i] = compact.get_volume(compact.bids()[i]);
+                    }
+                    for (int i = 0; i < std::min<int>(10, compact.ask_levels); i++)
+                    {
+                        depth.ask_price[i] = compact.get_price(compact.asks()[i]);
+                        depth.ask_volume[i] = compact.get_volume(compact.asks()[i]);
+                    }
                 }
 
                 struct Trade
@@ -343,6 +530,9 @@ namespace kungfu
                     Side side;                                  //主动成交方向
                     Direction position_side;                    //仓位方向
                     int64_t trade_time;                         //成交时间
+                    int64_t exchange_time;                      //交易所事件时间, 无则为0
+                    int64_t receive_time;                       //本地收到时间, 写入journal时间为帧的gen_time
+                    uint32_t instrument_id;                     //品种注册ID
 
                     const std::string get_client_id() const
                     { return std::string(client_id); }
@@ -375,6 +565,7 @@ namespace kungfu
                     j["exchange_id"] = trade.get_exchange_id();
                     j["client_id"] = trade.get_client_id();
                     j["instrument_type"] = trade.instrument_type;
+                    j["instrument_id"] = trade.instrument_id;
                     j["trade_id"] = trade.trade_id;
                     j["price"] = trade.price;
                     j["volume"] = trade.volume;
@@ -382,6 +573,8 @@ namespace kungfu
                     j["position_side"] = trade.position_side;
                     j["ask_id"] = trade.ask_id;
                     j["bid_id"] = trade.bid_id;
+                    j["exchange_time"] = trade.exchange_time;
+                    j["receive_time"] = trade.receive_time;
                 }
 
                 inline void from_json(const nlohmann::json &j, Trade &trade)
@@ -391,6 +584,7 @@ namespace kungfu
                     trade.set_exchange_id(j["exchange_id"].get<std::string>());
                     trade.set_client_id(j["client_id"].get<std::string>());
                     trade.instrument_type = j["instrument_type"];
+                    trade.instrument_id = j.value("instrument_id", 0u);
                     trade.trade_id = j["trade_id"];
                     trade.price = j["price"];
                     trade.volume = j["volume"];
@@ -398,6 +592,8 @@ namespace kungfu
                     trade.position_side = j["position_side"];
                     trade.ask_id = j["ask_id"];
                     trade.bid_id = j["bid_id"];
+                    trade.exchange_time = j.value("exchange_time", int64_t(0));
+                    trade.receive_time = j.value("receive_time", int64_t(0));
                 }
 
 
@@ -409,6 +605,7 @@ namespace kungfu
                     InstrumentType instrument_type;         //交易品种类型
 
                     double price;                           //指数价格
+                    uint32_t instrument_id;                 //品种注册ID
 
                     const std::string get_symbol() const
                     { return std::string(symbol); }
@@ -432,6 +629,7 @@ namespace kungfu
                     j["symbol"] = ip.get_symbol();
                     j["exchange_id"] = ip.get_exchange_id();
                     j["instrument_type"] = ip.instrument_type;
+                    j["instrument_id"] = ip.instrument_id;
                     j["price"] = ip.price;
                 }
 
@@ -440,9 +638,152 @@ namespace kungfu
                     ip.set_symbol(j["symbol"].get<std::string>());
                     ip.set_exchange_id(j["exchange_id"].get<std::string>());
                     ip.instrument_type = j["instrument_type"];
+                    ip.instrument_id = j.value("instrument_id", 0u);
                     ip.price = j["price"];
                 }
 
+#define ARCHIVE_FIELD(type, member, kind) \
+    yijinjing::journal::archive_field{static_cast<uint32_t>(offsetof(type, member)), static_cast<uint32_t>(sizeof(type::member)), \
+                                      yijinjing::journal::archive_field_kind::kind}
+
+                /**
+                 * register layouts of market data for journal archives, symbol first so that prices, volumes and times
+                 * are delta encoded per symbol
+                 */
+                inline void register_archive_layouts()
+                {
+                    using yijinjing::journal::archive;
+                    archive::register_layout({type::Depth, sizeof(Depth), {
+                            ARCHIVE_FIELD(Depth, symbol, DICTIONARY),
+                            ARCHIVE_FIELD(Depth, source_id, DICTIONARY),
+                            ARCHIVE_FIELD(Depth, exchange_id, DICTIONARY),
+                            ARCHIVE_FIELD(Depth, data_time, DELTA),
+                            ARCHIVE_FIELD(Depth, bid_price, DECIMAL),
+                            ARCHIVE_FIELD(Depth, ask_price, DECIMAL),
+                            ARCHIVE_FIELD(Depth, bid_volume, DECIMAL),
+                            ARCHIVE_FIELD(Depth, ask_volume, DECIMAL),
+                            ARCHIVE_FIELD(Depth, exchange_time, DELTA),
+                            ARCHIVE_FIELD(Depth, receive_time, DELTA)}});
+                    archive::register_layout({type::Ticker, sizeof(Ticker), {
+                            ARCHIVE_FIELD(Ticker, symbol, DICTIONARY),
+                            ARCHIVE_FIELD(Ticker, source_id, DICTIONARY),
+                            ARCHIVE_FIELD(Ticker, exchange_id, DICTIONARY),
+                            ARCHIVE_FIELD(Ticker, data_time, DELTA),
+                            ARCHIVE_FIELD(Ticker, bid_price, DECIMAL),
+                            ARCHIVE_FIELD(Ticker, bid_volume, DECIMAL),
+                            ARCHIVE_FIELD(Ticker, ask_price, DECIMAL),
+                            ARCHIVE_FIELD(Ticker, ask_volume, DECIMAL),
+                            ARCHIVE_FIELD(Ticker, exchange_time, DELTA),
+                            ARCHIVE_FIELD(Ticker, receive_time, DELTA)}});
+                    archive::register_layout({type::Trade, sizeof(Trade), {
+                            ARCHIVE_FIELD(Trade, symbol, DICTIONARY),
+                            ARCHIVE_FIELD(Trade, client_id, DICTIONARY),
+                            ARCHIVE_FIELD(Trade, exchange_id, DICTIONARY),
+                            ARCHIVE_FIELD(Trade, trade_id, DELTA),
+                            ARCHIVE_FIELD(Trade, ask_id, DELTA),
+                            ARCHIVE_FIELD(Trade, bid_id, DELTA),
+                            ARCHIVE_FIELD(Trade, price, DECIMAL),
+                            ARCHIVE_FIELD(Trade, volume, DECIMAL),
+                            ARCHIVE_FIELD(Trade, trade_time, DELTA),
+                            ARCHIVE_FIELD(Trade, exchange_time, DELTA),
+                            ARCHIVE_FIELD(Trade, receive_time, DELTA)}});
+                    archive::register_layout({type::IndexPrice, sizeof(IndexPrice), {
+                            ARCHIVE_FIELD(IndexPrice, symbol, DICTIONARY),
+                            ARCHIVE_FIELD(IndexPrice, exchange_id, DICTIONARY),
+                            ARCHIVE_FIELD(IndexPrice, price, DECIMAL)}});
+                }
+
+#undef ARCHIVE_FIELD
+
+                //一段延迟的分位数, 纳秒
+                struct LatencyPercentiles
+                {
+                    int64_t p50;
+                    int64_t p90;
+                    int64_t p99;
+                    int64_t p999;
+                    int64_t max;
+#ifndef _WIN32
+                } __attribute__((packed));
+#else
+                };
+#endif
+
+                inline void to_json(nlohmann::json &j, const LatencyPercentiles &lp)
+                {
+                    j["p50"] = lp.p50;
+                    j["p90"] = lp.p90;
+                    j["p99"] = lp.p99;
+                    j["p999"] = lp.p999;
+                    j["max"] = lp.max;
+                }
+
+                //一个品种一种行情在 [begin_time, end_time) 内的延迟分布, 由行情柜台定时写出
+                struct MarketDataLatency
+                {
+                    uint32_t instrument_id;                 //品种注册ID
+                    InstrumentType instrument_type;         //交易品种类型
+                    int32_t msg_type;                       //行情消息类型, Depth/CompactDepth/Ticker/Trade
+                    int64_t begin_time;                     //统计开始时间
+                    int64_t end_time;                       //统计结束时间
+                    uint32_t count;                         //写出的行情条数
+                    uint32_t skewed;                        //交易所时间晚于本地收到时间的条数, 不计入wire
+                    LatencyPercentiles wire;                //交易所事件时间到本地收到
+                    LatencyPercentiles parse;               //本地收到到解析完成
+                    LatencyPercentiles journal;             //解析完成到写入journal, 含订单簿维护
+#ifndef _WIN32
+                } __attribute__((packed));
+#else
+                };
+#endif
+
+                inline void to_json(nlohmann::json &j, const MarketDataLatency &latency)
+                {
+                    j["instrument_id"] = latency.instrument_id;
+                    j["instrument_type"] = latency.instrument_type;
+                    j["msg_type"] = latency.msg_type;
+                    j["begin_time"] = latency.begin_time;
+                    j["end_time"] = latency.end_time;
+                    j["count"] = latency.count;
+                    j["skewed"] = latency.skewed;
+                    j["wire"] = latency.wire;
+                    j["parse"] = latency.parse;
+                    j["journal"] = latency.journal;
+                }
+
+                //行情柜台一个分片的一路行情在 [begin_time, end_time) 内的表现, 多路行情择优时由行情柜台定时写出
+                struct FeedLegStats
+                {
+                    uint32_t shard;                         //分片序号
+                    uint32_t leg;                           //行情路序号, 0为主路
+                    uint32_t legs;                          //分片的行情路数
+                    int64_t begin_time;                     //统计开始时间
+                    int64_t end_time;                       //统计结束时间
+                    uint64_t wins;                          //由此路最先收到并写出的更新数
+                    uint64_t late;                          //已由其他路写出而丢弃的更新数
+                    uint64_t lag_count;                     //计入落后时间的丢弃更新数
+                    int64_t lag_mean;                       //落后最先一路的平均时间, 纳秒
+                    int64_t lag_max;                        //落后最先一路的最大时间, 纳秒
+#ifndef _WIN32
+                } __attribute__((packed));
+#else
+                };
+#endif
+
+                inline void to_json(nlohmann::json &j, const FeedLegStats &stats)
+                {
+                    j["shard"] = stats.shard;
+                    j["leg"] = stats.leg;
+                    j["legs"] = stats.legs;
+                    j["begin_time"] = stats.begin_time;
+                    j["end_time"] = stats.end_time;
+                    j["wins"] = stats.wins;
+                    j["late"] = stats.late;
+                    j["lag_count"] = stats.lag_count;
+                    j["lag_mean"] = stats.lag_mean;
+                    j["lag_max"] = stats.lag_max;
+                }
+
                 struct Bar
                 {
                     char symbol[SYMBOL_LEN];                //交易品种
@@ -511,6 +852,7 @@ namespace kungfu
                     OrderType order_type;                   //价格类型
                     TimeCondition time_condition;           //时间条件
                     bool reduce_only;                       //只减仓
+                    uint32_t instrument_id;                 //品种注册ID
 
                     const std::string get_symbol() const
                     { return std::string(symbol); }
@@ -550,6 +892,7 @@ namespace kungfu
                     j["account_id"] = std::string(input.account_id);
                     j["source_id"] = std::string(input.source_id);
                     j["instrument_type"] = input.instrument_type;
+                    j["instrument_id"] = input.instrument_id;
                     j["volume"] = input.volume;
                     j["price"] = input.price;
                     j["stop_price"] =  input.stop_price;
@@ -569,6 +912,7 @@ namespace kungfu
                     strncpy(input.account_id, j["account_id"].get<std::string>().c_str(), ACCOUNT_ID_LEN);
                     strncpy(input.source_id, j["source_id"].get<std::string>().c_str(), SOURCE_ID_LEN);
                     input.instrument_type = j["instrument_type"];
+                    input.instrument_id = j.value("instrument_id", 0u);
                     input.price = j["price"].get<double>();
                     input.stop_price = j["stop_price"].get<double>();
                     input.volume = j["volume"].get<double>();
@@ -694,6 +1038,8 @@ namespace kungfu
                     char error_code[ERROR_CODE_LEN];        //错误码，每个交易所不同
                     int64_t insert_time;                    //订单写入时间
                     int64_t update_time;                    //订单更新时间
+                    int64_t send_time;                      //报单请求写出到交易所连接的时间, 未发出为0
+                    uint32_t instrument_id;                 //品种注册ID
 
                     const std::string get_fee_currency() const
                     { return std::string(fee_currency); }
@@ -751,8 +1097,10 @@ namespace kungfu
                     j["ex_order_id"] = std::string(order.ex_order_id);
                     j["insert_time"] = order.insert_time;
                     j["update_time"] = order.update_time;
+                    j["send_time"] = order.send_time;
                     j["symbol"] = std::string(order.symbol);
                     j["instrument_type"] = order.instrument_type;
+                    j["instrument_id"] = order.instrument_id;
                     j["exchange_id"] = std::string(order.exchange_id);
                     j["account_id"] = std::string(order.account_id);
                     j["source_id"] = std::string(order.source_id);
@@ -780,11 +1128,13 @@ namespace kungfu
                     order.set_ex_order_id(j["ex_order_id"].get<std::string>());
                     order.insert_time = j["insert_time"];
                     order.update_time = j["update_time"];
+                    order.send_time = j.value("send_time", int64_t(0));
                     order.set_symbol(j["symbol"].get<std::string>());
                     order.set_exchange_id(j["exchange_id"].get<std::string>());
                     order.set_account_id(j["account_id"].get<std::string>());
                     order.set_source_id(j["source_id"].get<std::string>());
                     order.instrument_type = j["instrument_type"];
+                    order.instrument_id = j.value("instrument_id", 0u);
                     order.price = j["price"].get<double>();
                     order.stop_price = j["stop_price"].get<double>();
                     order.volume = j["volume"].get<double>();
@@ -810,12 +1160,14 @@ namespace kungfu
                     strcpy(order.account_id, input.account_id);
                     strcpy(order.source_id, input.source_id);
                     order.instrument_type = input.instrument_type;
+                    order.instrument_id = input.instrument_id;
                     order.price = input.price;
                     order.stop_price = input.stop_price;
                     order.volume = input.volume;
                     order.volume_traded = 0;
                     order.volume_left = input.volume;
                     order.close_pnl = 0;
+                    order.send_time = 0;
                     order.status = OrderStatus::PreSend;
                     order.time_condition = input.time_condition;
                     order.side = input.side;
@@ -844,6 +1196,7 @@ namespace kungfu
                     char fee_currency[SYMBOL_LEN];          //手续费币种
                     char base_currency[SYMBOL_LEN];         //标的币种
                     char quote_currency[SYMBOL_LEN];        //报价币种
+                    uint32_t instrument_id;                 //品种注册ID
 
                     const std::string get_symbol() const
                     { return std::string(symbol); }
@@ -911,6 +1264,7 @@ namespace kungfu
                     j["account_id"] = std::string(trade.account_id);
                     j["source_id"] = std::string(trade.source_id);
                     j["instrument_type"] = trade.instrument_type;
+                    j["instrument_id"] = trade.instrument_id;
                     j["side"] = trade.side;
                     j["offset"] = trade.offset;
                     j["price"] = trade.price;
@@ -933,6 +1287,7 @@ namespace kungfu
                     strncpy(trade.account_id, j["account_id"].get<std::string>().c_str(), ACCOUNT_ID_LEN);
                     strncpy(trade.source_id, j["source_id"].get<std::string>().c_str(), SOURCE_ID_LEN);
                     trade.instrument_type = j["instrument_type"];
+                    trade.instrument_id = j.value("instrument_id", 0u);
                     trade.side = static_cast<Side>(j["side"].get<int>());
                     trade.offset = j["offset"];
                     trade.price = j["price"].get<double>();
@@ -1018,6 +1373,7 @@ namespace kungfu
                     double margin;                          //保证金
                     double realized_pnl;                    //已实现盈亏
                     double unrealized_pnl;                  //未实现盈亏
+                    uint32_t instrument_id;                 //品种注册ID
 
                     const std::string get_symbol() const
                     { return std::string(symbol); }
@@ -1057,6 +1413,7 @@ namespace kungfu
                     j["update_time"] = position.update_time;
                     j["symbol"] = std::string(position.symbol);
                     j["instrument_type"] = position.instrument_type;
+                    j["instrument_id"] = position.instrument_id;
                     j["exchange_id"] = std::string(position.exchange_id);
                     j["account_id"] = std::string(position.account_id);
                     j["direction"] = position.direction;
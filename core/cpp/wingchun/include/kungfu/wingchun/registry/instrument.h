@@ -0,0 +1,134 @@
+/**
+ * This is source code modified under the Apache License 2.0.
+ * Original Author: Keren Dong
+ * Modifier: kx@godzilla.dev
+ * Modification date: March 3, 2025
+ */
+
+#ifndef WINGCHUN_REGISTRY_INSTRUMENT_H
+#define WINGCHUN_REGISTRY_INSTRUMENT_H
+
+#include <atomic>
+#include <cstring>
+#include <unordered_map>
+
+#include <kungfu/yijinjing/common.h>
+#include <kungfu/wingchun/common.h>
+
+namespace kungfu
+{
+    namespace wingchun
+    {
+        namespace registry
+        {
+            /** 0 stands for an instrument not registered, or a message written without instrument id */
+            constexpr uint32_t UNKNOWN_INSTRUMENT = 0;
+
+            /** ids are in [1, INSTRUMENT_CAPACITY) */
+            constexpr uint32_t INSTRUMENT_CAPACITY = 65536;
+
+            struct InstrumentKey
+            {
+                char symbol[SYMBOL_LEN];
+                char exchange_id[EXCHANGE_ID_LEN];
+                InstrumentType instrument_type;
+
+                bool operator==(const InstrumentKey &other) const
+                { return memcmp(this, &other, sizeof(InstrumentKey)) == 0; }
+
+                static InstrumentKey make(const char *symbol, const char *exchange_id, InstrumentType instrument_type)
+                {
+                    InstrumentKey key;
+                    memset(&key, 0, sizeof(InstrumentKey));
+                    strncpy(key.symbol, symbol, SYMBOL_LEN - 1);
+                    strncpy(key.exchange_id, exchange_id, EXCHANGE_ID_LEN - 1);
+                    key.instrument_type = instrument_type;
+                    return key;
+                }
+            };
+
+            struct InstrumentKeyHash
+            {
+                size_t operator()(const InstrumentKey &key) const;
+            };
+
+            /** layout of the shared registry file, entry 0 is never used */
+            struct InstrumentRegistryState
+            {
+                uint32_t magic;
+                /** number of ids in use, entries up to it are published */
+                std::atomic<uint32_t> count;
+                /** pid of the process registering, 0 if none */
+                std::atomic<int32_t> writer_pid;
+                alignas(64) InstrumentKey entries[INSTRUMENT_CAPACITY];
+            };
+
+            /**
+             * Append only table of instruments shared by all processes of one kungfu home, mapped from the instruments
+             * file in master journal directory. An instrument keeps its id for the life of the home, so producers stamp
+             * it into messages once and consumers index arrays by it instead of hashing symbol strings.
+             *
+             * Entries are immutable once published, readers never lock. Registering takes a lock in the shared state,
+             * taken over if the process holding it is gone.
+             */
+            class InstrumentRegistry
+            {
+            public:
+                explicit InstrumentRegistry(const yijinjing::data::location_ptr &home);
+
+                ~InstrumentRegistry();
+
+                /** @return id of instrument, registered if new, UNKNOWN_INSTRUMENT if registry is full */
+                uint32_t intern(const char *symbol, const char *exchange_id, InstrumentType instrument_type);
+
+                uint32_t intern(const std::string &symbol, const std::string &exchange_id, InstrumentType instrument_type)
+                { return intern(symbol.c_str(), exchange_id.c_str(), instrument_type); }
+
+                /** @return id of instrument, UNKNOWN_INSTRUMENT if not registered */
+                uint32_t find(const char *symbol, const char *exchange_id, InstrumentType instrument_type);
+
+                /** @throw wingchun_error if id is not registered */
+                const InstrumentKey &get(uint32_t id) const;
+
+                /** @return number of ids in use plus one, arrays of this size can be indexed by any id known so far */
+                uint32_t size() const
+                { return state_->count.load(std::memory_order_acquire) + 1; }
+
+                /** set instrument_id of data from its symbol, exchange_id and instrument_type */
+                template<class T>
+                uint32_t stamp(T &data)
+                {
+                    data.instrument_id = intern(data.symbol, data.exchange_id, data.instrument_type);
+                    return data.instrument_id;
+                }
+
+                /** @return instrument_id of data, looked up by symbol for messages written without one */
+                template<class T>
+                uint32_t get_id(const T &data)
+                {
+                    if (data.instrument_id != UNKNOWN_INSTRUMENT and data.instrument_id < size())
+                    {
+                        return data.instrument_id;
+                    }
+                    return find(data.symbol, data.exchange_id, data.instrument_type);
+                }
+
+            private:
+                std::string path_;
+                InstrumentRegistryState *state_;
+                std::unordered_map<InstrumentKey, uint32_t, InstrumentKeyHash> index_;
+                uint32_t indexed_;
+
+                void sync();
+
+                void lock();
+
+                void unlock();
+            };
+
+            DECLARE_PTR(InstrumentRegistry)
+        }
+    }
+}
+
+#endif //WINGCHUN_REGISTRY_INSTRUMENT_H
@@ -34,6 +34,10 @@ namespace kungfu
                 location_ptr source_location_;
                 int64_t time_interval_;
                 std::unordered_map<uint32_t, Bar> bars_;
+                /** bar of trades by instrument_id, resolved by symbol on first trade, cleared on subscribe */
+                std::vector<std::pair<bool, Bar *>> bars_by_instrument_;
+
+                Bar *find_bar(const Trade &trade);
             };
         }
     }
@@ -11,6 +11,8 @@
 #include <kungfu/practice/apprentice.h>
 #include <kungfu/wingchun/msg.h>
 #include <kungfu/wingchun/strategy/strategy.h>
+#include <kungfu/wingchun/strategy/subscription.h>
+#include <kungfu/wingchun/registry/instrument.h>
 #include <kungfu/wingchun/book/book.h>
 #include <kungfu/wingchun/algo/algo.h>
 
@@ -33,9 +35,14 @@ namespace kungfu
                 //@return            当前纳秒时间
                 int64_t now() const;
 
-                virtual void add_timer(int64_t nanotime, const std::function<void(yijinjing::event_ptr)> &callback);
+                virtual practice::timer_handle add_timer(int64_t nanotime, const std::function<void(yijinjing::event_ptr)> &callback);
 
-                virtual void add_time_interval(int64_t duration, const std::function<void(yijinjing::event_ptr)> &callback);
+                virtual practice::timer_handle add_time_interval(int64_t duration, const std::function<void(yijinjing::event_ptr)> &callback);
+
+                // 取消定时器
+                //@param handle      add_timer 或 add_time_interval 返回的句柄
+                //@return            定时器已触发或已取消时返回 false
+                virtual bool cancel_timer(practice::timer_handle handle);
 
                 inline uint32_t get_current_strategy_index() {
                     return current_strategy_idx;
@@ -125,6 +132,14 @@ namespace kungfu
 
                 virtual const std::string get_market_info(const std::string &symbol, const std::string &exchange);
 
+                // 获取合约注册ID, 行情及订单中的 instrument_id, 可用作数组下标
+                //@param symbol        交易对名称
+                //@param exchange_id   交易所ID
+                //@return              合约注册ID, 未注册时注册
+                virtual uint32_t get_instrument_id(const std::string &symbol, const std::string &exchange, InstrumentType inst_type = InstrumentType::Spot);
+
+                registry::InstrumentRegistry_ptr get_instrument_registry() const { return instruments_; }
+
                 virtual book::BookContext_ptr get_book_context() const { return book_context_; };
 
                 virtual algo::AlgoContext_ptr get_algo_context() const { return algo_context_; }
@@ -158,25 +173,13 @@ namespace kungfu
                 void request_subscribe(uint32_t source, const std::vector<std::string> &symbols, const std::string &exchange, const std::string &sub_type, InstrumentType inst_type=InstrumentType::Spot);
                 void request_unsubscribe(uint32_t source, const std::vector<std::string> &symbols, const std::string &exchange, const std::string &sub_type, InstrumentType inst_type=InstrumentType::Spot);
 
-                template <class T>
-                bool is_subscribed(const std::string &sub_type, uint32_t hash_id, const T &data)
-                {
-                    // std::cout << sub_type << "," << static_cast<int>(data.instrument_type) << "," << data.exchange_id << "," << hash_id << std::endl;
-                    if (subscribe_all_) {
-                        return true;
-                    } else {
-                        auto symbol_id = get_symbol_id(data.symbol, sub_type, data.instrument_type, data.exchange_id, hash_id);
-                        return subscribed_symbols_.find(symbol_id) != subscribed_symbols_.end();
-                    }
-                }
-
             private:
                 std::unordered_map<uint32_t, uint32_t> account_location_ids_;
                 std::unordered_map<uint32_t, yijinjing::data::location_ptr> accounts_;
                 std::unordered_map<uint32_t, std::unordered_map<std::string, double>> account_cash_limits_;
                 std::unordered_map<std::string, uint32_t> market_data_;
-                bool subscribe_all_;
-                std::unordered_map<uint32_t, uint32_t> subscribed_symbols_;
+                registry::InstrumentRegistry_ptr instruments_;
+                SubscriptionTable subscriptions_;
                 uint32_t current_strategy_idx;
                 std::unordered_map<uint32_t, std::vector<msg::data::Bar>> bars_;
 
@@ -40,6 +40,26 @@ namespace kungfu
 
             private:
                 Context_ptr context_;
+                std::vector<Strategy_ptr> strategy_slots_;
+
+                /** call f for strategies subscribed to data, as the current strategy, in slot order */
+                template<class T, class F>
+                void for_each_subscriber(SubscribeType type, const T &data, F f)
+                {
+                    auto subscribers = context_->subscriptions_.get_subscribers(type, data);
+                    if (subscribers == nullptr)
+                    {
+                        return;
+                    }
+                    SubscriptionTable::for_each(*subscribers, [&](uint32_t slot)
+                    {
+                        if (slot < strategy_slots_.size())
+                        {
+                            context_->set_current_strategy_index(context_->subscriptions_.get_strategy_uid(slot));
+                            f(strategy_slots_[slot]);
+                        }
+                    });
+                }
             };
         }
     }
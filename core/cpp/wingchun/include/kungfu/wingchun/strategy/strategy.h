@@ -48,6 +48,11 @@ namespace kungfu
                 virtual void on_depth(Context_ptr context, const msg::data::Depth &depth)
                 {};
 
+                //定点深度数据更新回调, 含行情源写出的全部档位, 同一更新随后仍以前10档回调 on_depth
+                //@param depth             定点深度数据
+                virtual void on_compact_depth(Context_ptr context, const msg::data::CompactDepth &depth)
+                {};
+
                 //深度数据更新回调
                 //@param ticker             Ticker数据
                 virtual void on_ticker(Context_ptr context, const msg::data::Ticker &ticker)
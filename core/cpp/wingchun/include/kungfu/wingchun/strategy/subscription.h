@@ -0,0 +1,169 @@
+/**
+ * This is source code modified under the Apache License 2.0.
+ * Original Author: Keren Dong
+ * Modifier: kx@godzilla.dev
+ * Modification date: March 3, 2025
+ */
+
+#ifndef WINGCHUN_SUBSCRIPTION_H
+#define WINGCHUN_SUBSCRIPTION_H
+
+#include <cstring>
+#include <deque>
+#include <vector>
+#include <unordered_map>
+
+#include <kungfu/wingchun/common.h>
+#include <kungfu/yijinjing/util/util.h>
+
+namespace kungfu
+{
+    namespace wingchun
+    {
+        namespace strategy
+        {
+            enum class SubscribeType : int8_t
+            {
+                Unknown,
+                Depth,
+                Ticker,
+                Trade,
+                IndexPrice
+            };
+
+            inline SubscribeType get_subscribe_type(const std::string &sub_type)
+            {
+                if (sub_type == "depth")
+                    return SubscribeType::Depth;
+                if (sub_type == "ticker")
+                    return SubscribeType::Ticker;
+                if (sub_type == "trade")
+                    return SubscribeType::Trade;
+                if (sub_type == "index_price")
+                    return SubscribeType::IndexPrice;
+                return SubscribeType::Unknown;
+            }
+
+            /** one bit per strategy slot */
+            typedef std::vector<uint64_t> StrategyBits;
+
+            /**
+             * Market data subscriptions of strategies in one runner. Each (symbol, exchange, instrument type, sub type)
+             * gets a dense id when first subscribed, and each strategy a dense slot, so that finding the strategies
+             * subscribed to a tick is one lookup of its key, then iterating bits.
+             */
+            class SubscriptionTable
+            {
+            public:
+                /** dense slot of strategy, assigned on first call */
+                uint32_t get_strategy_slot(uint32_t strategy_uid);
+
+                uint32_t get_strategy_uid(uint32_t slot) const
+                { return strategy_uids_[slot]; }
+
+                size_t get_strategy_count() const
+                { return strategy_uids_.size(); }
+
+                /** instrument_id from registry lets ticks stamped with it skip the key lookup */
+                void subscribe(SubscribeType type, uint32_t strategy_uid, const std::string &symbol, InstrumentType inst_type,
+                               const std::string &exchange, uint32_t instrument_id = 0);
+
+                void unsubscribe(SubscribeType type, uint32_t strategy_uid, const std::string &symbol, InstrumentType inst_type,
+                                 const std::string &exchange);
+
+                /** every strategy gets everything from now on */
+                void subscribe_all()
+                { subscribe_all_ = true; }
+
+                /** @return strategies subscribed to data, nullptr if none */
+                template<class T>
+                const StrategyBits *get_subscribers(SubscribeType type, const T &data) const
+                {
+                    if (subscribe_all_)
+                    {
+                        return &all_;
+                    }
+                    if (data.instrument_id != 0 and not unresolved_)
+                    {
+                        const auto &by_instrument = by_instrument_[static_cast<size_t>(type)];
+                        uint32_t id = data.instrument_id < by_instrument.size() ? by_instrument[data.instrument_id] : 0;
+                        return id == 0 ? nullptr : &subscribers_[id - 1];
+                    }
+                    auto it = ids_.find(make_key(type, data.symbol, data.instrument_type, data.exchange_id));
+                    return it == ids_.end() ? nullptr : &subscribers_[it->second];
+                }
+
+                template<class T>
+                bool is_subscribed(SubscribeType type, uint32_t strategy_uid, const T &data) const
+                {
+                    auto slot = strategy_slots_.find(strategy_uid);
+                    auto bits = get_subscribers(type, data);
+                    return slot != strategy_slots_.end() and bits != nullptr and test(*bits, slot->second);
+                }
+
+                static bool test(const StrategyBits &bits, uint32_t slot)
+                {
+                    return slot / 64 < bits.size() and (bits[slot / 64] >> (slot % 64)) & 1;
+                }
+
+                /** call f with each slot set in bits, in ascending order, f may change subscriptions */
+                template<class F>
+                static void for_each(const StrategyBits &bits, F f)
+                {
+                    for (size_t word = 0; word < bits.size(); word++)
+                    {
+                        for (uint64_t b = bits[word]; b != 0; b &= b - 1)
+                        {
+                            f(static_cast<uint32_t>(word * 64 + __builtin_ctzll(b)));
+                        }
+                    }
+                }
+
+            private:
+                struct Key
+                {
+                    char symbol[SYMBOL_LEN];
+                    char exchange_id[EXCHANGE_ID_LEN];
+                    InstrumentType instrument_type;
+                    SubscribeType type;
+
+                    bool operator==(const Key &other) const
+                    { return memcmp(this, &other, sizeof(Key)) == 0; }
+                };
+
+                struct KeyHash
+                {
+                    size_t operator()(const Key &key) const
+                    { return yijinjing::util::hash_32(reinterpret_cast<const unsigned char *>(&key), sizeof(Key)); }
+                };
+
+                bool subscribe_all_ = false;
+                /** set once a subscription came without instrument id, ids of ticks can not be trusted to be complete */
+                bool unresolved_ = false;
+                /** id + 1 of key by sub type and instrument id, 0 if not subscribed */
+                std::vector<uint32_t> by_instrument_[static_cast<size_t>(SubscribeType::IndexPrice) + 1];
+                std::unordered_map<Key, uint32_t, KeyHash> ids_;
+                // deque keeps bits in place while a strategy subscribes from inside for_each
+                std::deque<StrategyBits> subscribers_;
+                StrategyBits all_;
+                std::unordered_map<uint32_t, uint32_t> strategy_slots_;
+                std::vector<uint32_t> strategy_uids_;
+
+                static Key make_key(SubscribeType type, const char *symbol, InstrumentType inst_type, const char *exchange_id)
+                {
+                    Key key;
+                    memset(&key, 0, sizeof(Key));
+                    strncpy(key.symbol, symbol, SYMBOL_LEN - 1);
+                    strncpy(key.exchange_id, exchange_id, EXCHANGE_ID_LEN - 1);
+                    key.instrument_type = inst_type;
+                    key.type = type;
+                    return key;
+                }
+
+                static void set(StrategyBits &bits, uint32_t slot, bool value);
+            };
+        }
+    }
+}
+
+#endif //WINGCHUN_SUBSCRIPTION_H
@@ -189,6 +189,17 @@ public:
     void on_depth(strategy::Context_ptr context, const Depth &depth) override
     {PYBIND11_OVERLOAD(void, strategy::Strategy, on_depth, context, depth); }
 
+    // levels live behind the struct in the journal, hand python a reference instead of a copy
+    void on_compact_depth(strategy::Context_ptr context, const CompactDepth &depth) override
+    {
+        py::gil_scoped_acquire gil;
+        py::function overload = py::get_overload(static_cast<const strategy::Strategy *>(this), "on_compact_depth");
+        if (overload)
+        {
+            overload(context, py::cast(depth, py::return_value_policy::reference));
+        }
+    }
+
     void on_ticker(strategy::Context_ptr context, const Ticker &ticker) override
     {PYBIND11_OVERLOAD(void, strategy::Strategy, on_ticker, context, ticker); }
 
@@ -223,6 +234,7 @@ PYBIND11_MODULE(pywingchun, m)
     m_utils.def("is_valid_price", &kungfu::wingchun::is_valid_price);
     m_utils.def("is_final_status", &kungfu::wingchun::is_final_status);
     m_utils.def("get_shm_db", &kungfu::wingchun::get_shm_db);
+    m_utils.def("register_archive_layouts", &kungfu::wingchun::msg::data::register_archive_layouts);
     m_utils.def("order_from_input", [](const kungfu::wingchun::msg::data::OrderInput &input)
     {
         kungfu::wingchun::msg::data::Order order = {};
@@ -389,6 +401,7 @@ PYBIND11_MODULE(pywingchun, m)
     py::class_<Instrument>(m, "Instrument")
             .def(py::init<>())
             .def_readwrite("instrument_type", &Instrument::instrument_type)
+            .def_readwrite("instrument_id", &Instrument::instrument_id)
             .def_property("symbol", &Instrument::get_symbol, &Instrument::set_symbol)
             .def_property("exchange_id", &Instrument::get_exchange_id, &Instrument::set_exchange_id)
             .def_readwrite("contract_multiplier", &Instrument::contract_multiplier)
@@ -416,15 +429,38 @@ PYBIND11_MODULE(pywingchun, m)
             .def_property("symbol", &Depth::get_symbol, &Depth::set_symbol)
             .def_property("exchange_id", &Depth::get_exchange_id, &Depth::set_exchange_id)
             .def_readwrite("instrument_type", &Depth::instrument_type)
+            .def_readwrite("instrument_id", &Depth::instrument_id)
             .def_property("bid_price", &Depth::get_bid_price, &Depth::set_bid_price)
             .def_property("ask_price", &Depth::get_ask_price, &Depth::set_ask_price)
             .def_property("bid_volume", &Depth::get_bid_volume, &Depth::set_bid_volume)
             .def_property("ask_volume", &Depth::get_ask_volume, &Depth::set_ask_volume)
+            .def_readwrite("exchange_time", &Depth::exchange_time)
+            .def_readwrite("receive_time", &Depth::receive_time)
             .def_property_readonly("raw_address", [](const Depth &a) { return reinterpret_cast<uintptr_t>(&a);})
             .def("from_raw_address",[](uintptr_t addr) { return * reinterpret_cast<Depth*>(addr); })
             .def("__sizeof__", [](const Depth &a) { return sizeof(a); })
             .def("__repr__",[](const Depth &a){return to_string(a);});
 
+    py::class_<CompactDepth>(m, "CompactDepth")
+            .def_readonly("instrument_id", &CompactDepth::instrument_id)
+            .def_readonly("data_time", &CompactDepth::data_time)
+            .def_readonly("instrument_type", &CompactDepth::instrument_type)
+            .def_readonly("price_exponent", &CompactDepth::price_exponent)
+            .def_readonly("volume_exponent", &CompactDepth::volume_exponent)
+            .def_readonly("bid_levels", &CompactDepth::bid_levels)
+            .def_readonly("ask_levels", &CompactDepth::ask_levels)
+            .def_readonly("exchange_time", &CompactDepth::exchange_time)
+            .def_readonly("receive_time", &CompactDepth::receive_time)
+            .def_property_readonly("bid_price", &CompactDepth::get_bid_price)
+            .def_property_readonly("ask_price", &CompactDepth::get_ask_price)
+            .def_property_readonly("bid_volume", &CompactDepth::get_bid_volume)
+            .def_property_readonly("ask_volume", &CompactDepth::get_ask_volume)
+            .def_property_readonly("raw_address", [](const CompactDepth &a) { return reinterpret_cast<uintptr_t>(&a);})
+            .def_static("from_raw_address", [](uintptr_t addr) -> const CompactDepth & { return *reinterpret_cast<const CompactDepth*>(addr); },
+                        py::return_value_policy::reference)
+            .def("__sizeof__", [](const CompactDepth &a) { return a.length(); })
+            .def("__repr__",[](const CompactDepth &a){return to_string(a);});
+
     py::class_<Ticker>(m, "Ticker")
             .def(py::init<>())
             .def_property("source_id", &Ticker::get_source_id, &Ticker::set_source_id)
@@ -432,10 +468,13 @@ PYBIND11_MODULE(pywingchun, m)
             .def_property("exchange_id", &Ticker::get_exchange_id, &Ticker::set_exchange_id)
             .def_readwrite("data_time", &Ticker::data_time)
             .def_readwrite("instrument_type", &Ticker::instrument_type)
+            .def_readwrite("instrument_id", &Ticker::instrument_id)
             .def_readwrite("bid_price", &Ticker::bid_price)
             .def_readwrite("ask_price", &Ticker::ask_price)
             .def_readwrite("bid_volume", &Ticker::bid_volume)
             .def_readwrite("ask_volume", &Ticker::ask_volume)
+            .def_readwrite("exchange_time", &Ticker::exchange_time)
+            .def_readwrite("receive_time", &Ticker::receive_time)
             .def_property_readonly("raw_address", [](const Ticker &a) { return reinterpret_cast<uintptr_t>(&a);})
             .def("from_raw_address",[](uintptr_t addr) { return * reinterpret_cast<Ticker*>(addr); })
             .def("__sizeof__", [](const Ticker &a) { return sizeof(a); })
@@ -449,6 +488,7 @@ PYBIND11_MODULE(pywingchun, m)
             .def_property("symbol", &Trade::get_symbol, &Trade::set_symbol)
             .def_property("exchange_id", &Trade::get_exchange_id, &Trade::set_exchange_id)
             .def_readwrite("instrument_type", &Trade::instrument_type)
+            .def_readwrite("instrument_id", &Trade::instrument_id)
             .def_readwrite("price", &Trade::price)
             .def_readwrite("volume", &Trade::volume)
             .def_readwrite("side", &Trade::side)
@@ -456,16 +496,61 @@ PYBIND11_MODULE(pywingchun, m)
             .def_readwrite("ask_id", &Trade::ask_id)
             .def_readwrite("bid_id", &Trade::bid_id)
             .def_readwrite("trade_id", &Trade::trade_id)
+            .def_readwrite("exchange_time", &Trade::exchange_time)
+            .def_readwrite("receive_time", &Trade::receive_time)
             .def_property_readonly("raw_address", [](const Trade &a) { return reinterpret_cast<uintptr_t>(&a);})
             .def("from_raw_address",[](uintptr_t addr) { return * reinterpret_cast<Trade*>(addr); })
             .def("__sizeof__", [](const Trade &a) { return sizeof(a); })
             .def("__repr__",[](const Trade &a){return to_string(a);});
 
+    py::class_<LatencyPercentiles>(m, "LatencyPercentiles")
+            .def_readonly("p50", &LatencyPercentiles::p50)
+            .def_readonly("p90", &LatencyPercentiles::p90)
+            .def_readonly("p99", &LatencyPercentiles::p99)
+            .def_readonly("p999", &LatencyPercentiles::p999)
+            .def_readonly("max", &LatencyPercentiles::max)
+            .def("__repr__",[](const LatencyPercentiles &a){return to_string(a);});
+
+    py::class_<MarketDataLatency>(m, "MarketDataLatency")
+            .def_readonly("instrument_id", &MarketDataLatency::instrument_id)
+            .def_readonly("instrument_type", &MarketDataLatency::instrument_type)
+            .def_readonly("msg_type", &MarketDataLatency::msg_type)
+            .def_readonly("begin_time", &MarketDataLatency::begin_time)
+            .def_readonly("end_time", &MarketDataLatency::end_time)
+            .def_readonly("count", &MarketDataLatency::count)
+            .def_readonly("skewed", &MarketDataLatency::skewed)
+            .def_readonly("wire", &MarketDataLatency::wire)
+            .def_readonly("parse", &MarketDataLatency::parse)
+            .def_readonly("journal", &MarketDataLatency::journal)
+            .def_property_readonly("raw_address", [](const MarketDataLatency &a) { return reinterpret_cast<uintptr_t>(&a);})
+            .def_static("from_raw_address", [](uintptr_t addr) -> const MarketDataLatency & { return *reinterpret_cast<const MarketDataLatency*>(addr); },
+                        py::return_value_policy::reference)
+            .def("__sizeof__", [](const MarketDataLatency &a) { return sizeof(a); })
+            .def("__repr__",[](const MarketDataLatency &a){return to_string(a);});
+
+    py::class_<FeedLegStats>(m, "FeedLegStats")
+            .def_readonly("shard", &FeedLegStats::shard)
+            .def_readonly("leg", &FeedLegStats::leg)
+            .def_readonly("legs", &FeedLegStats::legs)
+            .def_readonly("begin_time", &FeedLegStats::begin_time)
+            .def_readonly("end_time", &FeedLegStats::end_time)
+            .def_readonly("wins", &FeedLegStats::wins)
+            .def_readonly("late", &FeedLegStats::late)
+            .def_readonly("lag_count", &FeedLegStats::lag_count)
+            .def_readonly("lag_mean", &FeedLegStats::lag_mean)
+            .def_readonly("lag_max", &FeedLegStats::lag_max)
+            .def_property_readonly("raw_address", [](const FeedLegStats &a) { return reinterpret_cast<uintptr_t>(&a);})
+            .def_static("from_raw_address", [](uintptr_t addr) -> const FeedLegStats & { return *reinterpret_cast<const FeedLegStats*>(addr); },
+                        py::return_value_policy::reference)
+            .def("__sizeof__", [](const FeedLegStats &a) { return sizeof(a); })
+            .def("__repr__",[](const FeedLegStats &a){return to_string(a);});
+
     py::class_<IndexPrice>(m, "IndexPrice")
             .def(py::init<>())
             .def_property("symbol", &IndexPrice::get_symbol, &IndexPrice::set_symbol)
             .def_property("exchange_id", &IndexPrice::get_exchange_id, &IndexPrice::set_exchange_id)
             .def_readwrite("instrument_type", &IndexPrice::instrument_type)
+            .def_readwrite("instrument_id", &IndexPrice::instrument_id)
             .def_readwrite("price", &IndexPrice::price)
             .def_property_readonly("raw_address", [](const IndexPrice &a) { return reinterpret_cast<uintptr_t>(&a);})
             .def("from_raw_address",[](uintptr_t addr) { return * reinterpret_cast<IndexPrice*>(addr); })
@@ -496,6 +581,7 @@ PYBIND11_MODULE(pywingchun, m)
             .def_readwrite("strategy_id", &OrderInput::strategy_id)
             .def_readwrite("order_id", &OrderInput::order_id)
             .def_readwrite("instrument_type", &OrderInput::instrument_type)
+            .def_readwrite("instrument_id", &OrderInput::instrument_id)
             .def_readwrite("price", &OrderInput::price)
             .def_readwrite("stop_price", &OrderInput::stop_price)
             .def_readwrite("volume", &OrderInput::volume)
@@ -519,7 +605,9 @@ PYBIND11_MODULE(pywingchun, m)
             .def_readwrite("order_id", &Order::order_id)
             .def_readwrite("insert_time", &Order::insert_time)
             .def_readwrite("update_time", &Order::update_time)
+            .def_readwrite("send_time", &Order::send_time)
             .def_readwrite("instrument_type", &Order::instrument_type)
+            .def_readwrite("instrument_id", &Order::instrument_id)
             .def_readwrite("price", &Order::price)
             .def_readwrite("stop_price", &Order::stop_price)
             .def_readwrite("avg_price", &Order::avg_price)
@@ -577,6 +665,7 @@ PYBIND11_MODULE(pywingchun, m)
             .def_readwrite("order_id", &MyTrade::order_id)
             .def_readwrite("trade_time", &MyTrade::trade_time)
             .def_readwrite("instrument_type", &MyTrade::instrument_type)
+            .def_readwrite("instrument_id", &MyTrade::instrument_id)
             .def_readwrite("side", &MyTrade::side)
             .def_readwrite("offset", &MyTrade::offset)
             .def_readwrite("price", &MyTrade::price)
@@ -614,6 +703,7 @@ PYBIND11_MODULE(pywingchun, m)
             .def_readwrite("strategy_id", &Position::strategy_id)
             .def_readwrite("update_time", &Position::update_time)
             .def_readwrite("instrument_type", &Position::instrument_type)
+            .def_readwrite("instrument_id", &Position::instrument_id)
             .def_readwrite("direction", &Position::direction)
             .def_readwrite("volume", &Position::volume)
             .def_readwrite("frozen_total", &Position::frozen_total)
@@ -648,7 +738,8 @@ PYBIND11_MODULE(pywingchun, m)
     py::class_<kwb::BookContext, std::shared_ptr<kwb::BookContext>>(m, "BookContext")
             .def("add_book", &kwb::BookContext::add_book)
             .def("pop_book", &kwb::BookContext::pop_book)
-            .def("get_inst_info", &kwb::BookContext::get_inst_info)
+            .def("get_inst_info", py::overload_cast<const std::string &, const std::string &>(&kwb::BookContext::get_inst_info, py::const_))
+            .def("get_inst_info", py::overload_cast<uint32_t>(&kwb::BookContext::get_inst_info, py::const_))
             ;
 
     py::class_<MarketData, PyMarketData, kungfu::practice::apprentice, std::shared_ptr<MarketData>>(m, "MarketData")
@@ -707,6 +798,7 @@ PYBIND11_MODULE(pywingchun, m)
             .def("pre_start", &Ledger::pre_start)
             .def("add_timer", &Ledger::add_timer)
             .def("add_time_interval", &Ledger::add_time_interval)
+            .def("cancel_timer", &Ledger::cancel_timer)
             .def("run", &Ledger::run);
 
     py::class_<strategy::Runner, PyRunner, kungfu::practice::apprentice, std::shared_ptr<strategy::Runner>>(m, "Runner")
@@ -722,7 +814,9 @@ PYBIND11_MODULE(pywingchun, m)
             .def("now", &strategy::Context::now)
             .def("add_timer", &strategy::Context::add_timer)
             .def("add_time_interval", &strategy::Context::add_time_interval)
+            .def("cancel_timer", &strategy::Context::cancel_timer)
             .def("get_market_info", &strategy::Context::get_market_info)
+            .def("get_instrument_id", &strategy::Context::get_instrument_id, py::arg("symbol"), py::arg("exchange"), py::arg("inst_type") = InstrumentType::Spot)
             .def("add_account", &strategy::Context::add_account)
             .def("list_accounts", &strategy::Context::list_accounts)
             .def("get_account_cash_limit", &strategy::Context::get_account_cash_limit)
@@ -757,6 +851,7 @@ PYBIND11_MODULE(pywingchun, m)
             .def("pre_stop", &strategy::Strategy::pre_stop)
             .def("post_stop", &strategy::Strategy::post_stop)
             .def("on_depth", &strategy::Strategy::on_depth)
+            .def("on_compact_depth", &strategy::Strategy::on_compact_depth)
             .def("on_ticker", &strategy::Strategy::on_ticker)
             .def("on_index_price", &strategy::Strategy::on_index_price)
             .def("on_transaction", &strategy::Strategy::on_transaction)
@@ -783,6 +878,7 @@ PYBIND11_MODULE(pywingchun, m)
             .def("insert_child_order", &algo::AlgoContext::insert_order)
             .def("now", &algo::AlgoContext::now)
             .def("add_timer", &algo::AlgoContext::add_timer)
+            .def("cancel_timer", &algo::AlgoContext::cancel_timer)
             .def("add_order", &algo::AlgoContext::add_order);
 
     py::class_<service::Algo, PyAlgoService, service::Algo_ptr>(m, "AlgoService")
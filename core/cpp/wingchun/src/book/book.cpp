@@ -25,6 +25,7 @@ namespace kungfu
             {
                 auto home = app.get_io_device()->get_home();
                 log::copy_log_settings(home, home->name);
+                registry_ = std::make_shared<registry::InstrumentRegistry>(home);
                 this->monitor_instruments();
                 service_location_ = location::make(mode::LIVE, category::SYSTEM, "service", "ledger", app.get_io_device()->get_home()->locator);
             }
@@ -39,6 +40,16 @@ namespace kungfu
                 return this->instruments_.at(id);
             }
 
+            const msg::data::Instrument& BookContext::get_inst_info(uint32_t instrument_id) const
+            {
+                if (instrument_id == registry::UNKNOWN_INSTRUMENT or instrument_id >= instruments_by_id_.size() or
+                    instruments_by_id_[instrument_id].instrument_id != instrument_id)
+                {
+                    throw wingchun_error(fmt::format("no instrument info found for instrument id {}", instrument_id));
+                }
+                return instruments_by_id_[instrument_id];
+            }
+
             std::vector<msg::data::Instrument> BookContext::all_inst_info() const
             {
                 std::vector<msg::data::Instrument> res(instruments_.size());
@@ -62,10 +73,17 @@ namespace kungfu
                     if (! this->app_.is_live()) { return;}
                     SPDLOG_INFO("instrument info updated, size: {}", res.size());
                     this->instruments_.clear();
-                    for (const auto& inst: res)
+                    this->instruments_by_id_.assign(registry_->size(), Instrument{});
+                    for (auto inst: res)
                     {
                         auto id = yijinjing::util::hash_str_32(std::string(inst.symbol).append(inst.exchange_id));
+                        auto instrument_id = registry_->stamp(inst);
                         this->instruments_[id] = inst;
+                        if (instrument_id >= this->instruments_by_id_.size())
+                        {
+                            this->instruments_by_id_.resize(instrument_id + 1, Instrument{});
+                        }
+                        this->instruments_by_id_[instrument_id] = inst;
                     }
                     this->monitor_instruments();
                 });
@@ -74,6 +92,11 @@ namespace kungfu
             void BookContext::pop_book(uint32_t location_uid)
             {
                 books_.erase(location_uid);
+                for (auto id : book_handlers_[location_uid])
+                {
+                    app_.get_dispatcher().off(id);
+                }
+                book_handlers_.erase(location_uid);
             }
 
             void BookContext::add_book(const yijinjing::data::location_ptr& location, const Book_ptr& book)
@@ -116,8 +139,16 @@ namespace kungfu
                     }
                 }
 
-                events_ | is(yijinjing::msg::type::Channel) |
-                $([=](event_ptr event)
+                auto &handlers = book_handlers_[location->uid];
+                auto &dispatcher = app_.get_dispatcher();
+                // orders and trades of a td book are written by td, the ones of a strategy book are written to strategy
+                auto on_book = [&, location](int32_t msg_type, practice::dispatcher::handler h)
+                {
+                    return location->category == category::TD ? dispatcher.on_from(msg_type, location->uid, std::move(h)) :
+                           dispatcher.on_to(msg_type, location->uid, std::move(h));
+                };
+
+                handlers.push_back(dispatcher.on(yijinjing::msg::type::Channel, [=](const event_ptr &event)
                 {
                     const auto& channel = event->data<yijinjing::msg::data::Channel>();
                     if (channel.source_id == location->uid)
@@ -144,10 +175,9 @@ namespace kungfu
                             SPDLOG_WARN("location {} not exist", channel.source_id);
                         }
                     }
-                });
+                }));
 
-                events_ | is(msg::type::Depth) |
-                $([=](event_ptr event)
+                handlers.push_back(dispatcher.on(msg::type::Depth, [=](const event_ptr &event)
                 {
                     try
                     {
@@ -157,13 +187,25 @@ namespace kungfu
                     {
                         SPDLOG_ERROR("Unexpected exception {}", e.what());
                     }
-                });
+                }));
 
-                events_ | is(msg::type::Position) | filter([=](yijinjing::event_ptr e)
+                handlers.push_back(dispatcher.on(msg::type::CompactDepth, [=](const event_ptr &event)
                 {
-                    return location->category == category::TD ? location->uid == e->source() : location->uid == e->dest();
-                }) |
-                $([=](event_ptr event)
+                    try
+                    {
+                        const auto &compact = event->data<msg::data::CompactDepth>();
+                        const auto &instrument = registry_->get(compact.instrument_id);
+                        msg::data::Depth depth;
+                        msg::data::depth_from_compact(compact, instrument.symbol, instrument.exchange_id, depth);
+                        book->on_depth(event, depth);
+                    }
+                    catch (const std::exception &e)
+                    {
+                        SPDLOG_ERROR("Unexpected exception {}", e.what());
+                    }
+                }));
+
+                handlers.push_back(on_book(msg::type::Position, [=](const event_ptr &event)
                 {
                     try
                     {
@@ -173,13 +215,9 @@ namespace kungfu
                     {
                         SPDLOG_ERROR("Unexpected exception {}", e.what());
                     }
-                });
+                }));
 
-                events_ | is(msg::type::MyTrade) | filter([=](yijinjing::event_ptr e)
-                {
-                    return location->category == category::TD ? location->uid == e->source() : location->uid == e->dest();
-                }) |
-                $([=](event_ptr event)
+                handlers.push_back(on_book(msg::type::MyTrade, [=](const event_ptr &event)
                 {
                     try
                     {
@@ -189,23 +227,19 @@ namespace kungfu
                     {
                         SPDLOG_ERROR("Unexpected exception {}", e.what());
                     }
-                });
+                }));
 
-                events_ | is(msg::type::Order) | filter([=](yijinjing::event_ptr e)
+                handlers.push_back(on_book(msg::type::Order, [=](const event_ptr &event)
                 {
-                    return location->category == category::TD ? location->uid == e->source() : location->uid == e->dest();
-                }) |
-                $([=](event_ptr event)
-                  {
-                      try
-                      {
-                          book->on_order(event, event->data<Order>());
-                      }
-                      catch (const std::exception &e)
-                      {
-                          SPDLOG_ERROR("Unexpected exception {}", e.what());
-                      }
-                  });
+                    try
+                    {
+                        book->on_order(event, event->data<Order>());
+                    }
+                    catch (const std::exception &e)
+                    {
+                        SPDLOG_ERROR("Unexpected exception {}", e.what());
+                    }
+                }));
 
                 // events_ | is(msg::type::OrderInput) | filter([=](yijinjing::event_ptr e)
                 // {
@@ -224,22 +258,23 @@ namespace kungfu
                 //       }
                 //   });
 
-                events_ | is(msg::type::Asset) | filter([=](yijinjing::event_ptr e)
+                handlers.push_back(dispatcher.on(msg::type::Asset, [=](const event_ptr &event)
                 {
-                    const auto& asset = e->data<Asset>();
+                    const auto& asset = event->data<Asset>();
                     SPDLOG_DEBUG("Asset event from: {} in {}", asset.holder_uid, location->uid);
-                    return asset.holder_uid == location->uid;
-                })  | $([=](event_ptr event)
-                {
+                    if (asset.holder_uid != location->uid)
+                    {
+                        return;
+                    }
                     try
                     {
-                        book->on_asset(event, event->data<Asset>());
+                        book->on_asset(event, asset);
                     }
                     catch (const std::exception &e)
                     {
                         SPDLOG_ERROR("Unexpected exception {}", e.what());
                     }
-                });
+                }));
 
                 auto home = app_.get_io_device()->get_home();
                 if (home->uid != service_location_->uid)
@@ -26,21 +26,20 @@ namespace kungfu
                     apprentice(location::make(mode::LIVE, category::MD, source, source, std::move(locator)), low_latency)
             {
                 log::copy_log_settings(get_io_device()->get_home(), source);
+                instruments_ = std::make_shared<registry::InstrumentRegistry>(get_io_device()->get_home());
             }
 
             void MarketData::on_start()
             {
                 apprentice::on_start();
 
-                events_ | is(msg::type::SubscribeAll) |
-                $([&](event_ptr event)
+                dispatcher_.on(msg::type::SubscribeAll, [&](const event_ptr &event)
                 {
                     SPDLOG_INFO("subscribe all request");
                     subscribe_all();
                 });
 
-                events_ | is(msg::type::Subscribe) |
-                $([&](event_ptr event)
+                dispatcher_.on(msg::type::Subscribe, [&](const event_ptr &event)
                   {
                       std::vector<Instrument> symbols;
                       auto json_str = event->data_as_string();
@@ -69,8 +68,7 @@ namespace kungfu
 
                   });
 
-                events_ | is(msg::type::Unsubscribe) |
-                $([&](event_ptr event)
+                dispatcher_.on(msg::type::Unsubscribe, [&](const event_ptr &event)
                   {
                       std::vector<Instrument> symbols;
                       auto json_str = event->data_as_string();
@@ -28,39 +28,35 @@ namespace kungfu
                     source_(source), account_id_(account_id)
             {
                 log::copy_log_settings(get_io_device()->get_home(), account_id);
+                instruments_ = std::make_shared<registry::InstrumentRegistry>(get_io_device()->get_home());
             }
 
             void Trader::on_start()
             {
                 apprentice::on_start();
 
-                events_ | is(msg::type::OrderInput) |
-                $([&](event_ptr event)
+                dispatcher_.on(msg::type::OrderInput, [&](const event_ptr &event)
                   {
                       SPDLOG_DEBUG("insert_order in trader");
                       insert_order(event);
                   });
 
-                events_ | is(msg::type::AdjustLeverage) |
-                $([&](event_ptr event)
+                dispatcher_.on(msg::type::AdjustLeverage, [&](const event_ptr &event)
                   {
                       adjust_leverage(event);
                   });
 
-                events_ | is(msg::type::MergePosition) |
-                $([&](event_ptr event)
+                dispatcher_.on(msg::type::MergePosition, [&](const event_ptr &event)
                   {
                       merge_position(event);
                   });
 
-                events_ | is(msg::type::QueryPosition) |
-                $([&](event_ptr event)
+                dispatcher_.on(msg::type::QueryPosition, [&](const event_ptr &event)
                   {
                       query_position(event);
                   });
 
-                events_ | is(msg::type::OrderAction) |
-                $([&](event_ptr event)
+                dispatcher_.on(msg::type::OrderAction, [&](const event_ptr &event)
                   {
                       const auto& action = event->data<OrderAction>();
                       if (action.action_flag == OrderActionFlag::Cancel)
@@ -0,0 +1,169 @@
+/**
+ * This is source code modified under the Apache License 2.0.
+ * Original Author: Keren Dong
+ * Modifier: kx@godzilla.dev
+ * Modification date: March 3, 2025
+ */
+
+#include <thread>
+#include <cerrno>
+#include <signal.h>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+#ifdef _WINDOWS
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <kungfu/yijinjing/util/os.h>
+#include <kungfu/yijinjing/util/util.h>
+#include <kungfu/wingchun/registry/instrument.h>
+
+using namespace kungfu::yijinjing;
+using namespace kungfu::yijinjing::data;
+
+namespace kungfu
+{
+    namespace wingchun
+    {
+        namespace registry
+        {
+            /** bumped whenever layout of the registry file changes */
+            constexpr uint32_t INSTRUMENT_REGISTRY_MAGIC = 0x4B465231;
+
+            inline static int32_t current_pid()
+            {
+#ifdef _WINDOWS
+                return _getpid();
+#else
+                return getpid();
+#endif
+            }
+
+            inline static bool is_alive(int32_t pid)
+            {
+#ifdef _WINDOWS
+                return true;
+#else
+                return kill(pid, 0) == 0 or errno != ESRCH;
+#endif
+            }
+
+            size_t InstrumentKeyHash::operator()(const InstrumentKey &key) const
+            {
+                return util::hash_32(reinterpret_cast<const unsigned char *>(&key), sizeof(InstrumentKey));
+            }
+
+            InstrumentRegistry::InstrumentRegistry(const location_ptr &home) : state_(nullptr), indexed_(0)
+            {
+                auto master = location::make(mode::LIVE, category::SYSTEM, "master", "master", home->locator);
+                path_ = home->locator->layout_dir(master, layout::JOURNAL) + "/instruments";
+                state_ = reinterpret_cast<InstrumentRegistryState *>(
+                        os::load_mmap_buffer(path_, sizeof(InstrumentRegistryState), true, true));
+                if (state_->magic != 0 and state_->magic != INSTRUMENT_REGISTRY_MAGIC)
+                {
+                    os::release_mmap_buffer(reinterpret_cast<uintptr_t>(state_), sizeof(InstrumentRegistryState), true);
+                    throw wingchun_error(fmt::format("incompatible instrument registry {}", path_));
+                }
+                sync();
+            }
+
+            InstrumentRegistry::~InstrumentRegistry()
+            {
+                os::release_mmap_buffer(reinterpret_cast<uintptr_t>(state_), sizeof(InstrumentRegistryState), true);
+            }
+
+            uint32_t InstrumentRegistry::intern(const char *symbol, const char *exchange_id, InstrumentType instrument_type)
+            {
+                auto key = InstrumentKey::make(symbol, exchange_id, instrument_type);
+                auto it = index_.find(key);
+                if (it != index_.end())
+                {
+                    return it->second;
+                }
+                lock();
+                sync();
+                it = index_.find(key);
+                if (it != index_.end())
+                {
+                    unlock();
+                    return it->second;
+                }
+                uint32_t id = state_->count.load(std::memory_order_relaxed) + 1;
+                if (id >= INSTRUMENT_CAPACITY)
+                {
+                    unlock();
+                    SPDLOG_ERROR("instrument registry full, {}.{} not registered", symbol, exchange_id);
+                    return UNKNOWN_INSTRUMENT;
+                }
+                state_->magic = INSTRUMENT_REGISTRY_MAGIC;
+                state_->entries[id] = key;
+                // readers see the entry once they see the count
+                state_->count.store(id, std::memory_order_release);
+                unlock();
+                index_.emplace(key, id);
+                indexed_ = id;
+                SPDLOG_DEBUG("registered instrument {}.{} as {}", key.symbol, key.exchange_id, id);
+                return id;
+            }
+
+            uint32_t InstrumentRegistry::find(const char *symbol, const char *exchange_id, InstrumentType instrument_type)
+            {
+                auto key = InstrumentKey::make(symbol, exchange_id, instrument_type);
+                auto it = index_.find(key);
+                if (it == index_.end() and indexed_ != state_->count.load(std::memory_order_acquire))
+                {
+                    sync();
+                    it = index_.find(key);
+                }
+                return it == index_.end() ? UNKNOWN_INSTRUMENT : it->second;
+            }
+
+            const InstrumentKey &InstrumentRegistry::get(uint32_t id) const
+            {
+                if (id == UNKNOWN_INSTRUMENT or id >= size())
+                {
+                    throw wingchun_error(fmt::format("instrument {} not registered", id));
+                }
+                return state_->entries[id];
+            }
+
+            void InstrumentRegistry::sync()
+            {
+                uint32_t count = state_->count.load(std::memory_order_acquire);
+                for (uint32_t id = indexed_ + 1; id <= count; id++)
+                {
+                    index_.emplace(state_->entries[id], id);
+                }
+                indexed_ = count;
+            }
+
+            void InstrumentRegistry::lock()
+            {
+                int32_t pid = current_pid();
+                int32_t owner = 0;
+                while (not state_->writer_pid.compare_exchange_weak(owner, pid, std::memory_order_acquire))
+                {
+                    // registering is rare and short, only a dead holder keeps the lock for long
+                    if (owner != 0 and not is_alive(owner))
+                    {
+                        SPDLOG_WARN("instrument registry lock held by dead process {}, taken over", owner);
+                        if (state_->writer_pid.compare_exchange_strong(owner, pid, std::memory_order_acquire))
+                        {
+                            return;
+                        }
+                    }
+                    std::this_thread::yield();
+                    owner = 0;
+                }
+            }
+
+            void InstrumentRegistry::unlock()
+            {
+                state_->writer_pid.store(0, std::memory_order_release);
+            }
+        }
+    }
+}
@@ -8,6 +8,7 @@
 #include <kungfu/wingchun/service/bar.h>
 #include <regex>
 #include <kungfu/wingchun/utils.h>
+#include <kungfu/wingchun/registry/instrument.h>
 #include <kungfu/yijinjing/log/setup.h>
 
 using namespace kungfu::yijinjing;
@@ -94,7 +95,8 @@ namespace kungfu
                                   bar.end_time = start_time + time_interval_;
                                   bars_[symbol_id] = bar;
                               }
-                          } });
+                          }
+                          bars_by_instrument_.clear(); });
                 }
                 else
                 {
@@ -115,10 +117,31 @@ namespace kungfu
                             bars_[symbol_id] = bar;
                         }
                     }
+                    bars_by_instrument_.clear();
                 }
                 return true;
             }
 
+            Bar *BarGenerator::find_bar(const Trade &trade)
+            {
+                if (trade.instrument_id != 0 and trade.instrument_id < bars_by_instrument_.size() and
+                    bars_by_instrument_[trade.instrument_id].first)
+                {
+                    return bars_by_instrument_[trade.instrument_id].second;
+                }
+                auto it = bars_.find(get_symbol_id(trade.get_symbol(), trade.get_exchange_id()));
+                Bar *bar = it == bars_.end() ? nullptr : &it->second;
+                if (trade.instrument_id != 0 and trade.instrument_id < registry::INSTRUMENT_CAPACITY)
+                {
+                    if (trade.instrument_id >= bars_by_instrument_.size())
+                    {
+                        bars_by_instrument_.resize(trade.instrument_id + 1, std::make_pair(false, nullptr));
+                    }
+                    bars_by_instrument_[trade.instrument_id] = std::make_pair(true, bar);
+                }
+                return bar;
+            }
+
             void BarGenerator::register_location(int64_t trigger_time, const yijinjing::data::location_ptr &location)
             {
                 if (has_location(location->uid))
@@ -142,11 +165,11 @@ namespace kungfu
                     $([&](event_ptr event)
                       {
                     const auto& trade = event->data<Trade>();
-                    auto symbol_id = get_symbol_id(trade.get_symbol(), trade.get_exchange_id());
-                    if (bars_.find(symbol_id) != bars_.end())
+                    auto found = find_bar(trade);
+                    if (found != nullptr)
                     {
                         SPDLOG_TRACE("{}.{} at {} vol {} price {}", trade.symbol, trade.exchange_id, time::strftime(trade.trade_time), trade.volume, trade.price);
-                        auto& bar = bars_[symbol_id];
+                        auto& bar = *found;
                         if (trade.trade_time >= bar.start_time && trade.trade_time <= bar.end_time)
                         {
                             if(bar.trade_count == 0)
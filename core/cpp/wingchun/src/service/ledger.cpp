@@ -206,8 +206,7 @@ namespace kungfu
 
                 pre_start();
 
-                events_ | is(msg::type::BrokerState) |
-                $([&](event_ptr event)
+                dispatcher_.on(msg::type::BrokerState, [&](const event_ptr &event)
                   {
                       auto broker_location = get_location(event->source());
                       update_broker_state(event->gen_time(), broker_location, static_cast<BrokerState>(event->data<int32_t>()));
@@ -227,8 +226,7 @@ namespace kungfu
                 /**
                  * process trade events
                  */
-                events_ | is(msg::type::Depth) |
-                $([&](event_ptr event)
+                dispatcher_.on(msg::type::Depth, [&](const event_ptr &event)
                   {
                       try
                       { on_depth(event, event->data<Depth>()); }
@@ -238,8 +236,7 @@ namespace kungfu
                       }
                   });
 
-                events_ | is(msg::type::Trade) |
-                $([&](event_ptr event)
+                dispatcher_.on(msg::type::Trade, [&](const event_ptr &event)
                   {
                       try
                       { on_trade(event, event->data<Trade>()); }
@@ -249,8 +246,7 @@ namespace kungfu
                       }
                   });
 
-                events_ | is(msg::type::Order) |
-                $([&](event_ptr event)
+                dispatcher_.on(msg::type::Order, [&](const event_ptr &event)
                   {
                       try
                       { on_order(event, event->data<Order>()); }
@@ -260,8 +256,7 @@ namespace kungfu
                       }
                   });
 
-                events_ | is(msg::type::MyTrade) |
-                $([&](event_ptr event)
+                dispatcher_.on(msg::type::MyTrade, [&](const event_ptr &event)
                   {
                       try
                       { on_transaction(event, event->data<MyTrade>()); }
@@ -271,8 +266,7 @@ namespace kungfu
                       }
                   });
 
-                events_ | is(msg::type::QryAsset) |
-                $([&](event_ptr event)
+                dispatcher_.on(msg::type::QryAsset, [&](const event_ptr &event)
                 {
                     try
                     {
@@ -295,8 +289,7 @@ namespace kungfu
                     }
                 });
 
-                events_ | is(msg::type::InstrumentRequest) |
-                $([&](event_ptr event)
+                dispatcher_.on(msg::type::InstrumentRequest, [&](const event_ptr &event)
                 {
                     try {
                         handle_instrument_request(event);
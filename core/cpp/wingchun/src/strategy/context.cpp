@@ -27,10 +27,11 @@ namespace kungfu
         namespace strategy
         {
             Context::Context(practice::apprentice &app, const rx::connectable_observable<yijinjing::event_ptr> &events) :
-                app_(app), events_(events), subscribe_all_(false)
+                app_(app), events_(events)
             {
                 auto home = app.get_io_device()->get_home();
                 log::copy_log_settings(home, home->name);
+                instruments_ = std::make_shared<registry::InstrumentRegistry>(home);
                 book_context_ = std::make_shared<book::BookContext>(app, events);
                 algo_context_ = std::make_shared<algo::AlgoContext>(app, events);
             }
@@ -64,10 +65,10 @@ namespace kungfu
                 return app_.now();
             }
 
-            void Context::add_timer(int64_t nanotime, const std::function<void(yijinjing::event_ptr)>& callback)
+            practice::timer_handle Context::add_timer(int64_t nanotime, const std::function<void(yijinjing::event_ptr)>& callback)
             {
                 auto strategy_id = get_current_strategy_index();
-                app_.add_timer(nanotime, [this, callback, strategy_id](yijinjing::event_ptr e){
+                return app_.add_timer(nanotime, [this, callback, strategy_id](yijinjing::event_ptr e){
                     auto prev_strategy_id = get_current_strategy_index();
                     set_current_strategy_index(strategy_id);
                     callback(e);
@@ -75,10 +76,10 @@ namespace kungfu
                     });
             }
 
-            void Context::add_time_interval(int64_t duration, const std::function<void(yijinjing::event_ptr)>& callback)
+            practice::timer_handle Context::add_time_interval(int64_t duration, const std::function<void(yijinjing::event_ptr)>& callback)
             {
                 auto strategy_id = get_current_strategy_index();
-                app_.add_time_interval(duration, [this, callback, strategy_id](yijinjing::event_ptr e){
+                return app_.add_time_interval(duration, [this, callback, strategy_id](yijinjing::event_ptr e){
                     auto prev_strategy_id = get_current_strategy_index();
                     set_current_strategy_index(strategy_id);
                     callback(e);
@@ -86,6 +87,11 @@ namespace kungfu
                     });
             }
 
+            bool Context::cancel_timer(practice::timer_handle handle)
+            {
+                return app_.cancel_timer(handle);
+            }
+
             void Context::add_account(const std::string &source, const std::string &account)
             {
                 uint32_t account_id = yijinjing::util::hash_str_32(account);
@@ -235,7 +241,7 @@ namespace kungfu
 
             void Context::subscribe_all(const std::string &source)
             {
-                subscribe_all_ = true;
+                subscriptions_.subscribe_all();
                 auto md_source = add_marketdata(source);
                 SPDLOG_INFO("strategy subscribe all from {} [{:08x}]", source, md_source);
                 if (not app_.has_writer(md_source))
@@ -260,11 +266,12 @@ namespace kungfu
 
             void Context::_subscribe(const std::string &sub_type, const std::string &source, const std::vector<std::string> &symbols, InstrumentType inst_type, const std::string &exchange)
             {
+                auto type = get_subscribe_type(sub_type);
                 for (const auto& symbol: symbols)
                 {
                     SPDLOG_TRACE("_subscribe: instrument_type({}), strategy_id({})", static_cast<int>(inst_type), current_strategy_idx);
-                    auto symbol_id = get_symbol_id(symbol, sub_type, inst_type, exchange, current_strategy_idx);
-                    subscribed_symbols_[symbol_id] = symbol_id;
+                    subscriptions_.subscribe(type, current_strategy_idx, symbol, inst_type, exchange,
+                                             instruments_->intern(symbol, exchange, inst_type));
                 }
 
                 auto md_source = add_marketdata(source);
@@ -289,11 +296,11 @@ namespace kungfu
 
             void Context::_unsubscribe(const std::string &sub_type, const std::string &source, const std::vector<std::string> &symbols, InstrumentType inst_type, const std::string &exchange)
             {
+                auto type = get_subscribe_type(sub_type);
                 for (const auto& symbol: symbols)
                 {
                     SPDLOG_TRACE("_unsubscribe: instrument_type({}), strategy_id({})", static_cast<int>(inst_type), current_strategy_idx);
-                    auto symbol_id = get_symbol_id(symbol, sub_type, inst_type, exchange, current_strategy_idx);
-                    subscribed_symbols_[symbol_id] = symbol_id;
+                    subscriptions_.unsubscribe(type, current_strategy_idx, symbol, inst_type, exchange);
                 }
 
                 auto md_source = add_marketdata(source);
@@ -376,8 +383,6 @@ namespace kungfu
                 //    SPDLOG_CRITICAL("Invalid order blocked by hard limit: (symbol){}, (amount){}", symbol, limit_price*volume);
                 //    return 0;
                 //}
-                auto symbol_id = get_symbol_id(symbol, "order", inst_type, exchange, current_strategy_idx);
-                subscribed_symbols_[symbol_id] = symbol_id;
                 auto writer = app_.get_writer(lookup_account_location_id(account));
                 SPDLOG_DEBUG("{:08x} insert order with account location {:08x}", app_.get_home_uid(), lookup_account_location_id(account));
                 msg::data::OrderInput &input = writer->open_data<msg::data::OrderInput>(0, msg::type::OrderInput);
@@ -387,6 +392,7 @@ namespace kungfu
                 strcpy(input.exchange_id, exchange.c_str());
                 strcpy(input.account_id, account.c_str());
                 input.instrument_type = inst_type;
+                instruments_->stamp(input);
                 input.price = limit_price;
                 input.stop_price = limit_price;
                 input.volume = volume;
@@ -402,8 +408,6 @@ namespace kungfu
 
             uint64_t Context::query_order(const std::string &account, uint64_t order_id, std::string &ex_order_id, InstrumentType inst_type, const std::string &symbol)
             {
-                auto symbol_id = get_symbol_id(symbol, "order", InstrumentType::Spot, "", current_strategy_idx);
-                subscribed_symbols_[symbol_id] = symbol_id;
                 auto writer = app_.get_writer(lookup_account_location_id(account));
                 SPDLOG_DEBUG("{:08x} query order {:016x} with account location {:08x}", app_.get_home_uid(), order_id, lookup_account_location_id(account));
                 msg::data::OrderAction &action = writer->open_data<msg::data::OrderAction>(0, msg::type::OrderAction);
@@ -435,8 +439,6 @@ namespace kungfu
 
             uint64_t Context::cancel_order(const std::string &account, uint64_t order_id, std::string &symbol, std::string &ex_order_id, InstrumentType inst_type)
             {
-                auto symbol_id = get_symbol_id("", "order", InstrumentType::Spot, "", current_strategy_idx);
-                subscribed_symbols_[symbol_id] = symbol_id;
                 auto writer = app_.get_writer(lookup_account_location_id(account));
                 SPDLOG_DEBUG("{:08x} cancel order {} with account account {}", app_.get_home_uid(), order_id, account);
                 // auto writer = app_.get_writer(account_location_id);
@@ -468,6 +470,11 @@ namespace kungfu
             {
                 return "";
             }
+
+            uint32_t Context::get_instrument_id(const std::string &symbol, const std::string &exchange, InstrumentType inst_type)
+            {
+                return instruments_->intern(symbol, exchange, inst_type);
+            }
         }
     }
 }
@@ -57,58 +57,67 @@ namespace kungfu
                 context_ = make_context();
                 context_->react();
 
+                // slots first, subscribe all covers every strategy
+                for (const auto &strategy : strategies_)
+                {
+                    auto slot = context_->subscriptions_.get_strategy_slot(strategy.first);
+                    strategy_slots_.resize(slot + 1);
+                    strategy_slots_[slot] = strategy.second;
+                }
+
                 for (const auto &strategy : strategies_)
                 {
                     context_->set_current_strategy_index(strategy.first);
                     strategy.second->pre_start(context_);
                 }
 
-                events_ | is(msg::type::Depth) |
-                $([&](event_ptr event)
+                dispatcher_.on(msg::type::Depth, [&](const event_ptr &event)
                 {
-                    for (const auto &strategy : strategies_)
+                    const Depth &data = event->data<Depth>();
+                    for_each_subscriber(SubscribeType::Depth, data, [&](const Strategy_ptr &strategy)
                     {
-                        context_->set_current_strategy_index(strategy.first);
-                        if (context_->is_subscribed("depth", strategy.first, event->data<Depth>())) {
-                            strategy.second->on_depth(context_, event->data<Depth>());
-                        }
-                    }
+                        strategy->on_depth(context_, data);
+                    });
                 });
 
-                events_ | is(msg::type::Ticker) |
-                $([&](event_ptr event)
+                dispatcher_.on(msg::type::CompactDepth, [&](const event_ptr &event)
                 {
-                    for (const auto &strategy : strategies_)
+                    const CompactDepth &data = event->data<CompactDepth>();
+                    const auto &instrument = context_->get_instrument_registry()->get(data.instrument_id);
+                    Depth depth;
+                    depth_from_compact(data, instrument.symbol, instrument.exchange_id, depth);
+                    for_each_subscriber(SubscribeType::Depth, depth, [&](const Strategy_ptr &strategy)
                     {
-                        context_->set_current_strategy_index(strategy.first);
-                        if (context_->is_subscribed("ticker", strategy.first, event->data<Ticker>())) {
-                            strategy.second->on_ticker(context_, event->data<Ticker>());
-                        }
-                    }
+                        strategy->on_compact_depth(context_, data);
+                        strategy->on_depth(context_, depth);
+                    });
                 });
 
-                events_ | is(msg::type::Trade) |
-                $([&](event_ptr event)
+                dispatcher_.on(msg::type::Ticker, [&](const event_ptr &event)
                 {
-                    for (const auto &strategy : strategies_)
+                    const Ticker &data = event->data<Ticker>();
+                    for_each_subscriber(SubscribeType::Ticker, data, [&](const Strategy_ptr &strategy)
                     {
-                        context_->set_current_strategy_index(strategy.first);
-                        if (context_->is_subscribed("trade", strategy.first, event->data<Trade>())) {
-                            strategy.second->on_trade(context_, event->data<Trade>());
-                        }
-                    }
+                        strategy->on_ticker(context_, data);
+                    });
                 });
 
-                events_ | is(msg::type::IndexPrice) |
-                $([&](event_ptr event)
+                dispatcher_.on(msg::type::Trade, [&](const event_ptr &event)
                 {
-                    for (const auto &strategy : strategies_)
+                    const Trade &data = event->data<Trade>();
+                    for_each_subscriber(SubscribeType::Trade, data, [&](const Strategy_ptr &strategy)
                     {
-                        context_->set_current_strategy_index(strategy.first);
-                        if (context_->is_subscribed("index_price", strategy.first, event->data<IndexPrice>())) {
-                            strategy.second->on_index_price(context_, event->data<IndexPrice>());
-                        }
-                    }
+                        strategy->on_trade(context_, data);
+                    });
+                });
+
+                dispatcher_.on(msg::type::IndexPrice, [&](const event_ptr &event)
+                {
+                    const IndexPrice &data = event->data<IndexPrice>();
+                    for_each_subscriber(SubscribeType::IndexPrice, data, [&](const Strategy_ptr &strategy)
+                    {
+                        strategy->on_index_price(context_, data);
+                    });
                 });
 
                 /* 3 */
@@ -121,8 +130,7 @@ namespace kungfu
                 //       }
                 //   });
 
-                events_ | is(msg::type::Order) | to(context_->app_.get_home_uid()) |
-                $([&](event_ptr event)
+                dispatcher_.on_to(msg::type::Order, get_home_uid(), [&](const event_ptr &event)
                 {
                     auto order = event->data<Order>();
                     for (const auto &strategy : strategies_)
@@ -151,8 +159,7 @@ namespace kungfu
                 //     }
                 // });
 
-                events_ | is(msg::type::MyTrade) | to(context_->app_.get_home_uid()) |
-                $([&](event_ptr event)
+                dispatcher_.on_to(msg::type::MyTrade, get_home_uid(), [&](const event_ptr &event)
                 {
                     auto myTrade = event->data<MyTrade>();
                     auto itr = strategies_.find(myTrade.strategy_id);
@@ -162,8 +169,7 @@ namespace kungfu
                     }
                 });
 
-                events_ | is(msg::type::Position) |
-                $([&](event_ptr event)
+                dispatcher_.on(msg::type::Position, [&](const event_ptr &event)
                 {
                     auto position = event->data<Position>();
                     for (const auto &strategy : strategies_)
@@ -173,8 +179,7 @@ namespace kungfu
                     }
                 });
 
-                events_ | is(msg::type::UnionResponse) | to(context_->app_.get_home_uid()) |
-                $([&](event_ptr event)
+                dispatcher_.on_to(msg::type::UnionResponse, get_home_uid(), [&](const event_ptr &event)
                 {
                     nlohmann::json sub_msg = nlohmann::json::parse(event->data_as_string());
                     auto itr = strategies_.find(sub_msg["strategy_id"]);
@@ -0,0 +1,83 @@
+/**
+ * This is source code modified under the Apache License 2.0.
+ * Original Author: Keren Dong
+ * Modifier: kx@godzilla.dev
+ * Modification date: March 3, 2025
+ */
+
+#include <kungfu/wingchun/strategy/subscription.h>
+
+namespace kungfu
+{
+    namespace wingchun
+    {
+        namespace strategy
+        {
+            uint32_t SubscriptionTable::get_strategy_slot(uint32_t strategy_uid)
+            {
+                auto it = strategy_slots_.find(strategy_uid);
+                if (it != strategy_slots_.end())
+                {
+                    return it->second;
+                }
+                auto slot = static_cast<uint32_t>(strategy_uids_.size());
+                strategy_slots_.emplace(strategy_uid, slot);
+                strategy_uids_.push_back(strategy_uid);
+                set(all_, slot, true);
+                return slot;
+            }
+
+            void SubscriptionTable::subscribe(SubscribeType type, uint32_t strategy_uid, const std::string &symbol,
+                                              InstrumentType inst_type, const std::string &exchange, uint32_t instrument_id)
+            {
+                auto slot = get_strategy_slot(strategy_uid);
+                auto key = make_key(type, symbol.c_str(), inst_type, exchange.c_str());
+                auto it = ids_.find(key);
+                if (it == ids_.end())
+                {
+                    it = ids_.emplace(key, static_cast<uint32_t>(subscribers_.size())).first;
+                    subscribers_.emplace_back();
+                }
+                set(subscribers_[it->second], slot, true);
+                if (instrument_id == 0)
+                {
+                    unresolved_ = true;
+                    return;
+                }
+                auto &by_instrument = by_instrument_[static_cast<size_t>(type)];
+                if (instrument_id >= by_instrument.size())
+                {
+                    by_instrument.resize(instrument_id + 1, 0);
+                }
+                by_instrument[instrument_id] = it->second + 1;
+            }
+
+            void SubscriptionTable::unsubscribe(SubscribeType type, uint32_t strategy_uid, const std::string &symbol,
+                                                InstrumentType inst_type, const std::string &exchange)
+            {
+                auto slot = strategy_slots_.find(strategy_uid);
+                auto it = ids_.find(make_key(type, symbol.c_str(), inst_type, exchange.c_str()));
+                if (slot != strategy_slots_.end() and it != ids_.end())
+                {
+                    // id stays, strategies subscribing again reuse it
+                    set(subscribers_[it->second], slot->second, false);
+                }
+            }
+
+            void SubscriptionTable::set(StrategyBits &bits, uint32_t slot, bool value)
+            {
+                if (slot / 64 >= bits.size())
+                {
+                    bits.resize(slot / 64 + 1, 0);
+                }
+                if (value)
+                {
+                    bits[slot / 64] |= uint64_t(1) << (slot % 64);
+                } else
+                {
+                    bits[slot / 64] &= ~(uint64_t(1) << (slot % 64));
+                }
+            }
+        }
+    }
+}
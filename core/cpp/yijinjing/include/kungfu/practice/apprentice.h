@@ -14,6 +14,7 @@
 #include <kungfu/yijinjing/time.h>
 #include <kungfu/yijinjing/io.h>
 #include <kungfu/practice/hero.h>
+#include <kungfu/practice/timer_wheel.h>
 
 namespace kungfu
 {
@@ -28,6 +29,13 @@ namespace kungfu
 
             void request_read_from(int64_t trigger_time, uint32_t source_id, bool pub = false);
 
+            /**
+             * open a writer to one more public journal of this location, dest_id must not be a location uid, master
+             * tells every apprentice about it so that readers of the public journal here join this one as well
+             */
+            yijinjing::journal::writer_ptr open_public_writer(uint32_t dest_id,
+                                                              yijinjing::journal::writer_mode write_mode = yijinjing::journal::writer_mode::LOCKED);
+
             uint32_t get_master_commands_uid()
             {
                 return master_commands_location_->uid;
@@ -56,15 +64,29 @@ namespace kungfu
                 writers_[dest_id]->write(trigger_time, msg_type, data);
             }
 
-            void add_timer(int64_t nanotime, const std::function<void(yijinjing::event_ptr)> &callback);
+            /**
+             * call back once at nanotime, timers of live apprentice run on its own timer wheel, otherwise on time events
+             * of master so that backtest and replay stay deterministic
+             * @return handle to cancel_timer
+             */
+            timer_handle add_timer(int64_t nanotime, const std::function<void(yijinjing::event_ptr)> &callback);
+
+            /** call back every duration nanoseconds from now, @return handle to cancel_timer */
+            timer_handle add_time_interval(int64_t duration, const std::function<void(yijinjing::event_ptr)> &callback);
 
-            void add_time_interval(int64_t nanotime, const std::function<void(yijinjing::event_ptr)> &callback);
+            /** @return false if timer already fired or cancelled */
+            bool cancel_timer(timer_handle handle);
 
         protected:
             yijinjing::data::location_ptr config_location_;
 
             void react() override;
 
+            bool produce_one(const rx::subscriber<yijinjing::event_ptr> &sb) override;
+
+            int64_t next_wakeup_time() override
+            { return timer_wheel_.next_deadline(); }
+
             virtual void on_start()
             {}
 
@@ -89,8 +111,10 @@ namespace kungfu
                     boost::ignore_unused(src);
                     return events_ | rx::filter([&, duration_ns, timer_usage_count](yijinjing::event_ptr e)
                                                 {
+                                                    auto checkpoint = timer_checkpoints_.find(timer_usage_count);
                                                     return (e->msg_type() == yijinjing::msg::type::Time &&
-                                                            e->gen_time() > timer_checkpoints_[timer_usage_count] + duration_ns);
+                                                            checkpoint != timer_checkpoints_.end() &&
+                                                            e->gen_time() > checkpoint->second + duration_ns);
                                                 }) | rx::first();
                 };
             }
@@ -113,8 +137,10 @@ namespace kungfu
                     return events_ |
                            rx::filter([&, duration_ns, timer_usage_count](yijinjing::event_ptr e)
                                       {
+                                          auto checkpoint = timer_checkpoints_.find(timer_usage_count);
                                           if (e->msg_type() == yijinjing::msg::type::Time &&
-                                              e->gen_time() > timer_checkpoints_[timer_usage_count] + duration_ns)
+                                              checkpoint != timer_checkpoints_.end() &&
+                                              e->gen_time() > checkpoint->second + duration_ns)
                                           {
                                               auto writer = writers_[master_commands_location_->uid];
                                               yijinjing::msg::data::TimeRequest &r = writer->open_data
@@ -181,12 +207,24 @@ namespace kungfu
             yijinjing::data::location_ptr master_home_location_;
             yijinjing::data::location_ptr master_commands_location_;
             std::unordered_map<int, int64_t> timer_checkpoints_;
+            /** locations whose public journals are read, to the time reading started */
+            std::unordered_map<uint32_t, int64_t> public_sources_;
             int32_t timer_usage_count_;
+            timer_wheel timer_wheel_;
+
+            /** tells handles of timers on master time events from the ones on timer wheel */
+            static constexpr timer_handle MASTER_TIMER = timer_handle(1) << 63;
+
+            timer_wheel::callback make_timer_callback(const std::function<void(yijinjing::event_ptr)> &callback);
 
             void checkin();
 
             void register_location_from_event(const yijinjing::event_ptr &event);
             void deregister_location_from_event(const yijinjing::event_ptr &event);
+
+            /** public journals other than dest 0 are announced as channels to a dest which is not a location */
+            bool is_public_channel(const yijinjing::msg::data::Channel &channel)
+            { return not has_location(channel.dest_id); }
         };
 
         DECLARE_PTR(apprentice)
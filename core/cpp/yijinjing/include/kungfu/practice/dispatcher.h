@@ -0,0 +1,153 @@
+/**
+ * This is source code modified under the Apache License 2.0.
+ * Original Author: Keren Dong
+ * Modifier: kx@godzilla.dev
+ * Modification date: March 3, 2025
+ */
+
+#ifndef KUNGFU_DISPATCHER_H
+#define KUNGFU_DISPATCHER_H
+
+#include <deque>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <unordered_map>
+
+#include <kungfu/yijinjing/common.h>
+
+namespace kungfu
+{
+    namespace practice
+    {
+        /** identifies a registered handler for off, 0 is never a valid id */
+        typedef uint64_t handler_id;
+
+        /**
+         * Calls handlers registered by msg_type, and optionally by source or dest, directly for each event produced by
+         * hero, after the rx events stream had it. Costs one table lookup per event no matter how many handlers are
+         * registered for other types or locations, where every rx filter subscription sees every event.
+         * For one event handlers run in this order: by msg_type, by source, by dest, each in the order registered.
+         * Handlers registered while dispatching do not see the current event. Not thread safe.
+         */
+        class dispatcher
+        {
+        public:
+            typedef std::function<void(const yijinjing::event_ptr &)> handler;
+
+            dispatcher();
+
+            /** handle all events of msg_type */
+            handler_id on(int32_t msg_type, handler h);
+
+            /** handle events of msg_type written by source */
+            handler_id on_from(int32_t msg_type, uint32_t source, handler h);
+
+            /** handle events of msg_type written to dest */
+            handler_id on_to(int32_t msg_type, uint32_t dest, handler h);
+
+            /** @return false if no such handler, its slot is reclaimed once no handler is running */
+            bool off(handler_id id);
+
+            inline void dispatch(const yijinjing::event_ptr &event)
+            {
+                int32_t msg_type = event->msg_type();
+                const route *r = nullptr;
+                if (msg_type >= 0 and msg_type < DENSE_MSG_TYPES)
+                {
+                    r = dense_[msg_type].get();
+                } else if (not sparse_.empty())
+                {
+                    auto it = sparse_.find(msg_type);
+                    r = it == sparse_.end() ? nullptr : &it->second;
+                }
+                if (r == nullptr)
+                {
+                    return;
+                }
+                depth_++;
+                call(r->all, event);
+                if (not r->by_source.empty())
+                {
+                    auto it = r->by_source.find(event->source());
+                    if (it != r->by_source.end())
+                    {
+                        call(it->second, event);
+                    }
+                }
+                if (not r->by_dest.empty())
+                {
+                    auto it = r->by_dest.find(event->dest());
+                    if (it != r->by_dest.end())
+                    {
+                        call(it->second, event);
+                    }
+                }
+                if (--depth_ == 0 and not retired_.empty())
+                {
+                    release_retired();
+                }
+            }
+
+        private:
+            /** msg types below are looked up by index, wingchun types all fit, yijinjing system types go to the map */
+            static constexpr int32_t DENSE_MSG_TYPES = 1024;
+
+            struct slot
+            {
+                handler fn;
+                handler_id id;
+                bool active;
+            };
+
+            // deque keeps handlers in place while new ones are registered by a running handler
+            typedef std::deque<slot> handlers;
+
+            typedef std::unordered_map<uint32_t, handlers> keyed_handlers;
+
+            struct route
+            {
+                handlers all;
+                keyed_handlers by_source;
+                keyed_handlers by_dest;
+            };
+
+            /** where a handler lives, keyed is null for handlers of all events of a msg type */
+            struct registration
+            {
+                handlers *list;
+                size_t index;
+                keyed_handlers *keyed;
+                uint32_t key;
+            };
+
+            std::vector<std::unique_ptr<route>> dense_;
+            std::unordered_map<int32_t, route> sparse_;
+            std::unordered_map<handler_id, registration> registry_;
+            std::vector<registration> retired_;
+            handler_id last_id_;
+            int depth_;
+
+            route &get_route(int32_t msg_type);
+
+            handler_id add(handlers &list, keyed_handlers *keyed, uint32_t key, handler h);
+
+            void release_retired();
+
+            void compact(const registration &r);
+
+            static inline void call(const handlers &list, const yijinjing::event_ptr &event)
+            {
+                for (size_t i = 0, n = list.size(); i < n; i++)
+                {
+                    if (list[i].active)
+                    {
+                        list[i].fn(event);
+                    }
+                }
+            }
+        };
+    }
+}
+
+#endif //KUNGFU_DISPATCHER_H
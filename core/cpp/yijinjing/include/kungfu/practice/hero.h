@@ -13,6 +13,8 @@
 #include <kungfu/yijinjing/io.h>
 #include <kungfu/yijinjing/msg.h>
 #include <kungfu/yijinjing/journal/journal.h>
+#include <kungfu/yijinjing/util/os.h>
+#include <kungfu/practice/dispatcher.h>
 
 namespace kungfu
 {
@@ -40,6 +42,9 @@ namespace kungfu
 
             void run();
 
+            /** place calling thread as thread policy of home location says for role */
+            void place_thread(yijinjing::os::thread_role role);
+
             bool is_live()
             { return live_; }
 
@@ -78,6 +83,10 @@ namespace kungfu
 
             std::unordered_map<uint64_t, yijinjing::msg::data::Channel>& get_channels() { return channels_; }
 
+            /** handlers registered here are called directly by msg type, cheaper than subscribing to events stream */
+            dispatcher &get_dispatcher()
+            { return dispatcher_; }
+
         protected:
             std::unordered_map<uint64_t, yijinjing::msg::data::Channel> channels_;
             std::unordered_map<uint32_t, yijinjing::data::location_ptr> locations_;
@@ -88,6 +97,7 @@ namespace kungfu
             int64_t end_time_;
             int64_t now_;
             rx::connectable_observable<yijinjing::event_ptr> events_;
+            dispatcher dispatcher_;
 
             virtual void register_location(int64_t trigger_time, const yijinjing::data::location_ptr &location);
 
@@ -107,10 +117,16 @@ namespace kungfu
 
             virtual bool produce_one(const rx::subscriber<yijinjing::event_ptr> &sb);
 
+            /** time by which produce_one has to come back even if no event arrives, INT64_MAX for none */
+            virtual int64_t next_wakeup_time()
+            { return INT64_MAX; }
+
             virtual void react() = 0;
 
         private:
             yijinjing::io_device_with_reply_ptr io_device_;
+            std::shared_ptr<yijinjing::journal::idle_strategy> idle_strategy_;
+            yijinjing::data::thread_policy thread_policy_;
             volatile bool live_ = true;
 
             static void delegate_produce(hero *instance, const rx::subscriber<yijinjing::event_ptr> &sb);
@@ -0,0 +1,107 @@
+/**
+ * This is source code modified under the Apache License 2.0.
+ * Original Author: Keren Dong
+ * Modifier: kx@godzilla.dev
+ * Modification date: March 3, 2025
+ */
+
+#ifndef KUNGFU_TIMER_WHEEL_H
+#define KUNGFU_TIMER_WHEEL_H
+
+#include <cstdint>
+#include <vector>
+#include <functional>
+
+namespace kungfu
+{
+    namespace practice
+    {
+        /** identifies a scheduled timer for cancel, 0 is never a valid handle */
+        typedef uint64_t timer_handle;
+
+        /**
+         * Hierarchical timing wheel, 4 levels of 256 slots, driven by whoever owns it calling advance with its clock.
+         * Timers are kept in intrusive lists indexed in a pool, so schedule and cancel are O(1) and do not allocate once
+         * the pool has grown. Timers fire at the first advance reaching their deadline rounded up to tick, in deadline
+         * order across ticks. Not thread safe, meant to live in the event loop thread.
+         */
+        class timer_wheel
+        {
+        public:
+            /** called with the time advance was called with */
+            typedef std::function<void(int64_t)> callback;
+
+            static constexpr int LEVEL_BITS = 8;
+            static constexpr int SLOTS = 1 << LEVEL_BITS;
+            static constexpr int LEVELS = 4;
+
+            timer_wheel(int64_t tick, int64_t start_time);
+
+            /**
+             * @param deadline time to fire, fires on next advance if already passed
+             * @param interval repeat every interval after deadline if positive, fire once otherwise
+             * @return handle to cancel
+             */
+            timer_handle schedule(int64_t deadline, int64_t interval, callback cb);
+
+            /** @return false if timer already fired (and does not repeat) or cancelled */
+            bool cancel(timer_handle handle);
+
+            /** fire all timers due by now, @return number of timers fired */
+            int advance(int64_t now);
+
+            /** earliest time advance might have work to do, INT64_MAX if no timer pending */
+            int64_t next_deadline() const;
+
+            size_t size() const
+            { return size_; }
+
+            int64_t get_tick() const
+            { return tick_; }
+
+        private:
+            static constexpr int32_t NIL = -1;
+            static constexpr int32_t DUE = LEVELS * SLOTS;
+            static constexpr int32_t FIRING = DUE + 1;
+            static constexpr int32_t RUNNING = DUE + 2;
+            static constexpr int32_t CANCELLED = DUE + 3;
+            static constexpr int32_t FREE = DUE + 4;
+
+            struct entry
+            {
+                int64_t deadline;
+                int64_t interval;
+                int64_t expire_tick;
+                callback cb;
+                uint32_t generation;
+                int32_t list;
+                int32_t prev;
+                int32_t next;
+            };
+
+            const int64_t tick_;
+            int64_t current_tick_;
+            size_t size_;
+            std::vector<entry> entries_;
+            std::vector<int32_t> free_;
+            int32_t heads_[FIRING + 1];
+            int32_t pending_[LEVELS];
+
+            void link(int32_t index);
+
+            void link_to(int32_t index, int32_t list);
+
+            void unlink(int32_t index);
+
+            void release(int32_t index);
+
+            void cascade(int level);
+
+            int fire_list(int32_t list, int64_t now);
+
+            void fire(int32_t index, int64_t now);
+        };
+    }
+}
+
+#endif //KUNGFU_TIMER_WHEEL_H
@@ -9,6 +9,7 @@
 #define KUNGFU_YIJINJING_COMMON_H
 
 #include <utility>
+#include <vector>
 #include <typeinfo>
 #include <signal.h>
 #include <fmt/format.h>
@@ -82,6 +83,10 @@ namespace kungfu
 
             virtual int notify() = 0;
 
+            /** frames were written to journal of location_uid/dest_id, publishers which can tell its readers apart override */
+            virtual int notify_journal(uint32_t location_uid, uint32_t dest_id)
+            { return notify(); }
+
             virtual int publish(const std::string &json_message) = 0;
         };
 
@@ -95,7 +100,15 @@ namespace kungfu
 
             virtual bool wait() = 0;
 
+            /** wait as wait() does, but do not block past deadline in nanoseconds */
+            virtual bool wait_until(int64_t deadline)
+            { return wait(); }
+
             virtual const std::string &get_notice() = 0;
+
+            /** a notice is waiting, never blocks, observers which can not tell say no */
+            virtual bool has_notice()
+            { return false; }
         };
 
         DECLARE_PTR(observer)
@@ -195,6 +208,60 @@ namespace kungfu
 
             FORWARD_DECLARE_PTR(locator)
 
+            /**
+             * page size, retention and memory mapping of journal pages of one location/dest, zero means built-in page size
+             * and no limit for the others, retention is carried out by the writer on a helper thread
+             */
+            struct journal_policy
+            {
+                /** size of new pages in bytes, existing pages keep the size they were created with */
+                uint32_t page_size = 0;
+                /** max number of pages kept on disk, counting the one being written but not the one prepared ahead */
+                uint32_t max_pages = 0;
+                /** max total bytes of pages kept on disk */
+                uint64_t max_bytes = 0;
+                /** closed pages ended longer than this many nanoseconds ago are removed */
+                int64_t max_age = 0;
+                /** number of latest closed pages kept in page cache, older ones are dropped from page cache */
+                uint32_t cached_pages = 0;
+                /** fill page tables when a page is mapped, instead of faulting on first touch */
+                bool populate = false;
+                /** advise transparent huge pages on mapped pages, a journal directory on hugetlbfs gets huge pages regardless */
+                bool huge_pages = false;
+                /** numa node to place pages on, usually the node of the pinned consumer, -1 for no preference */
+                int32_t numa_node = -1;
+            };
+
+            /**
+             * how a low latency process waits for new frames, it spins, then yields, then parks on the doorbell until
+             * a writer rings it, park_timeout bounds how long nanomsg requests might wait
+             */
+            struct wait_policy
+            {
+                /** busy polls with cpu pause before yielding */
+                uint32_t spin_count = 1000;
+                /** polls with thread yield before parking */
+                uint32_t yield_count = 100;
+                /** nanoseconds to park before polling again, zero to never park and spin as before */
+                int64_t park_timeout = 1000000000;
+            };
+
+            /**
+             * where threads of one location run, empty cpus leave a thread to the scheduler, priority above zero runs it as
+             * SCHED_FIFO with that priority, cpus are best taken from isolated ones on the numa node of the nic
+             */
+            struct thread_policy
+            {
+                /** cpus of the thread running hero event loop */
+                std::vector<int> event_loop_cpus;
+                int32_t event_loop_priority = 0;
+                /** cpus of io threads of extensions, e.g. websocket and rest */
+                std::vector<int> io_cpus;
+                int32_t io_priority = 0;
+                /** cpus of the log flusher thread */
+                std::vector<int> log_cpus;
+            };
+
             class locator
             {
             public:
@@ -213,6 +280,15 @@ namespace kungfu
                 virtual const std::string default_to_system_db(location_ptr location, const std::string &name) const = 0;
 
                 virtual const std::vector<int> list_page_id(location_ptr location, uint32_t dest_id) const = 0;
+
+                virtual journal_policy get_journal_policy(location_ptr location, uint32_t dest_id) const
+                { return journal_policy{}; }
+
+                virtual wait_policy get_wait_policy(location_ptr location) const
+                { return wait_policy{}; }
+
+                virtual thread_policy get_thread_policy(location_ptr location) const
+                { return thread_policy{}; }
             };
 
             class location : public std::enable_shared_from_this<location>
@@ -9,6 +9,7 @@
 #define KUNGFU_IO_H
 
 #include <kungfu/yijinjing/journal/journal.h>
+#include <kungfu/yijinjing/journal/doorbell.h>
 #include <kungfu/yijinjing/nanomsg/socket.h>
 
 namespace kungfu
@@ -36,9 +37,10 @@ namespace kungfu
 
             journal::reader_ptr open_reader(const data::location_ptr &location, uint32_t dest_id);
 
-            journal::writer_ptr open_writer(uint32_t dest_id);
+            journal::writer_ptr open_writer(uint32_t dest_id, journal::writer_mode mode = journal::writer_mode::LOCKED);
 
-            journal::writer_ptr open_writer_at(const data::location_ptr &location, uint32_t dest_id);
+            journal::writer_ptr open_writer_at(const data::location_ptr &location, uint32_t dest_id,
+                                               journal::writer_mode mode = journal::writer_mode::LOCKED);
 
             nanomsg::socket_ptr
             connect_socket(const data::location_ptr &location, const nanomsg::protocol &p, int timeout = 0);
@@ -55,6 +57,9 @@ namespace kungfu
             observer_ptr get_observer()
             { return observer_; }
 
+            journal::doorbell_ptr get_doorbell()
+            { return doorbell_; }
+
         protected:
             data::location_ptr home_;
             data::location_ptr live_home_;
@@ -63,6 +68,7 @@ namespace kungfu
             nanomsg::url_factory_ptr url_factory_;
             publisher_ptr publisher_;
             observer_ptr observer_;
+            journal::doorbell_ptr doorbell_;
         };
 
         DECLARE_PTR(io_device)
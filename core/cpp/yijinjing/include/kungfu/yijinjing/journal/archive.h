@@ -0,0 +1,167 @@
+/*****************************************************************************
+ * Copyright [taurus.ai]
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *****************************************************************************/
+
+#ifndef YIJINJING_ARCHIVE_H
+#define YIJINJING_ARCHIVE_H
+
+#include <vector>
+
+#include <kungfu/yijinjing/journal/common.h>
+#include <kungfu/yijinjing/journal/page.h>
+
+namespace kungfu
+{
+    namespace yijinjing
+    {
+        namespace journal
+        {
+#ifdef _WIN32
+#pragma  pack(push, 1)
+#endif
+            /**
+             * head of {dest_id:08x}.{page_id}.archive, followed by compressed blocks, the block index and the layouts
+             */
+            struct archive_header
+            {
+                uint32_t magic;
+                uint32_t version;
+                /** size of the page this archive is made from */
+                uint32_t page_size;
+                uint32_t block_count;
+                uint64_t block_index_offset;
+                uint64_t frame_count;
+                /** bytes taken by frames in page, page end frame excluded */
+                uint64_t frame_bytes;
+                int64_t begin_time;
+                int64_t end_time;
+                /** trigger time of the page end frame */
+                int64_t page_end_trigger_time;
+#ifndef _WIN32
+            } __attribute__((packed));
+#else
+            };
+#pragma pack(pop)
+#endif
+
+#ifdef _WIN32
+#pragma  pack(push, 1)
+#endif
+            /**
+             * one record per block, blocks can be decoded independently
+             */
+            struct archive_block_entry
+            {
+                int64_t begin_time;
+                int64_t end_time;
+                uint64_t offset;
+                uint32_t compressed_length;
+                uint32_t raw_length;
+                uint32_t frame_count;
+#ifndef _WIN32
+            } __attribute__((packed));
+#else
+            };
+#pragma pack(pop)
+#endif
+
+            /** how a field of fixed layout frame data is stored in archives */
+            enum class archive_field_kind : int32_t
+            {
+                /** fixed length bytes such as symbols, stored once per block and referred to by id after */
+                DICTIONARY,
+                /**
+                 * array of int64 such as times or ids, stored as delta from the same field of the previous frame
+                 * of same msg type with same first dictionary field
+                 */
+                DELTA,
+                /**
+                 * array of double such as prices or volumes, delta encoded as DELTA in units of 1e-8, values which do not
+                 * come back exactly from that are stored by their bit pattern, so it is lossless either way
+                 */
+                DECIMAL
+            };
+
+#ifdef _WIN32
+#pragma  pack(push, 1)
+#endif
+            struct archive_field
+            {
+                uint32_t offset;
+                uint32_t length;
+                archive_field_kind kind;
+#ifndef _WIN32
+            } __attribute__((packed));
+#else
+            };
+#pragma pack(pop)
+#endif
+
+            /**
+             * fields of data of a msg type, frames of the type with another data length are stored as is,
+             * bytes not covered by fields are stored as is too
+             */
+            struct archive_layout
+            {
+                int32_t msg_type;
+                uint32_t data_length;
+                std::vector<archive_field> fields;
+            };
+
+            struct archive_stats
+            {
+                uint64_t frame_count;
+                /** bytes of frames in page, zero padded tail excluded */
+                uint64_t frame_bytes;
+                uint64_t page_bytes;
+                uint64_t archive_bytes;
+            };
+
+            /**
+             * Compacts closed journal pages into compressed columnar archives, and brings archived pages back as
+             * in-memory pages, so that readers join and seek into archives the same way as into journal pages.
+             *
+             * Within a block, frame headers are stored as columns of zigzag varints, with gen_time and trigger_time
+             * delta encoded, followed by frame data back to back. Fields of msg types with a registered layout are taken
+             * out of frame data into columns of their own, dictionary or delta encoded. Each block is then deflated.
+             */
+            class archive
+            {
+            public:
+                /**
+                 * register layout of a msg type for archives compacted after, layouts are written into each archive
+                 * so loading does not need them registered
+                 */
+                static void register_layout(const archive_layout &layout);
+
+                static std::string get_archive_path(const data::location_ptr &location, uint32_t dest_id, int page_id);
+
+                static bool exists(const data::location_ptr &location, uint32_t dest_id, int page_id);
+
+                /**
+                 * archive a closed page, the journal page is removed after archive is written if remove_page is set
+                 */
+                static archive_stats compact(const data::location_ptr &location, uint32_t dest_id, int page_id, bool remove_page);
+
+                /**
+                 * decode archive into memory laid out as a journal page, ending with a page end frame,
+                 * blocks which end at or before from_time are skipped, their memory is never touched
+                 */
+                static page_ptr load(const data::location_ptr &location, uint32_t dest_id, int page_id, int64_t from_time = 0);
+            };
+        }
+    }
+}
+
+#endif //YIJINJING_ARCHIVE_H
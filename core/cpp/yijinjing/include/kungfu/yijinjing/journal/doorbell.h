@@ -0,0 +1,142 @@
+/*****************************************************************************
+ * Copyright [taurus.ai]
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *****************************************************************************/
+
+#ifndef YIJINJING_DOORBELL_H
+#define YIJINJING_DOORBELL_H
+
+#include <atomic>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include <kungfu/yijinjing/journal/common.h>
+
+namespace kungfu
+{
+    namespace yijinjing
+    {
+        namespace journal
+        {
+            constexpr uint32_t DOORBELL_WAITERS = 64;
+            constexpr uint32_t DOORBELL_SLOTS = 1024;
+
+            /** a parked thread, writers bump its sequence to wake it */
+            struct doorbell_waiter
+            {
+                alignas(64) std::atomic<uint32_t> sequence;
+                /** process owning the entry, entries of processes gone are taken over when all are claimed */
+                std::atomic<int32_t> pid;
+            };
+
+            /**
+             * state shared by all processes of one kungfu home, mapped from the doorbells file in master journal directory
+             */
+            struct doorbell_state
+            {
+                /** waiter entries in use, one bit each */
+                alignas(64) std::atomic<uint64_t> claimed;
+                /** waiters parked right now, for rings meant to everyone */
+                std::atomic<uint64_t> parked;
+                /** waiters parked on journals hashed into the slot, one bit each */
+                alignas(64) std::atomic<uint64_t> slots[DOORBELL_SLOTS];
+                doorbell_waiter waiters[DOORBELL_WAITERS];
+            };
+
+            /** journal a waiter parks on, location uid and dest id */
+            using doorbell_key = std::pair<uint32_t, uint32_t>;
+
+            /**
+             * Wakes parked readers when frames are written, without any syscall on the writer side when nobody is parked
+             * on the journal written.
+             *
+             * A waiter sets its bit in the slots of the journals it reads, takes its own sequence, checks for data once more
+             * and then parks until the sequence changes. A writer publishes its frame, then wakes only the waiters found in
+             * the slot of its journal, if any. Parking relies on futex shared between processes on linux, other platforms
+             * sleep for a short while instead. Only one thread parks on a doorbell at a time.
+             */
+            class doorbell
+            {
+            public:
+                /** dest id no journal uses, rung for messages sent to sockets of a location */
+                static constexpr uint32_t MAILBOX = 0xFFFFFFFF;
+
+                explicit doorbell(const data::location_ptr &home);
+
+                ~doorbell();
+
+                /** called by writers after frames are published to journal of location_uid/dest_id */
+                void ring(uint32_t location_uid, uint32_t dest_id);
+
+                /** wakes every parked waiter, for notices sent to all processes */
+                void ring_all();
+
+                /**
+                 * park calling thread until one of the journals of keys is rung or timeout, has_data is checked after
+                 * registering as waiter so that frames written in between are never missed
+                 * @return true if woke up by ring
+                 */
+                bool park(const std::vector<doorbell_key> &keys, const std::function<bool()> &has_data, int64_t timeout);
+
+            private:
+                std::string path_;
+                doorbell_state *state_;
+                /** waiter entry of this doorbell, claimed on first park, -1 when none is left */
+                int32_t waiter_;
+                bool waiter_claimed_;
+
+                void wake(uint64_t mask);
+
+                int32_t claim_waiter();
+            };
+
+            DECLARE_PTR(doorbell)
+
+            /**
+             * spin, then yield, then park on doorbell, as configured by data::wait_policy
+             */
+            class idle_strategy
+            {
+            public:
+                idle_strategy(doorbell_ptr bell, const data::wait_policy &policy);
+
+                /**
+                 * called when a poll found nothing, never parks past deadline in nanoseconds,
+                 * keys fills in the journals to park on, it is only called when about to park,
+                 * a ring can come before what it tells of is readable, a nanomsg message still on its way, so the park
+                 * right after a ring that found nothing is kept short
+                 */
+                void idle(const std::function<bool()> &has_data, const std::function<void(std::vector<doorbell_key> &)> &keys,
+                          int64_t deadline = INT64_MAX);
+
+                /** called when a poll found something */
+                void reset()
+                {
+                    idle_count_ = 0;
+                    rung_ = false;
+                }
+
+            private:
+                doorbell_ptr bell_;
+                const data::wait_policy policy_;
+                uint32_t idle_count_;
+                /** last park was rung, and no poll found anything since */
+                bool rung_;
+                std::vector<doorbell_key> keys_;
+            };
+        }
+    }
+}
+
+#endif //YIJINJING_DOORBELL_H
@@ -151,6 +151,147 @@ namespace kungfu
                 friend class journal;
 
                 friend class writer;
+
+                friend class reader;
+
+                friend class frame_batch;
+            };
+
+            /**
+             * Contiguous frames of one journal page, handed out by reader::read_batch without copying,
+             * valid until the reader moves on again.
+             */
+            class frame_batch
+            {
+            public:
+                class iterator
+                {
+                public:
+                    explicit iterator(uintptr_t address)
+                    { frame_.set_address(address); }
+
+                    const frame &operator*() const
+                    { return frame_; }
+
+                    const frame *operator->() const
+                    { return &frame_; }
+
+                    iterator &operator++()
+                    {
+                        frame_.move_to_next();
+                        return *this;
+                    }
+
+                    bool operator==(const iterator &other) const
+                    { return frame_.address() == other.frame_.address(); }
+
+                    bool operator!=(const iterator &other) const
+                    { return frame_.address() != other.frame_.address(); }
+
+                private:
+                    frame frame_;
+                };
+
+                /**
+                 * iterates data of frames with given msg_type, other frames are skipped by their header only
+                 */
+                template<typename T>
+                class typed_iterator
+                {
+                public:
+                    typed_iterator(uintptr_t address, uintptr_t end, int32_t msg_type) : address_(address), end_(end), msg_type_(msg_type)
+                    { skip(); }
+
+                    const T &operator*() const
+                    { return *reinterpret_cast<const T *>(address_ + header()->header_length); }
+
+                    const T *operator->() const
+                    { return &operator*(); }
+
+                    /** header of current frame, for gen_time, source and dest */
+                    [[nodiscard]] const frame_header *header() const
+                    { return reinterpret_cast<const frame_header *>(address_); }
+
+                    typed_iterator &operator++()
+                    {
+                        address_ += header()->length;
+                        skip();
+                        return *this;
+                    }
+
+                    bool operator==(const typed_iterator &other) const
+                    { return address_ == other.address_; }
+
+                    bool operator!=(const typed_iterator &other) const
+                    { return address_ != other.address_; }
+
+                private:
+                    uintptr_t address_;
+                    uintptr_t end_;
+                    int32_t msg_type_;
+
+                    void skip()
+                    {
+                        while (address_ < end_ && header()->msg_type != msg_type_)
+                        {
+                            address_ += header()->length;
+                        }
+                    }
+                };
+
+                template<typename T>
+                class typed_range
+                {
+                public:
+                    typed_range(uintptr_t begin, uintptr_t end, int32_t msg_type) : begin_(begin), end_(end), msg_type_(msg_type)
+                    {}
+
+                    typed_iterator<T> begin() const
+                    { return typed_iterator<T>(begin_, end_, msg_type_); }
+
+                    typed_iterator<T> end() const
+                    { return typed_iterator<T>(end_, end_, msg_type_); }
+
+                private:
+                    uintptr_t begin_;
+                    uintptr_t end_;
+                    int32_t msg_type_;
+                };
+
+                frame_batch() : begin_(0), end_(0), size_(0)
+                {}
+
+                frame_batch(uintptr_t begin, uintptr_t end, size_t size) : begin_(begin), end_(end), size_(size)
+                {}
+
+                [[nodiscard]] iterator begin() const
+                { return iterator(begin_); }
+
+                [[nodiscard]] iterator end() const
+                { return iterator(end_); }
+
+                /** number of frames */
+                [[nodiscard]] size_t size() const
+                { return size_; }
+
+                [[nodiscard]] bool empty() const
+                { return size_ == 0; }
+
+                /** address of first frame, frames are laid out back to back up to end_address() */
+                [[nodiscard]] uintptr_t begin_address() const
+                { return begin_; }
+
+                [[nodiscard]] uintptr_t end_address() const
+                { return end_; }
+
+                template<typename T>
+                typed_range<T> of(int32_t msg_type) const
+                { return typed_range<T>(begin_, end_, msg_type); }
+
+            private:
+                uintptr_t begin_;
+                uintptr_t end_;
+                size_t size_;
             };
         }
     }
@@ -18,6 +18,7 @@
 
 #include <utility>
 #include <mutex>
+#include <atomic>
 
 #include <kungfu/yijinjing/msg.h>
 #include <kungfu/yijinjing/journal/common.h>
@@ -33,8 +34,6 @@ namespace kungfu
         namespace journal
         {
 
-            FORWARD_DECLARE_PTR(page_provider)
-
             FORWARD_DECLARE_PTR(page_provider_factory)
 
             /**
@@ -74,7 +73,8 @@ namespace kungfu
                 frame_ptr frame_;
                 int page_frame_nb_;
 
-                void load_page(int page_id);
+                /** from_time tells archived pages where to start decoding, page is reloaded if it was decoded from later on */
+                void load_page(int page_id, int64_t from_time = 0);
 
                 /** load next page, current page will be released if not empty */
                 void load_next_page();
@@ -87,7 +87,7 @@ namespace kungfu
             class reader
             {
             public:
-                explicit reader(bool lazy) : lazy_(lazy), current_(nullptr)
+                explicit reader(bool lazy) : lazy_(lazy), current_(nullptr), time_bound_(0)
                 {};
 
                 ~reader();
@@ -102,6 +102,9 @@ namespace kungfu
 
                 void disjoin(uint32_t location_uid);
 
+                /** appends location uid and dest id of every joined journal to ids */
+                void list_journals(std::vector<std::pair<uint32_t, uint32_t>> &ids) const;
+
                 frame_ptr current_frame()
                 { return current_->current_frame(); }
 
@@ -113,18 +116,83 @@ namespace kungfu
                 /** seek next frame */
                 void next();
 
+                /**
+                 * take frames of current journal in one go, the batch ends before a frame generated after end_time,
+                 * before the earliest frame of other joined journals so that time order is kept, at page end, or
+                 * at max_count frames, reader moves past returned frames, page end frames are never returned
+                 */
+                frame_batch read_batch(int64_t end_time, size_t max_count);
+
+                /** rebuild the merge heap from all joined journals */
                 void sort();
 
             private:
                 const bool lazy_;
                 journal *current_;
                 std::vector<journal_ptr> journals_;
+                /** min-heap on current frame gen_time, holds journals which have data to read */
+                std::vector<journal *> ready_;
+                /** journals reached their tail, polled for new data by data_available() */
+                std::vector<journal *> idle_;
+                /** cached wall clock, frames generated after it are not readable yet */
+                int64_t time_bound_;
+
+                void rebuild();
+
+                void track(journal *j);
+
+                void poll_idle();
+
+                /** heap order, journal with the earliest current frame on top */
+                static bool later_frame(const journal *a, const journal *b);
+            };
+
+            /**
+             * gen_time of the event being handled on the calling thread, for as long as the scope lives.
+             * frames written with trigger_time 0 get it as their trigger_time instead, so everything written by a handler
+             * points back to the event it was written for, and latency from one to the other can be read from journals.
+             */
+            class trigger_scope
+            {
+            public:
+                explicit trigger_scope(int64_t trigger_time) : previous_(current_)
+                { current_ = trigger_time; }
+
+                ~trigger_scope()
+                { current_ = previous_; }
+
+                trigger_scope(const trigger_scope &) = delete;
+
+                trigger_scope &operator=(const trigger_scope &) = delete;
+
+                /** 0 outside of any scope */
+                static int64_t current()
+                { return current_; }
+
+            private:
+                const int64_t previous_;
+                static inline thread_local int64_t current_ = 0;
+            };
+
+            /**
+             * how frames written from different threads are ordered
+             * LOCKED: serialized by writer mutex, any thread may write
+             * SINGLE_PRODUCER: no synchronization at all, only one thread may write
+             * MULTI_PRODUCER: space is claimed from an atomic cursor and filled concurrently, frames are then stamped and published
+             *                 in claim order, only one-shot write/write_raw/mark are supported
+             */
+            enum class writer_mode : int8_t
+            {
+                LOCKED,
+                SINGLE_PRODUCER,
+                MULTI_PRODUCER
             };
 
             class writer
             {
             public:
-                writer(const data::location_ptr &location, uint32_t dest_id, bool lazy, publisher_ptr publisher);
+                writer(const data::location_ptr &location, uint32_t dest_id, bool lazy, publisher_ptr publisher,
+                       writer_mode mode = writer_mode::LOCKED);
 
                 const data::location_ptr &get_location() const
                 { return journal_->location_; }
@@ -132,6 +200,9 @@ namespace kungfu
                 uint32_t get_dest() const
                 { return journal_->dest_id_; }
 
+                writer_mode get_mode() const
+                { return mode_; }
+
                 uint64_t current_frame_uid();
 
                 frame_ptr open_frame(int64_t trigger_time, int32_t msg_type, uint32_t length);
@@ -167,6 +238,11 @@ namespace kungfu
                 template<typename T>
                 void write(int64_t trigger_time, int32_t msg_type, const T &data)
                 {
+                    if (mode_ == writer_mode::MULTI_PRODUCER)
+                    {
+                        write_multi_producer(trigger_time, msg_type, &data, sizeof(T));
+                        return;
+                    }
                     auto frame = open_frame(trigger_time, msg_type, sizeof(T));
                     close_frame(frame->copy_data<T>(data));
                 }
@@ -174,11 +250,11 @@ namespace kungfu
                 template<typename T>
                 void write_with_time(int64_t gen_time, int32_t msg_type, const T &data)
                 {
+                    assert(mode_ != writer_mode::MULTI_PRODUCER);
                     assert(sizeof(frame_header) + sizeof(T) + sizeof(frame_header) <= journal_->current_page_->get_page_size());
                     if (journal_->current_frame()->address() + sizeof(frame_header) + sizeof(T) > journal_->current_page_->address_border())
                     {
-                        mark(gen_time, msg::type::PageEnd);
-                        journal_->load_next_page();
+                        close_page(gen_time);
                     }
                     auto frame = journal_->current_frame();
                     frame->set_header_length();
@@ -197,13 +273,27 @@ namespace kungfu
                 void write_raw(int64_t trigger_time, int32_t msg_type, uintptr_t data, uint32_t length);
 
             private:
+                const writer_mode mode_;
                 std::mutex writer_mtx_;
                 journal_ptr journal_;
                 uint64_t frame_id_base_;
                 publisher_ptr publisher_;
                 size_t size_to_write_;
 
+                /** multi producer only, page id in high 32 bits, offset of next free frame in low 32 bits */
+                std::atomic<uint64_t> reserve_cursor_;
+                /** multi producer only, end of frames published so far, frames are published in the order they are claimed */
+                std::atomic<uint64_t> commit_cursor_;
+                /** multi producer only, address of mapped page and number of producers inside it, indexed by page id & 1 */
+                std::atomic<uintptr_t> page_addresses_[2];
+                std::atomic<int32_t> producers_[2];
+                std::atomic<uint32_t> page_size_;
+
                 void close_page(int64_t trigger_time);
+
+                void write_multi_producer(int64_t trigger_time, int32_t msg_type, const void *data, uint32_t length);
+
+                void close_page_multi_producer(uint64_t cursor, int64_t trigger_time);
             };
         }
     }
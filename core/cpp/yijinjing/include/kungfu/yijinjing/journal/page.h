@@ -16,6 +16,15 @@
 #ifndef YIJINJING_PAGE_H
 #define YIJINJING_PAGE_H
 
+#include <map>
+#include <set>
+#include <cstdlib>
+#include <deque>
+#include <tuple>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
 #include <kungfu/yijinjing/journal/common.h>
 #include <kungfu/yijinjing/journal/frame.h>
 
@@ -38,6 +47,25 @@ namespace kungfu
 #else
             };
 #pragma pack(pop)
+#endif
+
+#ifdef _WIN32
+#pragma  pack(push, 1)
+#endif
+            /**
+             * one record per closed page in the sidecar index file {dest_id:08x}.index,
+             * lets readers locate pages by time without listing the journal directory
+             */
+            struct page_index_entry
+            {
+                int32_t page_id;
+                int64_t begin_time;
+                int64_t end_time;
+#ifndef _WIN32
+            } __attribute__((packed));
+#else
+            };
+#pragma pack(pop)
 #endif
 
             class page
@@ -78,12 +106,27 @@ namespace kungfu
                 [[nodiscard]] bool is_full() const
                 { return last_frame_address() + reinterpret_cast<frame_header *>(last_frame_address())->length > address_border(); }
 
-                static page_ptr load(const data::location_ptr& location, uint32_t dest_id, int page_id, bool is_writing, bool lazy);
+                /**
+                 * load page, from_time only applies to archived pages, which are decoded from the block holding it on
+                 */
+                static page_ptr load(const data::location_ptr& location, uint32_t dest_id, int page_id, bool is_writing, bool lazy,
+                                     int64_t from_time = 0);
 
                 static std::string get_page_path(const data::location_ptr& location, uint32_t dest_id, int id);
 
                 static int find_page_id(const data::location_ptr& location, uint32_t dest_id, int64_t time);
 
+                static std::string get_page_index_path(const data::location_ptr& location, uint32_t dest_id);
+
+                static std::vector<page_index_entry> load_page_index(const data::location_ptr& location, uint32_t dest_id);
+
+                static std::vector<page_index_entry> load_page_index(const std::string &index_path);
+
+                /**
+                 * index pages written before the index existed, only the writer of the journal should call this
+                 */
+                static void build_page_index(const data::location_ptr& location, uint32_t dest_id);
+
             private:
 
                 const data::location_ptr location_;
@@ -92,30 +135,148 @@ namespace kungfu
                 const bool lazy_;
                 const size_t size_;
                 const page_header *header_;
+                /** frames before this time might be left out, set only for archived pages */
+                int64_t decoded_from_ = 0;
 
                 page(const data::location_ptr& location, uint32_t dest_id, int page_id, size_t size, bool lazy, uintptr_t address);
 
+                /**
+                 * map page file at given path, an existing page keeps the size it was created with
+                 */
+                static page_ptr map(const data::location_ptr& location, uint32_t dest_id, int page_id, const std::string &path,
+                                    const data::journal_policy &policy, bool is_writing, bool lazy);
+
                 /**
                  * update page header when new frame added
                  */
                 void set_last_frame_position(uint64_t position);
 
+                /**
+                 * record begin/end time of this page into index, called once the page is closed
+                 */
+                void append_to_index() const;
+
+                void append_to_index(const std::string &index_path) const;
+
                 friend class journal;
                 friend class writer;
                 friend class reader;
+                friend class page_provider;
+                friend class archive;
+            };
+
+            /**
+             * Maps journal pages for writers on a helper thread, so that page rollover does not
+             * create, stretch, map and fault a page file in the middle of writing a frame.
+             * Closed pages are handed back to be indexed and unmapped on the same thread, which then
+             * applies the journal policy, removing expired pages and dropping old ones from page cache.
+             * Paths and policy are resolved from locator on caller threads only, since a python locator
+             * can not be called from the helper thread while the caller holds the GIL.
+             */
+            class page_provider
+            {
+            public:
+                ~page_provider();
+
+                /**
+                 * start mapping page in background, it will be pre-faulted if not locked by mmap
+                 */
+                void prepare(const data::location_ptr &location, uint32_t dest_id, int page_id, bool lazy);
+
+                /**
+                 * take the prepared page, wait for it if being prepared, or load it in place if never asked for
+                 */
+                page_ptr take(const data::location_ptr &location, uint32_t dest_id, int page_id, bool lazy);
+
+                /**
+                 * append closed page to index and release it off the writing thread
+                 */
+                void retire(page_ptr closed_page);
+
+                /**
+                 * unmap pages prepared for a journal which stops writing, they would never be taken otherwise,
+                 * waits for the one being prepared if any
+                 */
+                void release(const data::location_ptr &location, uint32_t dest_id);
+
+                static page_provider &get_instance();
+
+            private:
+                typedef std::tuple<uint32_t, uint32_t, int> page_key;
+
+                typedef std::pair<uint32_t, uint32_t> journal_key;
+
+                struct journal_files
+                {
+                    std::string journal_dir;
+                    std::string index_path;
+                    /** false when journal dir is on hugetlbfs, which takes no write, readers find pages by listing there */
+                    bool indexed;
+                    data::journal_policy policy;
+                };
+
+                struct task
+                {
+                    data::location_ptr location;
+                    uint32_t dest_id;
+                    int page_id;
+                    bool lazy;
+                    page_ptr closed_page;
+                    std::shared_ptr<const journal_files> files;
+                };
+
+                std::mutex mutex_;
+                std::condition_variable cv_;
+                std::deque<task> tasks_;
+                std::set<page_key> pending_;
+                std::map<page_key, page_ptr> prepared_;
+                std::map<journal_key, std::shared_ptr<const journal_files>> files_;
+                std::thread worker_;
+                bool live_ = true;
+
+                page_provider() = default;
+
+                /**
+                 * paths and policy of journal, looked up from locator the first time, must be called without mutex held
+                 */
+                std::shared_ptr<const journal_files> resolve(const data::location_ptr &location, uint32_t dest_id);
+
+                void load(const task &t);
+
+                /**
+                 * index closed page and apply journal policy to pages closed before
+                 */
+                void reclaim(task &t);
+
+                void run();
             };
 
-            inline static uint32_t find_page_size(const data::location_ptr& location, uint32_t dest_id)
+            /**
+             * policy from locator, with built-in page size filled in when not given,
+             * and legacy page number limits applied when CLEAR_JOURNAL is set
+             */
+            inline static data::journal_policy find_journal_policy(const data::location_ptr& location, uint32_t dest_id)
             {
-                if (location->category == data::category::MD && dest_id == 0)
+                auto policy = location->locator->get_journal_policy(location, dest_id);
+                bool is_md_public = location->category == data::category::MD && dest_id == 0;
+                if (policy.page_size == 0)
                 {
-                    return 128 * MB;
+                    if (is_md_public)
+                    {
+                        policy.page_size = 128 * MB;
+                    } else if ((location->category == data::category::TD || location->category == data::category::STRATEGY) && dest_id != 0)
+                    {
+                        policy.page_size = 4 * MB;
+                    } else
+                    {
+                        policy.page_size = MB;
+                    }
                 }
-                if ((location->category == data::category::TD || location->category == data::category::STRATEGY) && dest_id != 0)
+                if (policy.max_pages == 0 and std::getenv("CLEAR_JOURNAL") != nullptr)
                 {
-                    return 4 * MB;
+                    policy.max_pages = is_md_public ? 8 : 50;
                 }
-                return MB;
+                return policy;
             }
         }
     }
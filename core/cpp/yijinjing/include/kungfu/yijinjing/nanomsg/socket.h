@@ -5,6 +5,7 @@
 #ifndef KUNGFU_NANOMSG_SOCKET_H
 #define KUNGFU_NANOMSG_SOCKET_H
 
+#include <functional>
 #include <string>
 #include <cstring>
 #include <algorithm>
@@ -147,6 +148,9 @@ namespace kungfu
 
                 const std::string &recv_msg(int flags = NN_DONTWAIT);
 
+                /** a message is waiting to be received, never blocks */
+                bool readable() const;
+
                 int send_json(const nlohmann::json &msg, int flags = NN_DONTWAIT) const;
 
                 nlohmann::json recv_json(int flags = 0);
@@ -162,12 +166,17 @@ namespace kungfu
                 const std::string &last_message() const
                 { return message_; };
 
+                /** called after each message sent, so that receivers parked on doorbell can be woken */
+                void set_on_sent(std::function<void()> on_sent)
+                { on_sent_ = std::move(on_sent); };
+
             private:
                 int sock_;
                 protocol protocol_;
                 std::string url_;
                 std::vector<char> buf_;
                 std::string message_;
+                std::function<void()> on_sent_;
 
                 /*  Prevent making copies of the socket by accident. */
                 socket(const socket &);
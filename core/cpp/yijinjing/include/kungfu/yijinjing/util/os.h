@@ -6,6 +6,8 @@
 #define KUNGFU_YIJINJING_OS_H
 
 #include <string>
+#include <vector>
+#include <functional>
 #include <initializer_list>
 #include <cstdint>
 
@@ -15,16 +17,81 @@ namespace kungfu
     {
         namespace os
         {
+            /**
+             * linux only tuning of mapped memory, ignored on other platforms
+             */
+            struct mmap_options
+            {
+                /** fill page tables at map time instead of on first touch */
+                bool populate = false;
+                /** advise transparent huge pages for the mapping */
+                bool huge_pages = false;
+                /** numa node to allocate pages from, -1 for no preference, pages are populated at map time when set */
+                int numa_node = -1;
+            };
+
             /**
              * load mmap buffer, return address of the file-mapped memory
              * whether to write has to be specified in "is_writing"
              * buffer memory is locked if not lazy
+             * files on hugetlbfs are backed by huge pages, size has to be a multiple of huge page size there
              * @return the address of mapped memory
              */
-            uintptr_t load_mmap_buffer(const std::string &path, size_t size, bool is_writing = false, bool lazy = true);
+            uintptr_t load_mmap_buffer(const std::string &path, size_t size, bool is_writing = false, bool lazy = true,
+                                       const mmap_options &options = {});
 
             bool release_mmap_buffer(uintptr_t address, size_t size, bool lazy);
 
+            /**
+             * map zero filled memory not backed by any file, released by release_mmap_buffer as lazy
+             * @return the address of mapped memory
+             */
+            uintptr_t load_anonymous_buffer(size_t size);
+
+            /**
+             * write back and drop cached pages of file from kernel page cache, only supported on linux
+             * @return true if page cache is released
+             */
+            bool release_page_cache(const std::string &path);
+
+            /**
+             * files on hugetlbfs can only be mapped and truncated, not written, only detected on linux
+             * @return true if path is on hugetlbfs
+             */
+            bool is_hugetlbfs(const std::string &path);
+
+            enum class thread_role : int8_t
+            {
+                EVENT_LOOP,
+                IO,
+                LOG
+            };
+
+            /** thread name of role, shown by `kfc threads` */
+            const char *get_thread_role_name(thread_role role);
+
+            /** parse cpu list as in sysfs, e.g. "0-3,8" */
+            std::vector<int> parse_cpu_list(const std::string &cpu_list);
+
+            /** cpus isolated from scheduler by isolcpus kernel parameter, empty if none or not on linux */
+            std::vector<int> get_isolated_cpus();
+
+            /** numa node of cpu, -1 if unknown */
+            int get_numa_node(int cpu);
+
+            /**
+             * name calling thread after role, pin it to cpus and run it as SCHED_FIFO if priority is above zero,
+             * only supported on linux, failures are logged and the thread keeps running as it was
+             * @return true if all requested placement took effect
+             */
+            bool place_thread(thread_role role, const std::vector<int> &cpus, int priority = 0);
+
+            /**
+             * run spawn with calling thread placed as role, threads created within inherit the placement,
+             * used for threads created by libraries, placement of calling thread is restored afterwards
+             */
+            void spawn_placed(thread_role role, const std::vector<int> &cpus, const std::function<void()> &spawn);
+
             void handle_os_signals(void *hero);
         }
     }
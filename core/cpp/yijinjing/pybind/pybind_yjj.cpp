@@ -14,6 +14,7 @@
 #include <kungfu/yijinjing/log/setup.h>
 #include <kungfu/yijinjing/journal/journal.h>
 #include <kungfu/yijinjing/journal/frame.h>
+#include <kungfu/yijinjing/journal/archive.h>
 #include <kungfu/yijinjing/nanomsg/socket.h>
 #include <kungfu/yijinjing/util/os.h>
 #include <kungfu/yijinjing/util/util.h>
@@ -61,6 +62,21 @@ class PyLocator : public data::locator
     {
         PYBIND11_OVERLOAD_PURE(const std::vector<int>, data::locator, list_page_id, location, dest_id)
     }
+
+    data::journal_policy get_journal_policy(data::location_ptr location, uint32_t dest_id) const override
+    {
+        PYBIND11_OVERLOAD(data::journal_policy, data::locator, get_journal_policy, location, dest_id);
+    }
+
+    data::wait_policy get_wait_policy(data::location_ptr location) const override
+    {
+        PYBIND11_OVERLOAD(data::wait_policy, data::locator, get_wait_policy, location);
+    }
+
+    data::thread_policy get_thread_policy(data::location_ptr location) const override
+    {
+        PYBIND11_OVERLOAD(data::thread_policy, data::locator, get_thread_policy, location);
+    }
 };
 
 class PyEvent : public event
@@ -169,6 +185,8 @@ PYBIND11_MODULE(pyyjj, m)
     m.def("hash_32", &hash_32, py::arg("key"), py::arg("length"), py::arg("seed") = KUNGFU_HASH_SEED);
     m.def("hash_str_32", &hash_str_32, py::arg("key"), py::arg("seed") = KUNGFU_HASH_SEED);
     m.def("get_page_path", &page::get_page_path);
+    m.def("get_archive_path", &archive::get_archive_path);
+    m.def("archive_page", &archive::compact, py::arg("location"), py::arg("dest_id"), py::arg("page_id"), py::arg("remove_page") = false);
 
     py::enum_<data::mode>(m, "mode", py::arithmetic(), "Kungfu Run Mode")
             .value("LIVE", data::mode::LIVE)
@@ -223,6 +241,14 @@ PYBIND11_MODULE(pyyjj, m)
             .def_property_readonly("data_address", [](const frame &f) {return f.address() + f.header_length();})
             ;
 
+    py::class_<frame_batch>(m, "frame_batch")
+            .def("__len__", &frame_batch::size)
+            .def("empty", &frame_batch::empty)
+            .def("__iter__", [](const frame_batch &batch)
+                 {
+                     return py::make_iterator<py::return_value_policy::copy>(batch.begin(), batch.end());
+                 }, py::keep_alive<0, 1>());
+
     py::class_<data::location, std::shared_ptr<data::location>>(m, "location")
             .def(py::init<data::mode, data::category, const std::string &, const std::string &, data::locator_ptr>())
             .def_readonly("mode", &data::location::mode)
@@ -239,7 +265,45 @@ PYBIND11_MODULE(pyyjj, m)
             .def("get_env", &data::locator::get_env)
             .def("layout_dir", &data::locator::layout_dir)
             .def("layout_file", &data::locator::layout_file)
-            .def("list_page_id", &data::locator::list_page_id);
+            .def("list_page_id", &data::locator::list_page_id)
+            .def("get_journal_policy", &data::locator::get_journal_policy)
+            .def("get_wait_policy", &data::locator::get_wait_policy)
+            .def("get_thread_policy", &data::locator::get_thread_policy);
+
+    py::class_<data::journal_policy>(m, "journal_policy")
+            .def(py::init<>())
+            .def_readwrite("page_size", &data::journal_policy::page_size)
+            .def_readwrite("max_pages", &data::journal_policy::max_pages)
+            .def_readwrite("max_bytes", &data::journal_policy::max_bytes)
+            .def_readwrite("max_age", &data::journal_policy::max_age)
+            .def_readwrite("cached_pages", &data::journal_policy::cached_pages)
+            .def_readwrite("populate", &data::journal_policy::populate)
+            .def_readwrite("huge_pages", &data::journal_policy::huge_pages)
+            .def_readwrite("numa_node", &data::journal_policy::numa_node);
+
+    py::class_<data::wait_policy>(m, "wait_policy")
+            .def(py::init<>())
+            .def_readwrite("spin_count", &data::wait_policy::spin_count)
+            .def_readwrite("yield_count", &data::wait_policy::yield_count)
+            .def_readwrite("park_timeout", &data::wait_policy::park_timeout);
+
+    py::class_<data::thread_policy>(m, "thread_policy")
+            .def(py::init<>())
+            .def_readwrite("event_loop_cpus", &data::thread_policy::event_loop_cpus)
+            .def_readwrite("event_loop_priority", &data::thread_policy::event_loop_priority)
+            .def_readwrite("io_cpus", &data::thread_policy::io_cpus)
+            .def_readwrite("io_priority", &data::thread_policy::io_priority)
+            .def_readwrite("log_cpus", &data::thread_policy::log_cpus);
+
+    m.def("parse_cpu_list", &os::parse_cpu_list);
+    m.def("get_isolated_cpus", &os::get_isolated_cpus);
+    m.def("get_numa_node", &os::get_numa_node);
+
+    py::class_<archive_stats>(m, "archive_stats")
+            .def_readonly("frame_count", &archive_stats::frame_count)
+            .def_readonly("frame_bytes", &archive_stats::frame_bytes)
+            .def_readonly("page_bytes", &archive_stats::page_bytes)
+            .def_readonly("archive_bytes", &archive_stats::archive_bytes);
 
     py::enum_<nanomsg::protocol>(m, "protocol", py::arithmetic(), "Nanomsg Protocol")
             .value("REPLY", nanomsg::protocol::REPLY)
@@ -277,9 +341,16 @@ PYBIND11_MODULE(pyyjj, m)
             .def("seek_to_time", &reader::seek_to_time)
             .def("data_available", &reader::data_available)
             .def("next", &reader::next)
+            .def("read_batch", &reader::read_batch, py::arg("end_time"), py::arg("max_count"))
             .def("join", &reader::join)
             .def("disjoin", &reader::disjoin);
 
+    py::enum_<writer_mode>(m, "writer_mode", py::arithmetic(), "Journal Writer Mode")
+            .value("LOCKED", writer_mode::LOCKED)
+            .value("SINGLE_PRODUCER", writer_mode::SINGLE_PRODUCER)
+            .value("MULTI_PRODUCER", writer_mode::MULTI_PRODUCER)
+            .export_values();
+
     py::class_<writer, writer_ptr>(m, "writer")
             .def("write_raw", &writer::write_raw)
             .def("write_str",
@@ -288,6 +359,7 @@ PYBIND11_MODULE(pyyjj, m)
                         w->write_raw(trigger_time, msg_type, reinterpret_cast<uintptr_t>(data.c_str()), data.length());
                     })
             .def("current_frame_uid", &writer::current_frame_uid)
+            .def_property_readonly("mode", &writer::get_mode)
             .def("mark", &writer::mark)
             .def("mark_with_time", &writer::mark_with_time);
 
@@ -299,7 +371,7 @@ PYBIND11_MODULE(pyyjj, m)
             .def_property_readonly("live_home", &io_device::get_live_home)
             .def("open_reader", &io_device::open_reader)
             .def("open_reader_to_subscribe", &io_device::open_reader_to_subscribe)
-            .def("open_writer", &io_device::open_writer)
+            .def("open_writer", &io_device::open_writer, py::arg("dest_id"), py::arg("mode") = writer_mode::LOCKED)
             .def("connect_socket", &io_device::connect_socket, py::arg("location"), py::arg("protocol"), py::arg("timeout") = 0);
 
     py::class_<io_device_with_reply, io_device_with_reply_ptr> io_device_with_reply(m, "io_device_with_reply", io_device);
@@ -5,6 +5,7 @@
  * Modification date: March 3, 2025
  */
 #include <utility>
+#include <algorithm>
 #include <typeinfo>
 #include <spdlog/spdlog.h>
 #include <nanomsg/nn.h>
@@ -13,6 +14,7 @@
 #include <nanomsg/pipeline.h>
 #include <nlohmann/json.hpp>
 
+#include <kungfu/yijinjing/time.h>
 #include <kungfu/yijinjing/util/util.h>
 #include <kungfu/yijinjing/util/os.h>
 #include <kungfu/yijinjing/io.h>
@@ -44,7 +46,7 @@ namespace kungfu
         class nanomsg_publisher : public publisher
         {
         public:
-            nanomsg_publisher(bool low_latency, protocol p) : socket_(p), low_latency_(low_latency)
+            nanomsg_publisher(bool low_latency, protocol p) : socket_(p), low_latency_(low_latency), master_uid_(0)
             {}
 
             ~nanomsg_publisher() override
@@ -52,21 +54,39 @@ namespace kungfu
                 socket_.close();
             }
 
-            void init(const io_device &io)
+            void init(io_device &io)
             {
                 auto location = std::make_shared<data::location>(data::mode::LIVE, data::category::SYSTEM, "master", "master",
                                                                  io.get_home()->locator);
                 init_socket(socket_, location, io.get_url_factory());
+                doorbell_ = io.get_doorbell();
+                master_uid_ = location->uid;
             }
 
             int notify() override
             {
+                doorbell_->ring_all();
+                return low_latency_ ? 0 : publish("{}");
+            }
+
+            int notify_journal(uint32_t location_uid, uint32_t dest_id) override
+            {
+                // parked low latency readers of the journal are woken by doorbell, processes not in low latency still wait for notices
+                doorbell_->ring(location_uid, dest_id);
                 return low_latency_ ? 0 : publish("{}");
             }
 
             int publish(const std::string &json_message) override
             {
-                return socket_.send(json_message);
+                int rc = socket_.send(json_message);
+                if (socket_.get_protocol() == protocol::PUBLISH)
+                {
+                    doorbell_->ring_all();
+                } else
+                {
+                    doorbell_->ring(master_uid_, journal::doorbell::MAILBOX);
+                }
+                return rc;
             }
 
         protected:
@@ -75,6 +95,8 @@ namespace kungfu
         private:
             const bool low_latency_;
             socket socket_;
+            journal::doorbell_ptr doorbell_;
+            uint32_t master_uid_;
         };
 
         class nanomsg_publisher_master : public nanomsg_publisher
@@ -107,7 +129,8 @@ namespace kungfu
         class nanomsg_observer : public observer
         {
         public:
-            nanomsg_observer(bool low_latency, protocol p) : low_latency_(low_latency), socket_(p), recv_flags_(low_latency ? NN_DONTWAIT : 0)
+            nanomsg_observer(bool low_latency, protocol p) : low_latency_(low_latency), socket_(p), recv_flags_(low_latency ? NN_DONTWAIT : 0),
+                                                             recv_timeout_(DEFAULT_NOTICE_TIMEOUT)
             {}
 
             void init(const io_device &io)
@@ -131,11 +154,40 @@ namespace kungfu
                 return socket_.recv(recv_flags_) > 0;
             }
 
+            bool wait_until(int64_t deadline) override
+            {
+                if (low_latency_)
+                {
+                    return wait();
+                }
+                int timeout = DEFAULT_NOTICE_TIMEOUT;
+                if (deadline != INT64_MAX)
+                {
+                    int64_t remaining = deadline - time::now_in_nano();
+                    if (remaining <= 0)
+                    {
+                        return socket_.recv(NN_DONTWAIT) > 0;
+                    }
+                    timeout = static_cast<int>(std::min<int64_t>(DEFAULT_NOTICE_TIMEOUT, remaining / time_unit::NANOSECONDS_PER_MILLISECOND + 1));
+                }
+                if (timeout != recv_timeout_)
+                {
+                    socket_.setsockopt_int(NN_SOL_SOCKET, NN_RCVTIMEO, timeout);
+                    recv_timeout_ = timeout;
+                }
+                return wait();
+            }
+
             const std::string &get_notice() override
             {
                 return socket_.last_message();
             }
 
+            bool has_notice() override
+            {
+                return socket_.readable();
+            }
+
         protected:
 
             virtual void init_socket(socket &s, location_ptr location, url_factory_ptr url_factory) = 0;
@@ -144,6 +196,7 @@ namespace kungfu
             const bool low_latency_;
             socket socket_;
             int recv_flags_;
+            int recv_timeout_;
         };
 
         class nanomsg_observer_master : public nanomsg_observer
@@ -192,14 +245,14 @@ namespace kungfu
             return r;
         }
 
-        writer_ptr io_device::open_writer(uint32_t dest_id)
+        writer_ptr io_device::open_writer(uint32_t dest_id, writer_mode mode)
         {
-            return std::make_shared<writer>(home_, dest_id, lazy_, publisher_);
+            return std::make_shared<writer>(home_, dest_id, lazy_, publisher_, mode);
         }
 
-        writer_ptr io_device::open_writer_at(const data::location_ptr &location, uint32_t dest_id)
+        writer_ptr io_device::open_writer_at(const data::location_ptr &location, uint32_t dest_id, writer_mode mode)
         {
-            return std::make_shared<writer>(location, dest_id, lazy_, publisher_);
+            return std::make_shared<writer>(location, dest_id, lazy_, publisher_, mode);
         }
 
         socket_ptr io_device::connect_socket(const data::location_ptr &location, const protocol &p, int timeout)
@@ -207,6 +260,16 @@ namespace kungfu
             socket_ptr s = std::make_shared<socket>(p);
             s->connect(url_factory_->make_path_connect(location, p));
             s->setsockopt_int(NN_SOL_SOCKET, NN_RCVTIMEO, timeout);
+            if (p == protocol::REQUEST or p == protocol::PUSH)
+            {
+                // the other end may be parked on doorbell rather than polling its socket
+                if (not doorbell_)
+                {
+                    doorbell_ = std::make_shared<doorbell>(home_);
+                }
+                s->set_on_sent([bell = doorbell_, uid = location->uid]()
+                               { bell->ring(uid, doorbell::MAILBOX); });
+            }
             SPDLOG_INFO("connected socket [{}] {} at {} with timeout {}", nanomsg::get_protocol_name(p), location->name, s->get_url(), timeout);
             return s;
         }
@@ -229,6 +292,7 @@ namespace kungfu
 
         io_device_master::io_device_master(data::location_ptr home, bool low_latency) : io_device_with_reply(std::move(home), low_latency, false)
         {
+            doorbell_ = std::make_shared<doorbell>(home_);
             auto publisher = std::make_shared<nanomsg_publisher_master>(low_latency);
             publisher->init(*this);
             publisher_ = publisher;
@@ -239,6 +303,7 @@ namespace kungfu
 
         io_device_client::io_device_client(data::location_ptr home, bool low_latency) : io_device_with_reply(std::move(home), low_latency, true)
         {
+            doorbell_ = std::make_shared<doorbell>(home_);
             auto publisher = std::make_shared<nanomsg_publisher_client>(low_latency);
             publisher->init(*this);
             publisher_ = publisher;
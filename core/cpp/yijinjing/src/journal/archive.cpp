@@ -0,0 +1,714 @@
+/**
+ * This is source code modified under the Apache License 2.0.
+ * Original Author: Keren Dong
+ * Modifier: kx@godzilla.dev
+ * Modification date: March 3, 2025
+ */
+#include <cstdio>
+#include <fstream>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <zlib.h>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+#include <kungfu/yijinjing/msg.h>
+#include <kungfu/yijinjing/util/os.h>
+#include <kungfu/yijinjing/journal/archive.h>
+
+namespace kungfu
+{
+    namespace yijinjing
+    {
+        namespace journal
+        {
+            constexpr uint32_t ARCHIVE_MAGIC            = 0x414a464b; // KFJA
+            constexpr uint32_t ARCHIVE_VERSION          = 2;
+            /** version 1 archives have no layouts and blocks of the first 7 columns */
+            constexpr uint32_t ARCHIVE_VERSION_PLAIN    = 1;
+            /** raw bytes of frames per block before compression */
+            constexpr size_t ARCHIVE_BLOCK_SIZE         = 4 * MB;
+
+            enum archive_column
+            {
+                GEN_TIME,
+                TRIGGER_TIME,
+                MSG_TYPE,
+                SOURCE,
+                DEST,
+                DATA_LENGTH,
+                DATA,
+                DICTIONARY_ID,
+                DICTIONARY,
+                DELTA,
+                COLUMN_COUNT
+            };
+
+            constexpr int PLAIN_COLUMN_COUNT = DICTIONARY_ID;
+
+            /** decimal fields are delta encoded in this unit */
+            constexpr double DECIMAL_SCALE = 1e8;
+            /** doubles are exact integers up to this */
+            constexpr double DECIMAL_BOUND = 9007199254740992.0;
+
+            inline static void put_varint(std::string &out, uint64_t value)
+            {
+                while (value >= 0x80)
+                {
+                    out.push_back(static_cast<char>(value | 0x80));
+                    value >>= 7;
+                }
+                out.push_back(static_cast<char>(value));
+            }
+
+            inline static uint64_t get_varint(const char *&cursor, const char *end)
+            {
+                uint64_t value = 0;
+                for (int shift = 0; cursor < end and shift < 64; shift += 7)
+                {
+                    auto byte = static_cast<uint8_t>(*cursor++);
+                    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+                    if ((byte & 0x80) == 0)
+                    {
+                        return value;
+                    }
+                }
+                throw journal_error("corrupted archive block");
+            }
+
+            inline static uint64_t zigzag(int64_t value)
+            { return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63); }
+
+            inline static int64_t unzigzag(uint64_t value)
+            { return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1); }
+
+            /** delta of arbitrary int64 wraps instead of overflowing, adding it back wraps back */
+            inline static int64_t wrapping_sub(int64_t a, int64_t b)
+            { return static_cast<int64_t>(static_cast<uint64_t>(a) - static_cast<uint64_t>(b)); }
+
+            inline static int64_t wrapping_add(int64_t a, int64_t b)
+            { return static_cast<int64_t>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b)); }
+
+            /**
+             * decimal delta with its trailing decimal zeros taken out, as zigzag(delta / 10^zeros) << 4 | zeros,
+             * prices move by ticks and volumes have few decimals, so most deltas take a byte or two
+             */
+            inline static uint64_t encode_decimal_delta(int64_t delta)
+            {
+                uint64_t zeros = 0;
+                while (delta != 0 and delta % 10 == 0 and zeros < 15)
+                {
+                    delta /= 10;
+                    zeros++;
+                }
+                return zigzag(delta) << 4 | zeros;
+            }
+
+            inline static int64_t decode_decimal_delta(uint64_t encoded)
+            {
+                int64_t delta = unzigzag(encoded >> 4);
+                for (uint64_t zeros = encoded & 0xf; zeros > 0; zeros--)
+                {
+                    delta *= 10;
+                }
+                return delta;
+            }
+
+            /** layout with what encoder and decoder derive from it */
+            struct layout_codec
+            {
+                archive_layout layout;
+                /** ranges of data not covered by fields, kept as is */
+                std::vector<std::pair<uint32_t, uint32_t>> gaps;
+                /** number of 8 byte values of all delta fields */
+                size_t delta_count = 0;
+                /** index of the first dictionary field, which delta series are kept per value of, -1 if none */
+                int key_field = -1;
+
+                explicit layout_codec(archive_layout l) : layout(std::move(l))
+                {
+                    std::vector<bool> covered(layout.data_length, false);
+                    for (size_t i = 0; i < layout.fields.size(); i++)
+                    {
+                        const auto &field = layout.fields[i];
+                        bool numeric = field.kind == archive_field_kind::DELTA or field.kind == archive_field_kind::DECIMAL;
+                        if (field.offset + field.length > layout.data_length or field.length == 0 or
+                            (numeric and field.length % sizeof(int64_t) != 0))
+                        {
+                            throw journal_error(fmt::format("invalid archive field at {} of msg type {}", field.offset, layout.msg_type));
+                        }
+                        for (uint32_t offset = field.offset; offset < field.offset + field.length; offset++)
+                        {
+                            if (covered[offset])
+                            {
+                                throw journal_error(fmt::format("overlapped archive field at {} of msg type {}", offset, layout.msg_type));
+                            }
+                            covered[offset] = true;
+                        }
+                        if (numeric)
+                        {
+                            delta_count += field.length / sizeof(int64_t);
+                        } else if (key_field < 0)
+                        {
+                            key_field = i;
+                        }
+                    }
+                    for (uint32_t offset = 0; offset < layout.data_length;)
+                    {
+                        uint32_t end = offset;
+                        while (end < layout.data_length and not covered[end])
+                        {
+                            end++;
+                        }
+                        if (end > offset)
+                        {
+                            gaps.emplace_back(offset, end - offset);
+                        }
+                        offset = end + 1;
+                    }
+                }
+            };
+
+            typedef std::map<int32_t, layout_codec> layout_codecs;
+
+            inline static layout_codecs &registered_layouts(std::unique_lock<std::mutex> &lock)
+            {
+                static std::mutex mutex;
+                static layout_codecs codecs;
+                lock = std::unique_lock<std::mutex>(mutex);
+                return codecs;
+            }
+
+            /** dictionary and delta state of a block, blocks start over so that each decodes on its own */
+            class field_state
+            {
+            public:
+                std::vector<int64_t> &series(int32_t msg_type, uint32_t key, size_t delta_count)
+                {
+                    auto &values = series_[(static_cast<uint64_t>(static_cast<uint32_t>(msg_type)) << 32) | key];
+                    values.resize(delta_count, 0);
+                    return values;
+                }
+
+            protected:
+                std::unordered_map<uint64_t, std::vector<int64_t>> series_;
+            };
+
+            class block_encoder : public field_state
+            {
+            public:
+                explicit block_encoder(const layout_codecs &codecs) : codecs_(codecs)
+                {}
+
+                void add(const frame_header *header)
+                {
+                    auto data = reinterpret_cast<const char *>(header) + header->header_length;
+                    uint32_t length = header->length - header->header_length;
+                    if (frame_count_ == 0)
+                    {
+                        begin_time_ = header->gen_time;
+                        last_gen_time_ = header->gen_time;
+                    }
+                    put_varint(columns_[GEN_TIME], zigzag(header->gen_time - last_gen_time_));
+                    put_varint(columns_[TRIGGER_TIME], zigzag(header->trigger_time - last_trigger_time_));
+                    put_varint(columns_[MSG_TYPE], zigzag(header->msg_type));
+                    put_varint(columns_[SOURCE], header->source);
+                    put_varint(columns_[DEST], header->dest);
+                    put_varint(columns_[DATA_LENGTH], length);
+                    auto codec = codecs_.find(static_cast<int32_t>(header->msg_type));
+                    if (codec != codecs_.end() and codec->second.layout.data_length == length)
+                    {
+                        add_fields(codec->second, data);
+                    } else
+                    {
+                        columns_[DATA].append(data, length);
+                    }
+                    last_gen_time_ = header->gen_time;
+                    last_trigger_time_ = header->trigger_time;
+                    raw_length_ += header->length;
+                    frame_count_++;
+                }
+
+                void add_fields(const layout_codec &codec, const char *data)
+                {
+                    uint32_t key = 0;
+                    for (size_t i = 0; i < codec.layout.fields.size(); i++)
+                    {
+                        const auto &field = codec.layout.fields[i];
+                        if (field.kind != archive_field_kind::DICTIONARY)
+                        {
+                            continue;
+                        }
+                        auto inserted = dictionary_.emplace(std::string(data + field.offset, field.length), dictionary_.size());
+                        if (inserted.second)
+                        {
+                            columns_[DICTIONARY].append(data + field.offset, field.length);
+                        }
+                        put_varint(columns_[DICTIONARY_ID], inserted.first->second);
+                        if (static_cast<int>(i) == codec.key_field)
+                        {
+                            key = inserted.first->second;
+                        }
+                    }
+                    auto &last = series(codec.layout.msg_type, key, codec.delta_count);
+                    size_t index = 0;
+                    for (const auto &field : codec.layout.fields)
+                    {
+                        if (field.kind == archive_field_kind::DICTIONARY)
+                        {
+                            continue;
+                        }
+                        for (uint32_t offset = field.offset; offset < field.offset + field.length; offset += sizeof(int64_t))
+                        {
+                            if (field.kind == archive_field_kind::DELTA)
+                            {
+                                int64_t value;
+                                memcpy(&value, data + offset, sizeof(value));
+                                put_varint(columns_[DELTA], zigzag(wrapping_sub(value, last[index])));
+                                last[index++] = value;
+                                continue;
+                            }
+                            // lowest bit tells a scaled delta from a bit pattern, which follows as 8 raw bytes
+                            double value;
+                            memcpy(&value, data + offset, sizeof(value));
+                            double scaled = std::round(value * DECIMAL_SCALE);
+                            if (std::abs(scaled) < DECIMAL_BOUND and static_cast<double>(static_cast<int64_t>(scaled)) / DECIMAL_SCALE == value)
+                            {
+                                auto units = static_cast<int64_t>(scaled);
+                                put_varint(columns_[DELTA], encode_decimal_delta(units - last[index]) << 1);
+                                last[index++] = units;
+                            } else
+                            {
+                                put_varint(columns_[DELTA], 1);
+                                columns_[DELTA].append(data + offset, sizeof(value));
+                                index++;
+                            }
+                        }
+                    }
+                    for (const auto &gap : codec.gaps)
+                    {
+                        columns_[DATA].append(data + gap.first, gap.second);
+                    }
+                }
+
+                [[nodiscard]] bool full() const
+                { return raw_length_ >= ARCHIVE_BLOCK_SIZE; }
+
+                [[nodiscard]] bool empty() const
+                { return frame_count_ == 0; }
+
+                /** deflate columns into out, returns index entry of the block with offset unset */
+                archive_block_entry finish(std::string &out)
+                {
+                    std::string raw;
+                    for (const auto &column : columns_)
+                    {
+                        put_varint(raw, column.size());
+                    }
+                    for (const auto &column : columns_)
+                    {
+                        raw.append(column);
+                    }
+                    uLongf compressed_length = compressBound(raw.size());
+                    out.resize(compressed_length);
+                    if (compress2(reinterpret_cast<Bytef *>(&out[0]), &compressed_length,
+                                  reinterpret_cast<const Bytef *>(raw.data()), raw.size(), Z_DEFAULT_COMPRESSION) != Z_OK)
+                    {
+                        throw journal_error("failed to compress archive block");
+                    }
+                    out.resize(compressed_length);
+
+                    archive_block_entry entry = {};
+                    entry.begin_time = begin_time_;
+                    entry.end_time = last_gen_time_;
+                    entry.compressed_length = compressed_length;
+                    entry.raw_length = raw.size();
+                    entry.frame_count = frame_count_;
+                    reset();
+                    return entry;
+                }
+
+            private:
+                void reset()
+                {
+                    series_.clear();
+                    dictionary_.clear();
+                    for (auto &column : columns_)
+                    {
+                        column.clear();
+                    }
+                    begin_time_ = 0;
+                    last_gen_time_ = 0;
+                    last_trigger_time_ = 0;
+                    raw_length_ = 0;
+                    frame_count_ = 0;
+                }
+
+                const layout_codecs &codecs_;
+                std::unordered_map<std::string, uint32_t> dictionary_;
+                std::string columns_[COLUMN_COUNT];
+                int64_t begin_time_ = 0;
+                int64_t last_gen_time_ = 0;
+                int64_t last_trigger_time_ = 0;
+                uint64_t raw_length_ = 0;
+                uint32_t frame_count_ = 0;
+            };
+
+            inline static const char *take(const char *&cursor, const char *end, size_t length)
+            {
+                if (cursor + length > end)
+                {
+                    throw journal_error("corrupted archive block");
+                }
+                auto taken = cursor;
+                cursor += length;
+                return taken;
+            }
+
+            /** decode one block into frames at address, returns address past the last frame */
+            inline static uintptr_t decode_block(const archive_block_entry &entry, const std::string &compressed, uintptr_t address,
+                                                 const layout_codecs &codecs, int column_count)
+            {
+                std::string raw(entry.raw_length, '\0');
+                uLongf raw_length = entry.raw_length;
+                if (uncompress(reinterpret_cast<Bytef *>(&raw[0]), &raw_length,
+                               reinterpret_cast<const Bytef *>(compressed.data()), compressed.size()) != Z_OK or raw_length != entry.raw_length)
+                {
+                    throw journal_error("failed to uncompress archive block");
+                }
+                const char *end = raw.data() + raw.size();
+                const char *cursor = raw.data();
+                uint64_t column_length[COLUMN_COUNT] = {};
+                for (int i = 0; i < column_count; i++)
+                {
+                    column_length[i] = get_varint(cursor, end);
+                }
+                const char *columns[COLUMN_COUNT];
+                const char *column_end[COLUMN_COUNT];
+                for (int i = 0; i < COLUMN_COUNT; i++)
+                {
+                    columns[i] = cursor;
+                    cursor += column_length[i];
+                    column_end[i] = cursor;
+                }
+                if (cursor > end)
+                {
+                    throw journal_error("corrupted archive block");
+                }
+
+                field_state state;
+                std::vector<const char *> dictionary;
+                int64_t gen_time = entry.begin_time;
+                int64_t trigger_time = 0;
+                for (uint32_t i = 0; i < entry.frame_count; i++)
+                {
+                    auto header = reinterpret_cast<frame_header *>(address);
+                    gen_time += unzigzag(get_varint(columns[GEN_TIME], column_end[GEN_TIME]));
+                    trigger_time += unzigzag(get_varint(columns[TRIGGER_TIME], column_end[TRIGGER_TIME]));
+                    auto msg_type = static_cast<int32_t>(unzigzag(get_varint(columns[MSG_TYPE], column_end[MSG_TYPE])));
+                    auto source = static_cast<uint32_t>(get_varint(columns[SOURCE], column_end[SOURCE]));
+                    auto dest = static_cast<uint32_t>(get_varint(columns[DEST], column_end[DEST]));
+                    auto length = static_cast<uint32_t>(get_varint(columns[DATA_LENGTH], column_end[DATA_LENGTH]));
+                    auto data = reinterpret_cast<char *>(address + sizeof(frame_header));
+
+                    auto codec = codecs.find(msg_type);
+                    if (codec != codecs.end() and codec->second.layout.data_length == length)
+                    {
+                        const auto &layout = codec->second.layout;
+                        uint32_t key = 0;
+                        for (size_t f = 0; f < layout.fields.size(); f++)
+                        {
+                            const auto &field = layout.fields[f];
+                            if (field.kind != archive_field_kind::DICTIONARY)
+                            {
+                                continue;
+                            }
+                            auto id = get_varint(columns[DICTIONARY_ID], column_end[DICTIONARY_ID]);
+                            if (id == dictionary.size())
+                            {
+                                dictionary.push_back(take(columns[DICTIONARY], column_end[DICTIONARY], field.length));
+                            } else if (id > dictionary.size())
+                            {
+                                throw journal_error("corrupted archive block");
+                            }
+                            memcpy(data + field.offset, dictionary[id], field.length);
+                            if (static_cast<int>(f) == codec->second.key_field)
+                            {
+                                key = id;
+                            }
+                        }
+                        auto &last = state.series(msg_type, key, codec->second.delta_count);
+                        size_t index = 0;
+                        for (const auto &field : layout.fields)
+                        {
+                            if (field.kind == archive_field_kind::DICTIONARY)
+                            {
+                                continue;
+                            }
+                            for (uint32_t offset = field.offset; offset < field.offset + field.length; offset += sizeof(int64_t))
+                            {
+                                auto encoded = get_varint(columns[DELTA], column_end[DELTA]);
+                                if (field.kind == archive_field_kind::DELTA)
+                                {
+                                    last[index] = wrapping_add(last[index], unzigzag(encoded));
+                                    memcpy(data + offset, &last[index++], sizeof(int64_t));
+                                } else if (encoded & 1)
+                                {
+                                    memcpy(data + offset, take(columns[DELTA], column_end[DELTA], sizeof(double)), sizeof(double));
+                                    index++;
+                                } else
+                                {
+                                    last[index] += decode_decimal_delta(encoded >> 1);
+                                    double value = static_cast<double>(last[index++]) / DECIMAL_SCALE;
+                                    memcpy(data + offset, &value, sizeof(value));
+                                }
+                            }
+                        }
+                        for (const auto &gap : codec->second.gaps)
+                        {
+                            memcpy(data + gap.first, take(columns[DATA], column_end[DATA], gap.second), gap.second);
+                        }
+                    } else
+                    {
+                        memcpy(data, take(columns[DATA], column_end[DATA], length), length);
+                    }
+
+                    header->length = sizeof(frame_header) + length;
+                    header->header_length = sizeof(frame_header);
+                    header->gen_time = gen_time;
+                    header->trigger_time = trigger_time;
+                    header->msg_type = msg_type;
+                    header->source = source;
+                    header->dest = dest;
+                    address += header->length;
+                }
+                return address;
+            }
+
+            /** layouts follow the block index, as count then msg type, data length, field count and fields of each */
+            inline static void write_layouts(std::ofstream &out, const layout_codecs &codecs)
+            {
+                auto put = [&](const auto &value)
+                { out.write(reinterpret_cast<const char *>(&value), sizeof(value)); };
+                put(static_cast<uint32_t>(codecs.size()));
+                for (const auto &item : codecs)
+                {
+                    const auto &layout = item.second.layout;
+                    put(layout.msg_type);
+                    put(layout.data_length);
+                    put(static_cast<uint32_t>(layout.fields.size()));
+                    out.write(reinterpret_cast<const char *>(layout.fields.data()), layout.fields.size() * sizeof(archive_field));
+                }
+            }
+
+            inline static layout_codecs read_layouts(std::ifstream &in, const std::string &path)
+            {
+                auto get = [&](auto &value)
+                {
+                    if (not in.read(reinterpret_cast<char *>(&value), sizeof(value)))
+                    {
+                        throw journal_error("invalid layouts in archive " + path);
+                    }
+                };
+                layout_codecs codecs;
+                uint32_t count = 0;
+                get(count);
+                for (uint32_t i = 0; i < count; i++)
+                {
+                    archive_layout layout = {};
+                    uint32_t field_count = 0;
+                    get(layout.msg_type);
+                    get(layout.data_length);
+                    get(field_count);
+                    layout.fields.resize(field_count);
+                    for (auto &field : layout.fields)
+                    {
+                        get(field);
+                    }
+                    codecs.emplace(layout.msg_type, layout_codec(layout));
+                }
+                return codecs;
+            }
+
+            void archive::register_layout(const archive_layout &layout)
+            {
+                layout_codec codec(layout);
+                std::unique_lock<std::mutex> lock;
+                auto &codecs = registered_layouts(lock);
+                codecs.erase(layout.msg_type);
+                codecs.emplace(layout.msg_type, std::move(codec));
+            }
+
+            std::string archive::get_archive_path(const data::location_ptr &location, uint32_t dest_id, int page_id)
+            {
+                return fmt::format("{}/{:08x}.{}.archive", location->locator->layout_dir(location, data::layout::JOURNAL), dest_id, page_id);
+            }
+
+            bool archive::exists(const data::location_ptr &location, uint32_t dest_id, int page_id)
+            {
+                return std::ifstream(get_archive_path(location, dest_id, page_id)).good();
+            }
+
+            archive_stats archive::compact(const data::location_ptr &location, uint32_t dest_id, int page_id, bool remove_page)
+            {
+                auto page_path = page::get_page_path(location, dest_id, page_id);
+                auto source_page = page::load(location, dest_id, page_id, false, true);
+                auto last_frame = reinterpret_cast<const frame_header *>(source_page->last_frame_address());
+                if (last_frame->msg_type != msg::type::PageEnd)
+                {
+                    throw journal_error("can not archive page not closed yet " + page_path);
+                }
+
+                archive_header header = {};
+                header.magic = ARCHIVE_MAGIC;
+                header.version = ARCHIVE_VERSION;
+                header.page_size = source_page->get_page_size();
+                header.begin_time = source_page->begin_time();
+                header.end_time = last_frame->gen_time;
+                header.page_end_trigger_time = last_frame->trigger_time;
+
+                auto path = get_archive_path(location, dest_id, page_id);
+                auto tmp_path = path + ".tmp";
+                std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+                out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+                layout_codecs codecs;
+                {
+                    std::unique_lock<std::mutex> lock;
+                    codecs = registered_layouts(lock);
+                }
+                archive_stats stats = {};
+                std::vector<archive_block_entry> blocks;
+                block_encoder encoder(codecs);
+                std::string compressed;
+                uint64_t offset = sizeof(header);
+                auto flush = [&]()
+                {
+                    auto entry = encoder.finish(compressed);
+                    entry.offset = offset;
+                    out.write(compressed.data(), compressed.size());
+                    offset += compressed.size();
+                    blocks.push_back(entry);
+                };
+                for (auto address = source_page->first_frame_address(); address < source_page->last_frame_address();)
+                {
+                    auto frame = reinterpret_cast<const frame_header *>(address);
+                    if (frame->header_length != sizeof(frame_header) or frame->length < frame->header_length)
+                    {
+                        throw journal_error(fmt::format("unexpected frame at {} in {}", address - source_page->address(), page_path));
+                    }
+                    encoder.add(frame);
+                    stats.frame_count++;
+                    stats.frame_bytes += frame->length;
+                    address += frame->length;
+                    if (encoder.full())
+                    {
+                        flush();
+                    }
+                }
+                if (not encoder.empty())
+                {
+                    flush();
+                }
+
+                header.block_count = blocks.size();
+                header.block_index_offset = offset;
+                header.frame_count = stats.frame_count;
+                header.frame_bytes = stats.frame_bytes;
+                out.write(reinterpret_cast<const char *>(blocks.data()), blocks.size() * sizeof(archive_block_entry));
+                write_layouts(out, codecs);
+                stats.archive_bytes = out.tellp();
+                out.seekp(0);
+                out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+                out.close();
+                if (not out or std::rename(tmp_path.c_str(), path.c_str()) != 0)
+                {
+                    std::remove(tmp_path.c_str());
+                    throw journal_error("failed to write archive " + path);
+                }
+
+                stats.page_bytes = source_page->get_page_size();
+                source_page.reset();
+                if (remove_page and std::remove(page_path.c_str()) != 0)
+                {
+                    SPDLOG_ERROR("can not remove archived page {}", page_path);
+                }
+                SPDLOG_INFO("archived {} frames of {}/{:08x}.{}.journal, {} bytes into {} bytes",
+                            stats.frame_count, location->uname, dest_id, page_id, stats.frame_bytes, stats.archive_bytes);
+                return stats;
+            }
+
+            page_ptr archive::load(const data::location_ptr &location, uint32_t dest_id, int page_id, int64_t from_time)
+            {
+                auto path = get_archive_path(location, dest_id, page_id);
+                std::ifstream in(path, std::ios::binary);
+                archive_header header = {};
+                if (not in.read(reinterpret_cast<char *>(&header), sizeof(header)) or header.magic != ARCHIVE_MAGIC)
+                {
+                    throw journal_error("invalid archive " + path);
+                }
+                if (header.version != ARCHIVE_VERSION and header.version != ARCHIVE_VERSION_PLAIN)
+                {
+                    throw journal_error(fmt::format("version mismatch for archive {}, required {}, found {}", path, ARCHIVE_VERSION, header.version));
+                }
+                std::vector<archive_block_entry> blocks(header.block_count);
+                in.seekg(header.block_index_offset);
+                in.read(reinterpret_cast<char *>(blocks.data()), blocks.size() * sizeof(archive_block_entry));
+                if (not in)
+                {
+                    throw journal_error("invalid block index in archive " + path);
+                }
+                bool plain = header.version == ARCHIVE_VERSION_PLAIN;
+                auto codecs = plain ? layout_codecs() : read_layouts(in, path);
+
+                // anonymous memory is only backed once touched, the part of skipped blocks costs nothing
+                size_t size = sizeof(page_header) + header.frame_bytes + sizeof(frame_header);
+                uintptr_t address = os::load_anonymous_buffer(size);
+                auto loaded_page = std::shared_ptr<page>(new page(location, dest_id, page_id, size, true, address));
+
+                // frames of a block end at its end_time, the ones readers would skip anyway are not decoded
+                auto first_block = std::find_if(blocks.begin(), blocks.end(), [&](const archive_block_entry &block)
+                { return block.end_time > from_time; });
+                loaded_page->decoded_from_ = first_block == blocks.begin() ? 0 : from_time;
+
+                uintptr_t frame_address = address + sizeof(page_header);
+                std::string compressed;
+                for (auto block = first_block; block != blocks.end(); block++)
+                {
+                    compressed.resize(block->compressed_length);
+                    in.seekg(block->offset);
+                    if (not in.read(&compressed[0], compressed.size()))
+                    {
+                        throw journal_error("truncated archive " + path);
+                    }
+                    frame_address = decode_block(*block, compressed, frame_address, codecs, plain ? PLAIN_COLUMN_COUNT : COLUMN_COUNT);
+                }
+                if (first_block == blocks.begin() and frame_address != address + sizeof(page_header) + header.frame_bytes)
+                {
+                    throw journal_error("corrupted archive " + path);
+                }
+
+                auto page_end = reinterpret_cast<frame_header *>(frame_address);
+                page_end->length = sizeof(frame_header);
+                page_end->header_length = sizeof(frame_header);
+                page_end->gen_time = header.end_time;
+                page_end->trigger_time = header.page_end_trigger_time;
+                page_end->msg_type = msg::type::PageEnd;
+                page_end->source = location->uid;
+                page_end->dest = dest_id;
+
+                auto page_header_address = reinterpret_cast<page_header *>(address);
+                page_header_address->version = __JOURNAL_VERSION__;
+                page_header_address->page_header_length = sizeof(page_header);
+                page_header_address->frame_header_length = sizeof(frame_header);
+                page_header_address->last_frame_position = frame_address - address;
+                // page ends right after page end frame, so that it is full even with blocks skipped
+                page_header_address->page_size = page_header_address->last_frame_position + sizeof(frame_header);
+                return loaded_page;
+            }
+        }
+    }
+}
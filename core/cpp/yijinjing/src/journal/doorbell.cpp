@@ -0,0 +1,240 @@
+/**
+ * This is source code modified under the Apache License 2.0.
+ * Original Author: Keren Dong
+ * Modifier: kx@godzilla.dev
+ * Modification date: March 3, 2025
+ */
+#include <thread>
+#include <algorithm>
+#include <spdlog/spdlog.h>
+
+#ifdef __linux__
+#include <cerrno>
+#include <ctime>
+#include <csignal>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif // __linux__
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include <kungfu/yijinjing/time.h>
+#include <kungfu/yijinjing/util/os.h>
+#include <kungfu/yijinjing/journal/doorbell.h>
+
+namespace kungfu
+{
+    namespace yijinjing
+    {
+        namespace journal
+        {
+            constexpr size_t DOORBELL_SIZE = 16 * KB;
+            static_assert(sizeof(doorbell_state) <= DOORBELL_SIZE, "doorbell state does not fit");
+            /** without futex, parking is a short sleep */
+            constexpr int64_t DOORBELL_SLEEP = 1000000;
+            /** park after a ring that found nothing, long enough for a message in flight to land */
+            constexpr int64_t DOORBELL_RECHECK = 1000000;
+
+            inline static void cpu_relax()
+            {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+                _mm_pause();
+#elif defined(__aarch64__)
+                asm volatile("yield" ::: "memory");
+#endif
+            }
+
+            inline static uint32_t slot_of(uint32_t location_uid, uint32_t dest_id)
+            {
+                uint64_t key = (static_cast<uint64_t>(location_uid) << 32) | dest_id;
+                return static_cast<uint32_t>((key * 0x9E3779B97F4A7C15ull) >> 54) % DOORBELL_SLOTS;
+            }
+
+            doorbell::doorbell(const data::location_ptr &home) : state_(nullptr), waiter_(-1), waiter_claimed_(false)
+            {
+                auto master = data::location::make(data::mode::LIVE, data::category::SYSTEM, "master", "master", home->locator);
+                path_ = home->locator->layout_dir(master, data::layout::JOURNAL) + "/doorbells";
+                try
+                {
+                    state_ = reinterpret_cast<doorbell_state *>(os::load_mmap_buffer(path_, DOORBELL_SIZE, true, true));
+                } catch (const journal_error &ex)
+                {
+                    SPDLOG_WARN("doorbell not available, parked waiters poll instead: {}", ex.what());
+                }
+            }
+
+            doorbell::~doorbell()
+            {
+                if (state_ != nullptr)
+                {
+                    if (waiter_ >= 0)
+                    {
+                        state_->waiters[waiter_].pid.store(0);
+                        state_->claimed.fetch_and(~(1ull << waiter_));
+                    }
+                    os::release_mmap_buffer(reinterpret_cast<uintptr_t>(state_), DOORBELL_SIZE, true);
+                }
+            }
+
+            void doorbell::ring(uint32_t location_uid, uint32_t dest_id)
+            {
+                if (state_ == nullptr)
+                {
+                    return;
+                }
+                // pairs with the fence in park, either the waiter sees our frame or we see the waiter
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                uint64_t mask = state_->slots[slot_of(location_uid, dest_id)].load(std::memory_order_relaxed);
+                if (mask != 0)
+                {
+                    wake(mask);
+                }
+            }
+
+            void doorbell::ring_all()
+            {
+                if (state_ == nullptr)
+                {
+                    return;
+                }
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                uint64_t mask = state_->parked.load(std::memory_order_relaxed);
+                if (mask != 0)
+                {
+                    wake(mask);
+                }
+            }
+
+            void doorbell::wake(uint64_t mask)
+            {
+                while (mask != 0)
+                {
+                    auto &waiter = state_->waiters[__builtin_ctzll(mask)];
+                    mask &= mask - 1;
+                    waiter.sequence.fetch_add(1, std::memory_order_release);
+#ifdef __linux__
+                    syscall(SYS_futex, &waiter.sequence, FUTEX_WAKE, 1, nullptr, nullptr, 0);
+#endif // __linux__
+                }
+            }
+
+            int32_t doorbell::claim_waiter()
+            {
+#ifdef __linux__
+                int32_t pid = getpid();
+                for (int attempt = 0; attempt < 2; attempt++)
+                {
+                    uint64_t claimed = state_->claimed.load();
+                    while (~claimed != 0)
+                    {
+                        int32_t id = __builtin_ctzll(~claimed);
+                        if (state_->claimed.compare_exchange_weak(claimed, claimed | (1ull << id)))
+                        {
+                            state_->waiters[id].pid.store(pid);
+                            return id;
+                        }
+                    }
+                    // all taken, take back entries of processes gone without releasing them
+                    for (uint32_t id = 0; id < DOORBELL_WAITERS; id++)
+                    {
+                        int32_t owner = state_->waiters[id].pid.load();
+                        if (owner > 0 and owner != pid and kill(owner, 0) != 0 and errno == ESRCH and
+                            state_->waiters[id].pid.compare_exchange_strong(owner, 0))
+                        {
+                            uint64_t bit = 1ull << id;
+                            for (auto &slot : state_->slots)
+                            {
+                                slot.fetch_and(~bit);
+                            }
+                            state_->parked.fetch_and(~bit);
+                            state_->claimed.fetch_and(~bit);
+                        }
+                    }
+                }
+                SPDLOG_WARN("all {} doorbell waiters taken, parked waiters poll instead", DOORBELL_WAITERS);
+#endif // __linux__
+                return -1;
+            }
+
+            bool doorbell::park(const std::vector<doorbell_key> &keys, const std::function<bool()> &has_data, int64_t timeout)
+            {
+                if (state_ != nullptr and not waiter_claimed_)
+                {
+                    waiter_ = claim_waiter();
+                    waiter_claimed_ = true;
+                }
+                if (waiter_ < 0)
+                {
+                    std::this_thread::sleep_for(std::chrono::nanoseconds(std::min(timeout, DOORBELL_SLEEP)));
+                    return false;
+                }
+                auto &waiter = state_->waiters[waiter_];
+                uint64_t bit = 1ull << waiter_;
+                for (const auto &key : keys)
+                {
+                    state_->slots[slot_of(key.first, key.second)].fetch_or(bit, std::memory_order_relaxed);
+                }
+                state_->parked.fetch_or(bit, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                uint32_t ticket = waiter.sequence.load(std::memory_order_acquire);
+                bool rung = true;
+                if (not has_data())
+                {
+#ifdef __linux__
+                    struct timespec ts = {};
+                    ts.tv_sec = timeout / time_unit::NANOSECONDS_PER_SECOND;
+                    ts.tv_nsec = timeout % time_unit::NANOSECONDS_PER_SECOND;
+                    // returns at once with EAGAIN if sequence moved since the ticket was taken
+                    rung = syscall(SYS_futex, &waiter.sequence, FUTEX_WAIT, ticket, &ts, nullptr, 0) == 0 or errno == EAGAIN;
+#endif // __linux__
+                }
+                state_->parked.fetch_and(~bit, std::memory_order_relaxed);
+                for (const auto &key : keys)
+                {
+                    state_->slots[slot_of(key.first, key.second)].fetch_and(~bit, std::memory_order_relaxed);
+                }
+                return rung;
+            }
+
+            idle_strategy::idle_strategy(doorbell_ptr bell, const data::wait_policy &policy) :
+                    bell_(std::move(bell)), policy_(policy), idle_count_(0), rung_(false)
+            {
+                SPDLOG_INFO("idle strategy spin {} yield {} park {}ms", policy_.spin_count, policy_.yield_count,
+                            policy_.park_timeout / time_unit::NANOSECONDS_PER_MILLISECOND);
+            }
+
+            void idle_strategy::idle(const std::function<bool()> &has_data,
+                                     const std::function<void(std::vector<doorbell_key> &)> &keys, int64_t deadline)
+            {
+                if (policy_.park_timeout <= 0)
+                {
+                    cpu_relax();
+                } else if (idle_count_ < policy_.spin_count)
+                {
+                    idle_count_++;
+                    cpu_relax();
+                } else if (idle_count_ < policy_.spin_count + policy_.yield_count)
+                {
+                    idle_count_++;
+                    std::this_thread::yield();
+                } else
+                {
+                    int64_t timeout = rung_ ? std::min(policy_.park_timeout, DOORBELL_RECHECK) : policy_.park_timeout;
+                    if (deadline != INT64_MAX)
+                    {
+                        timeout = std::min(timeout, deadline - time::now_in_nano());
+                    }
+                    if (timeout > 0)
+                    {
+                        keys_.clear();
+                        keys(keys_);
+                        rung_ = bell_->park(keys_, has_data, timeout);
+                    }
+                }
+            }
+        }
+    }
+}
@@ -12,9 +12,6 @@
 #include <kungfu/yijinjing/util/util.h>
 #include <kungfu/yijinjing/msg.h>
 
-#define MAX_MD_PAGE_NUMBER 8
-#define MAX_PAGE_NUMBER 50
-
 namespace kungfu
 {
     namespace yijinjing
@@ -28,6 +25,10 @@ namespace kungfu
                 {
                     current_page_.reset();
                 }
+                if (is_writing_)
+                {
+                    page_provider::get_instance().release(location_, dest_id_);
+                }
             }
 
             void journal::next()
@@ -46,7 +47,7 @@ namespace kungfu
             void journal::seek_to_time(int64_t nanotime)
             {
                 int page_id = page::find_page_id(location_, dest_id_, nanotime);
-                load_page(page_id);
+                load_page(page_id, nanotime);
                 SPDLOG_TRACE("{} in page [{}] [{} - {}]",
                              nanotime > 0 ? time::strftime(nanotime) : "beginning", page_id,
                              time::strftime(current_page_->begin_time(), "%F %T"), time::strftime(current_page_->end_time(), "%F %T"));
@@ -60,26 +61,21 @@ namespace kungfu
                 }
             }
 
-            void journal::load_page(int page_id)
+            void journal::load_page(int page_id, int64_t from_time)
             {
-                if (current_page_.get() == nullptr or current_page_->get_page_id() != page_id)
-                {
-                    current_page_ = page::load(location_, dest_id_, page_id, is_writing_, lazy_);
-                    frame_->set_address(current_page_->first_frame_address());
-                    page_frame_nb_ = 0;
-                }
-                char* clear_journal = std::getenv("CLEAR_JOURNAL");
-                if (clear_journal != nullptr and (is_writing_ || !lazy_))
+                if (current_page_.get() == nullptr or current_page_->get_page_id() != page_id or current_page_->decoded_from_ > from_time)
                 {
-                    auto page_number = MAX_PAGE_NUMBER;
-                    if (current_page_->get_location()->category == data::category::MD && current_page_->get_dest_id() == 0)
+                    if (is_writing_)
                     {
-                        page_number = MAX_MD_PAGE_NUMBER;
-                    }
-                    if (page_id > page_number)
+                        auto &provider = page_provider::get_instance();
+                        current_page_ = provider.take(location_, dest_id_, page_id, lazy_);
+                        provider.prepare(location_, dest_id_, page_id + 1, lazy_);
+                    } else
                     {
-                        unlink(current_page_->get_page_path(current_page_->get_location(), current_page_->get_dest_id(), page_id - MAX_PAGE_NUMBER).c_str());
+                        current_page_ = page::load(location_, dest_id_, page_id, is_writing_, lazy_, from_time);
                     }
+                    frame_->set_address(current_page_->first_frame_address());
+                    page_frame_nb_ = 0;
                 }
             }
 
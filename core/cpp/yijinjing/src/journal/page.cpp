@@ -6,11 +6,15 @@
  */
 #include <utility>
 #include <sstream>
+#include <fstream>
+#include <algorithm>
 #include <fmt/format.h>
 #include <spdlog/spdlog.h>
 
+#include <kungfu/yijinjing/msg.h>
 #include <kungfu/yijinjing/util/os.h>
 #include <kungfu/yijinjing/journal/page.h>
+#include <kungfu/yijinjing/journal/archive.h>
 
 namespace kungfu
 {
@@ -41,11 +45,54 @@ namespace kungfu
                 const_cast<page_header *>(header_)->last_frame_position = position;
             }
 
-            page_ptr page::load(const data::location_ptr &location, uint32_t dest_id, int page_id, bool is_writing, bool lazy)
+            void page::append_to_index() const
             {
-                uint32_t page_size = find_page_size(location, dest_id);
-                std::string path = get_page_path(location, dest_id, page_id);
-                uintptr_t address = os::load_mmap_buffer(path, page_size, is_writing, lazy);
+                append_to_index(get_page_index_path(location_, dest_id_));
+            }
+
+            void page::append_to_index(const std::string &index_path) const
+            {
+                page_index_entry entry = {};
+                entry.page_id = page_id_;
+                entry.begin_time = begin_time();
+                entry.end_time = end_time();
+                std::ofstream index(index_path, std::ios::binary | std::ios::app);
+                index.write(reinterpret_cast<const char *>(&entry), sizeof(entry));
+                if (not index)
+                {
+                    SPDLOG_ERROR("can not index page {}/{:08x}.{}.journal", location_->uname, dest_id_, page_id_);
+                }
+            }
+
+            page_ptr page::load(const data::location_ptr &location, uint32_t dest_id, int page_id, bool is_writing, bool lazy,
+                                int64_t from_time)
+            {
+                auto path = get_page_path(location, dest_id, page_id);
+                if (not is_writing and not std::ifstream(path).good() and archive::exists(location, dest_id, page_id))
+                {
+                    return archive::load(location, dest_id, page_id, from_time);
+                }
+                return map(location, dest_id, page_id, path, find_journal_policy(location, dest_id), is_writing, lazy);
+            }
+
+            page_ptr page::map(const data::location_ptr &location, uint32_t dest_id, int page_id, const std::string &path,
+                               const data::journal_policy &policy, bool is_writing, bool lazy)
+            {
+                uint32_t page_size = policy.page_size;
+                page_header existing_header = {};
+                std::ifstream existing_page(path, std::ios::binary);
+                if (existing_page.read(reinterpret_cast<char *>(&existing_header), sizeof(existing_header)) and existing_header.page_size > 0)
+                {
+                    // page size in policy only applies to new pages
+                    page_size = existing_header.page_size;
+                }
+                existing_page.close();
+
+                os::mmap_options options;
+                options.populate = policy.populate;
+                options.huge_pages = policy.huge_pages;
+                options.numa_node = policy.numa_node;
+                uintptr_t address = os::load_mmap_buffer(path, page_size, is_writing, lazy, options);
                 if (address < 0)
                 {
                     throw journal_error("unable to load page for " + path);
@@ -85,7 +132,12 @@ namespace kungfu
                 return location->locator->layout_file(location, data::layout::JOURNAL, fmt::format("{:08x}.{}", dest_id, id));
             }
 
-            int page::find_page_id(const data::location_ptr &location, uint32_t dest_id, int64_t time)
+            inline static bool page_exists(const data::location_ptr &location, uint32_t dest_id, int id)
+            {
+                return std::ifstream(page::get_page_path(location, dest_id, id)).good() or archive::exists(location, dest_id, id);
+            }
+
+            inline static int find_page_id_by_listing(const data::location_ptr &location, uint32_t dest_id, int64_t time)
             {
                 std::vector<int> page_ids = location->locator->list_page_id(location, dest_id);
                 if (page_ids.empty())
@@ -100,13 +152,89 @@ namespace kungfu
                 {
                     auto page = page::load(location, dest_id, page_ids[i], false, true);
                     auto page_begin_time = page->begin_time();
-                    if (page_begin_time < time)
+                    // skip pages prepared ahead by writer but not written yet
+                    if (page_begin_time > 0 && page_begin_time < time)
                     {
                         return page_ids[i];
                     }
                 }
                 return page_ids.front();
             }
+
+            int page::find_page_id(const data::location_ptr &location, uint32_t dest_id, int64_t time)
+            {
+                auto index = load_page_index(location, dest_id);
+                if (index.empty())
+                {
+                    return find_page_id_by_listing(location, dest_id, time);
+                }
+                int page_id = index.front().page_id;
+                if (time > index.back().end_time)
+                {
+                    // the page after the last closed one is created before the index entry is written
+                    page_id = index.back().page_id + 1;
+                } else if (time > 0)
+                {
+                    auto it = std::lower_bound(index.begin(), index.end(), time,
+                                               [](const page_index_entry &entry, int64_t t)
+                                               { return entry.begin_time < t; });
+                    page_id = it == index.begin() ? index.front().page_id : std::prev(it)->page_id;
+                }
+                if (not page_exists(location, dest_id, page_id))
+                {
+                    // pages recorded in index might have been removed by journal cleaning
+                    return find_page_id_by_listing(location, dest_id, time);
+                }
+                return page_id;
+            }
+
+            std::string page::get_page_index_path(const data::location_ptr &location, uint32_t dest_id)
+            {
+                return fmt::format("{}/{:08x}.index", location->locator->layout_dir(location, data::layout::JOURNAL), dest_id);
+            }
+
+            std::vector<page_index_entry> page::load_page_index(const data::location_ptr &location, uint32_t dest_id)
+            {
+                return load_page_index(get_page_index_path(location, dest_id));
+            }
+
+            std::vector<page_index_entry> page::load_page_index(const std::string &index_path)
+            {
+                std::vector<page_index_entry> index;
+                std::ifstream file(index_path, std::ios::binary | std::ios::ate);
+                if (not file)
+                {
+                    return index;
+                }
+                // a partially appended tail entry is ignored
+                index.resize(static_cast<size_t>(file.tellg()) / sizeof(page_index_entry));
+                file.seekg(0);
+                file.read(reinterpret_cast<char *>(index.data()), index.size() * sizeof(page_index_entry));
+                return index;
+            }
+
+            void page::build_page_index(const data::location_ptr &location, uint32_t dest_id)
+            {
+                if (std::ifstream(get_page_index_path(location, dest_id)).good() or
+                    os::is_hugetlbfs(location->locator->layout_dir(location, data::layout::JOURNAL)))
+                {
+                    return;
+                }
+                int indexed = 0;
+                for (auto page_id : location->locator->list_page_id(location, dest_id))
+                {
+                    auto page = page::load(location, dest_id, page_id, false, true);
+                    if (reinterpret_cast<frame_header *>(page->last_frame_address())->msg_type == msg::type::PageEnd)
+                    {
+                        page->append_to_index();
+                        indexed++;
+                    }
+                }
+                if (indexed > 0)
+                {
+                    SPDLOG_INFO("built page index for {}/{:08x} with {} pages", location->uname, dest_id, indexed);
+                }
+            }
         }
     }
 }
@@ -0,0 +1,313 @@
+/**
+ * This is source code modified under the Apache License 2.0.
+ * Original Author: Keren Dong
+ * Modifier: kx@godzilla.dev
+ * Modification date: March 3, 2025
+ */
+#include <cstdio>
+#include <algorithm>
+#include <fstream>
+#include <spdlog/spdlog.h>
+
+#include <kungfu/yijinjing/time.h>
+#include <kungfu/yijinjing/util/os.h>
+#include <kungfu/yijinjing/journal/page.h>
+
+namespace kungfu
+{
+    namespace yijinjing
+    {
+        namespace journal
+        {
+            /** touch one byte per memory page, for the kernel to fault it in before writer comes */
+            constexpr size_t PREFAULT_STRIDE = 4 * KB;
+
+            /** same naming as page::get_page_path, composed here since locator is not available on helper thread */
+            inline static std::string get_page_path(const std::string &journal_dir, uint32_t dest_id, int page_id)
+            {
+                return fmt::format("{}/{:08x}.{}.journal", journal_dir, dest_id, page_id);
+            }
+
+            /** same naming as archive::get_archive_path */
+            inline static std::string get_archive_path(const std::string &journal_dir, uint32_t dest_id, int page_id)
+            {
+                return fmt::format("{}/{:08x}.{}.archive", journal_dir, dest_id, page_id);
+            }
+
+            inline static int64_t get_file_size(const std::string &path)
+            {
+                std::ifstream file(path, std::ios::binary | std::ios::ate);
+                return file ? static_cast<int64_t>(file.tellg()) : -1;
+            }
+
+            page_provider::~page_provider()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    live_ = false;
+                }
+                cv_.notify_all();
+                if (worker_.joinable())
+                {
+                    worker_.join();
+                }
+                prepared_.clear();
+            }
+
+            void page_provider::prepare(const data::location_ptr &location, uint32_t dest_id, int page_id, bool lazy)
+            {
+                auto files = resolve(location, dest_id);
+                std::lock_guard<std::mutex> lock(mutex_);
+                page_key key = std::make_tuple(location->uid, dest_id, page_id);
+                if (pending_.find(key) != pending_.end() or prepared_.find(key) != prepared_.end())
+                {
+                    return;
+                }
+                pending_.insert(key);
+                tasks_.push_back({location, dest_id, page_id, lazy, nullptr, files});
+                if (not worker_.joinable())
+                {
+                    worker_ = std::thread(&page_provider::run, this);
+                }
+                cv_.notify_all();
+            }
+
+            page_ptr page_provider::take(const data::location_ptr &location, uint32_t dest_id, int page_id, bool lazy)
+            {
+                page_key key = std::make_tuple(location->uid, dest_id, page_id);
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    cv_.wait(lock, [&]
+                    { return pending_.find(key) == pending_.end(); });
+                    auto it = prepared_.find(key);
+                    if (it != prepared_.end())
+                    {
+                        auto prepared_page = it->second;
+                        prepared_.erase(it);
+                        return prepared_page;
+                    }
+                }
+                SPDLOG_DEBUG("page {}/{:08x}.{}.journal not prepared, load in place", location->uname, dest_id, page_id);
+                auto files = resolve(location, dest_id);
+                return page::map(location, dest_id, page_id, get_page_path(files->journal_dir, dest_id, page_id), files->policy, true, lazy);
+            }
+
+            void page_provider::retire(page_ptr closed_page)
+            {
+                auto files = resolve(closed_page->location_, closed_page->dest_id_);
+                std::unique_lock<std::mutex> lock(mutex_);
+                task t = {closed_page->location_, closed_page->dest_id_, closed_page->page_id_, true, std::move(closed_page), files};
+                if (not worker_.joinable())
+                {
+                    lock.unlock();
+                    reclaim(t);
+                    return;
+                }
+                tasks_.push_back(std::move(t));
+                cv_.notify_all();
+            }
+
+            void page_provider::release(const data::location_ptr &location, uint32_t dest_id)
+            {
+                auto of_journal = [&](const page_key &key)
+                { return std::get<0>(key) == location->uid and std::get<1>(key) == dest_id; };
+                std::vector<page_ptr> released;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    cv_.wait(lock, [&]
+                    { return std::none_of(pending_.begin(), pending_.end(), of_journal); });
+                    for (auto it = prepared_.begin(); it != prepared_.end();)
+                    {
+                        if (of_journal(it->first))
+                        {
+                            released.push_back(std::move(it->second));
+                            it = prepared_.erase(it);
+                        } else
+                        {
+                            it++;
+                        }
+                    }
+                }
+                // unmapped here, out of the mutex
+                released.clear();
+            }
+
+            std::shared_ptr<const page_provider::journal_files> page_provider::resolve(const data::location_ptr &location, uint32_t dest_id)
+            {
+                journal_key key = std::make_pair(location->uid, dest_id);
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    auto it = files_.find(key);
+                    if (it != files_.end())
+                    {
+                        return it->second;
+                    }
+                }
+                auto files = std::make_shared<journal_files>();
+                files->journal_dir = location->locator->layout_dir(location, data::layout::JOURNAL);
+                files->index_path = page::get_page_index_path(location, dest_id);
+                files->indexed = not os::is_hugetlbfs(files->journal_dir);
+                if (not files->indexed)
+                {
+                    SPDLOG_INFO("{}/{:08x} is on hugetlbfs, pages are not indexed nor cleaned", location->uname, dest_id);
+                }
+                files->policy = find_journal_policy(location, dest_id);
+                std::lock_guard<std::mutex> lock(mutex_);
+                return files_.emplace(key, files).first->second;
+            }
+
+            void page_provider::load(const task &t)
+            {
+                page_ptr loaded_page;
+                try
+                {
+                    const auto &policy = t.files->policy;
+                    loaded_page = page::map(t.location, t.dest_id, t.page_id, get_page_path(t.files->journal_dir, t.dest_id, t.page_id),
+                                            policy, true, t.lazy);
+                    if (t.lazy and not policy.populate and policy.numa_node < 0)
+                    {
+                        auto begin = reinterpret_cast<volatile char *>(loaded_page->address());
+                        for (size_t offset = 0; offset < loaded_page->get_page_size(); offset += PREFAULT_STRIDE)
+                        {
+                            begin[offset] = begin[offset];
+                        }
+                    }
+                } catch (const std::exception &ex)
+                {
+                    SPDLOG_ERROR("failed to prepare page {}/{:08x}.{}.journal: {}", t.location->uname, t.dest_id, t.page_id, ex.what());
+                }
+
+                std::lock_guard<std::mutex> lock(mutex_);
+                page_key key = std::make_tuple(t.location->uid, t.dest_id, t.page_id);
+                if (loaded_page)
+                {
+                    prepared_[key] = loaded_page;
+                }
+                pending_.erase(key);
+                cv_.notify_all();
+            }
+
+            void page_provider::reclaim(task &t)
+            {
+                const auto &policy = t.files->policy;
+                if (not t.files->indexed)
+                {
+                    // retention goes by index
+                    t.closed_page.reset();
+                    return;
+                }
+                t.closed_page->append_to_index(t.files->index_path);
+                t.closed_page.reset();
+
+                if (policy.max_pages == 0 and policy.max_bytes == 0 and policy.max_age == 0 and policy.cached_pages == 0)
+                {
+                    return;
+                }
+
+                // closed pages still on disk, oldest first, index entries of removed pages are dropped below,
+                // archived pages are kept in index but not subject to retention
+                std::vector<page_index_entry> index = page::load_page_index(t.files->index_path);
+                std::vector<page_index_entry> closed;
+                std::vector<page_index_entry> archived;
+                std::vector<int64_t> sizes;
+                uint64_t total_bytes = policy.page_size;
+                for (const auto &entry : index)
+                {
+                    int64_t size = get_file_size(get_page_path(t.files->journal_dir, t.dest_id, entry.page_id));
+                    if (size >= 0)
+                    {
+                        closed.push_back(entry);
+                        sizes.push_back(size);
+                        total_bytes += size;
+                    } else if (get_file_size(get_archive_path(t.files->journal_dir, t.dest_id, entry.page_id)) >= 0)
+                    {
+                        archived.push_back(entry);
+                    }
+                }
+
+                int64_t now = time::now_in_nano();
+                size_t removed = 0;
+                for (; removed < closed.size(); removed++)
+                {
+                    const auto &entry = closed[removed];
+                    uint64_t page_number = closed.size() - removed + 1;
+                    bool expired = (policy.max_pages > 0 and page_number > policy.max_pages) or
+                                   (policy.max_bytes > 0 and total_bytes > policy.max_bytes) or
+                                   (policy.max_age > 0 and now - entry.end_time > policy.max_age);
+                    if (not expired)
+                    {
+                        break;
+                    }
+                    auto path = get_page_path(t.files->journal_dir, t.dest_id, entry.page_id);
+                    if (std::remove(path.c_str()) != 0)
+                    {
+                        SPDLOG_ERROR("can not remove page {}", path);
+                        break;
+                    }
+                    total_bytes -= sizes[removed];
+                    SPDLOG_INFO("removed page {}/{:08x}.{}.journal", t.location->uname, t.dest_id, entry.page_id);
+                }
+
+                // each closed page is dropped from page cache once, when it falls out of the cached window
+                if (policy.cached_pages > 0 and closed.size() > removed + policy.cached_pages)
+                {
+                    const auto &entry = closed[closed.size() - policy.cached_pages - 1];
+                    auto path = get_page_path(t.files->journal_dir, t.dest_id, entry.page_id);
+                    if (not os::release_page_cache(path))
+                    {
+                        SPDLOG_DEBUG("page cache not released for {}", path);
+                    }
+                }
+
+                if (archived.size() + closed.size() - removed < index.size())
+                {
+                    std::vector<page_index_entry> remaining(archived);
+                    remaining.insert(remaining.end(), closed.begin() + removed, closed.end());
+                    std::sort(remaining.begin(), remaining.end(), [](const page_index_entry &a, const page_index_entry &b)
+                    { return a.page_id < b.page_id; });
+                    // rewrite then rename, readers never see a partially written index
+                    auto tmp_path = t.files->index_path + ".tmp";
+                    {
+                        std::ofstream tmp(tmp_path, std::ios::binary | std::ios::trunc);
+                        tmp.write(reinterpret_cast<const char *>(remaining.data()), remaining.size() * sizeof(page_index_entry));
+                    }
+                    if (std::rename(tmp_path.c_str(), t.files->index_path.c_str()) != 0)
+                    {
+                        SPDLOG_ERROR("can not update page index {}", t.files->index_path);
+                    }
+                }
+            }
+
+            page_provider &page_provider::get_instance()
+            {
+                static page_provider provider;
+                return provider;
+            }
+
+            void page_provider::run()
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                while (live_ or not tasks_.empty())
+                {
+                    cv_.wait(lock, [&]
+                    { return not live_ or not tasks_.empty(); });
+                    if (tasks_.empty())
+                    {
+                        continue;
+                    }
+                    task t = std::move(tasks_.front());
+                    tasks_.pop_front();
+                    lock.unlock();
+                    if (t.closed_page)
+                    {
+                        reclaim(t);
+                    } else
+                    {
+                        load(t);
+                    }
+                    lock.lock();
+                }
+            }
+        }
+    }
+}
@@ -5,9 +5,11 @@
  * Modification date: March 3, 2025
  */
 #include <utility>
+#include <algorithm>
 #include <spdlog/spdlog.h>
 
 #include <kungfu/yijinjing/time.h>
+#include <kungfu/yijinjing/msg.h>
 #include <kungfu/yijinjing/journal/page.h>
 #include <kungfu/yijinjing/journal/journal.h>
 
@@ -21,6 +23,8 @@ namespace kungfu
         {
             reader::~reader()
             {
+                ready_.clear();
+                idle_.clear();
                 journals_.clear();
             }
 
@@ -37,6 +41,8 @@ namespace kungfu
                 }
                 journals_.push_back(std::make_shared<journal>(location, dest_id, false, lazy_));
                 journals_.back()->seek_to_time(from_time);
+                // the heap is left untouched while reading, new journal is picked up by next poll
+                idle_.push_back(journals_.back().get());
                 if (current_ == nullptr)
                 {
                     sort(); // do not sort if current_ is set (because we could be in process of reading)
@@ -45,17 +51,38 @@ namespace kungfu
 
             void reader::disjoin(const uint32_t location_uid)
             {
+                if (current_ != nullptr && current_->location_->uid == location_uid)
+                {
+                    current_ = nullptr;
+                }
                 journals_.erase(std::remove_if(journals_.begin(), journals_.end(),
                                                [&](journal_ptr j)
                                                { return j->location_->uid == location_uid; }), journals_.end());
-                current_ = nullptr;
-                sort();
+                rebuild();
+            }
+
+            void reader::list_journals(std::vector<std::pair<uint32_t, uint32_t>> &ids) const
+            {
+                for (const auto &j : journals_)
+                {
+                    ids.emplace_back(j->location_->uid, j->dest_id_);
+                }
             }
 
             bool reader::data_available()
             {
-                sort();
-                return current_ != nullptr && current_frame()->has_data();
+                poll_idle();
+                if (ready_.empty())
+                {
+                    return false;
+                }
+                current_ = ready_.front();
+                int64_t gen_time = current_->frame_->gen_time();
+                if (gen_time > time_bound_)
+                {
+                    time_bound_ = time::now_in_nano();
+                }
+                return gen_time <= time_bound_;
             }
 
             void reader::seek_to_time(int64_t nanotime)
@@ -69,23 +96,110 @@ namespace kungfu
 
             void reader::next()
             {
-                if(current_ != nullptr)
+                if (current_ == nullptr)
+                {
+                    return;
+                }
+                if (not ready_.empty() && ready_.front() == current_)
                 {
+                    std::pop_heap(ready_.begin(), ready_.end(), later_frame);
+                    ready_.pop_back();
                     current_->next();
+                    track(current_);
+                    current_ = ready_.empty() ? current_ : ready_.front();
+                } else
+                {
+                    current_->next();
+                    sort();
                 }
-                sort();
+            }
+
+            frame_batch reader::read_batch(int64_t end_time, size_t max_count)
+            {
+                while (data_available() and current_->frame_->msg_type() == msg::type::PageEnd)
+                {
+                    next();
+                }
+                if (ready_.empty() or max_count == 0 or current_->frame_->gen_time() > std::min(end_time, time_bound_))
+                {
+                    return frame_batch();
+                }
+
+                journal *j = current_;
+                std::pop_heap(ready_.begin(), ready_.end(), later_frame);
+                ready_.pop_back();
+                time_bound_ = time::now_in_nano();
+                int64_t bound = std::min(end_time, time_bound_);
+                if (not ready_.empty())
+                {
+                    bound = std::min(bound, ready_.front()->frame_->gen_time());
+                }
+
+                auto frame = j->frame_;
+                uintptr_t begin = frame->address();
+                size_t count = 0;
+                do
+                {
+                    frame->move_to_next();
+                    j->page_frame_nb_++;
+                    count++;
+                } while (count < max_count and frame->has_data() and frame->msg_type() != msg::type::PageEnd and frame->gen_time() <= bound);
+
+                track(j);
+                current_ = ready_.empty() ? j : ready_.front();
+                return frame_batch(begin, frame->address(), count);
             }
 
             void reader::sort()
             {
-                int64_t min_time = time::now_in_nano();
+                rebuild();
+                if (not ready_.empty())
+                {
+                    current_ = ready_.front();
+                }
+            }
+
+            void reader::rebuild()
+            {
+                ready_.clear();
+                idle_.clear();
                 for (const auto &journal : journals_)
                 {
-                    const auto &&frame = journal->current_frame();
-                    if (frame->has_data() && frame->gen_time() <= min_time)
+                    track(journal.get());
+                }
+            }
+
+            void reader::track(journal *j)
+            {
+                if (j->frame_->has_data())
+                {
+                    ready_.push_back(j);
+                    std::push_heap(ready_.begin(), ready_.end(), later_frame);
+                } else
+                {
+                    idle_.push_back(j);
+                }
+            }
+
+            bool reader::later_frame(const journal *a, const journal *b)
+            {
+                return a->frame_->gen_time() > b->frame_->gen_time();
+            }
+
+            void reader::poll_idle()
+            {
+                for (size_t i = 0; i < idle_.size();)
+                {
+                    auto j = idle_[i];
+                    if (j->frame_->has_data())
+                    {
+                        ready_.push_back(j);
+                        std::push_heap(ready_.begin(), ready_.end(), later_frame);
+                        idle_[i] = idle_.back();
+                        idle_.pop_back();
+                    } else
                     {
-                        min_time = frame->gen_time();
-                        current_ = journal.get();
+                        i++;
                     }
                 }
             }
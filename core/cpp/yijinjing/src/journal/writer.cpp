@@ -6,6 +6,7 @@
  */
 #include <utility>
 #include <mutex>
+#include <thread>
 
 #include <kungfu/yijinjing/common.h>
 #include <kungfu/yijinjing/time.h>
@@ -35,14 +36,34 @@ namespace kungfu
                 return std::hash<std::string>()(uuid_str);
             }
 
-            writer::writer(const data::location_ptr& location, uint32_t dest_id, bool lazy, publisher_ptr publisher) :
-                    publisher_(std::move(publisher)), size_to_write_(0)
+            constexpr uint32_t CURSOR_CLOSING   = 0xFFFFFFFF;
+
+            inline uint64_t make_cursor(uint32_t page_id, uint32_t offset)
+            { return (static_cast<uint64_t>(page_id) << 32) | offset; }
+
+            inline uint32_t cursor_page_id(uint64_t cursor)
+            { return static_cast<uint32_t>(cursor >> 32); }
+
+            inline uint32_t cursor_offset(uint64_t cursor)
+            { return static_cast<uint32_t>(cursor); }
+
+            writer::writer(const data::location_ptr& location, uint32_t dest_id, bool lazy, publisher_ptr publisher, writer_mode mode) :
+                    mode_(mode), publisher_(std::move(publisher)), size_to_write_(0), producers_{{0}, {0}}
             {
                 auto uuid = generate_uuid();
                 frame_id_base_ = location->uid ^ dest_id ^ uuid;
                 frame_id_base_ = frame_id_base_ << 32;
+                page::build_page_index(location, dest_id);
                 journal_ = std::make_shared<journal>(location, dest_id, true, lazy);
                 journal_->seek_to_time(time::now_in_nano());
+
+                auto page = journal_->current_page_;
+                auto page_id = static_cast<uint32_t>(page->get_page_id());
+                page_size_ = page->get_page_size();
+                page_addresses_[page_id & 1].store(page->address());
+                page_addresses_[(page_id + 1) & 1].store(0);
+                reserve_cursor_.store(make_cursor(page_id, journal_->current_frame()->address() - page->address()));
+                commit_cursor_.store(reserve_cursor_.load());
             }
 
             uint64_t writer::current_frame_uid()
@@ -56,8 +77,16 @@ namespace kungfu
             {
                 assert(sizeof(frame_header) + data_length + sizeof(frame_header) <= journal_->current_page_->get_page_size());
                 SPDLOG_TRACE("open frame msg type {}:{}@{}", msg_type, journal_->location_->uid, journal_->dest_id_);
+                if (mode_ == writer_mode::MULTI_PRODUCER)
+                {
+                    throw journal_error("Can not open frame on multi producer writer for " + journal_->location_->uname + ", msg_type: " + std::to_string(msg_type));
+                }
+                if (trigger_time == 0)
+                {
+                    trigger_time = trigger_scope::current();
+                }
                 int64_t t = time::now_in_nano();
-                while (not writer_mtx_.try_lock())
+                while (mode_ == writer_mode::LOCKED and not writer_mtx_.try_lock())
                 {
                     if (time::now_in_nano() - t > time_unit::NANOSECONDS_PER_MILLISECOND)
                     {
@@ -87,23 +116,31 @@ namespace kungfu
                 frame->set_data_length(data_length);
                 journal_->current_page_->set_last_frame_position(frame->address() - journal_->current_page_->address());
                 journal_->next();
-                writer_mtx_.unlock();
-                publisher_->notify();
+                if (mode_ == writer_mode::LOCKED)
+                {
+                    writer_mtx_.unlock();
+                }
+                publisher_->notify_journal(journal_->location_->uid, journal_->dest_id_);
             }
 
             void writer::mark(int64_t trigger_time, int32_t msg_type)
             {
+                if (mode_ == writer_mode::MULTI_PRODUCER)
+                {
+                    write_multi_producer(trigger_time, msg_type, nullptr, 0);
+                    return;
+                }
                 open_frame(trigger_time, msg_type, 0);
                 close_frame(0);
             }
 
             void writer::mark_with_time(int64_t gen_time, int32_t msg_type)
             {
+                assert(mode_ != writer_mode::MULTI_PRODUCER);
                 assert(sizeof(frame_header) + sizeof(frame_header) <= journal_->current_page_->get_page_size());
                 if (journal_->current_frame()->address() + sizeof(frame_header) > journal_->current_page_->address_border())
                 {
-                    mark(gen_time, msg::type::PageEnd);
-                    journal_->load_next_page();
+                    close_page(gen_time);
                 }
                 auto frame = journal_->current_frame();
                 frame->set_header_length();
@@ -120,6 +157,11 @@ namespace kungfu
 
             void writer::write_raw(int64_t trigger_time, int32_t msg_type, uintptr_t data, uint32_t length)
             {
+                if (mode_ == writer_mode::MULTI_PRODUCER)
+                {
+                    write_multi_producer(trigger_time, msg_type, reinterpret_cast<void *>(data), length);
+                    return;
+                }
                 auto frame = open_frame(trigger_time, msg_type, length);
                 memcpy(const_cast<void*>(frame->data_address()), reinterpret_cast<void*>(data), length);
                 close_frame(length);
@@ -146,6 +188,119 @@ namespace kungfu
                 last_page_frame.set_gen_time(time::now_in_nano());
                 last_page_frame.set_data_length(0);
                 last_page->set_last_frame_position(last_page_frame.address() - last_page->address());
+                page_provider::get_instance().retire(std::move(last_page));
+            }
+
+            void writer::write_multi_producer(int64_t trigger_time, int32_t msg_type, const void *data, uint32_t length)
+            {
+                if (trigger_time == 0)
+                {
+                    trigger_time = trigger_scope::current();
+                }
+                uint32_t frame_length = sizeof(frame_header) + length;
+                while (true)
+                {
+                    uint64_t cursor = reserve_cursor_.load();
+                    // page size may change on rollover if policy changed, it is published before cursor
+                    uint32_t page_size = page_size_.load();
+                    assert(frame_length + sizeof(frame_header) <= page_size - sizeof(page_header));
+                    uint32_t page_id = cursor_page_id(cursor);
+                    uint32_t offset = cursor_offset(cursor);
+                    if (offset == CURSOR_CLOSING)
+                    {
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    // register before claiming, the page can not be released until we are done with it
+                    auto &producers = producers_[page_id & 1];
+                    producers.fetch_add(1);
+                    bool fits = offset + frame_length < page_size - sizeof(frame_header);
+                    uint64_t claimed = fits ? make_cursor(page_id, offset + frame_length) : make_cursor(page_id, CURSOR_CLOSING);
+                    if (not reserve_cursor_.compare_exchange_weak(cursor, claimed))
+                    {
+                        producers.fetch_sub(1);
+                        continue;
+                    }
+                    if (not fits)
+                    {
+                        producers.fetch_sub(1);
+                        close_page_multi_producer(make_cursor(page_id, offset), trigger_time);
+                        continue;
+                    }
+
+                    frame f;
+                    f.set_address(page_addresses_[page_id & 1].load() + offset);
+                    f.set_header_length();
+                    f.set_trigger_time(trigger_time);
+                    f.set_msg_type(msg_type);
+                    f.set_source(journal_->location_->uid);
+                    f.set_dest(journal_->dest_id_);
+                    if (length > 0)
+                    {
+                        memcpy(const_cast<void *>(f.data_address()), data, length);
+                    }
+                    // frames are published in the order they are claimed, stamped in turn so that gen_time follows that order,
+                    // readers stop at the first frame without length and would not see a later one published before it
+                    while (commit_cursor_.load(std::memory_order_acquire) != cursor)
+                    {
+                        std::this_thread::yield();
+                    }
+                    f.set_gen_time(time::now_in_nano());
+                    // frame length is what readers poll on, it must be the last thing becoming visible
+                    std::atomic_thread_fence(std::memory_order_release);
+                    f.set_data_length(length);
+                    commit_cursor_.store(claimed, std::memory_order_release);
+                    producers.fetch_sub(1);
+                    publisher_->notify_journal(journal_->location_->uid, journal_->dest_id_);
+                    return;
+                }
+            }
+
+            void writer::close_page_multi_producer(uint64_t cursor, int64_t trigger_time)
+            {
+                uint32_t page_id = cursor_page_id(cursor);
+                uint32_t offset = cursor_offset(cursor);
+                uint32_t next_page_id = page_id + 1;
+
+                // the closing mark on cursor makes us the only one touching journal_ until the next page is published
+                page_ptr last_page = journal_->current_page_;
+                journal_->load_next_page();
+                auto next_page = journal_->current_page_;
+                assert(static_cast<uint32_t>(next_page->get_page_id()) == next_page_id);
+
+                // page end goes after every frame claimed before it
+                while (commit_cursor_.load(std::memory_order_acquire) != cursor)
+                {
+                    std::this_thread::yield();
+                }
+                frame last_page_frame;
+                last_page_frame.set_address(last_page->address() + offset);
+                last_page_frame.set_header_length();
+                last_page_frame.set_trigger_time(trigger_time);
+                last_page_frame.set_msg_type(msg::type::PageEnd);
+                last_page_frame.set_source(journal_->location_->uid);
+                last_page_frame.set_dest(journal_->dest_id_);
+                last_page_frame.set_gen_time(time::now_in_nano());
+                std::atomic_thread_fence(std::memory_order_release);
+                last_page_frame.set_data_length(0);
+                last_page->set_last_frame_position(offset);
+
+                // slot of next page was used by the page before last one, wait for late producers to leave it
+                while (producers_[next_page_id & 1].load() > 0)
+                {
+                    std::this_thread::yield();
+                }
+                page_addresses_[next_page_id & 1].store(next_page->address());
+                page_size_.store(next_page->get_page_size());
+                commit_cursor_.store(make_cursor(next_page_id, next_page->first_frame_address() - next_page->address()));
+                reserve_cursor_.store(make_cursor(next_page_id, next_page->first_frame_address() - next_page->address()));
+
+                while (producers_[page_id & 1].load() > 0)
+                {
+                    std::this_thread::yield();
+                }
+                page_provider::get_instance().retire(std::move(last_page));
+                publisher_->notify_journal(journal_->location_->uid, journal_->dest_id_);
             }
         }
     }
@@ -10,6 +10,7 @@
 #include <spdlog/sinks/daily_file_sink.h>
 
 #include <kungfu/yijinjing/util/util.h>
+#include <kungfu/yijinjing/util/os.h>
 #include <kungfu/yijinjing/log/setup.h>
 
 namespace kungfu {
@@ -42,7 +43,8 @@ namespace kungfu {
                     spdlog::level::level_enum env_log_level = get_env_log_level(locator);
                     logger->set_level(env_log_level);
                     spdlog::set_default_logger(logger);
-                    spdlog::flush_every(std::chrono::seconds(3));
+                    os::spawn_placed(os::thread_role::LOG, locator->get_thread_policy(location).log_cpus, []()
+                    { spdlog::flush_every(std::chrono::seconds(3)); });
                 } else {
                     SPDLOG_WARN("Setup log for {} more than once", name);
                 }
@@ -142,6 +142,10 @@ int socket::send (const std::string& msg, int flags) const
         }
         return -1;
     }
+    if (on_sent_)
+    {
+        on_sent_();
+    }
     return rc;
 }
 
@@ -180,6 +184,12 @@ const std::string& socket::recv_msg(int flags)
     return message_;
 }
 
+bool socket::readable () const
+{
+    struct nn_pollfd pfd = {sock_, NN_POLLIN, 0};
+    return nn_poll (&pfd, 1, 0) > 0 and (pfd.revents & NN_POLLIN);
+}
+
 int socket::send_json (const nlohmann::json &msg, int flags) const
 {
     return send(msg.dump(), flags);
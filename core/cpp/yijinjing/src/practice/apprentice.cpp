@@ -23,8 +23,58 @@ namespace kungfu
 {
     namespace practice
     {
+        /** resolution of timer wheel, timers fire no earlier than asked and at most one tick later when loop is idle */
+        static constexpr int64_t TIMER_TICK = time_unit::NANOSECONDS_PER_MILLISECOND;
+
+        constexpr timer_handle apprentice::MASTER_TIMER;
+
+        /** event handed to callbacks of timers fired by timer wheel, looks like the time event master sends */
+        class timer_event : public event
+        {
+        public:
+            timer_event(int64_t gen_time, uint32_t source, uint32_t dest) : gen_time_(gen_time), source_(source), dest_(dest)
+            {}
+
+            int64_t gen_time() const override
+            { return gen_time_; }
+
+            int64_t trigger_time() const override
+            { return gen_time_; }
+
+            int32_t msg_type() const override
+            { return msg::type::Time; }
+
+            uint32_t source() const override
+            { return source_; }
+
+            uint32_t dest() const override
+            { return dest_; }
+
+            uint32_t data_length() const override
+            { return 0; }
+
+            const char *data_as_bytes() const override
+            { return nullptr; }
+
+            const std::string data_as_string() const override
+            { return std::string(); }
+
+            const std::string to_string() const override
+            { return fmt::format("{{\"gen_time\":{},\"msg_type\":{}}}", gen_time_, msg::type::Time); }
+
+        protected:
+            const void *data_address() const override
+            { return nullptr; }
+
+        private:
+            const int64_t gen_time_;
+            const uint32_t source_;
+            const uint32_t dest_;
+        };
+
         apprentice::apprentice(location_ptr home, bool low_latency) :
-                hero(std::make_shared<io_device_client>(home, low_latency)), timer_usage_count_(0)
+                hero(std::make_shared<io_device_client>(home, low_latency)), timer_usage_count_(0),
+                timer_wheel_(TIMER_TICK, time::now_in_nano())
         {
             auto uid_str = fmt::format("{:08x}", get_live_home_uid());
             auto locator = get_io_device()->get_home()->locator;
@@ -50,11 +100,40 @@ namespace kungfu
             }
         }
 
-        void apprentice::add_timer(int64_t nanotime, const std::function<void(event_ptr)> &callback)
+        journal::writer_ptr apprentice::open_public_writer(uint32_t dest_id, journal::writer_mode write_mode)
+        {
+            if (has_location(dest_id))
+            {
+                throw yijinjing_error(fmt::format("public journal can not go to location [{:08x}]", dest_id));
+            }
+            auto writer = get_io_device()->open_writer(dest_id, write_mode);
+            writers_[dest_id] = writer;
+            if (get_io_device()->get_home()->mode == mode::LIVE)
+            {
+                msg::data::Channel channel = {};
+                channel.source_id = get_home_uid();
+                channel.dest_id = dest_id;
+                writers_[master_commands_location_->uid]->write(now(), msg::type::Channel, channel);
+            }
+            return writer;
+        }
+
+        timer_handle apprentice::add_timer(int64_t nanotime, const std::function<void(event_ptr)> &callback)
         {
+            if (get_io_device()->get_home()->mode == mode::LIVE)
+            {
+                if (timer_wheel_.size() == 0)
+                {
+                    // wheel is not advanced while empty, catch up before scheduling
+                    timer_wheel_.advance(time::now_in_nano());
+                }
+                return timer_wheel_.schedule(nanotime, 0, make_timer_callback(callback));
+            }
+            int32_t timer_id = timer_usage_count_;
             events_ | timer(nanotime) |
-            $([&, callback](event_ptr e)
+            $([&, callback, timer_id](event_ptr e)
               {
+                  timer_checkpoints_.erase(timer_id);
                   try
                   { callback(e); }
                   catch (const std::exception &e)
@@ -75,10 +154,21 @@ namespace kungfu
                       SPDLOG_WARN("Unexpected exception by timer{}", ex.what());
                   }
               });
+            return MASTER_TIMER | static_cast<uint32_t>(timer_id);
         }
 
-        void apprentice::add_time_interval(int64_t duration, const std::function<void(event_ptr)> &callback)
+        timer_handle apprentice::add_time_interval(int64_t duration, const std::function<void(event_ptr)> &callback)
         {
+            if (get_io_device()->get_home()->mode == mode::LIVE)
+            {
+                auto now = time::now_in_nano();
+                if (timer_wheel_.size() == 0)
+                {
+                    timer_wheel_.advance(now);
+                }
+                return timer_wheel_.schedule(now + duration, duration, make_timer_callback(callback));
+            }
+            int32_t timer_id = timer_usage_count_;
             events_ | time_interval(std::chrono::nanoseconds(duration)) |
             $([&, callback](event_ptr e)
               {
@@ -89,6 +179,41 @@ namespace kungfu
                       SPDLOG_ERROR("Unexpected exception by time_interval {}", e.what());
                   }
               });
+            return MASTER_TIMER | static_cast<uint32_t>(timer_id);
+        }
+
+        bool apprentice::cancel_timer(timer_handle handle)
+        {
+            if (handle & MASTER_TIMER)
+            {
+                // time events from master keep coming, they just match no checkpoint any more
+                return timer_checkpoints_.erase(static_cast<int>(handle & ~MASTER_TIMER)) > 0;
+            }
+            return timer_wheel_.cancel(handle);
+        }
+
+        timer_wheel::callback apprentice::make_timer_callback(const std::function<void(event_ptr)> &callback)
+        {
+            return [&, callback](int64_t now)
+            {
+                now_ = now;
+                try
+                { callback(std::make_shared<timer_event>(now, get_master_commands_uid(), get_live_home_uid())); }
+                catch (const std::exception &e)
+                {
+                    SPDLOG_ERROR("Unexpected exception by timer {}", e.what());
+                }
+            };
+        }
+
+        bool apprentice::produce_one(const rx::subscriber<event_ptr> &sb)
+        {
+            bool alive = hero::produce_one(sb);
+            if (timer_wheel_.size() > 0)
+            {
+                timer_wheel_.advance(time::now_in_nano());
+            }
+            return alive;
         }
 
         void apprentice::react()
@@ -153,6 +278,11 @@ namespace kungfu
               {
                     auto& channel = e->data<msg::data::Channel>();
                     register_channel(e->gen_time(), channel);
+                    auto source = public_sources_.find(channel.source_id);
+                    if (source != public_sources_.end() and is_public_channel(channel))
+                    {
+                        reader_->join(get_location(channel.source_id), channel.dest_id, source->second);
+                    }
               });
 
             events_ | is(msg::type::Register) |
@@ -237,6 +367,18 @@ namespace kungfu
                         time::strftime(request.from_time));
             uint32_t dest_id = event->msg_type() == msg::type::RequestReadFromPublic ? 0 : get_live_home_uid();
             reader_->join(get_location(request.source_id), dest_id, request.from_time);
+            if (event->msg_type() == msg::type::RequestReadFromPublic)
+            {
+                // a source may be asked again from another time, channels announced later are joined from the latest
+                public_sources_[request.source_id] = request.from_time;
+                for (const auto &item : channels_)
+                {
+                    if (item.second.source_id == request.source_id and is_public_channel(item.second))
+                    {
+                        reader_->join(get_location(request.source_id), item.second.dest_id, request.from_time);
+                    }
+                }
+            }
         }
 
         void apprentice::checkin()
@@ -291,6 +433,7 @@ namespace kungfu
             nlohmann::json location_json = nlohmann::json::parse(json_str);
             uint32_t location_uid = location_json["uid"];
             reader_->disjoin(location_uid);
+            public_sources_.erase(location_uid);
             deregister_channel_by_source(location_uid);
             deregister_location(event->trigger_time(), location_uid);
         }
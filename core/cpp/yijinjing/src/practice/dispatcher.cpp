@@ -0,0 +1,121 @@
+/**
+ * This is source code modified under the Apache License 2.0.
+ * Original Author: Keren Dong
+ * Modifier: kx@godzilla.dev
+ * Modification date: March 3, 2025
+ */
+
+#include <kungfu/practice/dispatcher.h>
+
+namespace kungfu
+{
+    namespace practice
+    {
+        constexpr int32_t dispatcher::DENSE_MSG_TYPES;
+
+        dispatcher::dispatcher() : dense_(DENSE_MSG_TYPES), last_id_(0), depth_(0)
+        {}
+
+        handler_id dispatcher::on(int32_t msg_type, handler h)
+        {
+            return add(get_route(msg_type).all, nullptr, 0, std::move(h));
+        }
+
+        handler_id dispatcher::on_from(int32_t msg_type, uint32_t source, handler h)
+        {
+            auto &by_source = get_route(msg_type).by_source;
+            return add(by_source[source], &by_source, source, std::move(h));
+        }
+
+        handler_id dispatcher::on_to(int32_t msg_type, uint32_t dest, handler h)
+        {
+            auto &by_dest = get_route(msg_type).by_dest;
+            return add(by_dest[dest], &by_dest, dest, std::move(h));
+        }
+
+        bool dispatcher::off(handler_id id)
+        {
+            auto it = registry_.find(id);
+            if (it == registry_.end())
+            {
+                return false;
+            }
+            // slots stay in place, positions of other handlers may be in use by a dispatch up the stack
+            (*it->second.list)[it->second.index].active = false;
+            retired_.push_back(it->second);
+            registry_.erase(it);
+            if (depth_ == 0)
+            {
+                release_retired();
+            }
+            return true;
+        }
+
+        dispatcher::route &dispatcher::get_route(int32_t msg_type)
+        {
+            if (msg_type >= 0 and msg_type < DENSE_MSG_TYPES)
+            {
+                if (not dense_[msg_type])
+                {
+                    dense_[msg_type] = std::make_unique<route>();
+                }
+                return *dense_[msg_type];
+            }
+            return sparse_[msg_type];
+        }
+
+        handler_id dispatcher::add(handlers &list, keyed_handlers *keyed, uint32_t key, handler h)
+        {
+            list.push_back(slot{std::move(h), ++last_id_, true});
+            registry_[last_id_] = registration{&list, list.size() - 1, keyed, key};
+            return last_id_;
+        }
+
+        void dispatcher::release_retired()
+        {
+            // a handler may turn itself off, so slots are only reclaimed once no handler is running
+            for (const auto &r : retired_)
+            {
+                compact(r);
+            }
+            retired_.clear();
+        }
+
+        void dispatcher::compact(const registration &r)
+        {
+            handlers *list = r.list;
+            if (r.keyed != nullptr)
+            {
+                // the list is gone if compacted empty for an earlier retired handler
+                auto it = r.keyed->find(r.key);
+                if (it == r.keyed->end())
+                {
+                    return;
+                }
+                list = &it->second;
+            }
+            // keep handlers in the order registered, and tell the registry where they moved
+            size_t kept = 0;
+            for (size_t i = 0; i < list->size(); i++)
+            {
+                slot &s = (*list)[i];
+                if (not s.active)
+                {
+                    continue;
+                }
+                if (i != kept)
+                {
+                    (*list)[kept] = std::move(s);
+                    registry_[(*list)[kept].id].index = kept;
+                }
+                kept++;
+            }
+            list->resize(kept);
+            if (kept == 0 and r.keyed != nullptr)
+            {
+                // books popped leave no key behind
+                r.keyed->erase(r.key);
+            }
+        }
+    }
+}
@@ -37,6 +37,12 @@ namespace kungfu
             }
             os::handle_os_signals(this);
             reader_ = io_device_->open_reader_to_subscribe();
+            auto home = io_device_->get_home();
+            thread_policy_ = home->locator->get_thread_policy(home);
+            if (io_device_->is_low_latency() and home->mode == mode::LIVE)
+            {
+                idle_strategy_ = std::make_shared<idle_strategy>(io_device_->get_doorbell(), home->locator->get_wait_policy(home));
+            }
         }
 
         bool hero::has_location(uint32_t hash)
@@ -89,8 +95,25 @@ namespace kungfu
             return writers_[dest_id];
         }
 
+        void hero::place_thread(os::thread_role role)
+        {
+            switch (role)
+            {
+                case os::thread_role::EVENT_LOOP:
+                    os::place_thread(role, thread_policy_.event_loop_cpus, thread_policy_.event_loop_priority);
+                    break;
+                case os::thread_role::IO:
+                    os::place_thread(role, thread_policy_.io_cpus, thread_policy_.io_priority);
+                    break;
+                case os::thread_role::LOG:
+                    os::place_thread(role, thread_policy_.log_cpus);
+                    break;
+            }
+        }
+
         void hero::run()
         {
+            place_thread(os::thread_role::EVENT_LOOP);
             SPDLOG_INFO("{} [{:08x}] running", get_home_uname(), get_home_uid());
             SPDLOG_INFO("from {} until {}", time::strftime(begin_time_), end_time_ == INT64_MAX ? "end of world" : time::strftime(end_time_));
 
@@ -249,15 +272,19 @@ namespace kungfu
 
         bool hero::produce_one(const rx::subscriber<yijinjing::event_ptr> &sb)
         {
+            bool busy = false;
             if (io_device_->get_home()->mode == mode::LIVE)
             {
-                if (io_device_->get_observer()->wait())
+                if (io_device_->get_observer()->wait_until(next_wakeup_time()))
                 {
+                    busy = true;
                     const std::string &notice = io_device_->get_observer()->get_notice();
                     now_ = time::now_in_nano();
                     if (notice.length() > 2)
                     {
-                        sb.on_next(std::make_shared<nanomsg_json>(notice));
+                        event_ptr event = std::make_shared<nanomsg_json>(notice);
+                        sb.on_next(event);
+                        dispatcher_.dispatch(event);
                     } else
                     {
                         on_notify();
@@ -265,18 +292,28 @@ namespace kungfu
                 }
                 if (io_device_->get_rep_sock()->recv() > 0)
                 {
+                    busy = true;
                     const std::string &msg = io_device_->get_rep_sock()->last_message();
                     now_ = time::now_in_nano();
-                    sb.on_next(std::make_shared<nanomsg_json>(msg));
+                    event_ptr event = std::make_shared<nanomsg_json>(msg);
+                    sb.on_next(event);
+                    dispatcher_.dispatch(event);
                 }
             }
             while (reader_->data_available())
             {
+                busy = true;
                 if (reader_->current_frame()->gen_time() <= end_time_)
                 {
-                    now_ = reader_->current_frame()->gen_time();
-                    SPDLOG_TRACE("source: {}, dest: {}, msg type: {}, gen_time: {}", reader_->current_frame()->source(), reader_->current_frame()->dest(), reader_->current_frame()->msg_type(), now_);
-                    sb.on_next(reader_->current_frame());
+                    event_ptr event = reader_->current_frame();
+                    now_ = event->gen_time();
+                    SPDLOG_TRACE("source: {}, dest: {}, msg type: {}, gen_time: {}", event->source(), event->dest(), event->msg_type(), now_);
+                    {
+                        // frames written by handlers of the event are triggered by it
+                        trigger_scope scope(now_);
+                        sb.on_next(event);
+                        dispatcher_.dispatch(event);
+                    }
                     reader_->next();
                 } else
                 {
@@ -289,6 +326,24 @@ namespace kungfu
                 SPDLOG_INFO("reached journal end {}", time::strftime(reader_->current_frame()->gen_time()));
                 return false;
             }
+            if (idle_strategy_ and busy)
+            {
+                idle_strategy_->reset();
+            } else if (idle_strategy_)
+            {
+                idle_strategy_->idle([this]()
+                                     {
+                                         // a request sent before we parked rang nobody
+                                         return reader_->data_available() or io_device_->get_observer()->has_notice() or
+                                                io_device_->get_rep_sock()->readable();
+                                     },
+                                     [this](std::vector<doorbell_key> &keys)
+                                     {
+                                         // journals read, and requests sent to our sockets
+                                         reader_->list_journals(keys);
+                                         keys.emplace_back(io_device_->get_home()->uid, doorbell::MAILBOX);
+                                     }, next_wakeup_time());
+            }
             return true;
         }
 
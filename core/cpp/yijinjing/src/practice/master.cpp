@@ -246,6 +246,20 @@ namespace kungfu
                   }
               });
 
+            events_ | is(msg::type::Channel) |
+            $([&](event_ptr e)
+              {
+                  // an app announces one more public journal of its own
+                  const msg::data::Channel &channel = e->data<msg::data::Channel>();
+                  if (channel.source_id == e->source() and not has_location(channel.dest_id))
+                  {
+                      register_channel(e->gen_time(), channel);
+                  } else
+                  {
+                      SPDLOG_ERROR("Invalid public channel from {:08x} to {:08x}", channel.source_id, channel.dest_id);
+                  }
+              });
+
             events_ | is(msg::type::RequestReadFromPublic) |
             $([&](event_ptr e)
               {
@@ -0,0 +1,282 @@
+/**
+ * This is source code modified under the Apache License 2.0.
+ * Original Author: Keren Dong
+ * Modifier: kx@godzilla.dev
+ * Modification date: March 3, 2025
+ */
+
+#include <algorithm>
+#include <fmt/format.h>
+
+#include <kungfu/yijinjing/common.h>
+#include <kungfu/practice/timer_wheel.h>
+
+namespace kungfu
+{
+    namespace practice
+    {
+        constexpr int32_t timer_wheel::NIL;
+        constexpr int32_t timer_wheel::DUE;
+        constexpr int32_t timer_wheel::FIRING;
+        constexpr int32_t timer_wheel::RUNNING;
+        constexpr int32_t timer_wheel::CANCELLED;
+        constexpr int32_t timer_wheel::FREE;
+
+        constexpr int64_t SLOT_MASK = timer_wheel::SLOTS - 1;
+
+        timer_wheel::timer_wheel(int64_t tick, int64_t start_time) : tick_(tick), current_tick_(start_time / tick), size_(0)
+        {
+            if (tick_ <= 0)
+            {
+                throw yijinjing::yijinjing_error(fmt::format("invalid timer tick {}", tick));
+            }
+            std::fill(std::begin(heads_), std::end(heads_), NIL);
+            std::fill(std::begin(pending_), std::end(pending_), 0);
+        }
+
+        timer_handle timer_wheel::schedule(int64_t deadline, int64_t interval, callback cb)
+        {
+            int32_t index;
+            if (free_.empty())
+            {
+                index = static_cast<int32_t>(entries_.size());
+                entries_.emplace_back();
+                entries_[index].generation = 1;
+            } else
+            {
+                index = free_.back();
+                free_.pop_back();
+            }
+            entry &e = entries_[index];
+            e.deadline = deadline;
+            e.interval = interval;
+            e.expire_tick = deadline / tick_ + (deadline % tick_ > 0 ? 1 : 0);
+            e.cb = std::move(cb);
+            link(index);
+            size_++;
+            return static_cast<timer_handle>(e.generation) << 32 | static_cast<uint32_t>(index + 1);
+        }
+
+        bool timer_wheel::cancel(timer_handle handle)
+        {
+            auto index = static_cast<int32_t>(handle & 0xFFFFFFFF) - 1;
+            auto generation = static_cast<uint32_t>(handle >> 32);
+            if (index < 0 or index >= static_cast<int32_t>(entries_.size()))
+            {
+                return false;
+            }
+            entry &e = entries_[index];
+            if (e.generation != generation or e.list == FREE or e.list == CANCELLED)
+            {
+                return false;
+            }
+            if (e.list == RUNNING)
+            {
+                // cancelled by its own callback, released once the callback returns
+                e.list = CANCELLED;
+                return true;
+            }
+            unlink(index);
+            release(index);
+            return true;
+        }
+
+        int timer_wheel::advance(int64_t now)
+        {
+            int64_t target = now / tick_;
+            int fired = fire_list(DUE, now);
+            while (current_tick_ < target)
+            {
+                if (size_ == 0)
+                {
+                    current_tick_ = target;
+                    break;
+                }
+                if (pending_[0] == 0)
+                {
+                    // nothing on the lowest level, jump to the tick before next cascade
+                    current_tick_ = std::min(target - 1, current_tick_ | SLOT_MASK);
+                }
+                current_tick_++;
+                if ((current_tick_ & SLOT_MASK) == 0)
+                {
+                    cascade(1);
+                }
+                fired += fire_list(static_cast<int32_t>(current_tick_ & SLOT_MASK), now);
+                fired += fire_list(DUE, now);
+            }
+            return fired;
+        }
+
+        int64_t timer_wheel::next_deadline() const
+        {
+            if (heads_[DUE] != NIL)
+            {
+                return current_tick_ * tick_;
+            }
+            int64_t next_tick = INT64_MAX;
+            if (pending_[0] > 0)
+            {
+                for (int64_t t = current_tick_ + 1; t <= current_tick_ + SLOTS; t++)
+                {
+                    if (heads_[t & SLOT_MASK] != NIL)
+                    {
+                        next_tick = t;
+                        break;
+                    }
+                }
+            }
+            for (int level = 1; level < LEVELS; level++)
+            {
+                if (pending_[level] > 0)
+                {
+                    // higher levels have work to do only when they cascade
+                    int shift = level * LEVEL_BITS;
+                    next_tick = std::min(next_tick, ((current_tick_ >> shift) + 1) << shift);
+                    break;
+                }
+            }
+            return next_tick == INT64_MAX ? INT64_MAX : next_tick * tick_;
+        }
+
+        void timer_wheel::link(int32_t index)
+        {
+            int64_t diff = entries_[index].expire_tick - current_tick_;
+            int64_t expire_tick = entries_[index].expire_tick;
+            if (diff <= 0)
+            {
+                link_to(index, DUE);
+                return;
+            }
+            for (int level = 0; level < LEVELS; level++)
+            {
+                int shift = (level + 1) * LEVEL_BITS;
+                if (diff < (int64_t(1) << shift))
+                {
+                    link_to(index, level * SLOTS + static_cast<int32_t>((expire_tick >> (level * LEVEL_BITS)) & SLOT_MASK));
+                    return;
+                }
+            }
+            // beyond range of the wheel, park in the top level slot visited last and re-link when it cascades
+            int shift = (LEVELS - 1) * LEVEL_BITS;
+            link_to(index, (LEVELS - 1) * SLOTS + static_cast<int32_t>(((current_tick_ >> shift) - 1) & SLOT_MASK));
+        }
+
+        void timer_wheel::link_to(int32_t index, int32_t list)
+        {
+            entry &e = entries_[index];
+            e.list = list;
+            e.prev = NIL;
+            e.next = heads_[list];
+            if (e.next != NIL)
+            {
+                entries_[e.next].prev = index;
+            }
+            heads_[list] = index;
+            if (list < DUE)
+            {
+                pending_[list / SLOTS]++;
+            }
+        }
+
+        void timer_wheel::unlink(int32_t index)
+        {
+            entry &e = entries_[index];
+            if (e.prev != NIL)
+            {
+                entries_[e.prev].next = e.next;
+            } else
+            {
+                heads_[e.list] = e.next;
+            }
+            if (e.next != NIL)
+            {
+                entries_[e.next].prev = e.prev;
+            }
+            if (e.list < DUE)
+            {
+                pending_[e.list / SLOTS]--;
+            }
+            e.prev = e.next = NIL;
+        }
+
+        void timer_wheel::release(int32_t index)
+        {
+            entry &e = entries_[index];
+            e.cb = nullptr;
+            e.list = FREE;
+            e.generation++;
+            free_.push_back(index);
+            size_--;
+        }
+
+        void timer_wheel::cascade(int level)
+        {
+            if (level >= LEVELS)
+            {
+                return;
+            }
+            int64_t slot = (current_tick_ >> (level * LEVEL_BITS)) & SLOT_MASK;
+            if (slot == 0)
+            {
+                // higher level wraps too, bring its timers down first
+                cascade(level + 1);
+            }
+            int32_t list = level * SLOTS + static_cast<int32_t>(slot);
+            while (heads_[list] != NIL)
+            {
+                int32_t index = heads_[list];
+                unlink(index);
+                link(index);
+            }
+        }
+
+        int timer_wheel::fire_list(int32_t list, int64_t now)
+        {
+            if (heads_[list] == NIL)
+            {
+                return 0;
+            }
+            // move to a list of its own, so that timers scheduled by callbacks are not fired in the same pass
+            while (heads_[list] != NIL)
+            {
+                int32_t index = heads_[list];
+                unlink(index);
+                link_to(index, FIRING);
+            }
+            int fired = 0;
+            while (heads_[FIRING] != NIL)
+            {
+                int32_t index = heads_[FIRING];
+                unlink(index);
+                fire(index, now);
+                fired++;
+            }
+            return fired;
+        }
+
+        void timer_wheel::fire(int32_t index, int64_t now)
+        {
+            entries_[index].list = RUNNING;
+            callback cb = std::move(entries_[index].cb);
+            cb(now);
+            // entries_ may have grown in callback, take reference again
+            entry &e = entries_[index];
+            if (e.list == RUNNING and e.interval > 0)
+            {
+                e.deadline += e.interval;
+                if (e.deadline <= now)
+                {
+                    // skip missed periods instead of firing them in a burst
+                    e.deadline += ((now - e.deadline) / e.interval + 1) * e.interval;
+                }
+                e.expire_tick = e.deadline / tick_ + (e.deadline % tick_ > 0 ? 1 : 0);
+                e.cb = std::move(cb);
+                link(index);
+            } else
+            {
+                release(index);
+            }
+        }
+    }
+}
@@ -14,8 +14,14 @@
 #include <sys/fcntl.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <unistd.h>
 #endif // _WINDOWS
 
+#ifdef __linux__
+#include <sys/vfs.h>
+#include <sys/syscall.h>
+#endif // __linux__
+
 #include <regex>
 #include <spdlog/spdlog.h>
 
@@ -30,7 +36,66 @@ namespace kungfu {
 
         namespace os {
 
-            uintptr_t load_mmap_buffer(const std::string &path, size_t size, bool is_writing, bool lazy)
+#ifdef __linux__
+            constexpr long HUGETLBFS_MAGIC      = 0x958458f6;
+            constexpr int MPOL_PREFERRED_MODE   = 1;
+            constexpr unsigned long MAX_NUMA_NODES = 1024;
+
+            /**
+             * prefer allocating pages from numa node for calling thread, restores previous policy when destroyed,
+             * raw syscalls are used so that libnuma is not required
+             */
+            class numa_preference
+            {
+            public:
+                explicit numa_preference(int node) : saved_(false), mode_(0), mask_{}
+                {
+                    if (node < 0 or node >= static_cast<int>(MAX_NUMA_NODES))
+                    {
+                        return;
+                    }
+                    if (syscall(SYS_get_mempolicy, &mode_, mask_, MAX_NUMA_NODES, nullptr, 0) != 0)
+                    {
+                        SPDLOG_WARN("numa policy not supported, node {} ignored", node);
+                        return;
+                    }
+                    unsigned long node_mask[MAX_NUMA_NODES / (8 * sizeof(unsigned long))] = {};
+                    node_mask[node / (8 * sizeof(unsigned long))] = 1UL << (node % (8 * sizeof(unsigned long)));
+                    saved_ = syscall(SYS_set_mempolicy, MPOL_PREFERRED_MODE, node_mask, MAX_NUMA_NODES) == 0;
+                    if (not saved_)
+                    {
+                        SPDLOG_WARN("can not prefer numa node {}", node);
+                    }
+                }
+
+                ~numa_preference()
+                {
+                    if (saved_)
+                    {
+                        syscall(SYS_set_mempolicy, mode_, mode_ == 0 ? nullptr : mask_, MAX_NUMA_NODES);
+                    }
+                }
+
+                void bind(void *buffer, size_t size, int node)
+                {
+                    if (not saved_)
+                    {
+                        return;
+                    }
+                    // page cache of regular files follows the policy of faulting thread, vma policy is for hugetlbfs and shmem
+                    unsigned long node_mask[MAX_NUMA_NODES / (8 * sizeof(unsigned long))] = {};
+                    node_mask[node / (8 * sizeof(unsigned long))] = 1UL << (node % (8 * sizeof(unsigned long)));
+                    syscall(SYS_mbind, buffer, size, MPOL_PREFERRED_MODE, node_mask, MAX_NUMA_NODES, 0);
+                }
+
+            private:
+                bool saved_;
+                int mode_;
+                unsigned long mask_[MAX_NUMA_NODES / (8 * sizeof(unsigned long))];
+            };
+#endif // __linux__
+
+            uintptr_t load_mmap_buffer(const std::string &path, size_t size, bool is_writing, bool lazy, const mmap_options &options)
             {
 #ifdef _WINDOWS
                 bool master = is_writing || !lazy;
@@ -84,27 +149,62 @@ namespace kungfu {
                     throw journal_error("failed to open file for page " + path);
                 }
 
-                if (master)
+                bool on_hugetlbfs = false;
+#ifdef __linux__
+                struct statfs fs_stat = {};
+                if (fstatfs(fd, &fs_stat) == 0 && fs_stat.f_type == HUGETLBFS_MAGIC)
                 {
-                    if (lseek(fd, size - 1, SEEK_SET) == -1)
+                    on_hugetlbfs = true;
+                    if (size % fs_stat.f_bsize != 0)
                     {
                         close(fd);
-                        throw journal_error("failed to stretch for page " + path);
+                        throw journal_error(fmt::format("page size {} is not a multiple of huge page size {} for page {}", size, fs_stat.f_bsize, path));
                     }
-                    if (write(fd, "", 1) == -1)
+                }
+#endif // __linux__
+
+                if (master)
+                {
+                    if (on_hugetlbfs)
                     {
-                        close(fd);
-                        throw journal_error("unable to write for page " + path);
+                        // hugetlbfs does not support write, file is sized by truncate
+                        struct stat file_stat = {};
+                        if (fstat(fd, &file_stat) == 0 && static_cast<size_t>(file_stat.st_size) < size && ftruncate(fd, size) != 0)
+                        {
+                            close(fd);
+                            throw journal_error("failed to stretch for page " + path);
+                        }
+                    } else
+                    {
+                        if (lseek(fd, size - 1, SEEK_SET) == -1)
+                        {
+                            close(fd);
+                            throw journal_error("failed to stretch for page " + path);
+                        }
+                        if (write(fd, "", 1) == -1)
+                        {
+                            close(fd);
+                            throw journal_error("unable to write for page " + path);
+                        }
                     }
                 }
 
+                int flags = MAP_SHARED;
+#ifdef __linux__
+                numa_preference numa(options.numa_node);
+                if (options.populate or options.numa_node >= 0)
+                {
+                    flags |= MAP_POPULATE;
+                }
+#endif // __linux__
+
                 /**
                  * MAP_FIXED is dup2 for memory mappings, and it's useful in exactly the same situations where dup2 is useful for file descriptors:
                  * when you want to perform a replace operation that atomically reassigns a resource identifier (memory range in the case of MAP_FIXED,
                  * or fd in the case of dup2) to refer to a new resource without the possibility of races where it might get reassigned to something
                  * else if you first released the old resource then attempted to regain it for the new resource.
                  */
-                void *buffer = mmap(0, size, master ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd, 0);
+                void *buffer = mmap(0, size, master ? (PROT_READ | PROT_WRITE) : PROT_READ, flags, fd, 0);
 
                 if (buffer == MAP_FAILED)
                 {
@@ -112,6 +212,14 @@ namespace kungfu {
                     throw journal_error("Error mapping file to buffer");
                 }
 
+#ifdef __linux__
+                numa.bind(buffer, size, options.numa_node);
+                if (options.huge_pages && !on_hugetlbfs && madvise(buffer, size, MADV_HUGEPAGE) != 0)
+                {
+                    SPDLOG_DEBUG("transparent huge pages not available for {}", path);
+                }
+#endif // __linux__
+
                 if (!lazy && madvise(buffer, size, MADV_RANDOM) != 0 && mlock(buffer, size) != 0)
                 {
                     munmap(buffer, size);
@@ -147,6 +255,58 @@ namespace kungfu {
                 return true;
             }
 
+            uintptr_t load_anonymous_buffer(size_t size)
+            {
+#ifdef _WINDOWS
+                HANDLE fileMappingObject = CreateFileMapping(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                                                             static_cast<DWORD>(static_cast<uint64_t>(size) >> 32), static_cast<DWORD>(size), NULL);
+                if (fileMappingObject == NULL)
+                {
+                    throw journal_error("unable to map anonymous buffer of size " + std::to_string(size));
+                }
+                void *buffer = MapViewOfFile(fileMappingObject, FILE_MAP_ALL_ACCESS, 0, 0, size);
+                CloseHandle(fileMappingObject);
+                if (buffer == nullptr)
+                {
+                    throw journal_error("unable to map anonymous buffer of size " + std::to_string(size));
+                }
+#else
+                void *buffer = mmap(0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (buffer == MAP_FAILED)
+                {
+                    throw journal_error("unable to map anonymous buffer of size " + std::to_string(size));
+                }
+#endif // _WINDOWS
+                return reinterpret_cast<uintptr_t>(buffer);
+            }
+
+            bool release_page_cache(const std::string &path)
+            {
+#ifdef __linux__
+                int fd = open(path.c_str(), O_RDWR);
+                if (fd < 0)
+                {
+                    return false;
+                }
+                // dirty pages are not dropped, write them back first
+                bool released = fdatasync(fd) == 0 && posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+                close(fd);
+                return released;
+#else
+                return false;
+#endif // __linux__
+            }
+
+            bool is_hugetlbfs(const std::string &path)
+            {
+#ifdef __linux__
+                struct statfs fs_stat = {};
+                return statfs(path.c_str(), &fs_stat) == 0 && fs_stat.f_type == HUGETLBFS_MAGIC;
+#else
+                return false;
+#endif // __linux__
+            }
+
         }
     }
 }
@@ -0,0 +1,189 @@
+/**
+ * This is source code modified under the Apache License 2.0.
+ * Original Author: Keren Dong
+ * Modifier: kx@godzilla.dev
+ * Modification date: March 3, 2025
+ */
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <cstring>
+#endif // __linux__
+
+#include <kungfu/yijinjing/util/os.h>
+
+namespace kungfu
+{
+    namespace yijinjing
+    {
+        namespace os
+        {
+            const char *get_thread_role_name(thread_role role)
+            {
+                switch (role)
+                {
+                    case thread_role::EVENT_LOOP:
+                        return "kf-loop";
+                    case thread_role::IO:
+                        return "kf-io";
+                    case thread_role::LOG:
+                        return "kf-log";
+                    default:
+                        return "kf-unknown";
+                }
+            }
+
+            std::vector<int> parse_cpu_list(const std::string &cpu_list)
+            {
+                std::vector<int> cpus;
+                std::stringstream ss(cpu_list);
+                std::string range;
+                while (std::getline(ss, range, ','))
+                {
+                    range.erase(std::remove_if(range.begin(), range.end(), ::isspace), range.end());
+                    if (range.empty())
+                    {
+                        continue;
+                    }
+                    auto dash = range.find('-');
+                    int first = std::stoi(range.substr(0, dash));
+                    int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+                    for (int cpu = first; cpu <= last; cpu++)
+                    {
+                        cpus.push_back(cpu);
+                    }
+                }
+                return cpus;
+            }
+
+            inline static std::string read_line(const std::string &path)
+            {
+                std::string line;
+                std::ifstream file(path);
+                std::getline(file, line);
+                return line;
+            }
+
+            std::vector<int> get_isolated_cpus()
+            {
+#ifdef __linux__
+                return parse_cpu_list(read_line("/sys/devices/system/cpu/isolated"));
+#else
+                return {};
+#endif // __linux__
+            }
+
+            int get_numa_node(int cpu)
+            {
+#ifdef __linux__
+                for (int node : parse_cpu_list(read_line("/sys/devices/system/node/online")))
+                {
+                    auto cpus = parse_cpu_list(read_line(fmt::format("/sys/devices/system/node/node{}/cpulist", node)));
+                    if (std::find(cpus.begin(), cpus.end(), cpu) != cpus.end())
+                    {
+                        return node;
+                    }
+                }
+#endif // __linux__
+                return -1;
+            }
+
+            bool place_thread(thread_role role, const std::vector<int> &cpus, int priority)
+            {
+                bool placed = true;
+#ifdef __linux__
+                const char *name = get_thread_role_name(role);
+                if (getpid() != static_cast<pid_t>(syscall(SYS_gettid)))
+                {
+                    // renaming main thread would rename the process
+                    pthread_setname_np(pthread_self(), name);
+                }
+                if (not cpus.empty())
+                {
+                    cpu_set_t cpu_set;
+                    CPU_ZERO(&cpu_set);
+                    for (int cpu : cpus)
+                    {
+                        CPU_SET(cpu, &cpu_set);
+                    }
+                    int rc = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+                    if (rc != 0)
+                    {
+                        SPDLOG_WARN("can not pin {} to cpus {}: {}", name, fmt::join(cpus, ","), strerror(rc));
+                        placed = false;
+                    }
+                    auto isolated = get_isolated_cpus();
+                    for (int cpu : cpus)
+                    {
+                        if (not isolated.empty() and std::find(isolated.begin(), isolated.end(), cpu) == isolated.end())
+                        {
+                            SPDLOG_WARN("{} pinned to cpu {} which is not isolated, isolated cpus are {}", name, cpu, fmt::join(isolated, ","));
+                        }
+                    }
+                    int node = get_numa_node(cpus.front());
+                    for (int cpu : cpus)
+                    {
+                        if (get_numa_node(cpu) != node)
+                        {
+                            SPDLOG_WARN("{} pinned to cpus {} across numa nodes", name, fmt::join(cpus, ","));
+                            break;
+                        }
+                    }
+                    SPDLOG_INFO("{} pinned to cpus {} on numa node {}", name, fmt::join(cpus, ","), node);
+                }
+                if (priority > 0)
+                {
+                    sched_param param = {};
+                    param.sched_priority = std::min(priority, sched_get_priority_max(SCHED_FIFO));
+                    int rc = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+                    if (rc != 0)
+                    {
+                        // needs CAP_SYS_NICE or rtprio in limits.conf
+                        SPDLOG_WARN("can not run {} as SCHED_FIFO {}: {}", name, param.sched_priority, strerror(rc));
+                        placed = false;
+                    } else
+                    {
+                        SPDLOG_INFO("{} runs as SCHED_FIFO {}", name, param.sched_priority);
+                    }
+                }
+#else
+                if (not cpus.empty() or priority > 0)
+                {
+                    SPDLOG_WARN("thread placement only supported on linux, {} left as is", get_thread_role_name(role));
+                    placed = false;
+                }
+#endif // __linux__
+                return placed;
+            }
+
+            void spawn_placed(thread_role role, const std::vector<int> &cpus, const std::function<void()> &spawn)
+            {
+#ifdef __linux__
+                // new threads copy name and affinity of the creating thread
+                char name[16] = {};
+                pthread_getname_np(pthread_self(), name, sizeof(name));
+                cpu_set_t cpu_set;
+                bool saved = pthread_getaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) == 0;
+                place_thread(role, cpus);
+                pthread_setname_np(pthread_self(), get_thread_role_name(role));
+                spawn();
+                pthread_setname_np(pthread_self(), name);
+                if (saved and not cpus.empty())
+                {
+                    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+                }
+#else
+                spawn();
+#endif // __linux__
+            }
+        }
+    }
+}
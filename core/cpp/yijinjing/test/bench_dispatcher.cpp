@@ -0,0 +1,106 @@
+/**
+ * This is source code under the Apache License 2.0.
+ * Original Author: kx@godzilla.dev
+ * Original date: March 3, 2025
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include <kungfu/yijinjing/msg.h>
+#include <kungfu/practice/dispatcher.h>
+
+#include "temp_home.h"
+
+using namespace kungfu::yijinjing;
+using namespace kungfu::practice;
+
+/** wingchun msg types, yijinjing does not know them */
+enum bench_type : int32_t
+{
+    Depth = 101,
+    Order = 203,
+    MyTrade = 204,
+    Position = 205
+};
+
+/** handlers BookContext registers for a book */
+static std::vector<handler_id> add_book(dispatcher &d, uint32_t uid, int64_t &sink)
+{
+    return {d.on(msg::type::Channel, [&](const event_ptr &e)
+            { sink += e->source(); }),
+            d.on(Depth, [&](const event_ptr &e)
+            { sink++; }),
+            d.on_to(Order, uid, [&](const event_ptr &e)
+            { sink += e->dest(); }),
+            d.on_to(MyTrade, uid, [&](const event_ptr &e)
+            { sink += e->dest(); }),
+            d.on(Position, [&](const event_ptr &e)
+            { sink++; })};
+}
+
+/**
+ * dispatches a replay of 90% depth and orders/trades spread over N books, as an apprentice with BookContext does, for
+ * N = 1, 10, 100, then pops and adds every book back many times and dispatches again, cost per event should not change
+ * usage: yijinjing_bench_dispatcher [events, default 20000] [replays, default 10] [book churn rounds, default 1000]
+ */
+int main(int argc, char **argv)
+{
+    const size_t events = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+    const int replays = argc > 2 ? std::atoi(argv[2]) : 10;
+    const int churn = argc > 3 ? std::atoi(argv[3]) : 1000;
+    printf("%8s %14s %14s\n", "books", "ns/event", "after churn");
+
+    for (uint32_t books : {1u, 10u, 100u})
+    {
+        std::mt19937 rng(books);
+        std::vector<event_ptr> replay;
+        for (size_t i = 0; i < events; i++)
+        {
+            uint32_t book = 1000 + rng() % books;
+            int32_t type = rng() % 10 < 9 ? Depth : (rng() % 2 ? Order : MyTrade);
+            replay.push_back(std::make_shared<test::stub_event>(type, 1, book));
+        }
+
+        dispatcher d;
+        int64_t sink = 0;
+        std::vector<std::vector<handler_id>> handlers;
+        for (uint32_t b = 0; b < books; b++)
+        {
+            handlers.push_back(add_book(d, 1000 + b, sink));
+        }
+        auto run = [&]()
+        {
+            auto start = std::chrono::steady_clock::now();
+            for (int r = 0; r < replays; r++)
+            {
+                for (const auto &event : replay)
+                {
+                    d.dispatch(event);
+                }
+            }
+            return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (events * replays);
+        };
+        double before = run();
+        for (int round = 0; round < churn; round++)
+        {
+            uint32_t b = round % books;
+            for (auto id : handlers[b])
+            {
+                d.off(id);
+            }
+            handlers[b] = add_book(d, 1000 + b, sink);
+        }
+        double after = run();
+        printf("%8u %14.0f %14.0f\n", books, before, after);
+        if (sink == 0)
+        {
+            fprintf(stderr, "nothing dispatched\n");
+            return 1;
+        }
+    }
+    return 0;
+}
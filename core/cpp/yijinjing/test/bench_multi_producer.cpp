@@ -0,0 +1,79 @@
+/**
+ * This is source code under the Apache License 2.0.
+ * Original Author: kx@godzilla.dev
+ * Original date: March 3, 2025
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <spdlog/spdlog.h>
+
+#include <kungfu/yijinjing/journal/journal.h>
+
+#include "temp_home.h"
+
+using namespace kungfu::yijinjing;
+
+/** depth sized payload */
+struct payload
+{
+    char bytes[400];
+};
+
+/**
+ * total frames/sec of 1, 2, 4, 8 threads writing to one journal, through a multi producer writer and, for comparison,
+ * through a single producer one behind a mutex, locked writers give up after 1 ms of contention and would not finish
+ * usage: yijinjing_bench_multi_producer [frames per thread, default 200000]
+ */
+int main(int argc, char **argv)
+{
+    spdlog::set_level(spdlog::level::warn);
+    const size_t per_thread = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+    auto locator = std::make_shared<test::temp_locator>();
+    auto publisher = std::make_shared<test::null_publisher>();
+    printf("%8s %16s %16s\n", "threads", "multi producer", "mutex");
+
+    for (size_t n = 1; n <= 8; n *= 2)
+    {
+        double rates[2] = {};
+        journal::writer_mode modes[2] = {journal::writer_mode::MULTI_PRODUCER, journal::writer_mode::SINGLE_PRODUCER};
+        for (int m = 0; m < 2; m++)
+        {
+            auto location = data::location::make(data::mode::LIVE, data::category::MD, "bench", fmt::format("{}-{}", n, m), locator);
+            journal::writer writer(location, 0, true, publisher, modes[m]);
+            std::mutex mutex;
+            payload data = {};
+            std::vector<std::thread> threads;
+            auto start = std::chrono::steady_clock::now();
+            for (size_t t = 0; t < n; t++)
+            {
+                threads.emplace_back([&]
+                                     {
+                                         for (size_t i = 0; i < per_thread; i++)
+                                         {
+                                             if (m == 0)
+                                             {
+                                                 writer.write(0, msg::type::Time, data);
+                                             } else
+                                             {
+                                                 std::lock_guard<std::mutex> lock(mutex);
+                                                 writer.write(0, msg::type::Time, data);
+                                             }
+                                         }
+                                     });
+            }
+            for (auto &thread : threads)
+            {
+                thread.join();
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            rates[m] = n * per_thread / seconds;
+        }
+        printf("%8zu %16.0f %16.0f\n", n, rates[0], rates[1]);
+    }
+    return 0;
+}
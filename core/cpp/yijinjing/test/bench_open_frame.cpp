@@ -0,0 +1,94 @@
+/**
+ * This is source code under the Apache License 2.0.
+ * Original Author: kx@godzilla.dev
+ * Original date: March 3, 2025
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <spdlog/spdlog.h>
+
+#include <kungfu/yijinjing/journal/journal.h>
+
+#include "temp_home.h"
+
+using namespace kungfu::yijinjing;
+
+/** depth sized payload */
+struct payload
+{
+    char bytes[400];
+};
+constexpr uint32_t FRAME_DATA_LENGTH = sizeof(payload);
+
+/**
+ * times open_frame of a writer filling small pages with depth sized frames, so that a good share of calls
+ * cross page rollover, and reports percentiles over all calls and over the ones which rolled over.
+ * flat out, pages fill faster than the helper thread prepares them and rollover waits for it,
+ * a rate closer to a live feed shows rollover once the next page is ready
+ * usage: yijinjing_bench_open_frame [page size in MB, default 16] [pages to fill, default 32] [frames/sec, default flat out]
+ */
+int main(int argc, char **argv)
+{
+    spdlog::set_level(spdlog::level::warn);
+    const uint32_t page_size = (argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 16) * MB;
+    const size_t pages = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 32;
+    const size_t frames = pages * page_size / (sizeof(journal::frame_header) + FRAME_DATA_LENGTH);
+    const double rate = argc > 3 ? std::strtod(argv[3], nullptr) : 0;
+
+    auto locator = std::make_shared<test::temp_locator>();
+    auto location = data::location::make(data::mode::LIVE, data::category::MD, "bench", "open_frame", locator);
+    data::journal_policy policy;
+    policy.page_size = page_size;
+    policy.max_pages = 4;
+    locator->set_journal_policy(location, 0, policy);
+    journal::writer writer(location, 0, true, std::make_shared<test::null_publisher>(), journal::writer_mode::SINGLE_PRODUCER);
+
+    payload data = {};
+    std::vector<int64_t> all;
+    std::vector<int64_t> rollovers;
+    all.reserve(frames);
+    uint64_t last_page = writer.current_frame_uid() >> 16;
+    auto begin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < frames; i++)
+    {
+        if (rate > 0)
+        {
+            auto due = begin + std::chrono::nanoseconds(static_cast<int64_t>(i * 1e9 / rate));
+            while (std::chrono::steady_clock::now() < due);
+        }
+        auto start = std::chrono::steady_clock::now();
+        auto frame = writer.open_frame(0, msg::type::Time, FRAME_DATA_LENGTH);
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        const_cast<payload &>(frame->data<payload>()) = data;
+        writer.close_frame(FRAME_DATA_LENGTH);
+        all.push_back(elapsed);
+        uint64_t page = writer.current_frame_uid() >> 16;
+        if (page != last_page)
+        {
+            rollovers.push_back(elapsed);
+            last_page = page;
+        }
+    }
+
+    auto report = [](const char *name, std::vector<int64_t> &values)
+    {
+        if (values.empty())
+        {
+            return;
+        }
+        std::sort(values.begin(), values.end());
+        auto at = [&](double q)
+        { return values[std::min(values.size() - 1, static_cast<size_t>(q * values.size()))]; };
+        printf("%-10s %10zu %8ld %8ld %8ld %8ld %10ld\n", name, values.size(), at(0.5), at(0.99), at(0.999), at(0.9999), values.back());
+    };
+    printf("open_frame ns, %u MB pages, %u byte frames, %s\n", page_size / MB, FRAME_DATA_LENGTH,
+           rate > 0 ? fmt::format("{:.0f} frames/sec", rate).c_str() : "flat out");
+    printf("%-10s %10s %8s %8s %8s %8s %10s\n", "", "count", "p50", "p99", "p999", "p9999", "max");
+    report("all", all);
+    report("rollover", rollovers);
+    return 0;
+}
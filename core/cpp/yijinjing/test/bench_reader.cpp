@@ -0,0 +1,75 @@
+/**
+ * This is source code under the Apache License 2.0.
+ * Original Author: kx@godzilla.dev
+ * Original date: March 3, 2025
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <spdlog/spdlog.h>
+
+#include <kungfu/yijinjing/journal/journal.h>
+
+#include "temp_home.h"
+
+using namespace kungfu::yijinjing;
+
+/**
+ * replays frames spread round robin over N journals through one reader, as ledger does with its channels,
+ * and reports frames/sec for N = 1, 2, 4 .. 256
+ * usage: yijinjing_bench_reader [total frames, default 200000]
+ */
+int main(int argc, char **argv)
+{
+    spdlog::set_level(spdlog::level::warn);
+    const size_t total = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+    auto locator = std::make_shared<test::temp_locator>();
+    auto publisher = std::make_shared<test::null_publisher>();
+    printf("%8s %12s %14s\n", "journals", "frames", "frames/sec");
+
+    for (size_t n = 1; n <= 256; n *= 2)
+    {
+        std::vector<data::location_ptr> locations;
+        std::vector<journal::writer_ptr> writers;
+        for (size_t i = 0; i < n; i++)
+        {
+            auto location = data::location::make(data::mode::LIVE, data::category::STRATEGY, "bench", fmt::format("{}-{}", n, i), locator);
+            locations.push_back(location);
+            writers.push_back(std::make_shared<journal::writer>(location, 0, true, publisher, journal::writer_mode::SINGLE_PRODUCER));
+        }
+        for (size_t i = 0; i < total; i++)
+        {
+            writers[i % n]->write(0, msg::type::Time, static_cast<int64_t>(i));
+        }
+        writers.clear();
+
+        journal::reader reader(true);
+        for (const auto &location : locations)
+        {
+            reader.join(location, 0, 0);
+        }
+        auto start = std::chrono::steady_clock::now();
+        size_t count = 0;
+        int64_t sum = 0;
+        while (reader.data_available())
+        {
+            auto frame = reader.current_frame();
+            if (frame->msg_type() == msg::type::Time)
+            {
+                sum += frame->data<int64_t>();
+                count++;
+            }
+            reader.next();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (count != total or sum != static_cast<int64_t>(total * (total - 1) / 2))
+        {
+            fprintf(stderr, "read %zu of %zu frames\n", count, total);
+            return 1;
+        }
+        printf("%8zu %12zu %14.0f\n", n, count, count / seconds);
+    }
+    return 0;
+}
@@ -0,0 +1,159 @@
+/**
+ * This is source code under the Apache License 2.0.
+ * Original Author: kx@godzilla.dev
+ * Original date: March 3, 2025
+ */
+
+#ifndef YIJINJING_TEST_TEMP_HOME_H
+#define YIJINJING_TEST_TEMP_HOME_H
+
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <regex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <kungfu/yijinjing/common.h>
+
+namespace kungfu
+{
+    namespace yijinjing
+    {
+        namespace test
+        {
+            /**
+             * locator laid out as the python one, under a fresh directory which is removed with the locator,
+             * journal policy of a location/dest can be set for tests which need small pages
+             */
+            class temp_locator : public data::locator
+            {
+            public:
+                temp_locator()
+                {
+                    std::string pattern = (std::filesystem::temp_directory_path() / "yijinjing-XXXXXX").string();
+                    home_ = mkdtemp(pattern.data());
+                }
+
+                ~temp_locator() override
+                {
+                    std::error_code ec;
+                    std::filesystem::remove_all(home_, ec);
+                }
+
+                const std::string &get_home() const
+                { return home_; }
+
+                void set_journal_policy(const data::location_ptr &location, uint32_t dest_id, const data::journal_policy &policy)
+                { policies_[{location->uid, dest_id}] = policy; }
+
+                bool has_env(const std::string &name) const override
+                { return std::getenv(name.c_str()) != nullptr; }
+
+                const std::string get_env(const std::string &name) const override
+                {
+                    auto value = std::getenv(name.c_str());
+                    return value == nullptr ? "" : value;
+                }
+
+                const std::string layout_dir(data::location_ptr location, data::layout l) const override
+                {
+                    auto dir = std::filesystem::path(home_) / data::get_category_name(location->category) / location->group /
+                               location->name / data::get_layout_name(l) / data::get_mode_name(location->mode);
+                    std::filesystem::create_directories(dir);
+                    return dir.string();
+                }
+
+                const std::string layout_file(data::location_ptr location, data::layout l, const std::string &name) const override
+                { return layout_dir(location, l) + "/" + name + "." + data::get_layout_name(l); }
+
+                const std::string default_to_system_db(data::location_ptr location, const std::string &name) const override
+                { return layout_file(location, data::layout::SQLITE, name); }
+
+                const std::vector<int> list_page_id(data::location_ptr location, uint32_t dest_id) const override
+                {
+                    std::regex pattern(fmt::format("{:08x}\\.(\\d+)\\.(journal|archive)", dest_id));
+                    std::set<int> page_ids;
+                    for (const auto &entry : std::filesystem::directory_iterator(layout_dir(location, data::layout::JOURNAL)))
+                    {
+                        std::smatch match;
+                        auto name = entry.path().filename().string();
+                        if (std::regex_match(name, match, pattern))
+                        {
+                            page_ids.insert(std::stoi(match[1].str()));
+                        }
+                    }
+                    return std::vector<int>(page_ids.begin(), page_ids.end());
+                }
+
+                data::journal_policy get_journal_policy(data::location_ptr location, uint32_t dest_id) const override
+                {
+                    auto it = policies_.find({location->uid, dest_id});
+                    return it == policies_.end() ? data::journal_policy{} : it->second;
+                }
+
+            private:
+                std::string home_;
+                std::map<std::pair<uint32_t, uint32_t>, data::journal_policy> policies_;
+            };
+
+            /** event with header fields only, for code which does not read data */
+            class stub_event : public event
+            {
+            public:
+                stub_event(int32_t msg_type, uint32_t source, uint32_t dest) : msg_type_(msg_type), source_(source), dest_(dest)
+                {}
+
+                int64_t gen_time() const override
+                { return 0; }
+
+                int64_t trigger_time() const override
+                { return 0; }
+
+                int32_t msg_type() const override
+                { return msg_type_; }
+
+                uint32_t source() const override
+                { return source_; }
+
+                uint32_t dest() const override
+                { return dest_; }
+
+                uint32_t data_length() const override
+                { return 0; }
+
+                const char *data_as_bytes() const override
+                { return nullptr; }
+
+                const std::string data_as_string() const override
+                { return ""; }
+
+                const std::string to_string() const override
+                { return ""; }
+
+            protected:
+                const void *data_address() const override
+                { return nullptr; }
+
+            private:
+                const int32_t msg_type_;
+                const uint32_t source_;
+                const uint32_t dest_;
+            };
+
+            /** writers of tests have nobody to notify */
+            class null_publisher : public publisher
+            {
+            public:
+                int notify() override
+                { return 0; }
+
+                int publish(const std::string &json_message) override
+                { return 0; }
+            };
+        }
+    }
+}
+
+#endif //YIJINJING_TEST_TEMP_HOME_H
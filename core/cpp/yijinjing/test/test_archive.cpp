@@ -0,0 +1,131 @@
+/**
+ * This is source code under the Apache License 2.0.
+ * Original Author: kx@godzilla.dev
+ * Original date: March 3, 2025
+ */
+
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <vector>
+#include <gtest/gtest.h>
+#include <spdlog/spdlog.h>
+
+#include <kungfu/yijinjing/journal/journal.h>
+#include <kungfu/yijinjing/journal/archive.h>
+
+#include "temp_home.h"
+
+using namespace kungfu::yijinjing;
+
+namespace
+{
+    constexpr int32_t QUOTE = 900;
+    constexpr int32_t PLAIN = 901;
+
+    struct quote
+    {
+        char symbol[32];
+        char exchange_id[16];
+        int32_t level_count;
+        double price[10];
+        double volume[10];
+        int64_t data_time;
+    };
+
+    quote make_quote(int i)
+    {
+        quote q = {};
+        snprintf(q.symbol, sizeof(q.symbol), "symbol-%d", i % 7);
+        strcpy(q.exchange_id, "binance");
+        q.level_count = 10;
+        for (int level = 0; level < 10; level++)
+        {
+            q.price[level] = 100.0 + (i % 7) + level * 0.01 + (i / 100) * 0.1;
+            q.volume[level] = level == 9 ? 1.0 / (i + 3) : (i * 7 + level) % 13 * 0.5;
+        }
+        q.data_time = 1000000000LL * i;
+        return q;
+    }
+
+    /** fill page 1 of a journal with quotes and plain frames, the last one written opens page 2 */
+    int write_closed_page(const data::location_ptr &location)
+    {
+        int written;
+        journal::writer writer(location, 0, true, std::make_shared<test::null_publisher>(), journal::writer_mode::SINGLE_PRODUCER);
+        for (written = 0; (writer.current_frame_uid() >> 16 & 0xFFFF) == 1; written++)
+        {
+            if (written % 10 == 9)
+            {
+                writer.write(0, PLAIN, static_cast<int64_t>(written));
+            } else
+            {
+                writer.write(0, QUOTE, make_quote(written));
+            }
+        }
+        return written;
+    }
+
+    void expect_frame(const journal::frame_ptr &frame, int i)
+    {
+        if (i % 10 == 9)
+        {
+            ASSERT_EQ(frame->msg_type(), PLAIN);
+            EXPECT_EQ(frame->data<int64_t>(), i);
+        } else
+        {
+            ASSERT_EQ(frame->msg_type(), QUOTE);
+            auto expected = make_quote(i);
+            EXPECT_EQ(memcmp(&frame->data<quote>(), &expected, sizeof(quote)), 0) << "quote " << i;
+        }
+    }
+}
+
+TEST(archive, restores_frames_and_seeks_by_block)
+{
+    spdlog::set_level(spdlog::level::warn);
+    journal::archive::register_layout({QUOTE, sizeof(quote), {
+            {offsetof(quote, symbol), sizeof(quote::symbol), journal::archive_field_kind::DICTIONARY},
+            {offsetof(quote, exchange_id), sizeof(quote::exchange_id), journal::archive_field_kind::DICTIONARY},
+            {offsetof(quote, price), sizeof(quote::price), journal::archive_field_kind::DECIMAL},
+            {offsetof(quote, volume), sizeof(quote::volume), journal::archive_field_kind::DECIMAL},
+            {offsetof(quote, data_time), sizeof(quote::data_time), journal::archive_field_kind::DELTA}}});
+
+    auto locator = std::make_shared<test::temp_locator>();
+    auto location = data::location::make(data::mode::LIVE, data::category::MD, "test", "archive", locator);
+    data::journal_policy policy;
+    // more than one archive block per page
+    policy.page_size = 16 * MB;
+    locator->set_journal_policy(location, 0, policy);
+    int written = write_closed_page(location);
+
+    auto stats = journal::archive::compact(location, 0, 1, true);
+    EXPECT_LT(stats.archive_bytes * 10, stats.frame_bytes);
+    ASSERT_FALSE(std::ifstream(journal::page::get_page_path(location, 0, 1)).good());
+
+    std::vector<int64_t> gen_times;
+    {
+        journal::reader reader(true);
+        reader.join(location, 0, 0);
+        for (int i = 0; i < written - 1; i++)
+        {
+            ASSERT_TRUE(reader.data_available());
+            auto frame = reader.current_frame();
+            expect_frame(frame, i);
+            gen_times.push_back(frame->gen_time());
+            reader.next();
+        }
+    }
+
+    // joining in the last block decodes it only, the frames are the same
+    auto page = journal::page::load(location, 0, 1, false, true, gen_times[gen_times.size() - 100]);
+    EXPECT_GT(page->begin_time(), gen_times.front());
+    journal::reader reader(true);
+    reader.join(location, 0, gen_times[gen_times.size() - 100]);
+    for (size_t i = gen_times.size() - 99; i < gen_times.size(); i++)
+    {
+        ASSERT_TRUE(reader.data_available());
+        expect_frame(reader.current_frame(), i);
+        reader.next();
+    }
+}
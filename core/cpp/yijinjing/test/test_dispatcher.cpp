@@ -0,0 +1,86 @@
+/**
+ * This is source code under the Apache License 2.0.
+ * Original Author: kx@godzilla.dev
+ * Original date: March 3, 2025
+ */
+
+#include <vector>
+#include <gtest/gtest.h>
+
+#include <kungfu/practice/dispatcher.h>
+
+#include "temp_home.h"
+
+using namespace kungfu::yijinjing;
+using namespace kungfu::practice;
+
+TEST(dispatcher, order_kept_when_handlers_are_turned_off)
+{
+    dispatcher d;
+    std::vector<int> calls;
+    std::vector<handler_id> ids;
+    for (int i = 0; i < 6; i++)
+    {
+        ids.push_back(d.on_to(1, 7, [&, i](const event_ptr &)
+        { calls.push_back(i); }));
+    }
+    EXPECT_TRUE(d.off(ids[1]));
+    EXPECT_TRUE(d.off(ids[4]));
+    EXPECT_FALSE(d.off(ids[4]));
+    d.dispatch(std::make_shared<test::stub_event>(1, 0, 7));
+    EXPECT_EQ(calls, std::vector<int>({0, 2, 3, 5}));
+
+    // handlers moved down by the ones turned off can still be turned off themselves
+    EXPECT_TRUE(d.off(ids[5]));
+    EXPECT_TRUE(d.off(ids[2]));
+    calls.clear();
+    d.dispatch(std::make_shared<test::stub_event>(1, 0, 7));
+    EXPECT_EQ(calls, std::vector<int>({0, 3}));
+}
+
+TEST(dispatcher, turned_off_while_dispatching)
+{
+    dispatcher d;
+    std::vector<int> calls;
+    handler_id self = 0;
+    handler_id later = 0;
+    self = d.on(1, [&](const event_ptr &)
+    {
+        calls.push_back(0);
+        d.off(self);
+        d.off(later);
+        // not called for the current event
+        d.on(1, [&](const event_ptr &)
+        { calls.push_back(2); });
+    });
+    later = d.on(1, [&](const event_ptr &)
+    { calls.push_back(1); });
+    auto event = std::make_shared<test::stub_event>(1, 0, 0);
+    d.dispatch(event);
+    d.dispatch(event);
+    EXPECT_EQ(calls, std::vector<int>({0, 2}));
+}
+
+TEST(dispatcher, books_added_and_popped)
+{
+    dispatcher d;
+    int depth = 0;
+    int orders = 0;
+    d.on(2, [&](const event_ptr &)
+    { depth++; });
+    for (uint32_t round = 0; round < 1000; round++)
+    {
+        uint32_t book = 100 + round % 10;
+        auto order = d.on_to(3, book, [&](const event_ptr &)
+        { orders++; });
+        auto trade = d.on_from(4, book, [&](const event_ptr &)
+        {});
+        d.dispatch(std::make_shared<test::stub_event>(3, 0, book));
+        d.dispatch(std::make_shared<test::stub_event>(2, 0, book));
+        EXPECT_TRUE(d.off(order));
+        EXPECT_TRUE(d.off(trade));
+        d.dispatch(std::make_shared<test::stub_event>(3, 0, book));
+    }
+    EXPECT_EQ(orders, 1000);
+    EXPECT_EQ(depth, 1000);
+}
@@ -0,0 +1,67 @@
+/**
+ * This is source code under the Apache License 2.0.
+ * Original Author: kx@godzilla.dev
+ * Original date: March 3, 2025
+ */
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <gtest/gtest.h>
+#include <spdlog/spdlog.h>
+
+#include <kungfu/yijinjing/time.h>
+#include <kungfu/yijinjing/journal/doorbell.h>
+
+#include "temp_home.h"
+
+using namespace kungfu::yijinjing;
+
+TEST(doorbell, ring_wakes_only_waiters_of_the_journal)
+{
+    spdlog::set_level(spdlog::level::warn);
+    auto locator = std::make_shared<test::temp_locator>();
+    auto home = data::location::make(data::mode::LIVE, data::category::STRATEGY, "test", "doorbell", locator);
+    journal::doorbell reader_bell(home);
+    journal::doorbell writer_bell(home);
+
+    std::atomic<bool> done(false);
+    bool rung = false;
+    std::thread waiter([&]()
+                       {
+                           std::vector<journal::doorbell_key> keys = {{1, 0}, {1, journal::doorbell::MAILBOX}};
+                           rung = reader_bell.park(keys, []()
+                           { return false; }, 5 * time_unit::NANOSECONDS_PER_SECOND);
+                           done = true;
+                       });
+
+    // rings of other journals leave the waiter parked
+    auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(200);
+    while (std::chrono::steady_clock::now() < until)
+    {
+        writer_bell.ring(2, 0);
+        writer_bell.ring(1, 1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_FALSE(done);
+
+    while (not done)
+    {
+        writer_bell.ring(1, journal::doorbell::MAILBOX);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    waiter.join();
+    EXPECT_TRUE(rung);
+}
+
+TEST(doorbell, park_returns_at_once_with_data)
+{
+    spdlog::set_level(spdlog::level::warn);
+    auto locator = std::make_shared<test::temp_locator>();
+    auto home = data::location::make(data::mode::LIVE, data::category::STRATEGY, "test", "doorbell_data", locator);
+    journal::doorbell bell(home);
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_TRUE(bell.park({{1, 0}}, []()
+    { return true; }, 5 * time_unit::NANOSECONDS_PER_SECOND));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+}
@@ -0,0 +1,136 @@
+/**
+ * This is source code under the Apache License 2.0.
+ * Original Author: kx@godzilla.dev
+ * Original date: March 3, 2025
+ */
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <random>
+#include <thread>
+#include <gtest/gtest.h>
+#include <spdlog/spdlog.h>
+
+#include <kungfu/yijinjing/io.h>
+#include <kungfu/practice/hero.h>
+
+#include "temp_home.h"
+
+using namespace kungfu;
+using namespace kungfu::yijinjing;
+
+namespace
+{
+    /** parks as soon as a poll finds nothing */
+    class parking_locator : public test::temp_locator
+    {
+    public:
+        data::wait_policy get_wait_policy(data::location_ptr location) const override
+        {
+            data::wait_policy policy;
+            policy.spin_count = 0;
+            policy.yield_count = 0;
+            return policy;
+        }
+    };
+
+    /** hero which answers each request on its reply socket, driven one produce_one at a time by the test */
+    class replying_hero : public practice::hero
+    {
+    public:
+        explicit replying_hero(io_device_with_reply_ptr io_device) : practice::hero(std::move(io_device))
+        {}
+
+        void react() override
+        {}
+
+        void poll()
+        {
+            wakeup_asked_ = 0;
+            produce_one(rx::make_subscriber<event_ptr>([this](event_ptr event)
+                                                       {
+                                                           get_io_device()->get_rep_sock()->send(event->to_string());
+                                                       }));
+        }
+
+        /** called once by the next poll, after it found its sockets empty and before it parks */
+        void before_park(std::function<void()> hook)
+        { before_park_ = std::move(hook); }
+
+    protected:
+        int64_t next_wakeup_time() override
+        {
+            // asked once by the observer wait, then once more on the way to park
+            if (++wakeup_asked_ == 2 and before_park_)
+            {
+                auto hook = std::move(before_park_);
+                before_park_ = nullptr;
+                hook();
+            }
+            return INT64_MAX;
+        }
+
+    private:
+        int wakeup_asked_ = 0;
+        std::function<void()> before_park_;
+    };
+}
+
+TEST(hero, parked_hero_handles_requests_promptly)
+{
+    // a logger without sinks, so that hero does not set up one writing to the temp home
+    spdlog::set_default_logger(std::make_shared<spdlog::logger>("test", spdlog::sinks_init_list{}));
+    auto locator = std::make_shared<parking_locator>();
+    auto home = data::location::make(data::mode::LIVE, data::category::STRATEGY, "test", "parked", locator);
+    auto peer = data::location::make(data::mode::LIVE, data::category::STRATEGY, "test", "requester", locator);
+    // only one hero per process, it serves both cases
+    replying_hero hero(std::make_shared<io_device_client>(home, true));
+    auto requester = std::make_shared<io_device_client>(peer, true);
+    // rings the mailbox of home once sent, answers are waited for up to 3s
+    auto sock = requester->connect_socket(home, nanomsg::protocol::REQUEST, 3000);
+
+    // a park lasts up to wait_policy::park_timeout, 1s, when a request is missed
+
+    // landed after the hero found its socket empty but before it parked, the ring came when nobody was parked
+    const std::string early = R"({"msg_type": 0})";
+    hero.before_park([&]()
+                     {
+                         sock->send(early);
+                         auto until = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+                         while (not hero.get_io_device()->get_rep_sock()->readable() and std::chrono::steady_clock::now() < until)
+                         {
+                             std::this_thread::yield();
+                         }
+                     });
+    auto start = std::chrono::steady_clock::now();
+    hero.poll();
+    hero.poll();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(200));
+    EXPECT_EQ(sock->recv_msg(0), early);
+
+    // pauses of a few ms leave the hero parked, or about to park, as requests come in
+    std::atomic<bool> done(false);
+    std::thread loop([&]()
+                     {
+                         while (not done)
+                         {
+                             hero.poll();
+                         }
+                     });
+    std::mt19937 rng(20250303);
+    std::chrono::steady_clock::duration slowest{};
+    for (int i = 0; i < 50; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(rng() % 5000));
+        auto request = fmt::format(R"({{"msg_type": 0, "data": {{"seq": {}}}}})", i);
+        auto sent = std::chrono::steady_clock::now();
+        sock->send(request);
+        ASSERT_EQ(sock->recv_msg(0), request);
+        slowest = std::max(slowest, std::chrono::steady_clock::now() - sent);
+    }
+    done = true;
+    sock->send(early);
+    loop.join();
+    EXPECT_LT(slowest, std::chrono::milliseconds(200));
+}
@@ -0,0 +1,185 @@
+/**
+ * This is source code under the Apache License 2.0.
+ * Original Author: kx@godzilla.dev
+ * Original date: March 3, 2025
+ */
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include <kungfu/practice/timer_wheel.h>
+
+using namespace kungfu::practice;
+
+TEST(timer_wheel, fires_at_deadline_rounded_up_to_tick)
+{
+    timer_wheel wheel(10, 0);
+    std::vector<int64_t> fired;
+    wheel.schedule(25, 0, [&](int64_t now)
+    { fired.push_back(now); });
+    EXPECT_EQ(wheel.next_deadline(), 30);
+    EXPECT_EQ(wheel.advance(29), 0);
+    EXPECT_EQ(wheel.advance(30), 1);
+    EXPECT_EQ(fired, std::vector<int64_t>({30}));
+    EXPECT_EQ(wheel.size(), 0u);
+    EXPECT_EQ(wheel.next_deadline(), INT64_MAX);
+}
+
+TEST(timer_wheel, cascades_from_every_level)
+{
+    timer_wheel wheel(1, 0);
+    // lowest level, then one timer for each level above, and one beyond the range of the wheel
+    const std::vector<int64_t> deadlines = {200, 300, 70000, 20000000, (int64_t(1) << 32) + 100};
+    std::vector<int64_t> fired;
+    for (auto deadline : deadlines)
+    {
+        wheel.schedule(deadline, 0, [&, deadline](int64_t now)
+        {
+            EXPECT_EQ(now, deadline);
+            fired.push_back(deadline);
+        });
+    }
+    for (auto deadline : deadlines)
+    {
+        EXPECT_LE(wheel.next_deadline(), deadline);
+        EXPECT_EQ(wheel.advance(deadline - 1), 0) << deadline;
+        EXPECT_EQ(wheel.advance(deadline), 1) << deadline;
+    }
+    EXPECT_EQ(fired, deadlines);
+    EXPECT_EQ(wheel.size(), 0u);
+}
+
+TEST(timer_wheel, fires_in_deadline_order_across_ticks)
+{
+    timer_wheel wheel(1, 0);
+    std::vector<int64_t> fired;
+    for (int64_t deadline : {900, 5, 70000, 256, 255, 65536})
+    {
+        wheel.schedule(deadline, 0, [&, deadline](int64_t)
+        { fired.push_back(deadline); });
+    }
+    EXPECT_EQ(wheel.advance(100000), 6);
+    EXPECT_EQ(fired, std::vector<int64_t>({5, 255, 256, 900, 65536, 70000}));
+}
+
+TEST(timer_wheel, cancel)
+{
+    timer_wheel wheel(1, 0);
+    int fired = 0;
+    auto count = [&](int64_t)
+    { fired++; };
+    auto pending = wheel.schedule(500, 0, count);
+    auto due = wheel.schedule(10, 0, count);
+    EXPECT_TRUE(wheel.cancel(pending));
+    EXPECT_FALSE(wheel.cancel(pending));
+    EXPECT_EQ(wheel.advance(1000), 1);
+    EXPECT_EQ(fired, 1);
+    // fired already, and its entry is reused by the next timer, the old handle must not cancel the new one
+    EXPECT_FALSE(wheel.cancel(due));
+    auto reused = wheel.schedule(2000, 0, count);
+    EXPECT_FALSE(wheel.cancel(due));
+    EXPECT_FALSE(wheel.cancel(pending));
+    EXPECT_FALSE(wheel.cancel(0));
+    EXPECT_EQ(wheel.size(), 1u);
+    EXPECT_TRUE(wheel.cancel(reused));
+    EXPECT_EQ(wheel.size(), 0u);
+}
+
+TEST(timer_wheel, repeats_and_skips_missed_periods)
+{
+    timer_wheel wheel(1, 0);
+    std::vector<int64_t> fired;
+    auto handle = wheel.schedule(100, 50, [&](int64_t now)
+    { fired.push_back(now); });
+    wheel.advance(100);
+    wheel.advance(150);
+    // three periods missed, fires once and goes on from the next one due
+    wheel.advance(330);
+    wheel.advance(349);
+    wheel.advance(350);
+    EXPECT_EQ(fired, std::vector<int64_t>({100, 150, 330, 350}));
+    EXPECT_TRUE(wheel.cancel(handle));
+    wheel.advance(1000);
+    EXPECT_EQ(fired.size(), 4u);
+}
+
+TEST(timer_wheel, reschedule_from_callback)
+{
+    timer_wheel wheel(1, 0);
+    std::vector<int64_t> fired;
+    timer_handle handle = 0;
+    handle = wheel.schedule(100, 10, [&](int64_t now)
+    {
+        fired.push_back(now);
+        // stop repeating and move on to a later deadline of our own
+        EXPECT_TRUE(wheel.cancel(handle));
+        wheel.schedule(now + 1000, 0, [&](int64_t later)
+        { fired.push_back(later); });
+    });
+    EXPECT_EQ(wheel.advance(100), 1);
+    EXPECT_EQ(wheel.size(), 1u);
+    EXPECT_EQ(wheel.advance(1099), 0);
+    EXPECT_EQ(wheel.advance(1100), 1);
+    EXPECT_EQ(fired, std::vector<int64_t>({100, 1100}));
+    EXPECT_EQ(wheel.size(), 0u);
+}
+
+TEST(timer_wheel, matches_sorted_reference)
+{
+    std::mt19937_64 rng(20250303);
+    const int64_t tick = 7;
+    int64_t now = 1000003;
+    timer_wheel wheel(tick, now);
+    // expire tick of pending timers, by handle
+    std::map<timer_handle, int64_t> reference;
+    std::vector<timer_handle> handles;
+    std::vector<timer_handle> fired;
+    // timers already due may fire in any order, the others in order of their expire tick
+    int64_t start_tick = now / tick;
+    int64_t last_fired_tick = 0;
+
+    for (int round = 0; round < 20000; round++)
+    {
+        auto op = rng() % 10;
+        if (op < 5)
+        {
+            int64_t deadline = now - tick + static_cast<int64_t>(rng() % (rng() % 4 == 0 ? (int64_t(1) << 26) : 3000));
+            int64_t expire_tick = deadline / tick + (deadline % tick > 0 ? 1 : 0);
+            auto handle = std::make_shared<timer_handle>(0);
+            *handle = wheel.schedule(deadline, 0, [&, handle, expire_tick](int64_t at)
+            {
+                EXPECT_LE(expire_tick * tick, at);
+                EXPECT_LE(last_fired_tick, std::max(expire_tick, start_tick));
+                last_fired_tick = std::max(last_fired_tick, expire_tick);
+                fired.push_back(*handle);
+            });
+            reference[*handle] = expire_tick;
+            handles.push_back(*handle);
+        } else if (op < 7 and not handles.empty())
+        {
+            auto handle = handles[rng() % handles.size()];
+            EXPECT_EQ(wheel.cancel(handle), reference.erase(handle) == 1);
+        } else
+        {
+            start_tick = now / tick;
+            last_fired_tick = start_tick;
+            now += static_cast<int64_t>(rng() % (rng() % 8 == 0 ? 200000 : 2000));
+            fired.clear();
+            int count = wheel.advance(now);
+            EXPECT_EQ(count, static_cast<int>(fired.size()));
+            for (auto handle : fired)
+            {
+                EXPECT_EQ(reference.erase(handle), 1u);
+            }
+            for (const auto &pending : reference)
+            {
+                ASSERT_GT(pending.second * tick, now);
+            }
+        }
+        ASSERT_EQ(wheel.size(), reference.size());
+    }
+}
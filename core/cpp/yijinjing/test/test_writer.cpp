@@ -0,0 +1,142 @@
+/**
+ * This is source code under the Apache License 2.0.
+ * Original Author: kx@godzilla.dev
+ * Original date: March 3, 2025
+ */
+
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <spdlog/spdlog.h>
+
+#include <kungfu/yijinjing/journal/journal.h>
+
+#include "temp_home.h"
+
+using namespace kungfu::yijinjing;
+
+struct produced
+{
+    int32_t producer;
+    int32_t seq;
+};
+
+TEST(writer, multi_producer_publishes_in_gen_time_order)
+{
+    spdlog::set_level(spdlog::level::warn);
+    const int producers = 4;
+    const int per_producer = 20000;
+    auto locator = std::make_shared<test::temp_locator>();
+    auto location = data::location::make(data::mode::LIVE, data::category::STRATEGY, "test", "multi_producer", locator);
+    data::journal_policy policy;
+    // small pages, producers keep racing with rollover
+    policy.page_size = 64 * KB;
+    locator->set_journal_policy(location, 0, policy);
+    {
+        journal::writer writer(location, 0, true, std::make_shared<test::null_publisher>(), journal::writer_mode::MULTI_PRODUCER);
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; p++)
+        {
+            threads.emplace_back([&, p]
+                                 {
+                                     for (int i = 0; i < per_producer; i++)
+                                     {
+                                         writer.write(0, msg::type::Time, produced{p, i});
+                                     }
+                                 });
+        }
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    journal::reader reader(true);
+    reader.join(location, 0, 0);
+    std::vector<int32_t> next_seq(producers, 0);
+    int64_t last_gen_time = 0;
+    int count = 0;
+    while (reader.data_available())
+    {
+        auto frame = reader.current_frame();
+        ASSERT_GE(frame->gen_time(), last_gen_time);
+        last_gen_time = frame->gen_time();
+        if (frame->msg_type() == msg::type::PageEnd)
+        {
+            reader.next();
+            continue;
+        }
+        ASSERT_EQ(frame->msg_type(), msg::type::Time);
+        const auto &data = frame->data<produced>();
+        ASSERT_GE(data.producer, 0);
+        ASSERT_LT(data.producer, producers);
+        ASSERT_EQ(data.seq, next_seq[data.producer]);
+        next_seq[data.producer]++;
+        count++;
+        reader.next();
+    }
+    EXPECT_EQ(count, producers * per_producer);
+}
+
+/** trigger times of the frames of a journal in order, page ends left out */
+static std::vector<int64_t> read_trigger_times(const data::location_ptr &location)
+{
+    journal::reader reader(true);
+    reader.join(location, 0, 0);
+    std::vector<int64_t> trigger_times;
+    while (reader.data_available())
+    {
+        auto frame = reader.current_frame();
+        if (frame->msg_type() != msg::type::PageEnd)
+        {
+            trigger_times.push_back(frame->trigger_time());
+        }
+        reader.next();
+    }
+    return trigger_times;
+}
+
+TEST(writer, stamps_trigger_time_of_enclosing_scope)
+{
+    spdlog::set_level(spdlog::level::warn);
+    auto locator = std::make_shared<test::temp_locator>();
+    auto location = data::location::make(data::mode::LIVE, data::category::STRATEGY, "test", "trigger_scope", locator);
+    {
+        journal::writer writer(location, 0, true, std::make_shared<test::null_publisher>());
+        writer.write(0, msg::type::Time, produced{0, 0});
+        {
+            journal::trigger_scope scope(1000);
+            writer.write(0, msg::type::Time, produced{0, 1});
+            writer.open_data<produced>(0, msg::type::Time) = produced{0, 2};
+            writer.close_data();
+            writer.mark(0, msg::type::Time);
+            // set by the caller, kept
+            writer.write(7, msg::type::Time, produced{0, 3});
+            {
+                journal::trigger_scope inner(2000);
+                writer.write(0, msg::type::Time, produced{0, 4});
+            }
+            writer.write(0, msg::type::Time, produced{0, 5});
+            // the scope belongs to the thread which opened it
+            std::thread([&]
+                        { writer.write(0, msg::type::Time, produced{1, 0}); }).join();
+        }
+        EXPECT_EQ(journal::trigger_scope::current(), 0);
+        writer.write(0, msg::type::Time, produced{0, 6});
+    }
+    EXPECT_EQ(read_trigger_times(location), std::vector<int64_t>({0, 1000, 1000, 1000, 7, 2000, 1000, 0, 0}));
+}
+
+TEST(writer, multi_producer_stamps_trigger_time_of_enclosing_scope)
+{
+    spdlog::set_level(spdlog::level::warn);
+    auto locator = std::make_shared<test::temp_locator>();
+    auto location = data::location::make(data::mode::LIVE, data::category::STRATEGY, "test", "trigger_scope_mp", locator);
+    {
+        journal::writer writer(location, 0, true, std::make_shared<test::null_publisher>(), journal::writer_mode::MULTI_PRODUCER);
+        journal::trigger_scope scope(1000);
+        writer.write(0, msg::type::Time, produced{0, 0});
+        writer.write(7, msg::type::Time, produced{0, 1});
+    }
+    EXPECT_EQ(read_trigger_times(location), std::vector<int64_t>({1000, 7}));
+}
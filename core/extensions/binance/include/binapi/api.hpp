@@ -17,6 +17,7 @@
 
 #include <memory>
 #include <functional>
+#include <chrono>
 
 namespace boost {
 namespace asio {
@@ -31,6 +32,13 @@ namespace rest {
 
 /*************************************************************************************************/
 
+// when the request of the reply being handled was written to its connection,
+// only meaningful inside a reply callback of rest::api or wsapi::api, on the io_context thread
+std::chrono::steady_clock::time_point sent_time();
+void set_sent_time(std::chrono::steady_clock::time_point tp);
+
+/*************************************************************************************************/
+
 struct api {
     template<typename T>
     struct result {
@@ -47,6 +55,8 @@ struct api {
         explicit operator bool() const { return errmsg.empty(); }
     };
 
+    // 'timeout' is the recvWindow of signed requests in milliseconds. an async request not answered
+    // within it fails with e_error::TIMEOUT, its outcome unknown, the connect it waits for with timed_out
     api(
          boost::asio::io_context &ioctx
         ,std::string host
@@ -61,6 +71,11 @@ struct api {
     // api(const api &) = delete;
     api(api &&) = default;
 
+    // async requests share a pool of keep-alive TLS connections, one by default.
+    // grows the pool to 'connections', opens them right away and keeps idle ones warm with
+    // a GET of 'ping_target' every 'interval_ms', so requests never wait for a handshake.
+    void keep_alive(std::size_t connections, const char *ping_target, std::size_t interval_ms = 30000);
+
     // https://github.com/binance/binance-spot-api-docs/blob/master/rest-api.md#test-connectivity
     using ping_cb = std::function<bool(const char *fl, int ec, std::string errmsg, ping_t res)>;
     result<ping_t>
@@ -14,6 +14,9 @@
 
 #include <boost/multiprecision/cpp_dec_float.hpp>
 
+#include <cstdint>
+#include <ostream>
+
 /*************************************************************************************************/
 
 namespace binapi {
@@ -23,6 +26,88 @@ using double_type = boost::multiprecision::number<
     ,boost::multiprecision::et_off
 >;
 
+/*************************************************************************************************/
+
+// decimal as a count of 1e-8, the finest step binance quotes prices and quantities in.
+// market data streams parse into it straight from the json token, without allocating, where
+// double_type takes a string copy and a multiprecision parse per field.
+struct fixed_type {
+    static constexpr int exponent = -8;
+    static constexpr std::int64_t scale = 100000000;
+
+    std::int64_t units;
+
+    double to_double() const { return static_cast<double>(units) / scale; }
+
+    bool operator==(const fixed_type &r) const { return units == r.units; }
+    bool operator!=(const fixed_type &r) const { return units != r.units; }
+    bool operator<(const fixed_type &r) const { return units < r.units; }
+
+    // returns false, leaving v untouched, if str is not a plain decimal with at most 8 fraction digits
+    static bool parse(const char *str, std::size_t len, fixed_type &v) {
+        const char *p = str, *end = str + len;
+        bool negative = p != end && *p == '-';
+        if ( negative || (p != end && *p == '+') ) {
+            ++p;
+        }
+        if ( p == end ) {
+            return false;
+        }
+        std::int64_t units = 0;
+        int digits = 0;
+        for ( ; p != end && *p >= '0' && *p <= '9'; ++p, ++digits ) {
+            units = units * 10 + (*p - '0');
+        }
+        // 10 integer digits keep 1e-8 units inside int64
+        if ( digits > 10 ) {
+            return false;
+        }
+        int fraction = 0;
+        if ( p != end && *p == '.' ) {
+            for ( ++p; p != end && *p >= '0' && *p <= '9'; ++p, ++fraction, ++digits ) {
+                if ( fraction == -exponent ) {
+                    return false;
+                }
+                units = units * 10 + (*p - '0');
+            }
+        }
+        if ( p != end || digits == 0 ) {
+            return false;
+        }
+        static constexpr std::int64_t pow10[] = {100000000, 10000000, 1000000, 100000, 10000, 1000, 100, 10, 1};
+        units *= pow10[fraction];
+        v.units = negative ? -units : units;
+        return true;
+    }
+
+    friend std::ostream &operator<<(std::ostream &os, const fixed_type &v) {
+        std::uint64_t abs = v.units < 0 ? -static_cast<std::uint64_t>(v.units) : static_cast<std::uint64_t>(v.units);
+        char buf[32];
+        char *p = buf + sizeof(buf);
+        std::uint64_t frac = abs % scale;
+        int width = -exponent;
+        while ( frac != 0 && frac % 10 == 0 ) {
+            frac /= 10;
+            --width;
+        }
+        if ( frac != 0 ) {
+            for ( int i = 0; i < width; ++i, frac /= 10 ) {
+                *--p = static_cast<char>('0' + frac % 10);
+            }
+            *--p = '.';
+        }
+        std::uint64_t whole = abs / scale;
+        do {
+            *--p = static_cast<char>('0' + whole % 10);
+            whole /= 10;
+        } while ( whole != 0 );
+        if ( v.units < 0 ) {
+            *--p = '-';
+        }
+        return os.write(p, buf + sizeof(buf) - p);
+    }
+};
+
 } // ns binapi
 
 /*************************************************************************************************/
@@ -1519,6 +1519,33 @@ public:
         return true;
     }
 
+    // parses into the tokens left by previous documents without counting first,
+    // storage only grows when a document has more tokens than any before it.
+    // elements taken from the previous document are invalidated.
+    bool reload(InputIterator beg, std::size_t size) { return reload(beg, beg+size); }
+    bool reload(InputIterator beg, InputIterator end) {
+        m_src_beg = beg;
+        m_src_end = end;
+        m_beg = m_end = nullptr;
+        m_err = FJ_EC_OK;
+        // parser expects blank tokens, clear and resize within capacity resets them without reallocating
+        m_storage->clear();
+        m_storage->resize(m_storage->capacity());
+        if ( load(beg, end) ) {
+            return true;
+        }
+        if ( m_err != FJ_EC_NO_FREE_TOKENS ) {
+            return false;
+        }
+
+        // grow geometrically, so a stream of slowly growing documents settles after a few of them
+        m_err = FJ_EC_OK;
+        m_storage->clear();
+        m_storage->reserve(m_storage->capacity() * 2);
+
+        return load(beg, end);
+    }
+
     std::string dump(std::size_t indent = 0) const {
         std::size_t strlen = details::fj_str_length(m_beg, m_storage->size(), indent);
         std::string res(strlen, 0);
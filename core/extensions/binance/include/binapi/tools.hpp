@@ -17,6 +17,8 @@
 #include <string>
 #include <vector>
 
+struct evp_md_ctx_st;
+
 namespace binapi {
 
 /*************************************************************************************************/
@@ -42,6 +44,24 @@ bool is_my_orderid(const char *client_order_id);
 
 /*************************************************************************************************/
 
+// HMAC-SHA256 with the padded key hashed once, signing a request only hashes its payload
+struct hmac_sha256_key {
+    explicit hmac_sha256_key(const std::string &key);
+    ~hmac_sha256_key();
+
+    hmac_sha256_key(const hmac_sha256_key &) = delete;
+    hmac_sha256_key& operator= (const hmac_sha256_key &) = delete;
+
+    // the keyed states are only read, so threads can sign concurrently
+    std::string sign(const char *data, std::size_t dlen) const;
+
+private:
+    evp_md_ctx_st *m_inner;
+    evp_md_ctx_st *m_outer;
+};
+
+/*************************************************************************************************/
+
 } // ns binapi
 
 #endif // __binapi__tools_hpp
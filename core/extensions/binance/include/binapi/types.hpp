@@ -724,8 +724,8 @@ struct agg_trade_t {
     std::size_t E; // Event time
     std::string s; // Symbol
     std::size_t a; // Aggregate trade ID
-    double_type p; // Price
-    double_type q; // Quantity
+    fixed_type p; // Price
+    fixed_type q; // Quantity
     std::size_t f; // First trade ID
     std::size_t l; // Last trade ID
     std::size_t T; // Trade time
@@ -733,6 +733,8 @@ struct agg_trade_t {
     bool M; // Ignore
 
     static agg_trade_t construct(const flatjson::fjson &json);
+    // fills res in place, its strings and vectors keep their capacity across messages
+    static void construct(const flatjson::fjson &json, agg_trade_t &res);
     friend std::ostream &operator<<(std::ostream &os, const agg_trade_t &o);
 };
 
@@ -741,8 +743,8 @@ struct trade_t {
     std::size_t E; // Event time
     std::string s; // Symbol
     std::size_t t; // Trade ID
-    double_type p; // Price
-    double_type q; // Quantity
+    fixed_type p; // Price
+    fixed_type q; // Quantity
     std::size_t b; // Buyer order ID
     std::size_t a; // Seller order ID
     std::size_t T; // Trade time
@@ -750,6 +752,7 @@ struct trade_t {
     bool M; // Ignore
 
     static trade_t construct(const flatjson::fjson &json);
+    static void construct(const flatjson::fjson &json, trade_t &res);
     friend std::ostream &operator<<(std::ostream &os, const trade_t &o);
 };
 
@@ -758,18 +761,20 @@ struct trade_t {
 // https://github.com/binance/binance-spot-api-docs/blob/master/web-socket-streams.md#partial-book-depth-streams
 struct part_depths_t {
     struct depth_t {
-        double_type price;
-        double_type amount;
+        fixed_type price;
+        fixed_type amount;
 
         friend std::ostream &operator<<(std::ostream &os, const depth_t &o);
     };
 
     std::size_t E;
     std::size_t T;
+    std::size_t u; // last update id, lastUpdateId on spot
     std::vector<depth_t> a;
     std::vector<depth_t> b;
 
     static part_depths_t construct(const flatjson::fjson &json);
+    static void construct(const flatjson::fjson &json, part_depths_t &res);
     friend std::ostream& operator<<(std::ostream &os, const part_depths_t &o);
 };
 
@@ -789,8 +794,8 @@ struct mark_price_t {
 // https://github.com/binance-exchange/binance-official-api-docs/blob/master/web-socket-streams.md#diff-depth-stream
 struct diff_depths_t {
     struct depth_t {
-        double_type price;
-        double_type amount;
+        fixed_type price;
+        fixed_type amount;
 
         friend std::ostream &operator<<(std::ostream &os, const depth_t &o);
     };
@@ -803,6 +808,7 @@ struct diff_depths_t {
     std::vector<depth_t> b;
 
     static diff_depths_t construct(const flatjson::fjson &json);
+    static void construct(const flatjson::fjson &json, diff_depths_t &res);
     friend std::ostream& operator<<(std::ostream &os, const diff_depths_t &o);
 };
 
@@ -905,14 +911,15 @@ struct markets_tickers_t {
 struct book_ticker_t {
     std::size_t u;
     std::string s;
-    double_type b;
-    double_type B;
-    double_type a;
-    double_type A;
+    fixed_type b;
+    fixed_type B;
+    fixed_type a;
+    fixed_type A;
     std::size_t E;
     std::size_t T;
 
     static book_ticker_t construct(const flatjson::fjson &json);
+    static void construct(const flatjson::fjson &json, book_ticker_t &res);
     friend std::ostream& operator<<(std::ostream &os, const book_ticker_t &o);
 };
 
@@ -15,6 +15,7 @@
 #include "enums.hpp"
 
 #include <memory>
+#include <chrono>
 #include <functional>
 
 namespace boost {
@@ -48,6 +49,8 @@ struct book_ticker_t;
 struct future_part_depths_t;
 struct mark_price_t;
 
+struct combined_streams;
+
 /*************************************************************************************************/
 
 struct websockets {
@@ -68,54 +71,56 @@ struct websockets {
 
     using handle = void *;
 
+    // market data messages are filled in place by their channel, only valid during the callback
+
     // https://github.com/binance/binance-spot-api-docs/blob/master/web-socket-streams.md#partial-book-depth-streams
-    using on_part_depths_received_cb = std::function<bool(const char *fl, int ec, std::string errmsg, part_depths_t msg)>;
+    using on_part_depths_received_cb = std::function<bool(const char *fl, int ec, std::string errmsg, const part_depths_t &msg)>;
     handle part_depth(const char *pair, e_levels level, e_freq freq, on_part_depths_received_cb cb);
     // https://binance-docs.github.io/apidocs/futures/cn/#6ae7c2b506
     handle future_part_depth(const char *pair, e_levels level, e_freq freq, on_part_depths_received_cb cb);
 
     // https://github.com/binance/binance-spot-api-docs/blob/master/web-socket-streams.md#diff-depth-stream
-    using on_diff_depths_received_cb = std::function<bool(const char *fl, int ec, std::string errmsg, diff_depths_t msg)>;
+    using on_diff_depths_received_cb = std::function<bool(const char *fl, int ec, std::string errmsg, const diff_depths_t &msg)>;
     handle diff_depth(const char *pair, e_freq freq, on_diff_depths_received_cb cb);
 
     // https://github.com/binance/binance-spot-api-docs/blob/master/web-socket-streams.md#klinecandlestick-streams
-    using on_kline_received_cb = std::function<bool(const char *fl, int ec, std::string errmsg, kline_t msg)>;
+    using on_kline_received_cb = std::function<bool(const char *fl, int ec, std::string errmsg, const kline_t &msg)>;
     // period - 1m, 3m, 5m, 15m, 30m, 1h, 2h, 4h, 6h, 8h, 12h, 1d, 3d, 1w, 1M
     handle klines(const char *pair, const char *period, on_kline_received_cb cb);
 
     // https://github.com/binance/binance-spot-api-docs/blob/master/web-socket-streams.md#trade-streams
-    using on_trade_received_cb = std::function<bool(const char *fl, int ec, std::string errmsg, trade_t msg)>;
+    using on_trade_received_cb = std::function<bool(const char *fl, int ec, std::string errmsg, const trade_t &msg)>;
     handle trade(const char *pair, on_trade_received_cb cb);
 
     // https://github.com/binance/binance-spot-api-docs/blob/master/web-socket-streams.md#aggregate-trade-streams
-    using on_agg_trade_received_cb = std::function<bool(const char *fl, int ec, std::string errmsg, agg_trade_t msg)>;
+    using on_agg_trade_received_cb = std::function<bool(const char *fl, int ec, std::string errmsg, const agg_trade_t &msg)>;
     handle agg_trade(const char *pair, on_agg_trade_received_cb cb);
 
     // https://github.com/binance/binance-spot-api-docs/blob/master/web-socket-streams.md#individual-symbol-mini-ticker-stream
-    using on_mini_ticker_received_cb = std::function<bool(const char *fl, int ec, std::string errmsg, mini_ticker_t msg)>;
+    using on_mini_ticker_received_cb = std::function<bool(const char *fl, int ec, std::string errmsg, const mini_ticker_t &msg)>;
     handle mini_ticker(const char *pair, on_mini_ticker_received_cb cb);
 
     // https://github.com/binance/binance-spot-api-docs/blob/master/web-socket-streams.md#all-market-mini-tickers-stream
-    using on_mini_tickers_received_cb = std::function<bool(const char *fl, int ec, std::string errmsg, mini_tickers_t msg)>;
+    using on_mini_tickers_received_cb = std::function<bool(const char *fl, int ec, std::string errmsg, const mini_tickers_t &msg)>;
     handle mini_tickers(on_mini_tickers_received_cb cb);
 
     // https://github.com/binance/binance-spot-api-docs/blob/master/web-socket-streams.md#individual-symbol-ticker-streams
-    using on_market_received_cb = std::function<bool(const char *fl, int ec, std::string errmsg, market_ticker_t msg)>;
+    using on_market_received_cb = std::function<bool(const char *fl, int ec, std::string errmsg, const market_ticker_t &msg)>;
     handle market(const char *pair, on_market_received_cb cb);
 
     // https://github.com/binance/binance-spot-api-docs/blob/master/web-socket-streams.md#all-market-tickers-stream
-    using on_markets_received_cb = std::function<bool(const char *fl, int ec, std::string errmsg, markets_tickers_t msg)>;
+    using on_markets_received_cb = std::function<bool(const char *fl, int ec, std::string errmsg, const markets_tickers_t &msg)>;
     handle markets(on_markets_received_cb cb);
 
     // https://github.com/binance/binance-spot-api-docs/blob/master/web-socket-streams.md#individual-symbol-book-ticker-streams
-    using on_book_received_cb = std::function<bool(const char *fl, int ec, std::string errmsg, book_ticker_t msg)>;
+    using on_book_received_cb = std::function<bool(const char *fl, int ec, std::string errmsg, const book_ticker_t &msg)>;
     handle book(const char *pair, on_book_received_cb cb);
 
-    using on_books_received_cb = std::function<bool(const char *fl, int ec, std::string errmsg, book_ticker_t msg)>;
+    using on_books_received_cb = std::function<bool(const char *fl, int ec, std::string errmsg, const book_ticker_t &msg)>;
     handle books(on_books_received_cb cb);
 
     // https://binance-docs.github.io/apidocs/delivery/cn/#markprice
-    using on_mark_price_received_cb = std::function<bool(const char *fl, int ec, std::string errmsg, mark_price_t msg)>;
+    using on_mark_price_received_cb = std::function<bool(const char *fl, int ec, std::string errmsg, const mark_price_t &msg)>;
     handle mark_price(const char *pair, on_mark_price_received_cb cb);
 
     using on_account_update_cb = std::function<bool(const char *fl, int ec, std::string errmsg, userdata::account_update_t msg)>;
@@ -134,6 +139,10 @@ struct websockets {
         ,future_order_update_cb
     );
 
+    // https://github.com/binance/binance-spot-api-docs/blob/master/web-socket-streams.md#general-wss-information
+    // all streams read from one connection, /stream?streams=a/b/c, each message goes to the callback of its stream
+    handle combined(combined_streams streams);
+
     void unsubscribe(const handle &h);
     void async_unsubscribe(const handle &h);
     void unsubscribe_all();
@@ -148,6 +157,35 @@ private:
 
 /*************************************************************************************************/
 
+// streams to open on one connection by websockets::combined, callbacks are the same as for a stream of its own
+struct combined_streams {
+    combined_streams();
+    ~combined_streams();
+    combined_streams(combined_streams &&) noexcept;
+    combined_streams& operator= (combined_streams &&) noexcept;
+
+    void part_depth(const char *pair, e_levels level, e_freq freq, websockets::on_part_depths_received_cb cb);
+    void diff_depth(const char *pair, e_freq freq, websockets::on_diff_depths_received_cb cb);
+    void trade(const char *pair, websockets::on_trade_received_cb cb);
+    void agg_trade(const char *pair, websockets::on_agg_trade_received_cb cb);
+    void book(const char *pair, websockets::on_book_received_cb cb);
+
+    std::size_t size() const;
+    bool empty() const { return size() == 0; }
+
+private:
+    friend struct websockets;
+    struct impl;
+    std::unique_ptr<impl> pimpl;
+};
+
+/*************************************************************************************************/
+
+// time the message being dispatched on this thread was read off its socket, only valid during its callbacks
+std::chrono::steady_clock::time_point receive_time();
+
+/*************************************************************************************************/
+
 } // ns ws
 } // ns binapi
 
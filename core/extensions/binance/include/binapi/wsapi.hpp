@@ -0,0 +1,120 @@
+// ----------------------------------------------------------------------------
+//                              Apache License
+//                        Version 2.0, January 2004
+//                     http://www.apache.org/licenses/
+//
+// This file is part of binapi(https://github.com/niXman/binapi) project.
+//
+// Copyright (c) 2019-2021 niXman (github dot nixman dog pm.me). All rights reserved.
+// ----------------------------------------------------------------------------
+
+#ifndef __binapi__wsapi_hpp
+#define __binapi__wsapi_hpp
+
+#include "api.hpp"
+
+#include <memory>
+#include <functional>
+
+namespace boost {
+namespace asio {
+
+class io_context;
+
+} // ns asio
+} // ns boost
+
+namespace binapi {
+namespace wsapi {
+
+/*************************************************************************************************/
+
+// order entry over the websocket api, one long lived session per host:
+// https://github.com/binance/binance-spot-api-docs/blob/master/web-socket-api.md
+// https://developers.binance.com/docs/derivatives/usds-margined-futures/websocket-api-general-info
+//
+// requests are signed one by one like the rest api and written back to back without waiting
+// for replies, replies are matched back by request id, which starts with the client order id.
+// callbacks have the same signatures as rest::api and are invoked on the io_context thread.
+// requests made while the session is down go through the 'fallback' rest api, or fail right
+// away with e_error::DISCONNECTED without one. requests in flight when the session drops fail
+// with e_error::DISCONNECTED, requests without a reply after 'timeout' ms, the recvWindow they
+// are signed with, fail with e_error::TIMEOUT. the outcome of both is unknown to the caller.
+struct api {
+    api(
+         boost::asio::io_context &ioctx
+        ,std::string host
+        ,std::string port
+        ,std::string target // "/ws-api/v3" for spot, "/ws-fapi/v1" for usd-m futures
+        ,std::string pk
+        ,std::string sk
+        ,std::size_t timeout
+        ,std::shared_ptr<rest::api> fallback = {}
+    );
+    virtual ~api();
+
+    api(const api &) = delete;
+    api& operator= (const api &) = delete;
+
+    // connects and keeps reconnecting until stop()
+    void start();
+    void stop();
+    bool is_connected() const;
+    // called on the io_context thread each time a session is up, set before start()
+    void set_on_connected(std::function<void()> cb);
+
+    // https://github.com/binance/binance-spot-api-docs/blob/master/web-socket-api.md#place-new-order-trade
+    void new_order(
+         const char *symbol
+        ,e_side side
+        ,e_type type
+        ,e_time time
+        ,e_trade_resp_type resp
+        ,const char *amount
+        ,const char *price
+        ,const char *client_order_id
+        ,const char *stop_price
+        ,const char *iceberg_amount
+        ,rest::api::new_order_cb cb
+    );
+
+    // https://github.com/binance/binance-spot-api-docs/blob/master/web-socket-api.md#cancel-order-trade
+    void cancel_order(
+         const char *symbol
+        ,std::size_t order_id
+        ,const char *client_order_id
+        ,const char *new_client_order_id
+        ,rest::api::cancel_order_cb cb
+    );
+
+    // https://github.com/binance/binance-spot-api-docs/blob/master/web-socket-api.md#query-order-user_data
+    void order_info(const char *symbol, std::size_t order_id, const char *client_order_id, rest::api::order_info_cb cb);
+
+    // only market and limit orders, the same subset rest::api::future_new_order sends
+    void future_new_order(
+         const char *symbol
+        ,e_side side
+        ,e_position_side position_side
+        ,e_type type
+        ,e_time time
+        ,const char *quantity
+        ,const char *price
+        ,const char *client_order_id
+        ,rest::api::future_new_order_cb cb
+    );
+
+    void future_cancel_order(const char *symbol, std::size_t order_id, const char *client_order_id, rest::api::cancel_order_cb cb);
+
+    void future_order_info(const char *symbol, std::size_t order_id, const char *client_order_id, rest::api::order_info_cb cb);
+
+private:
+    struct impl;
+    std::unique_ptr<impl> pimpl;
+};
+
+/*************************************************************************************************/
+
+} // ns wsapi
+} // ns binapi
+
+#endif // __binapi__wsapi_hpp
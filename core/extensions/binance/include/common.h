@@ -32,6 +32,23 @@ namespace kungfu
                 int cbase_rest_port;         // 币本位合约rest端口
                 std::string cbase_wss_host;  // 币本位合约websocket域名
                 int cbase_wss_port;          // 币本位合约websocket端口
+                int depth_levels;            // 深度档数, 5/10/20
+                bool compact_depth;          // 以定点 CompactDepth 写出深度, 否则写出 Depth
+                bool incremental_depth;      // 现货以快照加增量深度维护本地订单簿, 否则使用部分深度推送
+                int rest_connections;        // 每个rest域名保持的长连接数
+                int rest_keep_alive_ms;      // 空闲长连接的保活间隔, 毫秒
+                std::string order_transport; // 下单/撤单/查单通道, rest 或 ws(websocket api)
+                std::string spot_wsapi_host; // 现货websocket api域名
+                int spot_wsapi_port;         // 现货websocket api端口
+                std::string ubase_wsapi_host;// u本位合约websocket api域名
+                int ubase_wsapi_port;        // u本位合约websocket api端口
+                int max_open_orders;         // 同时在途的最大订单数, 订单表按此预分配
+                int md_shards;               // 行情分片数, 每片一个io线程, 写入各自的journal
+                int md_streams_per_connection;// 每个合并流连接上的最大stream数, binance上限1024
+                int md_feed_legs;            // 行情冗余连接数, 同一组stream开多路连接, 按交易所序号去重, 谁先到发布谁
+                std::string spot_wss_alt_host; // 第二路起使用的现货websocket域名, 空则与第一路相同
+                std::string ubase_wss_alt_host;// 第二路起使用的u本位合约websocket域名, 空则与第一路相同
+                std::string cbase_wss_alt_host;// 第二路起使用的币本位合约websocket域名, 空则与第一路相同
             };
 
             inline void from_json(const nlohmann::json &j, Configuration &c)
@@ -51,6 +68,23 @@ namespace kungfu
                 c.cbase_rest_port = 443;
                 c.cbase_wss_host = "dstream.binance.com";
                 c.cbase_wss_port = 443;
+                c.depth_levels = j.value("depth_levels", 20);
+                c.compact_depth = j.value("compact_depth", false);
+                c.incremental_depth = j.value("incremental_depth", false);
+                c.rest_connections = j.value("rest_connections", 4);
+                c.rest_keep_alive_ms = j.value("rest_keep_alive_ms", 30000);
+                c.order_transport = j.value("order_transport", "rest");
+                c.spot_wsapi_host = "ws-api.binance.com";
+                c.spot_wsapi_port = 443;
+                c.ubase_wsapi_host = "ws-fapi.binance.com";
+                c.ubase_wsapi_port = 443;
+                c.max_open_orders = j.value("max_open_orders", 16384);
+                c.md_shards = j.value("md_shards", 1);
+                c.md_streams_per_connection = j.value("md_streams_per_connection", 64);
+                c.md_feed_legs = j.value("md_feed_legs", 1);
+                c.spot_wss_alt_host = j.value("spot_wss_alt_host", "");
+                c.ubase_wss_alt_host = j.value("ubase_wss_alt_host", "");
+                c.cbase_wss_alt_host = j.value("cbase_wss_alt_host", "");
             }
         }
     }
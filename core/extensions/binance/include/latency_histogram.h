@@ -0,0 +1,106 @@
+/**
+ * This is source code under the Apache License 2.0.
+ * Original Author: kx@godzilla.dev
+ * Original date: March 3, 2025
+ */
+
+#ifndef GODZILLA_BINANCE_EXT_LATENCY_HISTOGRAM_H
+#define GODZILLA_BINANCE_EXT_LATENCY_HISTOGRAM_H
+
+#include <array>
+#include <cstdint>
+#include <algorithm>
+
+#include <kungfu/wingchun/msg.h>
+
+namespace kungfu {
+    namespace wingchun {
+        namespace binance {
+            /**
+             * Latencies in ns counted into log-linear buckets like HdrHistogram, every power of two split into
+             * SUB_BUCKETS buckets, so percentiles are within 1/SUB_BUCKETS of the value. Fixed size, recording
+             * is a few instructions with no allocation.
+             */
+            class LatencyHistogram
+            {
+            public:
+                static constexpr int SUB_BITS = 4;
+                static constexpr int64_t SUB_BUCKETS = 1 << SUB_BITS;
+                /** larger values, 2^34 ns or about 17 s, count into the last bucket */
+                static constexpr int MAX_BITS = 34;
+                static constexpr size_t BUCKETS = (MAX_BITS - SUB_BITS + 1) * SUB_BUCKETS;
+
+                void record(int64_t value)
+                {
+                    value = std::max<int64_t>(value, 0);
+                    counts_[std::min(index_of(value), BUCKETS - 1)]++;
+                    count_++;
+                    max_ = std::max(max_, value);
+                }
+
+                uint64_t count() const
+                { return count_; }
+
+                /** lower end of the bucket holding the value at quantile q of 0..1, max for 1 */
+                int64_t percentile(double q) const
+                {
+                    if (count_ == 0) {
+                        return 0;
+                    }
+                    if (q >= 1) {
+                        return max_;
+                    }
+                    auto rank = static_cast<uint64_t>(q * count_) + 1;
+                    uint64_t seen = 0;
+                    for (size_t i = 0; i < BUCKETS; i++) {
+                        seen += counts_[i];
+                        if (seen >= rank) {
+                            return std::min(value_of(i), max_);
+                        }
+                    }
+                    return max_;
+                }
+
+                void fill(msg::data::LatencyPercentiles &percentiles) const
+                {
+                    percentiles.p50 = percentile(0.5);
+                    percentiles.p90 = percentile(0.9);
+                    percentiles.p99 = percentile(0.99);
+                    percentiles.p999 = percentile(0.999);
+                    percentiles.max = max_;
+                }
+
+                void reset()
+                {
+                    counts_.fill(0);
+                    count_ = 0;
+                    max_ = 0;
+                }
+
+                static size_t index_of(int64_t value)
+                {
+                    if (value < SUB_BUCKETS) {
+                        return static_cast<size_t>(value);
+                    }
+                    int msb = 63 - __builtin_clzll(static_cast<uint64_t>(value));
+                    int shift = msb - SUB_BITS;
+                    return static_cast<size_t>((shift + 1) * SUB_BUCKETS + ((value >> shift) - SUB_BUCKETS));
+                }
+
+                static int64_t value_of(size_t index)
+                {
+                    auto block = static_cast<int>(index / SUB_BUCKETS);
+                    auto offset = static_cast<int64_t>(index % SUB_BUCKETS);
+                    return block == 0 ? offset : (SUB_BUCKETS + offset) << (block - 1);
+                }
+
+            private:
+                std::array<uint32_t, BUCKETS> counts_{};
+                uint64_t count_ = 0;
+                int64_t max_ = 0;
+            };
+        }
+    }
+}
+
+#endif //GODZILLA_BINANCE_EXT_LATENCY_HISTOGRAM_H
@@ -11,8 +11,6 @@
 #include <memory>
 #include <string>
 #include <vector>
-#include <set>
-#include <list>
 #include <boost/asio/io_context.hpp>
 #include <binapi/websocket.hpp>
 #include <binapi/api.hpp>
@@ -23,62 +21,18 @@
 #include <kungfu/wingchun/broker/marketdata.h>
 
 #include "common.h"
+#include "order_book.h"
+#include "stream_shard.h"
 
 namespace kungfu {
     namespace wingchun {
         namespace binance {
-            struct OrderBook
-            {
-                struct level_t
-                {
-                    binapi::double_type price;
-                    binapi::double_type amount;
-
-                    friend std::ostream& operator<<(std::ostream& os, const level_t& s) {
-                        os << "price: " << s.price << ", amount: " << s.amount;
-                        return os;
-                    }
-
-                    bool operator<(const struct level_t& r) const {
-                        return this->price < r.price;
-                    }
-                };
-
-                struct greater {
-                    bool operator () (const level_t& l, const level_t& r) const {
-                        return l.price > r.price;
-                    }
-                };
-
-                std::string symbol;
-                std::size_t lastUpdateId;
-                std::set<level_t, greater> bids;
-                std::set<level_t> asks;
-
-                // static OrderBook construct(const flatjson::fjson &json);
-                friend std::ostream& operator<<(std::ostream& os, const OrderBook& book) {
-                    os << "orderbook: " << book.symbol << ", lastUpdateId: " << book.lastUpdateId << std::endl;
-                    os << "asks: " << std::endl;
-                    for (auto& a : book.asks) {
-                        os << a << std::endl;
-                    }
-                    os << "bids: " << std::endl;
-                    for (auto& b : book.bids) {
-                        os << b << std::endl;
-                    }
-                    return os;
-                }
-
-                void merge() {}
-            };
-
             struct ChannelInfo
             {
                 std::string symbol;
                 std::string sub_type;
                 InstrumentType inst_type;
-                binapi::ws::websockets::handle handle;
-                bool ready;
+                size_t shard;
             };
 
             class MarketDataBinance: public broker::MarketData
@@ -103,21 +57,29 @@ namespace kungfu {
             protected:
 
                 void on_start() override;
-                void _check_status(kungfu::yijinjing::event_ptr);
 
             private:
                 Configuration config_;
                 std::string get_runtime_folder() const;
+                /** shard of all streams of a symbol, same for every run with the same number of shards */
+                const std::shared_ptr<StreamShard> &get_shard(const std::string &binance_symbol) const;
+                /** ask REST for a snapshot of book, handled on io thread of shard with the diffs */
+                void request_snapshot(const std::shared_ptr<StreamShard> &shard, const std::shared_ptr<OrderBook> &book);
+                /** exponents of the depth of a symbol from its tick and step size, ignored if exchange info lacks either */
+                void add_depth_exponents(const std::string &binance_symbol, InstrumentType instrument_type, double tick, double step);
+                /** write top of book to journal, as Depth or as CompactDepth by config */
+                void publish_depth(const yijinjing::journal::writer_ptr &writer, const OrderBook &book,
+                                   int64_t exchange_time, int64_t receive_time);
+                // rest requests only, streams are read on the io threads of shards
                 boost::asio::io_context ioctx_;
-                std::shared_ptr<binapi::ws::websockets> ws_ptr_;
-                std::shared_ptr<binapi::ws::websockets> fws_ptr_;
-                std::shared_ptr<binapi::ws::websockets> dws_ptr_;
                 std::shared_ptr<std::thread> task_thread_;
+                std::vector<std::shared_ptr<StreamShard>> shards_;
+                std::vector<std::shared_ptr<std::thread>> shard_threads_;
                 std::shared_ptr<binapi::rest::api> rest_ptr_;
                 std::shared_ptr<binapi::rest::api> frest_ptr_;
-                std::map<std::string, OrderBook> depths_cache_;
-                std::list<binapi::ws::diff_depths_t> diff_depths_cache_;
                 std::map<uint32_t, ChannelInfo> channel_cache_;
+                /** price and volume exponent of each depth channel from exchange info, books of others keep EXPONENT */
+                std::map<uint32_t, std::pair<int8_t, int8_t>> depth_exponents_;
             };
         }
     }
@@ -0,0 +1,149 @@
+/**
+ * This is source code under the Apache License 2.0.
+ * Original Author: kx@godzilla.dev
+ * Original date: March 3, 2025
+ */
+
+#ifndef GODZILLA_BINANCE_EXT_ORDER_BOOK_H
+#define GODZILLA_BINANCE_EXT_ORDER_BOOK_H
+
+#include <string>
+#include <vector>
+#include <binapi/types.hpp>
+#include <binapi/double_type.hpp>
+
+#include <kungfu/yijinjing/time.h>
+#include <kungfu/wingchun/msg.h>
+
+namespace kungfu {
+    namespace wingchun {
+        namespace binance {
+            /**
+             * L2 book of one binance instrument, kept as two flat arrays of fixed point levels sorted best first,
+             * so updates near the top move a few bytes and never allocate once the arrays have grown.
+             *
+             * Follows the binance recipe for a local book: diffs are buffered until a REST snapshot arrives, diffs
+             * older than the snapshot are dropped, then every diff has to start right after the previous one ends,
+             * otherwise the book is out of sync and needs a new snapshot.
+             */
+            class OrderBook
+            {
+            public:
+                /** binance quotes prices and quantities with at most 8 decimals */
+                static constexpr int8_t EXPONENT = -8;
+                static_assert(EXPONENT == binapi::fixed_type::exponent, "stream decimals are kept as they come");
+
+                enum class Status
+                {
+                    Applied,    // book changed
+                    Buffered,   // waiting for snapshot
+                    Stale,      // diff already covered by the book
+                    Gap         // diff does not follow the book, needs a new snapshot
+                };
+
+                OrderBook(std::string symbol, InstrumentType instrument_type, uint32_t instrument_id, size_t max_levels = 1000);
+
+                const std::string &get_symbol() const { return symbol_; }
+
+                InstrumentType get_instrument_type() const { return instrument_type_; }
+
+                uint32_t get_instrument_id() const { return instrument_id_; }
+
+                const std::vector<msg::data::DepthLevel> &get_bids() const { return bids_; }
+
+                const std::vector<msg::data::DepthLevel> &get_asks() const { return asks_; }
+
+                size_t get_last_update_id() const { return last_update_id_; }
+
+                int8_t get_price_exponent() const { return price_exponent_; }
+
+                int8_t get_volume_exponent() const { return volume_exponent_; }
+
+                /**
+                 * exponents levels are published with, from the tick and step size of the instrument, so mantissas count
+                 * ticks and steps. EXPONENT until set, finer ones are raised to it
+                 */
+                void set_exponents(int8_t price_exponent, int8_t volume_exponent);
+
+                /** first n levels of side rescaled to the published exponents, exact as every level is a multiple of them */
+                void copy_levels(const std::vector<msg::data::DepthLevel> &side, size_t n, msg::data::DepthLevel *out) const;
+
+                bool is_synced() const { return synced_; }
+
+                /** time the pending snapshot was requested, 0 if none */
+                int64_t get_snapshot_time() const { return snapshot_time_; }
+
+                void set_snapshot_time(int64_t time) { snapshot_time_ = time; }
+
+                /** whether a snapshot should be requested at now, in nanoseconds, waits longer after each snapshot too old */
+                bool is_snapshot_due(int64_t now) const
+                { return not synced_ and (snapshot_time_ == 0 or now - snapshot_time_ > snapshot_backoff_); }
+
+                /** drop levels and wait for a new snapshot, buffered diffs are kept */
+                void reset();
+
+                /** replace all levels, for streams that send the top of book as a whole */
+                void set_levels(const std::vector<binapi::ws::part_depths_t::depth_t> &bids,
+                                const std::vector<binapi::ws::part_depths_t::depth_t> &asks);
+
+                /**
+                 * load snapshot and replay buffered diffs on top of it, Gap if the snapshot is older than them,
+                 * the request time is then kept so that the next one waits for the backoff
+                 */
+                Status apply_snapshot(const binapi::rest::depths_t &snapshot);
+
+                Status apply(const binapi::ws::diff_depths_t &diff);
+
+                /** value in units of 10^EXPONENT, scaling in decimal is exact and far cheaper than going through double */
+                static int64_t to_units(const binapi::double_type &value)
+                {
+                    static const binapi::double_type scale(DECIMAL_SCALES[-EXPONENT]);
+                    return binapi::double_type(value * scale).convert_to<int64_t>();
+                }
+
+                static int64_t to_units(const binapi::fixed_type &value)
+                { return value.units; }
+
+            private:
+                struct Diff
+                {
+                    size_t first_update_id;
+                    size_t last_update_id;
+                    std::vector<msg::data::DepthLevel> bids;
+                    std::vector<msg::data::DepthLevel> asks;
+                };
+
+                /** diffs kept while waiting for snapshot, 10 seconds at 100ms */
+                static constexpr size_t MAX_BUFFERED = 100;
+                /** wait before asking for another snapshot, doubled each time the one received is older than the diffs */
+                static constexpr int64_t SNAPSHOT_RETRY = yijinjing::time_unit::NANOSECONDS_PER_SECOND;
+                static constexpr int64_t MAX_SNAPSHOT_RETRY = 32 * SNAPSHOT_RETRY;
+
+                std::string symbol_;
+                InstrumentType instrument_type_;
+                uint32_t instrument_id_;
+                size_t max_levels_;
+                int8_t price_exponent_;
+                int8_t volume_exponent_;
+                /** 10^(published exponent - EXPONENT), levels are divided by them on the way out */
+                int64_t price_scale_;
+                int64_t volume_scale_;
+                std::vector<msg::data::DepthLevel> bids_;
+                std::vector<msg::data::DepthLevel> asks_;
+                size_t last_update_id_;
+                bool synced_;
+                /** first diff after snapshot only has to overlap it, later ones have to be contiguous */
+                bool first_diff_;
+                int64_t snapshot_time_;
+                int64_t snapshot_backoff_;
+                std::vector<Diff> buffered_;
+
+                Status apply(const Diff &diff);
+
+                void update(std::vector<msg::data::DepthLevel> &side, const msg::data::DepthLevel &level, bool descending);
+            };
+        }
+    }
+}
+
+#endif //GODZILLA_BINANCE_EXT_ORDER_BOOK_H
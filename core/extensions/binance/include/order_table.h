@@ -0,0 +1,83 @@
+/**
+ * This is source code under the Apache License 2.0.
+ * Original Author: kx@godzilla.dev
+ * Original date: March 3, 2025
+ */
+
+#ifndef GODZILLA_BINANCE_EXT_ORDER_TABLE_H
+#define GODZILLA_BINANCE_EXT_ORDER_TABLE_H
+
+#include <cstdint>
+#include <vector>
+
+#include <kungfu/wingchun/msg.h>
+
+namespace kungfu {
+    namespace wingchun {
+        namespace binance {
+            struct OrderRecord
+            {
+                uint64_t order_id;
+                uint64_t ex_order_id;   // 0 until binance acknowledges the order
+                uint32_t source;
+                int64_t last_update;
+                int64_t trigger_time;   // gen_time of the OrderInput, trigger of every Order frame written about it
+                msg::data::Order order;
+            };
+
+            /**
+             * Live orders of one trader, with every slot and both indexes allocated up front.
+             *
+             * Records sit in a fixed array and are recycled through a free list. Client order id and exchange order id
+             * each index them through an open addressing table at most half full, probed linearly and compacted on
+             * erase, so lookups touch a couple of cache lines and nothing allocates after construction.
+             *
+             * Not synchronized, the trader only touches it from its io thread.
+             */
+            class OrderTable
+            {
+            public:
+                explicit OrderTable(size_t capacity);
+
+                size_t capacity() const { return records_.size(); }
+
+                size_t size() const { return records_.size() - free_.size(); }
+
+                /** nullptr if the table is full or the order id is already live */
+                OrderRecord *insert(uint64_t order_id, uint32_t source, int64_t last_update, int64_t trigger_time,
+                                    const msg::data::Order &order);
+
+                OrderRecord *find(uint64_t order_id);
+
+                OrderRecord *find_by_ex_order_id(uint64_t ex_order_id);
+
+                void set_ex_order_id(OrderRecord &record, uint64_t ex_order_id);
+
+                void erase(OrderRecord &record);
+
+            private:
+                static constexpr uint32_t EMPTY = UINT32_MAX;
+
+                std::vector<OrderRecord> records_;
+                std::vector<uint32_t> free_;
+                std::vector<uint32_t> by_order_id_;
+                std::vector<uint32_t> by_ex_order_id_;
+                size_t mask_;
+
+                size_t bucket(uint64_t key) const
+                { return (key * 0x9E3779B97F4A7C15ull) >> 32 & mask_; }
+
+                template<uint64_t OrderRecord::*Key>
+                size_t find_bucket(const std::vector<uint32_t> &index, uint64_t key) const;
+
+                template<uint64_t OrderRecord::*Key>
+                void index_insert(std::vector<uint32_t> &index, uint32_t slot);
+
+                template<uint64_t OrderRecord::*Key>
+                void index_erase(std::vector<uint32_t> &index, size_t bucket);
+            };
+        }
+    }
+}
+
+#endif //GODZILLA_BINANCE_EXT_ORDER_TABLE_H
@@ -0,0 +1,198 @@
+/**
+ * This is source code under the Apache License 2.0.
+ * Original Author: kx@godzilla.dev
+ * Original date: March 3, 2025
+ */
+
+#ifndef GODZILLA_BINANCE_EXT_STREAM_SHARD_H
+#define GODZILLA_BINANCE_EXT_STREAM_SHARD_H
+
+#include <map>
+#include <array>
+#include <memory>
+#include <vector>
+#include <functional>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <binapi/websocket.hpp>
+
+#include <kungfu/yijinjing/journal/journal.h>
+#include <kungfu/wingchun/common.h>
+
+#include "common.h"
+#include "latency_histogram.h"
+
+namespace kungfu {
+    namespace wingchun {
+        namespace binance {
+            /** updates of one feed leg since the last report, on the io thread of the shard */
+            struct LegStats
+            {
+                uint64_t wins = 0;      // updates published from this leg
+                uint64_t late = 0;      // copies dropped as already published from another leg
+                uint64_t lag_count = 0; // late copies still remembered by their arbiter, with lag
+                int64_t lag_sum = 0;    // ns behind the winning leg
+                int64_t lag_max = 0;
+            };
+
+            /**
+             * Arbitrates the legs of one stream by exchange sequence id, an update is published once from the leg
+             * it arrives on first. Times of the last updates are kept to tell how far behind a late copy was.
+             */
+            class FeedArbiter
+            {
+            public:
+                explicit FeedArbiter(std::vector<LegStats> &stats);
+
+                /** true for the first copy of seq, to be published, false for later ones, 0 is always published */
+                bool arrive(size_t leg, uint64_t seq);
+
+                /** callback of leg that only passes first copies of updates and errors on to cb */
+                template<typename Callback, typename Sequence>
+                static auto wrap(std::shared_ptr<FeedArbiter> arbiter, size_t leg, Callback cb, Sequence seq)
+                {
+                    return [arbiter = std::move(arbiter), leg, cb = std::move(cb), seq](
+                            const char *fl, int ec, std::string errmsg, const auto &msg) {
+                        if (not ec and not arbiter->arrive(leg, seq(msg))) {
+                            return true;
+                        }
+                        return cb(fl, ec, std::move(errmsg), msg);
+                    };
+                }
+
+            private:
+                static constexpr size_t RECENT = 16;
+
+                struct Arrival
+                {
+                    uint64_t seq;
+                    int64_t time;
+                };
+
+                std::vector<LegStats> &stats_;
+                uint64_t last_seq_;
+                std::array<Arrival, RECENT> recent_;
+                size_t next_;
+            };
+
+            /** receive time of the message in a stream callback, in ns on the clock of yijinjing */
+            int64_t receive_time();
+
+            /**
+             * Latencies of the messages one stream writes to the journal, split into wire (exchange event to
+             * receive), parse (receive to callback) and journal (callback to frame written), on the io thread of
+             * the shard.
+             */
+            class StreamLatency
+            {
+            public:
+                StreamLatency(uint32_t instrument_id, InstrumentType instrument_type, int32_t msg_type);
+
+                /** times in ns on the clock of yijinjing, exchange_time 0 for messages without one */
+                void record(int64_t exchange_time, int64_t receive_time, int64_t parse_time, int64_t write_time);
+
+                /** write latencies since the last report as MarketDataLatency, if there were messages, and start over */
+                void report(const yijinjing::journal::writer_ptr &writer, int64_t time);
+
+            private:
+                const uint32_t instrument_id_;
+                const InstrumentType instrument_type_;
+                const int32_t msg_type_;
+                int64_t begin_time_;
+                uint32_t skewed_;
+                LatencyHistogram wire_;
+                LatencyHistogram parse_;
+                LatencyHistogram journal_;
+            };
+
+            /**
+             * Market data streams of the symbols mapped to one shard, read on the io thread of the shard and written
+             * to its own journal.
+             *
+             * Streams go to binance combined stream connections, at most streams_per_connection each. Streams added
+             * close together are opened together, so a burst of subscriptions ends up on a few connections. Every
+             * connection is checked on its own and reopened with the same streams when it drops.
+             *
+             * With more than one feed leg every connection is opened once per leg, legs after the first to the
+             * alternate host when one is configured. Callbacks pass updates through a FeedArbiter, which publishes
+             * the copy arriving first and drops the others.
+             */
+            class StreamShard
+            {
+            public:
+                /** adds one stream and its callback to the streams of a connection of leg, again on every reconnect */
+                typedef std::function<void(binapi::ws::combined_streams &, size_t leg)> stream_adder;
+
+                StreamShard(size_t index, const Configuration &config, yijinjing::journal::writer_ptr writer);
+
+                size_t get_index() const
+                { return index_; }
+
+                /** only for callbacks of streams in this shard, they all run on its io thread */
+                const yijinjing::journal::writer_ptr &get_writer() const
+                { return writer_; }
+
+                boost::asio::io_context &get_io_context()
+                { return ioctx_; }
+
+                /** run io of the shard on calling thread until stop */
+                void run();
+
+                void stop();
+
+                /** thread safe, the stream is opened on the io thread of the shard */
+                void add_stream(InstrumentType type, stream_adder adder);
+
+                /** arbiter of the legs of one stream, for its callbacks on the io thread of the shard */
+                std::shared_ptr<FeedArbiter> make_arbiter();
+
+                /** thread safe, latencies of one stream reported to the journal of the shard with the check */
+                std::shared_ptr<StreamLatency> make_latency(uint32_t instrument_id, InstrumentType instrument_type, int32_t msg_type);
+
+            private:
+                struct Connection
+                {
+                    InstrumentType type;
+                    size_t leg;
+                    std::vector<stream_adder> streams;
+                    binapi::ws::websockets::handle handle;
+                };
+
+                const size_t index_;
+                const size_t streams_per_connection_;
+                yijinjing::journal::writer_ptr writer_;
+                boost::asio::io_context ioctx_;
+                boost::asio::steady_timer flush_timer_;
+                boost::asio::steady_timer check_timer_;
+                struct Leg
+                {
+                    std::shared_ptr<binapi::ws::websockets> ws_ptr;
+                    std::shared_ptr<binapi::ws::websockets> fws_ptr;
+                    std::shared_ptr<binapi::ws::websockets> dws_ptr;
+                };
+
+                std::vector<Leg> legs_;
+                std::vector<LegStats> leg_stats_;
+                int64_t leg_stats_begin_time_;
+                std::vector<std::shared_ptr<StreamLatency>> latencies_;
+                std::vector<Connection> connections_;
+                std::map<InstrumentType, std::vector<stream_adder>> pending_;
+                bool flush_scheduled_;
+
+                binapi::ws::websockets &get_websockets(InstrumentType type, size_t leg);
+
+                /** open pending streams on new connections */
+                void flush();
+
+                void open(Connection &connection);
+
+                void check();
+
+                /** write how the legs did, as FeedLegStats, and latencies of streams since the last report */
+                void report();
+            };
+        }
+    }
+}
+
+#endif //GODZILLA_BINANCE_EXT_STREAM_SHARD_H
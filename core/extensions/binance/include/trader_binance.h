@@ -7,6 +7,7 @@
 #ifndef GODZILLA_BINANCE_EXT_TRADER_H
 #define GODZILLA_BINANCE_EXT_TRADER_H
 
+#include <atomic>
 #include <iostream>
 #include <boost/asio/io_context.hpp>
 #include <kungfu/yijinjing/common.h>
@@ -14,9 +15,10 @@
 #include <binapi/websocket.hpp>
 #include <kungfu/wingchun/broker/trader.h>
 #include <binapi/api.hpp>
+#include <binapi/wsapi.hpp>
 
 #include "common.h"
-#include "order_mapper.h"
+#include "order_table.h"
 
 namespace kungfu
 {
@@ -51,8 +53,15 @@ namespace kungfu
                 void on_start() override;
                 void _check_status(kungfu::yijinjing::event_ptr);
                 void _start_userdata(const InstrumentType type);
+                void erase_order(uint64_t order_id);
+                /** looks up unconfirmed orders of one instrument type, on the io thread */
+                void resolve_unconfirmed(InstrumentType type);
+                void query_unconfirmed(const OrderRecord &record);
 
             private:
+                /** recvWindow of signed requests, binance turns away orders arriving later than this after signing */
+                static constexpr std::size_t RECV_WINDOW_MS = 10000;
+
                 Configuration config_;
                 std::string get_runtime_folder() const;
                 boost::asio::io_context ioctx_;
@@ -61,9 +70,15 @@ namespace kungfu
                 std::shared_ptr<binapi::rest::api> frest_ptr_;
                 std::shared_ptr<binapi::ws::websockets> ws_ptr_;
                 std::shared_ptr<binapi::ws::websockets> fws_ptr_;
-                std::map<std::size_t, order_map_record> order_data_;
+                std::shared_ptr<binapi::wsapi::api> wsapi_ptr_;
+                std::shared_ptr<binapi::wsapi::api> fwsapi_ptr_;
+                // owned by the io thread, insert_order hands new orders over by posting to it
+                OrderTable orders_;
+                // orders handed over and not yet erased, so insert_order can turn orders away when the table is full
+                std::atomic<size_t> open_orders_;
+                // orders whose request failed with its outcome unknown, looked up once the session is back, io thread only
+                std::vector<uint64_t> unconfirmed_;
                 std::list<std::string> listenKeys;
-                std::mutex order_mtx_;
             };
         }
     }
@@ -8,6 +8,7 @@
 #define GODZILLA_BINANCE_EXT_TYPE_CONVERT_H
 
 #include <algorithm>
+#include <chrono>
 #include <boost/algorithm/string/split.hpp>
 #include <boost/algorithm/string.hpp>
 #include <binapi/enums.hpp>
@@ -22,6 +23,18 @@ namespace kungfu
         {
             using namespace kungfu::wingchun::msg::data;
 
+            /** steady clock time point on the yijinjing clock, 0 for a time point never set */
+            inline int64_t from_steady_clock(std::chrono::steady_clock::time_point time_point)
+            {
+                if (time_point.time_since_epoch().count() == 0) {
+                    return 0;
+                }
+                // now_in_nano runs on the steady clock from a fixed start
+                static const int64_t offset = yijinjing::time::now_in_nano() -
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+                return std::chrono::duration_cast<std::chrono::nanoseconds>(time_point.time_since_epoch()).count() + offset;
+            }
+
             inline OrderType from_binance(const binapi::e_type &binance_order_type)
             {
                 if (binance_order_type == binapi::e_type::limit)
@@ -12,6 +12,7 @@
 #include <binapi/api.hpp>
 #include <binapi/invoker.hpp>
 #include <binapi/errors.hpp>
+#include <binapi/tools.hpp>
 
 #include <boost/preprocessor.hpp>
 #include <boost/callable_traits.hpp>
@@ -24,9 +25,11 @@
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/ssl/error.hpp>
 #include <boost/asio/ssl/stream.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/post.hpp>
 
 #include <chrono>
-#include <queue>
+#include <deque>
 #include <type_traits>
 #include <iostream>
 
@@ -131,6 +134,22 @@ std::string hmac_sha256(const char *key, std::size_t klen, const char *data, std
 
 /*************************************************************************************************/
 
+namespace {
+
+thread_local std::chrono::steady_clock::time_point t_sent_time{};
+
+} // anon ns
+
+std::chrono::steady_clock::time_point sent_time() {
+    return t_sent_time;
+}
+
+void set_sent_time(std::chrono::steady_clock::time_point tp) {
+    t_sent_time = tp;
+}
+
+/*************************************************************************************************/
+
 struct api::impl {
     impl(
          boost::asio::io_context &ioctx
@@ -148,11 +167,33 @@ struct api::impl {
         ,m_sk{std::move(sk)}
         ,m_timeout{timeout}
         ,m_client_api_string{std::move(client_api_string)}
-        ,m_write_in_process{}
+        ,m_signer{m_sk}
+        ,m_request_template{}
         ,m_async_requests{}
         ,m_ssl_ctx{boost::asio::ssl::context::sslv23_client}
         ,m_resolver{m_ioctx}
-    {}
+        ,m_endpoints{}
+        ,m_pool{std::make_shared<connection>()}
+        ,m_keep_alive_timer{m_ioctx}
+        ,m_ping_target{}
+        ,m_ping_interval{}
+    {
+        // headers every request carries are set once, a request starts as a copy of them
+        m_request_template.version(11);
+        m_request_template.insert("X-MBX-APIKEY", m_pk);
+        m_request_template.set(boost::beast::http::field::host, m_host);
+        m_request_template.set(boost::beast::http::field::user_agent, m_client_api_string);
+        m_request_template.set(boost::beast::http::field::content_type, "application/x-www-form-urlencoded");
+        m_request_template.keep_alive(true);
+    }
+    ~impl() {
+        m_keep_alive_timer.cancel();
+        for ( auto &conn: m_pool ) {
+            if ( conn->deadline ) {
+                conn->deadline->cancel();
+            }
+        }
+    }
 
     using val_type = boost::variant<std::size_t, const char *>;
     using kv_type = std::pair<const char *, val_type>;
@@ -231,12 +272,7 @@ struct api::impl {
             data += "&recvWindow=";
             data += to_string(buf, sizeof(buf), m_timeout);
 
-            std::string signature = hmac_sha256(
-                 m_sk.c_str()
-                ,m_sk.length()
-                ,data.c_str()
-                ,data.length()
-            );
+            std::string signature = m_signer.sign(data.c_str(), data.length());
 
             data += "&signature=";
             data += signature;
@@ -292,10 +328,16 @@ struct api::impl {
                 ,action
                 ,std::move(data)
                 ,std::make_shared<invoker_type>(std::move(cb))
+                ,false
             };
-            m_async_requests.push(std::move(item));
-
-            async_post();
+            // connections are only touched from the io_context thread, callers may be on any other
+            boost::asio::post(
+                 m_ioctx
+                ,[this, item=std::move(item)]() mutable {
+                    m_async_requests.push_back(std::move(item));
+                    async_post();
+                }
+            );
         }
 
         return res;
@@ -399,183 +441,334 @@ struct api::impl {
     using ssl_socket_ptr = std::unique_ptr<boost::asio::ssl::stream<boost::asio::ip::tcp::socket>>;
     using ssl_socket_type = typename ssl_socket_ptr::element_type;
 
-    void async_post() {
-        if ( m_write_in_process ) {
-            return;
-        }
-
-        m_write_in_process = true;
-
-        auto &front = m_async_requests.front();
-        auto action = front.action;
-        std::string data = std::move(front.data);
-        std::string target = front.target;
+    struct async_req_item {
+        std::string target;
+        boost::beast::http::verb action;
+        std::string data;
+        detail::invoker_ptr invoker; // null for keep-alive pings
+        bool retried;
+        std::chrono::steady_clock::time_point sent{};
+    };
 
-        auto req = std::make_unique<request_type>();
-        req->version(11);
-        req->method(action);
-        if ( action != boost::beast::http::verb::get ) {
-            req->body() = std::move(data);
-            req->set(boost::beast::http::field::content_length, std::to_string(req->body().length()));
-        }
+    // one TLS connection of the pool, it serves one request at a time and stays open between them
+    struct connection {
+        enum class e_state { closed, connecting, idle, busy };
 
-        req->target(target);
-        req->insert("X-MBX-APIKEY", m_pk);
-        req->set(boost::beast::http::field::host, m_host);
-        req->set(boost::beast::http::field::user_agent, m_client_api_string);
-        req->set(boost::beast::http::field::content_type, "application/x-www-form-urlencoded");
+        e_state state = e_state::closed;
+        ssl_socket_ptr stream;
+        std::unique_ptr<boost::asio::steady_timer> deadline; // of the connect or request in progress
+        bool timed_out = false;
+        boost::beast::flat_buffer buffer;
+        request_type req;
+        response_type resp;
+        async_req_item item;
+        std::size_t served = 0; // replies read since connected
+        std::chrono::steady_clock::time_point last_used;
+    };
+    using connection_ptr = std::shared_ptr<connection>;
+
+    // servers drop idle keep-alive connections after about a minute, a request written to
+    // such a connection is lost, so connections idle for longer are reconnected instead
+    static constexpr std::chrono::seconds max_idle{50};
+
+    void keep_alive(std::size_t connections, std::string ping_target, std::size_t interval_ms) {
+        boost::asio::post(
+             m_ioctx
+            ,[this, connections, ping_target=std::move(ping_target), interval_ms]() mutable {
+                while ( m_pool.size() < connections ) {
+                    m_pool.push_back(std::make_shared<connection>());
+                }
+                m_ping_target = std::move(ping_target);
+                m_ping_interval = std::chrono::milliseconds(interval_ms);
+                for ( auto &conn: m_pool ) {
+                    if ( conn->state == connection::e_state::closed ) {
+                        async_connect(conn);
+                    }
+                }
+                start_keep_alive_timer();
+            }
+        );
+    }
 
-        std::stringstream oss;
-        oss << *req;
-        SPDLOG_TRACE("async_post(): target={}, REQUEST:\n{}", target, oss.str());
+    void start_keep_alive_timer() {
+        m_keep_alive_timer.expires_after(m_ping_interval);
+        m_keep_alive_timer.async_wait(
+            [this](const boost::system::error_code &ec) {
+                if ( ec ) {
+                    return;
+                }
 
-        // Look up the domain name
-        m_resolver.async_resolve(
-             m_host
-            ,m_port
-            ,[this, req=std::move(req)]
-             (const boost::system::error_code &ec, boost::asio::ip::tcp::resolver::results_type res) mutable
-             { on_resolve(ec, std::move(req), std::move(res)); }
+                // pings keep idle connections within max_idle and ready for the next order,
+                // connections lost meanwhile are reopened before a request has to wait for them
+                const auto now = std::chrono::steady_clock::now();
+                for ( auto &conn: m_pool ) {
+                    if ( conn->state == connection::e_state::idle && now - conn->last_used >= m_ping_interval ) {
+                        async_send(conn, async_req_item{m_ping_target, boost::beast::http::verb::get, {}, {}, false});
+                    } else if ( conn->state == connection::e_state::closed ) {
+                        async_connect(conn);
+                    }
+                }
+                start_keep_alive_timer();
+            }
         );
     }
-    void on_resolve(
-         const boost::system::error_code &ec
-        ,request_ptr req
-        ,boost::asio::ip::tcp::resolver::results_type results)
-    {
-        if ( ec ) {
-            m_write_in_process = false;
-            process_reply(__MAKE_FILELINE, ec.value(), ec.message(), std::string{});
-            return;
+
+    void async_post() {
+        const auto now = std::chrono::steady_clock::now();
+        std::size_t connecting = 0;
+        for ( auto &conn: m_pool ) {
+            if ( conn->state == connection::e_state::idle && now - conn->last_used > max_idle ) {
+                close(conn);
+            }
+            if ( conn->state == connection::e_state::idle && !m_async_requests.empty() ) {
+                auto item = std::move(m_async_requests.front());
+                m_async_requests.pop_front();
+                async_send(conn, std::move(item));
+            }
+            connecting += conn->state == connection::e_state::connecting;
         }
 
-        ssl_socket_ptr ssl_socket = std::make_unique<ssl_socket_type>(m_ioctx, m_ssl_ctx);
+        // requests left wait for connections being opened, one per request
+        for ( auto &conn: m_pool ) {
+            if ( connecting >= m_async_requests.size() ) {
+                break;
+            }
+            if ( conn->state == connection::e_state::closed ) {
+                async_connect(conn);
+                ++connecting;
+            }
+        }
+    }
+
+    void async_connect(const connection_ptr &conn) {
+        conn->state = connection::e_state::connecting;
+        conn->stream = std::make_unique<ssl_socket_type>(m_ioctx, m_ssl_ctx);
+        conn->buffer.consume(conn->buffer.size());
+        conn->served = 0;
+        start_deadline(conn);
 
-        if(! SSL_set_tlsext_host_name(ssl_socket->native_handle(), m_host.c_str())) {
-            boost::system::error_code ec2{static_cast<int>(::ERR_get_error()), boost::asio::error::get_ssl_category()};
-            std::cerr << __MESSAGE("msg=" << ec2.message()) << std::endl;
+        if(! SSL_set_tlsext_host_name(conn->stream->native_handle(), m_host.c_str())) {
+            boost::system::error_code ec{static_cast<int>(::ERR_get_error()), boost::asio::error::get_ssl_category()};
+            on_connect_error(conn, __MAKE_FILELINE, ec);
 
             return;
         }
 
-        auto sptr = ssl_socket.get();
+        if ( !m_endpoints.empty() ) {
+            on_resolve(conn);
 
-        boost::asio::async_connect(
-             sptr->next_layer()
-            ,results.begin()
-            ,results.end()
-            ,[this, req=std::move(req), ssl_socket=std::move(ssl_socket)]
-             (const boost::system::error_code &ec, auto) mutable
-             { on_connect(ec, std::move(req), std::move(ssl_socket)); }
-        );
-    }
-    void on_connect(
-         const boost::system::error_code &ec
-        ,request_ptr req
-        ,ssl_socket_ptr ssl_socket)
-    {
-        if ( ec ) {
-            m_write_in_process = false;
-            process_reply(__MAKE_FILELINE, ec.value(), ec.message(), std::string{});
             return;
         }
 
-        auto sptr = ssl_socket.get();
+        // Look up the domain name, once for all connections until one fails to connect
+        m_resolver.async_resolve(
+             m_host
+            ,m_port
+            ,[this, conn](const boost::system::error_code &ec, boost::asio::ip::tcp::resolver::results_type res) {
+                if ( ec ) {
+                    on_connect_error(conn, __MAKE_FILELINE, ec);
+                } else {
+                    m_endpoints = std::move(res);
+                    on_resolve(conn);
+                }
+            }
+        );
+    }
+    void on_resolve(const connection_ptr &conn) {
+        boost::asio::async_connect(
+             conn->stream->next_layer()
+            ,m_endpoints.begin()
+            ,m_endpoints.end()
+            ,[this, conn](const boost::system::error_code &ec, auto) {
+                if ( ec ) {
+                    m_endpoints = {};
+                    on_connect_error(conn, __MAKE_FILELINE, ec);
+                } else {
+                    on_connect(conn);
+                }
+            }
+        );
+    }
+    void on_connect(const connection_ptr &conn) {
+        boost::system::error_code ec;
+        conn->stream->next_layer().set_option(boost::asio::ip::tcp::no_delay{true}, ec);
 
         // Perform the SSL handshake
-        sptr->async_handshake(
+        conn->stream->async_handshake(
              boost::asio::ssl::stream_base::client
-            ,[this, req=std::move(req), ssl_socket=std::move(ssl_socket)]
-             (const boost::system::error_code &ec) mutable
-             { on_handshake(ec, std::move(req), std::move(ssl_socket)); }
+            ,[this, conn](const boost::system::error_code &ec) {
+                if ( ec ) {
+                    on_connect_error(conn, __MAKE_FILELINE, ec);
+                } else {
+                    stop_deadline(conn);
+                    conn->state = connection::e_state::idle;
+                    conn->last_used = std::chrono::steady_clock::now();
+                    async_post();
+                }
+            }
         );
     }
-    void on_handshake(
-         const boost::system::error_code &ec
-        ,request_ptr req
-        ,ssl_socket_ptr ssl_socket)
-    {
-        if ( ec ) {
-            m_write_in_process = false;
-            process_reply(__MAKE_FILELINE, ec.value(), ec.message(), std::string{});
-            return;
+    void on_connect_error(const connection_ptr &conn, const char *fl, boost::system::error_code ec) {
+        ec = connect_error_of(conn, ec);
+        close(conn);
+        SPDLOG_WARN("{}:{} connect failed: {}", m_host, m_port, ec.message());
+
+        // the request that was waiting for this connection fails, like it did with a connection of its own
+        if ( !m_async_requests.empty() ) {
+            auto item = std::move(m_async_requests.front());
+            m_async_requests.pop_front();
+            process_reply(item, fl, ec.value(), ec.message(), std::string{});
         }
+        async_post();
+    }
 
-        auto *request_ptr = req.get();
-        auto *socket_ptr = ssl_socket.get();
+    void async_send(const connection_ptr &conn, async_req_item item) {
+        conn->state = connection::e_state::busy;
+        conn->item = std::move(item);
+        start_deadline(conn);
+
+        auto &req = conn->req;
+        req = m_request_template;
+        req.method(conn->item.action);
+        req.target(conn->item.target);
+        if ( conn->item.action != boost::beast::http::verb::get ) {
+            req.body() = std::move(conn->item.data);
+            req.set(boost::beast::http::field::content_length, std::to_string(req.body().length()));
+        }
+
+        if ( spdlog::default_logger_raw()->should_log(spdlog::level::trace) ) {
+            std::stringstream oss;
+            oss << req;
+            SPDLOG_TRACE("async_post(): target={}, REQUEST:\n{}", conn->item.target, oss.str());
+        }
 
         // Send the HTTP request to the remote host
         boost::beast::http::async_write(
-            *socket_ptr
-            ,*request_ptr
-            ,[this, req=std::move(req), ssl_socket=std::move(ssl_socket)]
-             (const boost::system::error_code &ec, std::size_t wr) mutable
-             { on_write(ec, std::move(req), std::move(ssl_socket), wr); }
+             *conn->stream
+            ,req
+            ,[this, conn](const boost::system::error_code &ec, std::size_t wr) {
+                boost::ignore_unused(wr);
+                on_write(conn, ec);
+            }
         );
     }
-    void on_write(const boost::system::error_code &ec, request_ptr req, ssl_socket_ptr ssl_socket, std::size_t wr) {
-        boost::ignore_unused(wr);
-        boost::ignore_unused(req);
-
+    void on_write(const connection_ptr &conn, const boost::system::error_code &ec) {
         if ( ec ) {
-            m_write_in_process = false;
-            process_reply(__MAKE_FILELINE, ec.value(), ec.message(), std::string{});
+            // a reused connection closed by the server, part of the request may have left already,
+            // so only idempotent queries are sent again on a new one
+            on_request_error(conn, __MAKE_FILELINE, ec,
+                conn->served > 0 && conn->item.action == boost::beast::http::verb::get);
+
             return;
         }
 
-        auto resp = std::make_unique<response_type>();
-        auto *resp_ptr = resp.get();
-        auto *socket_ptr = ssl_socket.get();
+        conn->item.sent = std::chrono::steady_clock::now();
+        conn->resp = {};
 
         // Receive the HTTP response
         boost::beast::http::async_read(
-             *socket_ptr
-            ,m_buffer
-            ,*resp_ptr
-            ,[this, resp=std::move(resp), ssl_socket=std::move(ssl_socket)]
-             (const boost::system::error_code &ec, std::size_t rd) mutable
-             { on_read(ec, std::move(resp), std::move(ssl_socket), rd); }
+             *conn->stream
+            ,conn->buffer
+            ,conn->resp
+            ,[this, conn](const boost::system::error_code &ec, std::size_t rd) {
+                boost::ignore_unused(rd);
+                on_read(conn, ec);
+            }
         );
     }
-    void on_read(const boost::system::error_code &ec, response_ptr resp, ssl_socket_ptr ssl_socket, std::size_t rd) {
-        boost::ignore_unused(rd);
-
+    void on_read(const connection_ptr &conn, const boost::system::error_code &ec) {
         if ( ec ) {
-            m_write_in_process = false;
-            process_reply(__MAKE_FILELINE, ec.value(), ec.message(), std::string{});
+            // orders may have reached the server, only idempotent queries are sent again
+            on_request_error(conn, __MAKE_FILELINE, ec,
+                conn->served > 0 && conn->item.action == boost::beast::http::verb::get);
+
             return;
         }
 
-        auto *socket_ptr = ssl_socket.get();
+        stop_deadline(conn);
+        ++conn->served;
+        conn->last_used = std::chrono::steady_clock::now();
+        auto item = std::move(conn->item);
+        std::string body = std::move(conn->resp.body());
+        if ( conn->resp.keep_alive() ) {
+            conn->state = connection::e_state::idle;
+        } else {
+            close(conn);
+        }
 
-        socket_ptr->async_shutdown(
-            [this, resp=std::move(resp), ssl_socket=std::move(ssl_socket)]
-            (const boost::system::error_code &ec) mutable
-            { on_shutdown(ec, std::move(resp), std::move(ssl_socket)); }
-        );
+        process_reply(item, __MAKE_FILELINE, 0, std::string{}, std::move(body));
+        async_post();
+    }
+    void on_request_error(const connection_ptr &conn, const char *fl, boost::system::error_code ec, bool retry) {
+        const bool timed_out = conn->timed_out;
+        auto item = std::move(conn->item);
+        close(conn);
+
+        if ( timed_out ) {
+            // not sent again, its caller has waited long enough, and like a wsapi request without
+            // a reply it may or may not have reached binance
+            process_reply(item, fl, static_cast<int>(e_error::TIMEOUT), "no reply within the receive window", std::string{});
+        } else if ( retry && !item.retried && item.invoker ) {
+            item.retried = true;
+            m_async_requests.push_front(std::move(item));
+        } else {
+            process_reply(item, fl, ec.value(), ec.message(), std::string{});
+        }
+        async_post();
     }
-    void on_shutdown(const boost::system::error_code &ec, response_ptr resp, ssl_socket_ptr ssl_socket) {
-        boost::ignore_unused(ec);
-        boost::ignore_unused(ssl_socket);
 
-        std::string body = std::move(resp->body());
-        process_reply(__MAKE_FILELINE, 0, std::string{}, std::move(body));
+    // connect and request both have m_timeout milliseconds, the receive window of signed requests,
+    // closing the socket then aborts whatever is in progress. a connect out of time fails the
+    // request waiting for it with timed_out, a request out of time fails with e_error::TIMEOUT
+    void start_deadline(const connection_ptr &conn) {
+        if ( !conn->deadline ) {
+            conn->deadline = std::make_unique<boost::asio::steady_timer>(m_ioctx);
+        }
+        conn->timed_out = false;
+        conn->deadline->expires_after(std::chrono::milliseconds(m_timeout));
+        conn->deadline->async_wait(
+            [conn](const boost::system::error_code &ec) {
+                // stopped or restarted meanwhile
+                if ( ec || conn->deadline->expiry() > std::chrono::steady_clock::now() ) {
+                    return;
+                }
 
-        m_write_in_process = false;
+                conn->timed_out = true;
+                boost::system::error_code ignored;
+                conn->stream->lowest_layer().close(ignored);
+            }
+        );
+    }
+    void stop_deadline(const connection_ptr &conn) {
+        conn->deadline->expires_at(boost::asio::steady_timer::time_point::max());
+    }
+    static boost::system::error_code connect_error_of(const connection_ptr &conn, const boost::system::error_code &ec) {
+        return conn->timed_out ? boost::system::error_code{boost::asio::error::timed_out} : ec;
+    }
 
-        if ( !m_async_requests.empty() ) {
-            async_post();
+    void close(const connection_ptr &conn) {
+        conn->state = connection::e_state::closed;
+        if ( conn->deadline ) {
+            stop_deadline(conn);
+        }
+        if ( conn->stream ) {
+            boost::system::error_code ec;
+            conn->stream->lowest_layer().close(ec);
         }
     }
 
-    void process_reply(const char *fl, int ec, std::string errmsg, std::string body) {
-        assert(!m_async_requests.empty());
+    void process_reply(const async_req_item &item, const char *fl, int ec, std::string errmsg, std::string body) {
+        if ( !item.invoker ) {
+            if ( ec ) {
+                SPDLOG_WARN("{}:{} keep-alive ping failed: {}", m_host, m_port, errmsg);
+            }
+
+            return;
+        }
 
         __TRY_BLOCK() {
-            const auto item = std::move(m_async_requests.front());
-            m_async_requests.pop();
-
             SPDLOG_TRACE("process_reply(): target={}, recv buf={}", item.target, body);
+            set_sent_time(item.sent);
             item.invoker->invoke(fl, ec, std::move(errmsg), body.c_str(), body.size());
         } __CATCH_BLOCK(
             std::cout,
@@ -590,18 +783,17 @@ struct api::impl {
     const std::string m_sk;
     const std::size_t m_timeout;
     const std::string m_client_api_string;
+    const hmac_sha256_key m_signer;
+    request_type m_request_template;
 
-    bool m_write_in_process;
-    struct async_req_item {
-        std::string target;
-        boost::beast::http::verb action;
-        std::string data;
-        detail::invoker_ptr invoker;
-    };
-    std::queue<async_req_item> m_async_requests;
+    std::deque<async_req_item> m_async_requests;
     boost::asio::ssl::context m_ssl_ctx;
     boost::asio::ip::tcp::resolver m_resolver;
-    boost::beast::flat_buffer m_buffer; // (Must persist between reads)
+    boost::asio::ip::tcp::resolver::results_type m_endpoints;
+    std::vector<connection_ptr> m_pool;
+    boost::asio::steady_timer m_keep_alive_timer;
+    std::string m_ping_target;
+    std::chrono::milliseconds m_ping_interval;
 };
 
 /*************************************************************************************************/
@@ -629,6 +821,10 @@ api::api(
 api::~api()
 {}
 
+void api::keep_alive(std::size_t connections, const char *ping_target, std::size_t interval_ms) {
+    return pimpl->keep_alive(connections, ping_target, interval_ms);
+}
+
 /*************************************************************************************************/
 
 api::result<ping_t> api::ping(ping_cb cb) {
@@ -17,6 +17,12 @@
 #include <boost/algorithm/string/join.hpp>
 #include <boost/algorithm/string/trim.hpp>
 
+#include <openssl/evp.h>
+#include <openssl/sha.h>
+
+#include <cstring>
+#include <memory>
+
 namespace binapi {
 
 /*************************************************************************************************/
@@ -117,4 +123,53 @@ bool is_my_orderid(const std::string &client_order_id) {
 
 /*************************************************************************************************/
 
+hmac_sha256_key::hmac_sha256_key(const std::string &key)
+    :m_inner{::EVP_MD_CTX_new()}
+    ,m_outer{::EVP_MD_CTX_new()}
+{
+    std::uint8_t block[SHA256_CBLOCK] = {};
+    if ( key.length() > sizeof(block) ) {
+        ::SHA256(reinterpret_cast<const std::uint8_t *>(key.data()), key.length(), block);
+    } else {
+        std::memcpy(block, key.data(), key.length());
+    }
+
+    std::uint8_t pad[SHA256_CBLOCK];
+    for ( std::size_t i = 0; i < sizeof(pad); ++i ) { pad[i] = block[i] ^ 0x36; }
+    ::EVP_DigestInit_ex(m_inner, ::EVP_sha256(), nullptr);
+    ::EVP_DigestUpdate(m_inner, pad, sizeof(pad));
+    for ( std::size_t i = 0; i < sizeof(pad); ++i ) { pad[i] = block[i] ^ 0x5c; }
+    ::EVP_DigestInit_ex(m_outer, ::EVP_sha256(), nullptr);
+    ::EVP_DigestUpdate(m_outer, pad, sizeof(pad));
+}
+
+hmac_sha256_key::~hmac_sha256_key() {
+    ::EVP_MD_CTX_free(m_inner);
+    ::EVP_MD_CTX_free(m_outer);
+}
+
+std::string hmac_sha256_key::sign(const char *data, std::size_t dlen) const {
+    static thread_local std::unique_ptr<EVP_MD_CTX, decltype(&::EVP_MD_CTX_free)> ctx{::EVP_MD_CTX_new(), &::EVP_MD_CTX_free};
+
+    std::uint8_t digest[EVP_MAX_MD_SIZE];
+    std::uint32_t dilen{};
+    ::EVP_MD_CTX_copy_ex(ctx.get(), m_inner);
+    ::EVP_DigestUpdate(ctx.get(), data, dlen);
+    ::EVP_DigestFinal_ex(ctx.get(), digest, &dilen);
+    ::EVP_MD_CTX_copy_ex(ctx.get(), m_outer);
+    ::EVP_DigestUpdate(ctx.get(), digest, dilen);
+    ::EVP_DigestFinal_ex(ctx.get(), digest, &dilen);
+
+    static const char hex[] = "0123456789abcdef";
+    std::string res(dilen * 2, '\0');
+    for ( std::uint32_t i = 0; i < dilen; ++i ) {
+        res[i * 2] = hex[(digest[i] >> 4) & 0x0F];
+        res[i * 2 + 1] = hex[digest[i] & 0x0F];
+    }
+
+    return res;
+}
+
+/*************************************************************************************************/
+
 } // ns binapi
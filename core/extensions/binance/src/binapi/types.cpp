@@ -24,6 +24,11 @@ namespace binapi {
 template<typename T>
 typename std::enable_if<std::is_integral<T>::value>::type
 __get_json(T &v, const char *member, const flatjson::fjson &j) {
+    // optional fields like E and T of spot depth are missing from every message, throwing for them costs microseconds
+    if ( !j.contains(member) ) {
+        v = 0;
+        return;
+    }
     try {
     v = j.at(member).to<T>();
     } catch (const std::exception &ex) {
@@ -35,7 +40,12 @@ template<typename T>
 typename std::enable_if<std::is_same<T, std::string>::value>::type
 __get_json(T &v, const char *member, const flatjson::fjson &j) {
     const auto &o = j.at(member);
-    v = (o.is_null() ? std::string{} : o.to_string());
+    if ( o.is_null() ) {
+        v.clear();
+    } else {
+        const auto str = o.to_sstring();
+        v.assign(str.data(), str.size());
+    }
 }
 
 template<typename T>
@@ -44,6 +54,45 @@ __get_json(T &v, const char *member, const flatjson::fjson &j) {
     v.assign(j.at(member).to_string());
 }
 
+// parses in place, falls back to a multiprecision parse only for decimals fixed_type can not hold exactly
+inline fixed_type __get_fixed(const flatjson::fjson::element_type &tok) {
+    fixed_type v{};
+    const auto str = tok.to_sstring();
+    if ( !fixed_type::parse(str.data(), str.size(), v) ) {
+        static const double_type scale(fixed_type::scale);
+        double_type d;
+        d.assign(tok.to_string());
+        v.units = double_type(d * scale).convert_to<std::int64_t>();
+    }
+
+    return v;
+}
+
+inline fixed_type __get_fixed(const flatjson::fjson &j) {
+    return __get_fixed(*j.begin().operator->());
+}
+
+// [[price, amount], ...] in one pass over the tokens, at(idx) walks the array from its start for every level
+template<typename Depth>
+void __get_depths(std::vector<Depth> &res, const flatjson::fjson &levels) {
+    res.clear();
+    res.reserve(levels.size());
+    const auto *arr = levels.begin().operator->();
+    for ( const auto *it = arr + 1; it < arr->end(); it = it->end() + 1 ) {
+        assert(it->type() == flatjson::FJ_TYPE_ARRAY);
+        Depth item{};
+        item.price = __get_fixed(it[1]);
+        item.amount = __get_fixed(it[2]);
+        res.push_back(item);
+    }
+}
+
+template<typename T>
+typename std::enable_if<std::is_same<T, fixed_type>::value>::type
+__get_json(T &v, const char *member, const flatjson::fjson &j) {
+    v = __get_fixed(j.at(member));
+}
+
 #define __BINAPI_GET2(obj, member, json) \
     __get_json(obj.member, #member, json)
 
@@ -1614,9 +1663,15 @@ namespace ws {
 
 
 agg_trade_t agg_trade_t::construct(const flatjson::fjson &json) {
+    agg_trade_t res{};
+    construct(json, res);
+
+    return res;
+}
+
+void agg_trade_t::construct(const flatjson::fjson &json, agg_trade_t &res) {
     assert(json.is_valid());
 
-    agg_trade_t res{};
     __BINAPI_GET(e);
     __BINAPI_GET(E);
     __BINAPI_GET(s);
@@ -1628,8 +1683,6 @@ agg_trade_t agg_trade_t::construct(const flatjson::fjson &json) {
     __BINAPI_GET(T);
     __BINAPI_GET(m);
     // __BINAPI_GET(M);
-
-    return res;
 }
 
 std::ostream &operator<<(std::ostream &os, const agg_trade_t &o) {
@@ -1654,9 +1707,15 @@ std::ostream &operator<<(std::ostream &os, const agg_trade_t &o) {
 /*************************************************************************************************/
 
 trade_t trade_t::construct(const flatjson::fjson &json) {
+    trade_t res{};
+    construct(json, res);
+
+    return res;
+}
+
+void trade_t::construct(const flatjson::fjson &json, trade_t &res) {
     assert(json.is_valid());
 
-    trade_t res{};
     __BINAPI_GET(E);
     __BINAPI_GET(s);
     __BINAPI_GET(t);
@@ -1667,8 +1726,6 @@ trade_t trade_t::construct(const flatjson::fjson &json) {
     __BINAPI_GET(T);
     __BINAPI_GET(m);
     __BINAPI_GET(M);
-
-    return res;
 }
 
 std::ostream &operator<<(std::ostream &os, const trade_t &o) {
@@ -1697,36 +1754,32 @@ std::ostream &operator<<(std::ostream &os, const part_depths_t::depth_t &o) {
 }
 
 part_depths_t part_depths_t::construct(const flatjson::fjson &json) {
+    part_depths_t res{};
+    construct(json, res);
+
+    return res;
+}
+
+void part_depths_t::construct(const flatjson::fjson &json, part_depths_t &res) {
     assert(json.is_valid());
 
-    part_depths_t res{};
     __BINAPI_GET(E);
     __BINAPI_GET(T);
-    flatjson::fjson a;
-    flatjson::fjson b;
-    if (json.contains("asks")) {
-        a = json.at("asks");
-        b = json.at("bids");
-    } else if (json.contains("a")) {
-        a = json.at("a");
-        b = json.at("b");
-    }
-    for ( auto idx = 0u; idx < a.size(); ++idx ) {
-        part_depths_t::depth_t item{};
-        const auto it = a.at(idx);
-        item.price.assign(it.at(0).to_string());
-        item.amount.assign(it.at(1).to_string());
-        res.a.push_back(std::move(item));
+    __BINAPI_GET(u);
+    if ( !res.u ) {
+        __get_json(res.u, "lastUpdateId", json);
     }
-    for ( auto idx = 0u; idx < b.size(); ++idx ) {
-        part_depths_t::depth_t item{};
-        const auto it = b.at(idx);
-        item.price.assign(it.at(0).to_string());
-        item.amount.assign(it.at(1).to_string());
-        res.b.push_back(std::move(item));
+    // spot names the sides asks/bids, futures a/b
+    if ( json.contains("asks") ) {
+        __get_depths(res.a, json.at("asks"));
+        __get_depths(res.b, json.at("bids"));
+    } else if ( json.contains("a") ) {
+        __get_depths(res.a, json.at("a"));
+        __get_depths(res.b, json.at("b"));
+    } else {
+        res.a.clear();
+        res.b.clear();
     }
-
-    return res;
 }
 
 std::ostream& operator<<(std::ostream &os, const part_depths_t &o) {
@@ -1788,33 +1841,21 @@ std::ostream &operator<<(std::ostream &os, const diff_depths_t::depth_t &o) {
 }
 
 diff_depths_t diff_depths_t::construct(const flatjson::fjson &json) {
+    diff_depths_t res{};
+    construct(json, res);
+
+    return res;
+}
+
+void diff_depths_t::construct(const flatjson::fjson &json, diff_depths_t &res) {
     assert(json.is_valid());
 
-    diff_depths_t res{};
     __BINAPI_GET(E);
     __BINAPI_GET(s);
     __BINAPI_GET(u);
     __BINAPI_GET(U);
-    const auto a = json.at("a");
-    for ( auto idx = 0u; idx < a.size(); ++idx ) {
-        diff_depths_t::depth_t item{};
-        const auto it = a.at(idx);
-        item.price.assign(it.at(0).to_string());
-        item.amount.assign(it.at(1).to_string());
-
-        res.a.push_back(std::move(item));
-    }
-    const auto b = json.at("b");
-    for ( auto idx = 0u; idx < b.size(); ++idx ) {
-        diff_depths_t::depth_t item{};
-        const auto it = b.at(idx);
-        item.price.assign(it.at(0).to_string());
-        item.amount.assign(it.at(1).to_string());
-
-        res.b.push_back(std::move(item));
-    }
-
-    return res;
+    __get_depths(res.a, json.at("a"));
+    __get_depths(res.b, json.at("b"));
 }
 
 std::ostream& operator<<(std::ostream &os, const diff_depths_t &o) {
@@ -2091,9 +2132,15 @@ std::ostream& operator<<(std::ostream &os, const markets_tickers_t &o) {
 /*************************************************************************************************/
 
 book_ticker_t book_ticker_t::construct(const flatjson::fjson &json) {
+    book_ticker_t res{};
+    construct(json, res);
+
+    return res;
+}
+
+void book_ticker_t::construct(const flatjson::fjson &json, book_ticker_t &res) {
     assert(json.is_valid());
 
-    book_ticker_t res{};
     __BINAPI_GET(u);
     __BINAPI_GET(s);
     __BINAPI_GET(b);
@@ -2102,8 +2149,6 @@ book_ticker_t book_ticker_t::construct(const flatjson::fjson &json) {
     __BINAPI_GET(A);
     __BINAPI_GET(E);
     __BINAPI_GET(T);
-
-    return res;
 }
 
 std::ostream& operator<<(std::ostream &os, const book_ticker_t &o) {
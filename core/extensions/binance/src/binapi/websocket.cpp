@@ -33,6 +33,7 @@
 #include <list>
 #include <map>
 #include <set>
+#include <unordered_map>
 #include <cstring>
 #include <spdlog/spdlog.h>
 
@@ -48,6 +49,12 @@ struct websockets;
 
 /*************************************************************************************************/
 
+static thread_local std::chrono::steady_clock::time_point g_receive_time;
+
+std::chrono::steady_clock::time_point receive_time() { return g_receive_time; }
+
+/*************************************************************************************************/
+
 struct websocket: std::enable_shared_from_this<websocket> {
     friend struct websockets;
 
@@ -149,6 +156,9 @@ private:
 
             return;
         }
+        // asio lets openssl free the 16k record buffer whenever it is drained,
+        // which costs a malloc and a free per message on a busy stream
+        SSL_clear_mode(m_ws.next_layer().native_handle(), SSL_MODE_RELEASE_BUFFERS);
 
         boost::asio::async_connect(
              m_ws.next_layer().next_layer()
@@ -218,6 +228,7 @@ private:
         );
     }
     void on_read(boost::system::error_code ec, std::size_t rd, on_message_received_cb cb, holder_type holder) {
+        g_receive_time = std::chrono::steady_clock::now();
         if ( ec ) {
             if ( !m_stop_requested ) {
                 __BINAPI_CB_ON_ERROR(cb, ec);
@@ -229,15 +240,11 @@ private:
         auto size = m_buf.size();
         assert(size == rd);
 
-        std::string strbuf;
-        strbuf.reserve(size);
-        for ( const auto &it: m_buf.data() ) {
-            strbuf.append(static_cast<const char *>(it.data()), it.size());
-        }
-        m_buf.consume(m_buf.size());
-
-        SPDLOG_TRACE("websocket recv buf: {}", strbuf);
-        bool ok = cb(nullptr, 0, std::string{}, strbuf.data(), strbuf.size());
+        // flat buffer holds the message contiguously, handed out as is and reused by the next read
+        const char *ptr = static_cast<const char *>(m_buf.data().data());
+        SPDLOG_TRACE("websocket recv buf: {}", fmt::string_view(ptr, size));
+        bool ok = cb(nullptr, 0, std::string{}, ptr, size);
+        m_buf.consume(size);
         if ( !ok ) {
             stop();
         } else {
@@ -249,7 +256,7 @@ private:
     boost::asio::ssl::context m_ssl;
     boost::asio::ip::tcp::resolver m_resolver;
     boost::beast::websocket::stream<boost::asio::ssl::stream<boost::asio::ip::tcp::socket>> m_ws;
-    boost::beast::multi_buffer m_buf;
+    boost::beast::flat_buffer m_buf;
     std::string m_host;
     std::string m_target;
     bool m_stop_requested;
@@ -259,6 +266,128 @@ private:
     std::chrono::steady_clock::time_point start_time_;
 };
 
+template<typename T, typename = void>
+struct has_construct_in_place: std::false_type {};
+
+template<typename T>
+struct has_construct_in_place<
+     T
+    ,decltype(T::construct(std::declval<const flatjson::fjson &>(), std::declval<T &>()))
+>: std::true_type {};
+
+// builds the message of one stream from its parsed json and hands it to the user callback, json is null on error
+using stream_handler = std::function<bool(const char *fl, int ec, std::string errmsg, const flatjson::fjson *json)>;
+
+template<typename F>
+stream_handler make_stream_handler(F cb) {
+    using args_tuple = typename boost::callable_traits::args<F>::type;
+    using message_type = typename std::decay<typename std::tuple_element<3, args_tuple>::type>::type;
+
+    // message lives as long as the stream, so steady state messages are built without allocating
+    return [cb=std::move(cb), message=message_type{}]
+        (const char *fl, int ec, std::string errmsg, const flatjson::fjson *json) mutable -> bool
+    {
+        if ( ec ) {
+            try {
+                cb(fl, ec, std::move(errmsg), message_type{});
+            } catch (const std::exception &ex) {
+                std::fprintf(stderr, "%s: %s\n", __MAKE_FILELINE, ex.what());
+                std::fflush(stderr);
+            }
+
+            return false;
+        }
+
+        if ( json->is_object() && binapi::rest::is_api_error(*json) ) {
+            auto error = binapi::rest::construct_error(*json);
+            auto ecode = error.first;
+            auto emsg  = std::move(error.second);
+
+            try {
+                return cb(__MAKE_FILELINE, ecode, std::move(emsg), message_type{});
+            } catch (const std::exception &ex) {
+                std::fprintf(stderr, "%s: %s\n", __MAKE_FILELINE, ex.what());
+                std::fflush(stderr);
+            }
+        }
+
+        try {
+            if constexpr ( has_construct_in_place<message_type>::value ) {
+                message_type::construct(*json, message);
+                return cb(fl, ec, std::move(errmsg), message);
+            } else {
+                return cb(fl, ec, std::move(errmsg), message_type::construct(*json));
+            }
+        } catch (const std::exception &ex) {
+            std::fprintf(stderr, "%s: %s\n", __MAKE_FILELINE, ex.what());
+            std::fflush(stderr);
+        }
+
+        return false;
+    };
+}
+
+static std::string part_depth_channel(e_levels level, e_freq freq) {
+    std::string ch = "depth";
+    ch += std::to_string(static_cast<std::size_t>(level));
+    ch += "@";
+    ch += std::to_string(static_cast<std::size_t>(freq)) + "ms";
+    return ch;
+}
+
+static std::string diff_depth_channel(e_freq freq) {
+    return "depth@" + std::to_string(static_cast<std::size_t>(freq)) + "ms";
+}
+
+/*************************************************************************************************/
+
+struct combined_streams::impl {
+    struct stream {
+        std::string name;
+        stream_handler handler;
+    };
+
+    template<typename F>
+    void add(const char *pair, const std::string &channel, F cb) {
+        std::string name{pair};
+        boost::algorithm::to_lower(name);
+        name += '@';
+        name += channel;
+        m_streams.push_back({std::move(name), make_stream_handler(std::move(cb))});
+    }
+
+    std::vector<stream> m_streams;
+};
+
+combined_streams::combined_streams()
+    :pimpl{std::make_unique<impl>()}
+{}
+
+combined_streams::~combined_streams()
+{}
+
+combined_streams::combined_streams(combined_streams &&) noexcept = default;
+combined_streams& combined_streams::operator= (combined_streams &&) noexcept = default;
+
+void combined_streams::part_depth(const char *pair, e_levels level, e_freq freq, websockets::on_part_depths_received_cb cb)
+{ pimpl->add(pair, part_depth_channel(level, freq), std::move(cb)); }
+
+void combined_streams::diff_depth(const char *pair, e_freq freq, websockets::on_diff_depths_received_cb cb)
+{ pimpl->add(pair, diff_depth_channel(freq), std::move(cb)); }
+
+void combined_streams::trade(const char *pair, websockets::on_trade_received_cb cb)
+{ pimpl->add(pair, "trade", std::move(cb)); }
+
+void combined_streams::agg_trade(const char *pair, websockets::on_agg_trade_received_cb cb)
+{ pimpl->add(pair, "aggTrade", std::move(cb)); }
+
+void combined_streams::book(const char *pair, websockets::on_book_received_cb cb)
+{ pimpl->add(pair, "bookTicker", std::move(cb)); }
+
+std::size_t combined_streams::size() const { return pimpl->m_streams.size(); }
+
+/*************************************************************************************************/
+
 struct websocket_id_getter {
     using type = const void *;
     type operator()(const websocket &sock) const { return std::addressof(sock); }
@@ -295,12 +424,8 @@ struct websockets::impl {
         return res;
     }
 
-    template<typename F>
-    websockets::handle start_channel(const char *pair, const char *channel, F cb) {
-        using args_tuple = typename boost::callable_traits::args<F>::type;
-        using message_type = typename std::tuple_element<3, args_tuple>::type;
-
-        static const auto deleter = [this](websocket *ws) {
+    websockets::handle start(const std::string &target, websocket::on_message_received_cb wscb) {
+        auto deleter = [this](websocket *ws) {
             SPDLOG_WARN("delete websocket: {}", fmt::ptr(ws));
             auto it = m_set.find(ws);
             if ( it != m_set.end() ) {
@@ -310,35 +435,40 @@ struct websockets::impl {
             m_reconnected = true;
         };
         std::shared_ptr<websocket> ws{new websocket(m_ioctx), deleter};
+
+        auto *ptr = ws.get();
+        SPDLOG_TRACE("m_host: {}, m_port: {}, target: {}", m_host, m_port, target);
+        ptr->start(
+             m_host
+            ,m_port
+            ,target
+            ,std::move(wscb)
+            ,std::move(ws)
+        );
+
+        m_set.insert(ptr);
+
+        SPDLOG_DEBUG("handle in WS: {}", fmt::ptr(ptr));
+        return ptr;
+    }
+
+    template<typename F>
+    websockets::handle start_channel(const char *pair, const char *channel, F cb) {
         std::string schannel = make_channel_name(pair, channel);
 
-        auto wscb = [this, schannel, cb=std::move(cb)]
-            (const char *fl, int ec, std::string errmsg, const char *ptr, std::size_t size) -> bool
+        // tokens live as long as the channel, so steady state messages are parsed without allocating
+        auto wscb = [this, schannel, handler=make_stream_handler(std::move(cb)), json=flatjson::fjson{}]
+            (const char *fl, int ec, std::string errmsg, const char *ptr, std::size_t size) mutable -> bool
         {
             if ( ec ) {
-                try {
-                    cb(fl, ec, std::move(errmsg), message_type{});
-                } catch (const std::exception &ex) {
-                    std::fprintf(stderr, "%s: %s\n", __MAKE_FILELINE, ex.what());
-                    std::fflush(stderr);
-                }
-
-                return false;
+                return handler(fl, ec, std::move(errmsg), nullptr);
             }
 
-            const flatjson::fjson json{ptr, size};
-            if ( json.is_object() && binapi::rest::is_api_error(json) ) {
-                auto error = binapi::rest::construct_error(json);
-                auto ecode = error.first;
-                auto emsg  = std::move(error.second);
-
-                try {
-                    message_type message{};
-                    return cb(__MAKE_FILELINE, ecode, std::move(emsg), std::move(message));
-                } catch (const std::exception &ex) {
-                    std::fprintf(stderr, "%s: %s\n", __MAKE_FILELINE, ex.what());
-                    std::fflush(stderr);
-                }
+            if ( !json.reload(ptr, size) ) {
+                std::fprintf(stderr, "%s: %s\n", __MAKE_FILELINE, json.error_string());
+                std::fflush(stderr);
+
+                return false;
             }
 
             try {
@@ -348,31 +478,66 @@ struct websockets::impl {
                 std::fflush(stderr);
             }
 
+            return handler(fl, ec, std::move(errmsg), &json);
+        };
+
+        return start(schannel, std::move(wscb));
+    }
+
+    websockets::handle start_combined(combined_streams streams) {
+        auto &list = streams.pimpl->m_streams;
+        std::string target{"/stream?streams="};
+        // stream names are looked up by hash, names are compared only on a hit
+        std::unordered_map<std::uint32_t, std::size_t> index;
+        for ( std::size_t i = 0; i < list.size(); ++i ) {
+            if ( i > 0 ) {
+                target += '/';
+            }
+            target += list[i].name;
+            index.emplace(fnv1a(list[i].name.data(), list[i].name.size()), i);
+        }
+
+        auto wscb = [this, list=std::move(list), index=std::move(index), json=flatjson::fjson{}]
+            (const char *fl, int ec, std::string errmsg, const char *ptr, std::size_t size) mutable -> bool
+        {
+            if ( ec ) {
+                for ( auto &stream: list ) {
+                    stream.handler(fl, ec, errmsg, nullptr);
+                }
+
+                return false;
+            }
+
+            if ( !json.reload(ptr, size) ) {
+                std::fprintf(stderr, "%s: %s\n", __MAKE_FILELINE, json.error_string());
+                std::fflush(stderr);
+
+                return false;
+            }
+            // messages are {"stream":"<name>","data":{...}}, anything else is a reply to a request
+            if ( !json.is_object() || !json.contains("stream") || !json.contains("data") ) {
+                SPDLOG_DEBUG("combined stream message without stream: {}", fmt::string_view(ptr, size));
+                return true;
+            }
+            const auto name = json.at("stream").to_sstring();
+            auto it = index.find(fnv1a(name.data(), name.size()));
+            if ( it == index.end() || list[it->second].name.compare(0, std::string::npos, name.data(), name.size()) != 0 ) {
+                SPDLOG_WARN("unknown combined stream: {}", fmt::string_view(name.data(), name.size()));
+                return true;
+            }
+
             try {
-                message_type message = message_type::construct(json);
-                return cb(fl, ec, std::move(errmsg), std::move(message));
+                if ( m_on_message ) { m_on_message(list[it->second].name.c_str(), ptr, size); }
             } catch (const std::exception &ex) {
                 std::fprintf(stderr, "%s: %s\n", __MAKE_FILELINE, ex.what());
                 std::fflush(stderr);
             }
 
-            return false;
+            const auto data = json.at("data");
+            return list[it->second].handler(fl, ec, std::move(errmsg), &data);
         };
 
-        auto *ptr = ws.get();
-	    SPDLOG_TRACE("m_host: {}, m_port: {}, schannel: {}", m_host, m_port, schannel);
-        ptr->start(
-             m_host
-            ,m_port
-            ,schannel
-            ,std::move(wscb)
-            ,std::move(ws)
-        );
-
-        m_set.insert(ptr);
-
-        SPDLOG_DEBUG("handle in WS: {}", fmt::ptr(ptr));
-        return ptr;
+        return start(target, std::move(wscb));
     }
 
     template<typename F>
@@ -439,26 +604,17 @@ websockets::~websockets()
 /*************************************************************************************************/
 
 websockets::handle websockets::part_depth(const char *pair, e_levels level, e_freq freq, on_part_depths_received_cb cb) {
-    std::string ch = "depth";
-    ch += std::to_string(static_cast<std::size_t>(level));
-    ch += "@";
-    ch += std::to_string(static_cast<std::size_t>(freq)) + "ms";
-    return pimpl->start_channel(pair, ch.c_str(), std::move(cb));
+    return pimpl->start_channel(pair, part_depth_channel(level, freq).c_str(), std::move(cb));
 }
 
 websockets::handle websockets::future_part_depth(const char *pair, e_levels level, e_freq freq, on_part_depths_received_cb cb) {
-    std::string ch = "depth";
-    ch += std::to_string(static_cast<std::size_t>(level));
-    ch += "@";
-    ch += std::to_string(static_cast<std::size_t>(freq)) + "ms";
-    return pimpl->start_channel(pair, ch.c_str(), std::move(cb));
+    return pimpl->start_channel(pair, part_depth_channel(level, freq).c_str(), std::move(cb));
 }
 
 /*************************************************************************************************/
 
 websockets::handle websockets::diff_depth(const char *pair, e_freq freq, on_diff_depths_received_cb cb) {
-    std::string ch = "depth@" + std::to_string(static_cast<std::size_t>(freq)) + "ms";
-    return pimpl->start_channel(pair, ch.c_str(), std::move(cb));
+    return pimpl->start_channel(pair, diff_depth_channel(freq).c_str(), std::move(cb));
 }
 
 /*************************************************************************************************/
@@ -635,6 +791,11 @@ websockets::handle websockets::future_order_data(
 
 /*************************************************************************************************/
 
+websockets::handle websockets::combined(combined_streams streams)
+{ return pimpl->start_combined(std::move(streams)); }
+
+/*************************************************************************************************/
+
 void websockets::unsubscribe(const handle &h) { return pimpl->stop_channel(h); }
 void websockets::async_unsubscribe(const handle &h) { return pimpl->async_stop_channel(h); }
 
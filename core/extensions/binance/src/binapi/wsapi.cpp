@@ -0,0 +1,663 @@
+// ----------------------------------------------------------------------------
+//                              Apache License
+//                        Version 2.0, January 2004
+//                     http://www.apache.org/licenses/
+//
+// This file is part of binapi(https://github.com/niXman/binapi) project.
+//
+// Copyright (c) 2019-2021 niXman (github dot nixman dog pm.me). All rights reserved.
+// ----------------------------------------------------------------------------
+
+#include <binapi/wsapi.hpp>
+#include <binapi/message.hpp>
+#include <binapi/flatjson.hpp>
+#include <binapi/errors.hpp>
+#include <binapi/tools.hpp>
+
+#include <boost/variant.hpp>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/connect.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/ssl/stream.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/post.hpp>
+
+#include <boost/beast/core.hpp>
+#include <boost/beast/websocket.hpp>
+#include <boost/beast/websocket/ssl.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+#include <spdlog/spdlog.h>
+
+using namespace std::chrono_literals;
+
+namespace binapi {
+namespace wsapi {
+
+/*************************************************************************************************/
+
+struct api::impl {
+    using stream_type = boost::beast::websocket::stream<boost::asio::ssl::stream<boost::asio::ip::tcp::socket>>;
+    // 'result' is only valid during the call, nullptr on error
+    using reply_cb = std::function<void(const char *fl, int ec, std::string errmsg, const flatjson::fjson *result)>;
+
+    using val_type = boost::variant<std::size_t, const char *>;
+    using kv_type = std::pair<const char *, val_type>;
+    using init_list_type = std::initializer_list<kv_type>;
+
+    impl(
+         boost::asio::io_context &ioctx
+        ,std::string host
+        ,std::string port
+        ,std::string target
+        ,std::string pk
+        ,std::string sk
+        ,std::size_t timeout
+        ,std::shared_ptr<rest::api> fallback
+    )
+        :m_ioctx{ioctx}
+        ,m_host{std::move(host)}
+        ,m_port{std::move(port)}
+        ,m_target{std::move(target)}
+        ,m_pk{std::move(pk)}
+        ,m_signer{sk}
+        ,m_timeout{timeout}
+        ,m_fallback{std::move(fallback)}
+        ,m_seq{}
+        ,m_connected{false}
+        ,m_stop_requested{true}
+        ,m_session{}
+        ,m_ssl_ctx{boost::asio::ssl::context::sslv23_client}
+        ,m_resolver{m_ioctx}
+        ,m_ws{}
+        ,m_buf{}
+        ,m_json{}
+        ,m_outbox{}
+        ,m_writing{false}
+        ,m_pending{}
+        ,m_reconnect_timer{m_ioctx}
+        ,m_pending_timer{m_ioctx}
+        ,m_pending_timer_armed{false}
+    {}
+    ~impl() {
+        m_reconnect_timer.cancel();
+        m_pending_timer.cancel();
+    }
+
+    void start() {
+        boost::asio::post(m_ioctx, [this] {
+            if ( !m_stop_requested ) {
+                return;
+            }
+            m_stop_requested = false;
+            async_connect();
+        });
+    }
+
+    void stop() {
+        boost::asio::post(m_ioctx, [this] {
+            m_stop_requested = true;
+            m_reconnect_timer.cancel();
+            close(boost::asio::error::operation_aborted);
+            // nothing is pending any more, a start() later arms it again
+            m_pending_timer.cancel();
+            m_pending_timer_armed = false;
+        });
+    }
+
+    bool is_connected() const { return m_connected; }
+
+    void set_on_connected(std::function<void()> cb) { m_on_connected = std::move(cb); }
+
+    // the same request through the rest api, for when the session is down
+    using fallback_type = std::function<void(rest::api &)>;
+
+    // signs on the calling thread, the session itself is only touched from the io_context thread
+    void send(const char *method, const char *client_order_id, const init_list_type &params, reply_cb cb, fallback_type fallback) {
+        std::string id = client_order_id ? client_order_id : "";
+        id += '-';
+        id += std::to_string(++m_seq);
+
+        std::string msg = make_request(id, method, params);
+        SPDLOG_TRACE("wsapi {} send: {}", m_host, msg);
+
+        boost::asio::post(m_ioctx, [this, id=std::move(id), msg=std::move(msg), cb=std::move(cb), fallback=std::move(fallback)]() mutable {
+            // checked here rather than by the caller, the session may drop between the two threads
+            if ( !m_connected ) {
+                if ( m_fallback ) {
+                    fallback(*m_fallback);
+                } else {
+                    // never written, the sent time of whatever reply this thread handled last does not belong to it
+                    rest::set_sent_time({});
+                    cb(__MAKE_FILELINE, static_cast<int>(rest::e_error::DISCONNECTED), "websocket api session is not connected", nullptr);
+                }
+                return;
+            }
+
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(m_timeout);
+            m_pending.emplace(id, pending_request{std::move(cb), {}, deadline});
+            arm_pending_timer(deadline);
+            m_outbox.emplace_back(std::move(id), std::move(msg));
+            if ( !m_writing ) {
+                async_write();
+            }
+        });
+    }
+
+    template<typename R, typename CB>
+    static reply_cb make_reply(CB cb) {
+        return [cb=std::move(cb)](const char *fl, int ec, std::string errmsg, const flatjson::fjson *result) {
+            try {
+                if ( ec || !result ) {
+                    R arg{};
+                    cb(fl, ec, std::move(errmsg), std::move(arg));
+                } else {
+                    R arg = R::construct(*result);
+                    cb(fl, 0, std::move(errmsg), std::move(arg));
+                }
+            } catch (const std::exception &ex) {
+                std::fprintf(stderr, "%s: ex=%s\n", __MAKE_FILELINE, ex.what());
+                std::fflush(stderr);
+            }
+        };
+    }
+
+private:
+    // the signature covers the parameters sorted by name, including apiKey and timestamp
+    std::string make_request(const std::string &id, const char *method, const init_list_type &params) const {
+        std::vector<kv_type> sorted;
+        sorted.reserve(params.size() + 3);
+        for ( const auto &it: params ) {
+            if ( const auto *p = boost::get<const char *>(&it.second) ) {
+                if ( *p != nullptr && **p != '\0' ) {
+                    sorted.push_back(it);
+                }
+            } else if ( boost::get<std::size_t>(it.second) != 0u ) {
+                sorted.push_back(it);
+            }
+        }
+        const std::size_t timestamp = static_cast<std::size_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()
+        ).count());
+        sorted.emplace_back("apiKey", m_pk.c_str());
+        sorted.emplace_back("recvWindow", m_timeout);
+        sorted.emplace_back("timestamp", timestamp);
+        std::sort(sorted.begin(), sorted.end(), [](const kv_type &l, const kv_type &r) {
+            return std::strcmp(l.first, r.first) < 0;
+        });
+
+        std::string query;
+        std::string json = "{\"id\":\"";
+        json += id;
+        json += "\",\"method\":\"";
+        json += method;
+        json += "\",\"params\":{";
+        for ( const auto &it: sorted ) {
+            if ( !query.empty() ) {
+                query += '&';
+            }
+            query += it.first;
+            query += '=';
+            json += '"';
+            json += it.first;
+            json += "\":";
+            if ( const auto *p = boost::get<const char *>(&it.second) ) {
+                query += *p;
+                json += '"';
+                json += *p;
+                json += "\",";
+            } else {
+                auto v = std::to_string(boost::get<std::size_t>(it.second));
+                query += v;
+                json += v;
+                json += ',';
+            }
+        }
+        json += "\"signature\":\"";
+        json += m_signer.sign(query.c_str(), query.length());
+        json += "\"}}";
+
+        return json;
+    }
+
+    void async_connect() {
+        m_connected = false;
+        const auto session = ++m_session;
+        m_ws = std::make_shared<stream_type>(m_ioctx, m_ssl_ctx);
+        if ( !SSL_set_tlsext_host_name(m_ws->next_layer().native_handle(), m_host.c_str()) ) {
+            boost::system::error_code ec{static_cast<int>(::ERR_get_error()), boost::asio::error::get_ssl_category()};
+            on_error(session, ec, "sni");
+            return;
+        }
+        // same as the market data streams, keep the record buffer instead of freeing it on every drain
+        SSL_clear_mode(m_ws->next_layer().native_handle(), SSL_MODE_RELEASE_BUFFERS);
+
+        m_resolver.async_resolve(
+             m_host
+            ,m_port
+            ,[this, session, ws=m_ws](boost::system::error_code ec, boost::asio::ip::tcp::resolver::results_type res) {
+                if ( ec ) {
+                    on_error(session, ec, "resolve");
+                    return;
+                }
+                if ( session != m_session ) {
+                    return;
+                }
+                boost::asio::async_connect(
+                     ws->next_layer().next_layer()
+                    ,res.begin()
+                    ,res.end()
+                    ,[this, session, ws](boost::system::error_code ec, boost::asio::ip::tcp::resolver::iterator) {
+                        if ( ec ) {
+                            on_error(session, ec, "connect");
+                            return;
+                        }
+                        ws->next_layer().next_layer().set_option(boost::asio::ip::tcp::no_delay(true), ec);
+                        on_connected(session, ws);
+                    }
+                );
+            }
+        );
+    }
+
+    void on_connected(std::size_t session, std::shared_ptr<stream_type> ws) {
+        ws->next_layer().async_handshake(
+             boost::asio::ssl::stream_base::client
+            ,[this, session, ws](boost::system::error_code ec) {
+                if ( ec ) {
+                    on_error(session, ec, "ssl handshake");
+                    return;
+                }
+                // a session that went silent is noticed by the pings beast sends when idle
+                boost::beast::websocket::stream_base::timeout opt{30s, 20s, true};
+                ws->set_option(opt);
+                ws->text(true);
+                ws->async_handshake(
+                     m_host
+                    ,m_target
+                    ,[this, session, ws](boost::system::error_code ec) {
+                        if ( ec ) {
+                            on_error(session, ec, "websocket handshake");
+                            return;
+                        }
+                        SPDLOG_INFO("wsapi {}{} connected", m_host, m_target);
+                        m_connected = true;
+                        async_read(session, ws);
+                        if ( m_on_connected ) {
+                            m_on_connected();
+                        }
+                    }
+                );
+            }
+        );
+    }
+
+    void async_write() {
+        const auto session = m_session;
+        m_writing = true;
+        m_ws->async_write(
+             boost::asio::buffer(m_outbox.front().second)
+            ,[this, session, ws=m_ws](boost::system::error_code ec, std::size_t) {
+                if ( session != m_session ) {
+                    return;
+                }
+                m_writing = false;
+                if ( ec ) {
+                    on_error(session, ec, "write");
+                    return;
+                }
+                auto it = m_pending.find(m_outbox.front().first);
+                if ( it != m_pending.end() ) {
+                    it->second.sent = std::chrono::steady_clock::now();
+                }
+                m_outbox.pop_front();
+                if ( !m_outbox.empty() ) {
+                    async_write();
+                }
+            }
+        );
+    }
+
+    void async_read(std::size_t session, std::shared_ptr<stream_type> ws) {
+        ws->async_read(
+             m_buf
+            ,[this, session, ws](boost::system::error_code ec, std::size_t) {
+                if ( ec ) {
+                    on_error(session, ec, "read");
+                    return;
+                }
+                on_message(static_cast<const char *>(m_buf.data().data()), m_buf.size());
+                m_buf.consume(m_buf.size());
+                async_read(session, std::move(ws));
+            }
+        );
+    }
+
+    void on_message(const char *ptr, std::size_t size) {
+        SPDLOG_TRACE("wsapi {} recv: {}", m_host, fmt::string_view(ptr, size));
+        if ( !m_json.reload(ptr, size) || !m_json.is_object() || !m_json.contains("id") ) {
+            SPDLOG_WARN("wsapi {} unexpected message: {}", m_host, fmt::string_view(ptr, size));
+            return;
+        }
+
+        const auto sid = m_json.at("id").to_sstring();
+        auto it = m_pending.find(std::string{sid.data(), sid.size()});
+        if ( it == m_pending.end() ) {
+            SPDLOG_WARN("wsapi {} reply to unknown request {}", m_host, fmt::string_view(sid.data(), sid.size()));
+            return;
+        }
+        reply_cb cb = std::move(it->second.cb);
+        rest::set_sent_time(it->second.sent);
+        m_pending.erase(it);
+
+        if ( m_json.contains("error") ) {
+            auto error = rest::construct_error(m_json.at("error"));
+            cb(__MAKE_FILELINE, error.first, std::move(error.second), nullptr);
+        } else {
+            const auto result = m_json.at("result");
+            cb(__MAKE_FILELINE, 0, std::string{}, &result);
+        }
+    }
+
+    void on_error(std::size_t session, const boost::system::error_code &ec, const char *what) {
+        if ( session != m_session ) {
+            return;
+        }
+        if ( !m_stop_requested ) {
+            SPDLOG_WARN("wsapi {}{} {} failed: {}, reconnecting", m_host, m_target, what, ec.message());
+        }
+        close(ec);
+
+        if ( m_stop_requested ) {
+            return;
+        }
+        m_reconnect_timer.expires_after(1s);
+        m_reconnect_timer.async_wait([this](const boost::system::error_code &ec) {
+            if ( !ec && !m_stop_requested ) {
+                async_connect();
+            }
+        });
+    }
+
+    // every request has a deadline m_timeout after it is made, the same for all, so the timer only
+    // has to wait for the oldest one. requests past it fail with e_error::TIMEOUT, a reply coming
+    // later is dropped as a reply to an unknown request
+    void arm_pending_timer(std::chrono::steady_clock::time_point deadline) {
+        if ( m_pending_timer_armed ) {
+            return;
+        }
+        m_pending_timer_armed = true;
+        m_pending_timer.expires_at(deadline);
+        m_pending_timer.async_wait([this](const boost::system::error_code &ec) {
+            if ( ec ) {
+                return;
+            }
+            m_pending_timer_armed = false;
+            on_pending_timer();
+        });
+    }
+
+    void on_pending_timer() {
+        const auto now = std::chrono::steady_clock::now();
+        auto next = std::chrono::steady_clock::time_point::max();
+        std::vector<pending_request> expired;
+        for ( auto it = m_pending.begin(); it != m_pending.end(); ) {
+            if ( it->second.deadline <= now ) {
+                expired.push_back(std::move(it->second));
+                it = m_pending.erase(it);
+            } else {
+                next = std::min(next, it->second.deadline);
+                ++it;
+            }
+        }
+        if ( next != std::chrono::steady_clock::time_point::max() ) {
+            arm_pending_timer(next);
+        }
+
+        // callbacks may send again, so they run once the table is done with
+        for ( auto &it: expired ) {
+            SPDLOG_WARN("wsapi {}{} request without reply after {}ms", m_host, m_target, m_timeout);
+            rest::set_sent_time(it.sent);
+            it.cb(__MAKE_FILELINE, static_cast<int>(rest::e_error::TIMEOUT), "no reply within the receive window", nullptr);
+        }
+    }
+
+    // drops the session, requests it carried get an error since whether they reached binance is unknown
+    void close(const boost::system::error_code &ec) {
+        ++m_session;
+        m_connected = false;
+        m_writing = false;
+        m_outbox.clear();
+        m_buf.consume(m_buf.size());
+        if ( m_ws ) {
+            boost::system::error_code ignored;
+            m_ws->next_layer().next_layer().close(ignored);
+            // the stream goes with the last handler holding it, its idle ping timer with it
+            m_ws.reset();
+        }
+
+        auto pending = std::move(m_pending);
+        m_pending.clear();
+        for ( auto &it: pending ) {
+            rest::set_sent_time(it.second.sent);
+            it.second.cb(__MAKE_FILELINE, static_cast<int>(rest::e_error::DISCONNECTED), ec.message(), nullptr);
+        }
+    }
+
+    boost::asio::io_context &m_ioctx;
+    const std::string m_host;
+    const std::string m_port;
+    const std::string m_target;
+    const std::string m_pk;
+    const hmac_sha256_key m_signer;
+    const std::size_t m_timeout;
+    const std::shared_ptr<rest::api> m_fallback;
+    std::function<void()> m_on_connected;
+    std::atomic<std::size_t> m_seq;
+    std::atomic<bool> m_connected;
+    bool m_stop_requested;
+    // bumped whenever a session is dropped, handlers of an older session ignore their completion
+    std::size_t m_session;
+    boost::asio::ssl::context m_ssl_ctx;
+    boost::asio::ip::tcp::resolver m_resolver;
+    // handlers hold the stream they run on, a dropped session's stream lives until they complete
+    std::shared_ptr<stream_type> m_ws;
+    boost::beast::flat_buffer m_buf;
+    flatjson::fjson m_json;
+    // request id and message, in the order they are written
+    std::deque<std::pair<std::string, std::string>> m_outbox;
+    bool m_writing;
+    struct pending_request {
+        reply_cb cb;
+        std::chrono::steady_clock::time_point sent; // zero until written
+        std::chrono::steady_clock::time_point deadline;
+    };
+    std::unordered_map<std::string, pending_request> m_pending;
+    boost::asio::steady_timer m_reconnect_timer;
+    boost::asio::steady_timer m_pending_timer;
+    bool m_pending_timer_armed;
+};
+
+/*************************************************************************************************/
+
+api::api(
+     boost::asio::io_context &ioctx
+    ,std::string host
+    ,std::string port
+    ,std::string target
+    ,std::string pk
+    ,std::string sk
+    ,std::size_t timeout
+    ,std::shared_ptr<rest::api> fallback
+)
+    :pimpl{std::make_unique<impl>(
+         ioctx
+        ,std::move(host)
+        ,std::move(port)
+        ,std::move(target)
+        ,std::move(pk)
+        ,std::move(sk)
+        ,timeout
+        ,std::move(fallback)
+    )}
+{}
+
+api::~api()
+{}
+
+/*************************************************************************************************/
+
+void api::start() { pimpl->start(); }
+
+void api::stop() { pimpl->stop(); }
+
+bool api::is_connected() const { return pimpl->is_connected(); }
+
+void api::set_on_connected(std::function<void()> cb) { pimpl->set_on_connected(std::move(cb)); }
+
+// arguments of a request, kept by its fallback until the io_context thread decides on it
+static std::string copy_arg(const char *str) { return str ? str : ""; }
+
+/*************************************************************************************************/
+
+void api::new_order(
+     const char *symbol
+    ,const e_side side
+    ,const e_type type
+    ,const e_time time
+    ,const e_trade_resp_type resp
+    ,const char *amount
+    ,const char *price
+    ,const char *client_order_id
+    ,const char *stop_price
+    ,const char *iceberg_amount
+    ,rest::api::new_order_cb cb
+) {
+    const char *time_str = type == e_type::market
+        ? nullptr
+        : e_time_to_string(time)
+    ;
+
+    const impl::init_list_type map = {
+         {"symbol", symbol}
+        ,{"side", e_side_to_string(side)}
+        ,{"type", e_type_to_string(type)}
+        ,{"timeInForce", time_str}
+        ,{"quantity", amount}
+        ,{"price", price}
+        ,{"newClientOrderId", client_order_id}
+        ,{"stopPrice", stop_price}
+        ,{"icebergQty", iceberg_amount}
+        ,{"newOrderRespType", e_trade_resp_type_to_string(resp)}
+    };
+
+    auto fallback = [symbol=copy_arg(symbol), side, type, time, resp, amount=copy_arg(amount), price=copy_arg(price)
+        ,client_order_id=copy_arg(client_order_id), stop_price=copy_arg(stop_price), iceberg_amount=copy_arg(iceberg_amount), cb]
+        (rest::api &rest) mutable
+    {
+        rest.new_order(symbol, side, type, time, resp, amount, price, client_order_id, stop_price, iceberg_amount, std::move(cb));
+    };
+    pimpl->send("order.place", client_order_id, map, impl::make_reply<rest::new_order_resp_type>(cb), std::move(fallback));
+}
+
+void api::cancel_order(
+     const char *symbol
+    ,std::size_t order_id
+    ,const char *client_order_id
+    ,const char *new_client_order_id
+    ,rest::api::cancel_order_cb cb
+) {
+    const impl::init_list_type map = {
+         {"symbol", symbol}
+        ,{"orderId", order_id}
+        ,{"origClientOrderId", client_order_id}
+        ,{"newClientOrderId", new_client_order_id}
+    };
+
+    auto fallback = [symbol=copy_arg(symbol), order_id, client_order_id=copy_arg(client_order_id)
+        ,new_client_order_id=copy_arg(new_client_order_id), cb](rest::api &rest) mutable
+    { rest.cancel_order(symbol, order_id, client_order_id, new_client_order_id, std::move(cb)); };
+    pimpl->send("order.cancel", client_order_id ? client_order_id : new_client_order_id, map, impl::make_reply<rest::cancel_order_info_t>(cb), std::move(fallback));
+}
+
+void api::order_info(const char *symbol, std::size_t order_id, const char *client_order_id, rest::api::order_info_cb cb) {
+    const impl::init_list_type map = {
+         {"symbol", symbol}
+        ,{"orderId", order_id}
+        ,{"origClientOrderId", client_order_id}
+    };
+
+    auto fallback = [symbol=copy_arg(symbol), order_id, client_order_id=copy_arg(client_order_id), cb](rest::api &rest) mutable
+    { rest.order_info(symbol, order_id, client_order_id, std::move(cb)); };
+    pimpl->send("order.status", client_order_id, map, impl::make_reply<rest::order_info_t>(cb), std::move(fallback));
+}
+
+/*************************************************************************************************/
+
+void api::future_new_order(
+     const char *symbol
+    ,const e_side side
+    ,const e_position_side position_side
+    ,const e_type type
+    ,const e_time time
+    ,const char *quantity
+    ,const char *price
+    ,const char *client_order_id
+    ,rest::api::future_new_order_cb cb
+) {
+    const bool limit = type == e_type::limit;
+    const impl::init_list_type map = {
+         {"symbol", symbol}
+        ,{"side", e_side_to_string(side)}
+        ,{"type", e_type_to_string(type)}
+        ,{"positionSide", e_position_side_to_string(position_side)}
+        ,{"price", limit ? price : nullptr}
+        ,{"quantity", quantity}
+        ,{"newClientOrderId", client_order_id}
+        ,{"timeInForce", limit ? e_time_to_string(time) : nullptr}
+    };
+
+    auto fallback = [symbol=copy_arg(symbol), side, position_side, type, time, quantity=copy_arg(quantity), price=copy_arg(price)
+        ,client_order_id=copy_arg(client_order_id), cb](rest::api &rest) mutable
+    {
+        rest.future_new_order(symbol, side, position_side, type, "", price, quantity, client_order_id, "", "", "", "", time, ""
+            ,"", e_trade_resp_type::FULL, 0, std::move(cb));
+    };
+    pimpl->send("order.place", client_order_id, map, impl::make_reply<rest::future_new_order_resp_t>(cb), std::move(fallback));
+}
+
+void api::future_cancel_order(const char *symbol, std::size_t order_id, const char *client_order_id, rest::api::cancel_order_cb cb) {
+    const impl::init_list_type map = {
+         {"symbol", symbol}
+        ,{"orderId", order_id}
+        ,{"origClientOrderId", client_order_id}
+    };
+
+    auto fallback = [symbol=copy_arg(symbol), order_id, client_order_id=copy_arg(client_order_id), cb](rest::api &rest) mutable
+    { rest.future_cancel_order(symbol, order_id, client_order_id, std::move(cb)); };
+    pimpl->send("order.cancel", client_order_id, map, impl::make_reply<rest::cancel_order_info_t>(cb), std::move(fallback));
+}
+
+void api::future_order_info(const char *symbol, std::size_t order_id, const char *client_order_id, rest::api::order_info_cb cb) {
+    const impl::init_list_type map = {
+         {"symbol", symbol}
+        ,{"orderId", order_id}
+        ,{"origClientOrderId", client_order_id}
+    };
+
+    auto fallback = [symbol=copy_arg(symbol), order_id, client_order_id=copy_arg(client_order_id), cb](rest::api &rest) mutable
+    { rest.future_order_info(symbol, order_id, client_order_id, std::move(cb)); };
+    pimpl->send("order.status", client_order_id, map, impl::make_reply<rest::order_info_t>(cb), std::move(fallback));
+}
+
+/*************************************************************************************************/
+
+} // ns wsapi
+} // ns binapi
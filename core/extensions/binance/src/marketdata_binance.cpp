@@ -6,6 +6,8 @@
 
 #include <cmath>
 #include <utility>
+#include <boost/asio/post.hpp>
+#include <binapi/fnv1a.hpp>
 #include <kungfu/yijinjing/log/setup.h>
 #include "marketdata_binance.h"
 #include "type_convert_binance.h"
@@ -18,15 +20,23 @@ using namespace kungfu::yijinjing;
 namespace kungfu {
     namespace wingchun {
         namespace binance {
+            /** binance times are in ms, 0 for messages without one */
+            static int64_t exchange_nano(std::size_t ms) {
+                return static_cast<int64_t>(ms) * time_unit::NANOSECONDS_PER_MILLISECOND;
+            }
+
             MarketDataBinance::MarketDataBinance(bool low_latency, yijinjing::data::locator_ptr locator, const std::string& json_config):
                 MarketData(low_latency, std::move(locator), SOURCE_BINANCE) {
                 yijinjing::log::copy_log_settings(get_io_device()->get_home(), SOURCE_BINANCE);
                 config_ = nlohmann::json::parse(json_config);
-                ws_ptr_ = std::make_shared<binapi::ws::websockets>(
-                    ioctx_
-                    , config_.spot_wss_host                   //"stream.binance.com"
-                    , std::to_string(config_.spot_wss_port)   //"9443"
-                    );
+                if (config_.depth_levels != 5 and config_.depth_levels != 10 and config_.depth_levels != 20) {
+                    SPDLOG_WARN("depth_levels {} not supported by binance, use 20", config_.depth_levels);
+                    config_.depth_levels = 20;
+                }
+                if (config_.md_shards < 1) {
+                    SPDLOG_WARN("md_shards {} not supported, use 1", config_.md_shards);
+                    config_.md_shards = 1;
+                }
                 rest_ptr_ = std::make_shared<binapi::rest::api>(
                     ioctx_
                     , config_.spot_rest_host                  //"api.binance.com"
@@ -43,16 +53,6 @@ namespace kungfu {
                     , config_.secret_key
                     , 10000
                     );
-                fws_ptr_ = std::make_shared<binapi::ws::websockets>(
-                    ioctx_
-                    , config_.ubase_wss_host                    //"fstream.binance.com"
-                    , std::to_string(config_.ubase_wss_port)    //"443"
-                    );
-                dws_ptr_ = std::make_shared<binapi::ws::websockets>(
-                    ioctx_
-                    , config_.cbase_wss_host                    //"dstream.binance.com"
-                    , std::to_string(config_.cbase_wss_port)    //"443"
-                    );
             }
 
             MarketDataBinance::~MarketDataBinance() {}
@@ -66,17 +66,31 @@ namespace kungfu {
                 MarketData::on_start();
                 std::string runtime_folder = get_runtime_folder();
                 SPDLOG_INFO(
-                    "Connecting binance MD with {} // {} // {} // {} with runtime folder {}",
-                    config_.spot_rest_host, config_.spot_wss_host, config_.ubase_rest_host, config_.ubase_wss_host, runtime_folder);
+                    "Connecting binance MD with {} // {} // {} // {} on {} legs with runtime folder {}",
+                    config_.spot_rest_host, config_.spot_wss_host, config_.ubase_rest_host, config_.ubase_wss_host,
+                    config_.md_feed_legs, runtime_folder);
                 publish_state(msg::data::BrokerState::LoggedIn);
                 {
                     task_thread_ = std::make_shared<std::thread>(
                         [this]() {
+                            place_thread(yijinjing::os::thread_role::IO);
                             boost::asio::io_context::work worker(this->ioctx_);
                             this->ioctx_.run();
                             return 0;
                         });
                 }
+                // shard 0 writes to the public journal, others to public journals of their own which readers join too
+                for (size_t i = 0; i < static_cast<size_t>(config_.md_shards); i++) {
+                    auto writer = i == 0 ? get_writer(0) : open_public_writer(i, yijinjing::journal::writer_mode::SINGLE_PRODUCER);
+                    auto shard = std::make_shared<StreamShard>(i, config_, writer);
+                    shards_.push_back(shard);
+                    shard_threads_.push_back(std::make_shared<std::thread>(
+                        [this, shard]() {
+                            place_thread(yijinjing::os::thread_role::IO);
+                            shard->run();
+                            return 0;
+                        }));
+                }
                 {
                     SPDLOG_DEBUG("Update Spot info");
                     auto symbols = rest_ptr_->exchange_info();
@@ -88,6 +102,15 @@ namespace kungfu {
                                 oss << symbol.second;
                                 SPDLOG_TRACE(oss.str());
                                 db.add_market_info(from_binance_symbol(symbol.first), EXCHANGE_BINANCE, InstrumentType::Spot, oss.str(), now());
+                                double tick = 0, step = 0;
+                                for (const auto &filter : symbol.second.filters) {
+                                    if (auto price = boost::get<binapi::rest::exchange_info_t::symbol_t::filter_t::price_t>(&filter.filter)) {
+                                        tick = price->tickSize.convert_to<double>();
+                                    } else if (auto lot = boost::get<binapi::rest::exchange_info_t::symbol_t::filter_t::lot_size_t>(&filter.filter)) {
+                                        step = lot->stepSize.convert_to<double>();
+                                    }
+                                }
+                                add_depth_exponents(symbol.first, InstrumentType::Spot, tick, step);
                             }
                         }
                     }
@@ -102,10 +125,18 @@ namespace kungfu {
                             std::stringstream oss;
                             oss << symbol.dump();
                             db.add_market_info(from_binance_symbol(symbol["symbol"]), EXCHANGE_BINANCE, InstrumentType::FFuture, oss.str(), now());
+                            double tick = 0, step = 0;
+                            for (auto& filter : symbol["filters"]) {
+                                if (filter["filterType"] == "PRICE_FILTER") {
+                                    tick = std::stod(filter["tickSize"].get<std::string>());
+                                } else if (filter["filterType"] == "LOT_SIZE") {
+                                    step = std::stod(filter["stepSize"].get<std::string>());
+                                }
+                            }
+                            add_depth_exponents(symbol["symbol"], InstrumentType::FFuture, tick, step);
                         }
                     }
                 }
-                add_time_interval(time_unit::NANOSECONDS_PER_SECOND * 5, std::bind(&MarketDataBinance::_check_status, this, std::placeholders::_1));
                 {
                     wingchun::msg::data::Instrument inst;
                     strcpy(inst.symbol, "ltc_usdt");
@@ -129,60 +160,163 @@ namespace kungfu {
                         continue;
                     }
                     auto symbol_id = get_symbol_id(symbol, "depth", inst.instrument_type, EXCHANGE_BINANCE, 0);
-                    auto it = channel_cache_.find(symbol_id);
-                    if (it != channel_cache_.end() and it->second.ready) {
+                    if (channel_cache_.find(symbol_id) != channel_cache_.end()) {
                         SPDLOG_TRACE("add duplicated depth channel: {}", inst.symbol);
                         continue;
                     }
-                    auto cb = [this, instrument_type=inst.instrument_type, orig_symbol](const char* fl, int ec, std::string errmsg, binapi::ws::part_depths_t msg) {
+                    auto instrument_id = instruments_->intern(orig_symbol, EXCHANGE_BINANCE, inst.instrument_type);
+                    auto book = std::make_shared<OrderBook>(orig_symbol, inst.instrument_type, instrument_id);
+                    auto exponents = depth_exponents_.find(symbol_id);
+                    if (exponents != depth_exponents_.end()) {
+                        book->set_exponents(exponents->second.first, exponents->second.second);
+                    } else if (config_.compact_depth) {
+                        SPDLOG_WARN("no tick and step size of {}, depth published with exponent {}", inst.symbol, OrderBook::EXPONENT);
+                    }
+                    auto shard = get_shard(symbol);
+                    auto writer = shard->get_writer();
+                    auto latency = shard->make_latency(
+                        instrument_id, inst.instrument_type, config_.compact_depth ? msg::type::CompactDepth : msg::type::Depth);
+                    auto cb = [this, book, writer, latency](const char* fl, int ec, std::string errmsg, const binapi::ws::part_depths_t &msg) {
                         if (ec) {
                             SPDLOG_ERROR("fail to get depth: ec({}), errmsg({})", ec, errmsg);
                             return false;
                         }
-                        std::stringstream oss;
-                        oss << "depth message: " << msg;
-                        SPDLOG_TRACE(oss.str());
-                        msg::data::Depth& depth = this->get_writer(0)->open_data<msg::data::Depth>(0, msg::type::Depth);
-                        strcpy(depth.source_id, SOURCE_BINANCE);
-                        depth.data_time = now();
-                        strcpy(depth.symbol, orig_symbol.c_str());
-                        strcpy(depth.exchange_id, EXCHANGE_BINANCE);
-                        depth.instrument_type = instrument_type;
-                        for (int i = 0; i < 10; i++) {
-                            //FIXME, may not be safe in direct convertion
-                            depth.ask_price[i] = msg.a[i].price.convert_to<double>();
-                            depth.ask_volume[i] = msg.a[i].amount.convert_to<double>();
-                            depth.bid_price[i] = msg.b[i].price.convert_to<double>();
-                            depth.bid_volume[i] = msg.b[i].amount.convert_to<double>();
+                        auto parse_time = yijinjing::time::now_in_nano();
+                        if (spdlog::default_logger_raw()->should_log(spdlog::level::trace)) {
+                            std::stringstream oss;
+                            oss << "depth message: " << msg;
+                            SPDLOG_TRACE(oss.str());
                         }
-                        get_writer(0)->close_data();
+                        book->set_levels(msg.b, msg.a);
+                        auto received = receive_time();
+                        publish_depth(writer, *book, exchange_nano(msg.E), received);
+                        latency->record(exchange_nano(msg.E), received, parse_time, yijinjing::time::now_in_nano());
+                        return true;
+                    };
+                    auto diff_cb = [this, book, shard, latency](const char* fl, int ec, std::string errmsg, const binapi::ws::diff_depths_t &msg) {
                         if (ec) {
-                            std::cerr << "subscribe part_depth error: fl=" << fl << ", ec=" << ec << ", emsg=" << errmsg << std::endl;
+                            SPDLOG_ERROR("fail to get diff depth: ec({}), errmsg({})", ec, errmsg);
                             return false;
                         }
+                        auto parse_time = yijinjing::time::now_in_nano();
+                        auto status = book->apply(msg);
+                        if (status == OrderBook::Status::Gap) {
+                            SPDLOG_WARN("{} book out of sync at {}, resync", book->get_symbol(), book->get_last_update_id());
+                            book->reset();
+                            book->apply(msg);
+                        }
+                        if (status == OrderBook::Status::Applied) {
+                            auto received = receive_time();
+                            publish_depth(shard->get_writer(), *book, exchange_nano(msg.E), received);
+                            latency->record(exchange_nano(msg.E), received, parse_time, yijinjing::time::now_in_nano());
+                        }
+                        // a failed snapshot request is retried once a second, one older than the diffs later each time
+                        if (book->is_snapshot_due(yijinjing::time::now_in_nano())) {
+                            request_snapshot(shard, book);
+                        }
                         return true;
                     };
-                    binapi::ws::websockets::handle h;
-                    if (inst.instrument_type == InstrumentType::Spot) {
-                        //TODO, should make these hardcoded number configurable.
-                        h = ws_ptr_->part_depth(symbol.c_str(), binapi::e_levels::_20, binapi::e_freq::_100ms, cb);
-                    } else if (inst.instrument_type == InstrumentType::FFuture) {
-                        h = fws_ptr_->future_part_depth(symbol.c_str(), binapi::e_levels::_20, binapi::e_freq::_100ms, cb);
-                    } else if (inst.instrument_type == InstrumentType::DFuture) {
-                        h = dws_ptr_->future_part_depth(symbol.c_str(), binapi::e_levels::_20, binapi::e_freq::_100ms, cb);
+                    auto levels = static_cast<binapi::e_levels>(config_.depth_levels);
+                    if (inst.instrument_type == InstrumentType::Spot and config_.incremental_depth) {
+                        shard->add_stream(inst.instrument_type, [symbol, diff_cb, arbiter = shard->make_arbiter()](
+                                binapi::ws::combined_streams &streams, size_t leg) {
+                            streams.diff_depth(symbol.c_str(), binapi::e_freq::_100ms, FeedArbiter::wrap(
+                                arbiter, leg, diff_cb, [](const binapi::ws::diff_depths_t &msg) { return msg.u; }));
+                        });
+                    } else if (inst.instrument_type == InstrumentType::Spot or inst.instrument_type == InstrumentType::FFuture or
+                               inst.instrument_type == InstrumentType::DFuture) {
+                        //TODO, should make update speed configurable.
+                        shard->add_stream(inst.instrument_type, [symbol, levels, cb, arbiter = shard->make_arbiter()](
+                                binapi::ws::combined_streams &streams, size_t leg) {
+                            streams.part_depth(symbol.c_str(), levels, binapi::e_freq::_100ms, FeedArbiter::wrap(
+                                arbiter, leg, cb, [](const binapi::ws::part_depths_t &msg) { return msg.u; }));
+                        });
                     } else {
                         return false;
                     }
-                    if (it == channel_cache_.end()) {
-                        channel_cache_.emplace(std::make_pair(symbol_id, ChannelInfo{orig_symbol, "depth", inst.instrument_type, h, true}));
-                    } else {
-                        it->second.ready = true;
-                        it->second.handle = h;
-                    }
+                    channel_cache_.emplace(symbol_id, ChannelInfo{orig_symbol, "depth", inst.instrument_type, shard->get_index()});
                 }
                 return true;
             }
 
+            void MarketDataBinance::add_depth_exponents(const std::string &binance_symbol, InstrumentType instrument_type,
+                                                        double tick, double step) {
+                if (tick <= 0 or step <= 0) {
+                    return;
+                }
+                auto symbol_id = get_symbol_id(binance_symbol, "depth", instrument_type, EXCHANGE_BINANCE, 0);
+                depth_exponents_[symbol_id] = {get_decimal_exponent(tick), get_decimal_exponent(step)};
+            }
+
+            const std::shared_ptr<StreamShard> &MarketDataBinance::get_shard(const std::string &binance_symbol) const {
+                return shards_[binapi::fnv1a(binance_symbol.c_str(), binance_symbol.size()) % shards_.size()];
+            }
+
+            void MarketDataBinance::request_snapshot(const std::shared_ptr<StreamShard> &shard, const std::shared_ptr<OrderBook> &book) {
+                book->set_snapshot_time(yijinjing::time::now_in_nano());
+                auto symbol = to_binance_symbol(book->get_symbol());
+                rest_ptr_->depths(symbol, 1000, [this, shard, book](const char* fl, int ec, std::string errmsg, binapi::rest::depths_t res) {
+                    if (ec) {
+                        SPDLOG_ERROR("fail to get {} depth snapshot: ec({}), errmsg({})", book->get_symbol(), ec, errmsg);
+                        return false;
+                    }
+                    // the book belongs to the io thread of its shard
+                    boost::asio::post(shard->get_io_context(), [this, shard, book, res = std::move(res)]() {
+                        if (book->apply_snapshot(res) == OrderBook::Status::Gap) {
+                            // buffered diffs are newer than the snapshot, REST lags the stream, ask again after backoff
+                            return;
+                        }
+                        SPDLOG_INFO("{} book synced at {}", book->get_symbol(), book->get_last_update_id());
+                        publish_depth(shard->get_writer(), *book, 0, yijinjing::time::now_in_nano());
+                    });
+                    return true;
+                });
+            }
+
+            void MarketDataBinance::publish_depth(const yijinjing::journal::writer_ptr &writer, const OrderBook &book,
+                                                  int64_t exchange_time, int64_t receive_time) {
+                const auto &bids = book.get_bids();
+                const auto &asks = book.get_asks();
+                if (config_.compact_depth) {
+                    auto bid_levels = static_cast<uint16_t>(std::min<size_t>(bids.size(), config_.depth_levels));
+                    auto ask_levels = static_cast<uint16_t>(std::min<size_t>(asks.size(), config_.depth_levels));
+                    auto length = msg::data::CompactDepth::length(bid_levels, ask_levels);
+                    auto frame = writer->open_frame(0, msg::type::CompactDepth, length);
+                    auto &depth = const_cast<msg::data::CompactDepth &>(frame->data<msg::data::CompactDepth>());
+                    depth.instrument_id = book.get_instrument_id();
+                    depth.data_time = now();
+                    depth.instrument_type = book.get_instrument_type();
+                    depth.price_exponent = book.get_price_exponent();
+                    depth.volume_exponent = book.get_volume_exponent();
+                    depth.bid_levels = bid_levels;
+                    depth.ask_levels = ask_levels;
+                    depth.exchange_time = exchange_time;
+                    depth.receive_time = receive_time;
+                    book.copy_levels(bids, bid_levels, depth.bids());
+                    book.copy_levels(asks, ask_levels, depth.asks());
+                    writer->close_frame(length);
+                    return;
+                }
+                msg::data::Depth& depth = writer->open_data<msg::data::Depth>(0, msg::type::Depth);
+                strcpy(depth.source_id, SOURCE_BINANCE);
+                depth.data_time = now();
+                strcpy(depth.symbol, book.get_symbol().c_str());
+                strcpy(depth.exchange_id, EXCHANGE_BINANCE);
+                depth.instrument_type = book.get_instrument_type();
+                depth.instrument_id = book.get_instrument_id();
+                depth.exchange_time = exchange_time;
+                depth.receive_time = receive_time;
+                for (size_t i = 0; i < 10; i++) {
+                    bool has_bid = i < bids.size();
+                    bool has_ask = i < asks.size();
+                    depth.bid_price[i] = has_bid ? from_fixed_point(bids[i].price, OrderBook::EXPONENT) : 0;
+                    depth.bid_volume[i] = has_bid ? from_fixed_point(bids[i].volume, OrderBook::EXPONENT) : 0;
+                    depth.ask_price[i] = has_ask ? from_fixed_point(asks[i].price, OrderBook::EXPONENT) : 0;
+                    depth.ask_volume[i] = has_ask ? from_fixed_point(asks[i].volume, OrderBook::EXPONENT) : 0;
+                }
+                writer->close_data();
+            }
+
             bool MarketDataBinance::subscribe_trade(const std::vector<wingchun::msg::data::Instrument>& instruments) {
                 SPDLOG_TRACE("size: {}", instruments.size());
                 for (const auto& inst : instruments) {
@@ -193,30 +327,36 @@ namespace kungfu {
                         continue;
                     }
                     auto symbol_id = get_symbol_id(symbol, "trade", inst.instrument_type, EXCHANGE_BINANCE, 0);
-                    auto it = channel_cache_.find(symbol_id);
-                    if (it != channel_cache_.end() and it->second.ready) {
+                    if (channel_cache_.find(symbol_id) != channel_cache_.end()) {
                         SPDLOG_INFO("add duplicated trade channel: {}", inst.symbol);
                         continue;
                     }
-                    auto future_cb = [this, instrument_type=inst.instrument_type, orig_symbol](
-                            const char* fl, int ec, std::string errmsg, binapi::ws::agg_trade_t msg) {
+                    auto instrument_id = instruments_->intern(orig_symbol, EXCHANGE_BINANCE, inst.instrument_type);
+                    auto shard = get_shard(symbol);
+                    auto writer = shard->get_writer();
+                    auto latency = shard->make_latency(instrument_id, inst.instrument_type, msg::type::Trade);
+                    auto future_cb = [this, writer, latency, instrument_type=inst.instrument_type, orig_symbol, instrument_id](
+                            const char* fl, int ec, std::string errmsg, const binapi::ws::agg_trade_t &msg) {
                         if (ec) {
                             SPDLOG_ERROR("future trade error: ec={}, emsg={}", ec, errmsg);
                             return true;
                         }
-                        std::stringstream oss;
-                        oss << "trade message: " << msg;
-                        SPDLOG_TRACE(oss.str());
-                        if (std::abs(int(msg.E - msg.T)) > 500 or std::abs(int(now() / 1000000 - msg.T)) > 500)
-                            SPDLOG_WARN("future trade delay: event_time={}, trade_time={}, now={}", msg.E, msg.T, now());
-                        msg::data::Trade& trade = this->get_writer(0)->open_data<msg::data::Trade>(0, msg::type::Trade);
+                        auto parse_time = yijinjing::time::now_in_nano();
+                        if (spdlog::default_logger_raw()->should_log(spdlog::level::trace)) {
+                            std::stringstream oss;
+                            oss << "trade message: " << msg;
+                            SPDLOG_TRACE(oss.str());
+                        }
+                        auto received = receive_time();
+                        msg::data::Trade& trade = writer->open_data<msg::data::Trade>(0, msg::type::Trade);
                         trade.trade_time = msg.T * 1000 * 1000;
                         trade.set_symbol(orig_symbol);
                         trade.set_exchange_id(EXCHANGE_BINANCE);
                         trade.instrument_type = instrument_type;
+                        trade.instrument_id = instrument_id;
                         trade.trade_id = msg.a;
-                        trade.price = msg.p.convert_to<double>();
-                        trade.volume = msg.q.convert_to<double>();
+                        trade.price = msg.p.to_double();
+                        trade.volume = msg.q.to_double();
                         trade.ask_id = 0;
                         trade.bid_id = 0;
                         if (msg.m) {
@@ -224,53 +364,62 @@ namespace kungfu {
                         } else {
                             trade.side = kungfu::wingchun::Side::Buy;
                         }
-                        get_writer(0)->close_data();
+                        trade.exchange_time = exchange_nano(msg.E);
+                        trade.receive_time = received;
+                        writer->close_data();
+                        latency->record(exchange_nano(msg.E), received, parse_time, yijinjing::time::now_in_nano());
+                        return true;
+                    };
+                    auto spot_cb = [this, writer, latency, orig_symbol, instrument_id](const char* fl, int ec, std::string errmsg, const binapi::ws::trade_t &msg) {
+                        if (ec) {
+                            SPDLOG_ERROR("subscribe [trade] error: ec={}, emsg={}", ec, errmsg);
+                            return false;
+                        }
+                        auto parse_time = yijinjing::time::now_in_nano();
+                        if (spdlog::default_logger_raw()->should_log(spdlog::level::trace)) {
+                            std::stringstream oss;
+                            oss << "trade message: " << msg;
+                            SPDLOG_TRACE(oss.str());
+                        }
+                        auto received = receive_time();
+                        msg::data::Trade& trade = writer->open_data<msg::data::Trade>(0, msg::type::Trade);
+                        trade.trade_time = msg.T * 1000 * 1000;
+                        trade.set_symbol(orig_symbol);
+                        trade.set_exchange_id(EXCHANGE_BINANCE);
+                        trade.instrument_type = InstrumentType::Spot;
+                        trade.instrument_id = instrument_id;
+                        trade.trade_id = msg.t;
+                        trade.price = msg.p.to_double();
+                        trade.volume = msg.q.to_double();
+                        trade.ask_id = msg.a;
+                        trade.bid_id = msg.b;
+                        if (msg.m) {
+                            trade.side = kungfu::wingchun::Side::Sell;
+                        } else {
+                            trade.side = kungfu::wingchun::Side::Buy;
+                        }
+                        trade.exchange_time = exchange_nano(msg.E);
+                        trade.receive_time = received;
+                        writer->close_data();
+                        latency->record(exchange_nano(msg.E), received, parse_time, yijinjing::time::now_in_nano());
                         return true;
                     };
-                    binapi::ws::websockets::handle h = nullptr;
                     if (inst.instrument_type == InstrumentType::Spot) {
-                        h = ws_ptr_->trade(symbol.c_str(),
-                            [this, orig_symbol](const char* fl, int ec, std::string errmsg, binapi::ws::trade_t msg) {
-                                std::stringstream oss;
-                                oss << "trade message: " << msg;
-                                SPDLOG_TRACE(oss.str());
-                                if (std::abs(int(msg.E - msg.T)) > 500 or std::abs(int(now() / 1000000 - msg.T)) > 500)
-                                    SPDLOG_WARN("spot trade delay: event_time={}, trade_time={}, now={}", msg.E, msg.T, now());
-                                msg::data::Trade& trade = this->get_writer(0)->open_data<msg::data::Trade>(0, msg::type::Trade);
-                                trade.trade_time = msg.T * 1000 * 1000;
-                                trade.set_symbol(orig_symbol);
-                                trade.set_exchange_id(EXCHANGE_BINANCE);
-                                trade.instrument_type = InstrumentType::Spot;
-                                trade.trade_id = msg.t;
-                                trade.price = msg.p.convert_to<double>();
-                                trade.volume = msg.q.convert_to<double>();
-                                trade.ask_id = msg.a;
-                                trade.bid_id = msg.b;
-                                if (msg.m) {
-                                    trade.side = kungfu::wingchun::Side::Sell;
-                                } else {
-                                    trade.side = kungfu::wingchun::Side::Buy;
-                                }
-                                get_writer(0)->close_data();
-                                if (ec) {
-                                    SPDLOG_ERROR("subscribe [trade] error: ec={}, emsg={}", ec, errmsg);
-                                    return false;
-                                }
-                                return true;
-                            });
-                    } else if (inst.instrument_type == InstrumentType::FFuture) {
-                        h = fws_ptr_->agg_trade(symbol.c_str(), future_cb);
-                    } else if (inst.instrument_type == InstrumentType::DFuture) {
-                        h = dws_ptr_->agg_trade(symbol.c_str(), future_cb);
+                        shard->add_stream(inst.instrument_type, [symbol, spot_cb, arbiter = shard->make_arbiter()](
+                                binapi::ws::combined_streams &streams, size_t leg) {
+                            streams.trade(symbol.c_str(), FeedArbiter::wrap(
+                                arbiter, leg, spot_cb, [](const binapi::ws::trade_t &msg) { return msg.t; }));
+                        });
+                    } else if (inst.instrument_type == InstrumentType::FFuture or inst.instrument_type == InstrumentType::DFuture) {
+                        shard->add_stream(inst.instrument_type, [symbol, future_cb, arbiter = shard->make_arbiter()](
+                                binapi::ws::combined_streams &streams, size_t leg) {
+                            streams.agg_trade(symbol.c_str(), FeedArbiter::wrap(
+                                arbiter, leg, future_cb, [](const binapi::ws::agg_trade_t &msg) { return msg.a; }));
+                        });
                     } else {
                         continue;
                     }
-                    if (it == channel_cache_.end()) {
-                        channel_cache_.emplace(std::make_pair(symbol_id, ChannelInfo{orig_symbol, "trade", inst.instrument_type, h, true}));
-                    } else {
-                        it->second.ready = true;
-                        it->second.handle = h;
-                    }
+                    channel_cache_.emplace(symbol_id, ChannelInfo{orig_symbol, "trade", inst.instrument_type, shard->get_index()});
                 }
                 return true;
             }
@@ -285,22 +434,27 @@ namespace kungfu {
                         continue;
                     }
                     auto symbol_id = get_symbol_id(symbol, "ticker", inst.instrument_type, EXCHANGE_BINANCE, 0);
-                    auto it = channel_cache_.find(symbol_id);
-                    if (it != channel_cache_.end() and it->second.ready) {
+                    if (channel_cache_.find(symbol_id) != channel_cache_.end()) {
                         SPDLOG_INFO("add duplicated ticker channel: {}/ticker", inst.symbol);
                         continue;
                     }
-                    auto cb = [&, orig_symbol, inst_type=inst.instrument_type](const char* fl, int ec, std::string errmsg, binapi::ws::book_ticker_t msg) {
+                    auto instrument_id = instruments_->intern(orig_symbol, EXCHANGE_BINANCE, inst.instrument_type);
+                    auto shard = get_shard(symbol);
+                    auto writer = shard->get_writer();
+                    auto latency = shard->make_latency(instrument_id, inst.instrument_type, msg::type::Ticker);
+                    auto cb = [this, writer, latency, orig_symbol, instrument_id, inst_type=inst.instrument_type](const char* fl, int ec, std::string errmsg, const binapi::ws::book_ticker_t &msg) {
                         if (ec) {
                             SPDLOG_ERROR("subscribe [ticker] error: ec={}, emsg={}", ec, errmsg);
                             return false;
                         }
-                        std::stringstream oss;
-                        oss << "ticker message: " << msg;
-                        SPDLOG_TRACE(oss.str());
-                        if (msg.T > 0 and (std::abs(int(msg.E - msg.T)) > 500 or std::abs(int(now() / 1000000 - msg.T)) > 500))
-                            SPDLOG_WARN("ticker delay: event_time={}, ticker_time={}, now={}", msg.E, msg.T, now());
-                        msg::data::Ticker& ticker = this->get_writer(0)->open_data<msg::data::Ticker>(0, msg::type::Ticker);
+                        auto parse_time = yijinjing::time::now_in_nano();
+                        if (spdlog::default_logger_raw()->should_log(spdlog::level::trace)) {
+                            std::stringstream oss;
+                            oss << "ticker message: " << msg;
+                            SPDLOG_TRACE(oss.str());
+                        }
+                        auto received = receive_time();
+                        msg::data::Ticker& ticker = writer->open_data<msg::data::Ticker>(0, msg::type::Ticker);
                         ticker.set_source_id(SOURCE_BINANCE);
                         if (msg.T > 0)
                             ticker.data_time = msg.T * 1000 * 1000;
@@ -309,30 +463,29 @@ namespace kungfu {
                         ticker.set_symbol(orig_symbol);
                         ticker.set_exchange_id(EXCHANGE_BINANCE);
                         ticker.instrument_type = inst_type;
+                        ticker.instrument_id = instrument_id;
                         //FIXME, may not be safe in direct convertion
-                        ticker.ask_price = msg.a.convert_to<double>();
-                        ticker.ask_volume = msg.A.convert_to<double>();
-                        ticker.bid_price = msg.b.convert_to<double>();
-                        ticker.bid_volume = msg.B.convert_to<double>();
-                        get_writer(0)->close_data();
+                        ticker.ask_price = msg.a.to_double();
+                        ticker.ask_volume = msg.A.to_double();
+                        ticker.bid_price = msg.b.to_double();
+                        ticker.bid_volume = msg.B.to_double();
+                        ticker.exchange_time = exchange_nano(msg.E);
+                        ticker.receive_time = received;
+                        writer->close_data();
+                        latency->record(exchange_nano(msg.E), received, parse_time, yijinjing::time::now_in_nano());
                         return true;
                     };
-                    binapi::ws::websockets::handle h;
-                    if (inst.instrument_type == InstrumentType::Spot) {
-                        h = ws_ptr_->book(symbol.c_str(), cb);
-                    } else if (inst.instrument_type == InstrumentType::FFuture) {
-                        h = fws_ptr_->book(symbol.c_str(), cb);
-                    } else if (inst.instrument_type == InstrumentType::DFuture) {
-                        h = dws_ptr_->book(symbol.c_str(), cb);
+                    if (inst.instrument_type == InstrumentType::Spot or inst.instrument_type == InstrumentType::FFuture or
+                        inst.instrument_type == InstrumentType::DFuture) {
+                        shard->add_stream(inst.instrument_type, [symbol, cb, arbiter = shard->make_arbiter()](
+                                binapi::ws::combined_streams &streams, size_t leg) {
+                            streams.book(symbol.c_str(), FeedArbiter::wrap(
+                                arbiter, leg, cb, [](const binapi::ws::book_ticker_t &msg) { return msg.u; }));
+                        });
                     } else {
                         return false;
                     }
-                    if (it == channel_cache_.end()) {
-                        channel_cache_.emplace(std::make_pair(symbol_id, ChannelInfo{orig_symbol, "ticker", inst.instrument_type, h, true}));
-                    } else {
-                        it->second.ready = true;
-                        it->second.handle = h;
-                    }
+                    channel_cache_.emplace(symbol_id, ChannelInfo{orig_symbol, "ticker", inst.instrument_type, shard->get_index()});
                 }
                 return true;
             }
@@ -369,45 +522,6 @@ namespace kungfu {
                 // }
                 return true;
             }
-
-            void MarketDataBinance::_check_status(kungfu::yijinjing::event_ptr) {
-                SPDLOG_DEBUG("MarketDataBinance::_check_status, connections: {}", channel_cache_.size());
-                std::vector<wingchun::msg::data::Instrument> depth_insts;
-                std::vector<wingchun::msg::data::Instrument> trade_insts;
-                std::vector<wingchun::msg::data::Instrument> ticker_insts;
-                for (auto &it: channel_cache_)
-                {
-                    SPDLOG_DEBUG("handle in MD: {}", fmt::ptr(it.second.handle));
-                    bool is_ready = true;
-                    if (it.second.inst_type == InstrumentType::FFuture)
-                        is_ready = fws_ptr_->is_ready(it.second.handle);
-                    else
-                        is_ready = ws_ptr_->is_ready(it.second.handle);
-                    if (not is_ready) {
-                        it.second.ready = false;
-                        wingchun::msg::data::Instrument inst;
-                        strcpy(inst.symbol, it.second.symbol.c_str());
-                        strcpy(inst.exchange_id, EXCHANGE_BINANCE);
-                        inst.instrument_type = it.second.inst_type;
-                        if (it.second.sub_type == "depth")
-                            depth_insts.push_back(inst);
-                        else if (it.second.sub_type == "trade")
-                            trade_insts.push_back(inst);
-                        else if (it.second.sub_type == "ticker")
-                            ticker_insts.push_back(inst);
-                        SPDLOG_WARN("MarketDataBinance::_check_status re-subscribe:{} {}@{} {}", it.first, it.second.symbol, it.second.sub_type, it.second.ready);
-                    }
-                }
-                if (not depth_insts.empty()) {
-                    subscribe(depth_insts);
-                }
-                if (not trade_insts.empty()) {
-                    subscribe_trade(trade_insts);
-                }
-                if (not ticker_insts.empty()) {
-                    subscribe_ticker(ticker_insts);
-                }
-            }
         }
     }
 }
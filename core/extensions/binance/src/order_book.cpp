@@ -0,0 +1,175 @@
+/**
+ * This is source code under the Apache License 2.0.
+ * Original Author: kx@godzilla.dev
+ * Original date: March 3, 2025
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <spdlog/spdlog.h>
+#include "order_book.h"
+
+using namespace kungfu::wingchun::msg::data;
+
+namespace kungfu {
+    namespace wingchun {
+        namespace binance {
+            OrderBook::OrderBook(std::string symbol, InstrumentType instrument_type, uint32_t instrument_id, size_t max_levels):
+                symbol_(std::move(symbol)), instrument_type_(instrument_type), instrument_id_(instrument_id), max_levels_(max_levels),
+                price_exponent_(EXPONENT), volume_exponent_(EXPONENT), price_scale_(1), volume_scale_(1), last_update_id_(0), synced_(false), first_diff_(false), snapshot_time_(0), snapshot_backoff_(SNAPSHOT_RETRY) {
+                bids_.reserve(max_levels_ + 1);
+                asks_.reserve(max_levels_ + 1);
+            }
+
+            void OrderBook::set_exponents(int8_t price_exponent, int8_t volume_exponent) {
+                price_exponent_ = std::min<int8_t>(std::max(price_exponent, EXPONENT), EXPONENT + MAX_DECIMAL_EXPONENT);
+                volume_exponent_ = std::min<int8_t>(std::max(volume_exponent, EXPONENT), EXPONENT + MAX_DECIMAL_EXPONENT);
+                price_scale_ = DECIMAL_SCALES[price_exponent_ - EXPONENT];
+                volume_scale_ = DECIMAL_SCALES[volume_exponent_ - EXPONENT];
+            }
+
+            void OrderBook::copy_levels(const std::vector<msg::data::DepthLevel> &side, size_t n, msg::data::DepthLevel *out) const {
+                if (price_scale_ == 1 and volume_scale_ == 1) {
+                    memcpy(out, side.data(), sizeof(msg::data::DepthLevel) * n);
+                    return;
+                }
+                for (size_t i = 0; i < n; i++) {
+                    out[i].price = side[i].price / price_scale_;
+                    out[i].volume = side[i].volume / volume_scale_;
+                }
+            }
+
+            void OrderBook::reset() {
+                bids_.clear();
+                asks_.clear();
+                last_update_id_ = 0;
+                synced_ = false;
+                first_diff_ = false;
+                snapshot_time_ = 0;
+            }
+
+            void OrderBook::set_levels(const std::vector<binapi::ws::part_depths_t::depth_t> &bids,
+                                       const std::vector<binapi::ws::part_depths_t::depth_t> &asks) {
+                bids_.resize(std::min(bids.size(), max_levels_));
+                for (size_t i = 0; i < bids_.size(); i++) {
+                    bids_[i] = DepthLevel{to_units(bids[i].price), to_units(bids[i].amount)};
+                }
+                asks_.resize(std::min(asks.size(), max_levels_));
+                for (size_t i = 0; i < asks_.size(); i++) {
+                    asks_[i] = DepthLevel{to_units(asks[i].price), to_units(asks[i].amount)};
+                }
+            }
+
+            OrderBook::Status OrderBook::apply_snapshot(const binapi::rest::depths_t &snapshot) {
+                auto first = std::find_if(buffered_.begin(), buffered_.end(), [&](const Diff &diff) {
+                    return diff.last_update_id > snapshot.lastUpdateId;
+                });
+                if (first != buffered_.end() and first->first_update_id > snapshot.lastUpdateId + 1) {
+                    snapshot_backoff_ = std::min(snapshot_backoff_ * 2, MAX_SNAPSHOT_RETRY);
+                    SPDLOG_WARN("{} snapshot {} older than buffered diff {}, next in {}ms", symbol_, snapshot.lastUpdateId,
+                                first->first_update_id, snapshot_backoff_ / yijinjing::time_unit::NANOSECONDS_PER_MILLISECOND);
+                    return Status::Gap;
+                }
+                bids_.resize(std::min(snapshot.bids.size(), max_levels_));
+                for (size_t i = 0; i < bids_.size(); i++) {
+                    bids_[i] = DepthLevel{to_units(snapshot.bids[i].price), to_units(snapshot.bids[i].amount)};
+                }
+                asks_.resize(std::min(snapshot.asks.size(), max_levels_));
+                for (size_t i = 0; i < asks_.size(); i++) {
+                    asks_[i] = DepthLevel{to_units(snapshot.asks[i].price), to_units(snapshot.asks[i].amount)};
+                }
+                last_update_id_ = snapshot.lastUpdateId;
+                synced_ = true;
+                first_diff_ = true;
+                snapshot_time_ = 0;
+                snapshot_backoff_ = SNAPSHOT_RETRY;
+                for (auto it = first; it != buffered_.end(); it++) {
+                    if (apply(*it) == Status::Gap) {
+                        buffered_.erase(buffered_.begin(), it);
+                        reset();
+                        return Status::Gap;
+                    }
+                }
+                buffered_.clear();
+                return Status::Applied;
+            }
+
+            OrderBook::Status OrderBook::apply(const binapi::ws::diff_depths_t &diff) {
+                if (not synced_) {
+                    if (buffered_.size() == MAX_BUFFERED) {
+                        buffered_.erase(buffered_.begin());
+                    }
+                    Diff buffered{diff.U, diff.u, {}, {}};
+                    for (const auto &level : diff.b) {
+                        buffered.bids.push_back(DepthLevel{to_units(level.price), to_units(level.amount)});
+                    }
+                    for (const auto &level : diff.a) {
+                        buffered.asks.push_back(DepthLevel{to_units(level.price), to_units(level.amount)});
+                    }
+                    buffered_.push_back(std::move(buffered));
+                    return Status::Buffered;
+                }
+                if (diff.u <= last_update_id_) {
+                    return Status::Stale;
+                }
+                if (first_diff_ ? diff.U > last_update_id_ + 1 : diff.U != last_update_id_ + 1) {
+                    SPDLOG_WARN("{} diff [{}, {}] does not follow {}", symbol_, diff.U, diff.u, last_update_id_);
+                    return Status::Gap;
+                }
+                for (const auto &level : diff.b) {
+                    update(bids_, DepthLevel{to_units(level.price), to_units(level.amount)}, true);
+                }
+                for (const auto &level : diff.a) {
+                    update(asks_, DepthLevel{to_units(level.price), to_units(level.amount)}, false);
+                }
+                last_update_id_ = diff.u;
+                first_diff_ = false;
+                return Status::Applied;
+            }
+
+            OrderBook::Status OrderBook::apply(const Diff &diff) {
+                if (diff.last_update_id <= last_update_id_) {
+                    return Status::Stale;
+                }
+                if (first_diff_ ? diff.first_update_id > last_update_id_ + 1 : diff.first_update_id != last_update_id_ + 1) {
+                    SPDLOG_WARN("{} buffered diff [{}, {}] does not follow {}", symbol_, diff.first_update_id, diff.last_update_id, last_update_id_);
+                    return Status::Gap;
+                }
+                for (const auto &level : diff.bids) {
+                    update(bids_, level, true);
+                }
+                for (const auto &level : diff.asks) {
+                    update(asks_, level, false);
+                }
+                last_update_id_ = diff.last_update_id;
+                first_diff_ = false;
+                return Status::Applied;
+            }
+
+            void OrderBook::update(std::vector<DepthLevel> &side, const DepthLevel &level, bool descending) {
+                auto it = std::lower_bound(side.begin(), side.end(), level.price, [descending](const DepthLevel &l, int64_t price) {
+                    return descending ? l.price > price : l.price < price;
+                });
+                if (it != side.end() and it->price == level.price) {
+                    if (level.volume == 0) {
+                        side.erase(it);
+                    } else {
+                        it->volume = level.volume;
+                    }
+                    return;
+                }
+                if (level.volume == 0) {
+                    return;
+                }
+                if (it == side.end() and side.size() >= max_levels_) {
+                    // beyond the window the snapshot covered, would never be complete
+                    return;
+                }
+                side.insert(it, level);
+                if (side.size() > max_levels_) {
+                    side.pop_back();
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,104 @@
+/**
+ * This is source code under the Apache License 2.0.
+ * Original Author: kx@godzilla.dev
+ * Original date: March 3, 2025
+ */
+
+#include "order_table.h"
+
+namespace kungfu {
+    namespace wingchun {
+        namespace binance {
+            OrderTable::OrderTable(size_t capacity): records_(capacity), mask_(0) {
+                size_t buckets = 2;
+                while (buckets < capacity * 2) {
+                    buckets <<= 1;
+                }
+                mask_ = buckets - 1;
+                by_order_id_.assign(buckets, EMPTY);
+                by_ex_order_id_.assign(buckets, EMPTY);
+                free_.reserve(capacity);
+                for (size_t i = capacity; i > 0; i--) {
+                    free_.push_back(i - 1);
+                }
+            }
+
+            OrderRecord *OrderTable::insert(uint64_t order_id, uint32_t source, int64_t last_update, int64_t trigger_time,
+                                            const msg::data::Order &order) {
+                if (free_.empty() or by_order_id_[find_bucket<&OrderRecord::order_id>(by_order_id_, order_id)] != EMPTY) {
+                    return nullptr;
+                }
+                uint32_t slot = free_.back();
+                free_.pop_back();
+                records_[slot] = OrderRecord{order_id, 0, source, last_update, trigger_time, order};
+                index_insert<&OrderRecord::order_id>(by_order_id_, slot);
+                return &records_[slot];
+            }
+
+            OrderRecord *OrderTable::find(uint64_t order_id) {
+                uint32_t slot = by_order_id_[find_bucket<&OrderRecord::order_id>(by_order_id_, order_id)];
+                return slot == EMPTY ? nullptr : &records_[slot];
+            }
+
+            OrderRecord *OrderTable::find_by_ex_order_id(uint64_t ex_order_id) {
+                if (ex_order_id == 0) {
+                    return nullptr;
+                }
+                uint32_t slot = by_ex_order_id_[find_bucket<&OrderRecord::ex_order_id>(by_ex_order_id_, ex_order_id)];
+                return slot == EMPTY ? nullptr : &records_[slot];
+            }
+
+            void OrderTable::set_ex_order_id(OrderRecord &record, uint64_t ex_order_id) {
+                if (record.ex_order_id == ex_order_id) {
+                    return;
+                }
+                if (record.ex_order_id != 0) {
+                    index_erase<&OrderRecord::ex_order_id>(by_ex_order_id_, find_bucket<&OrderRecord::ex_order_id>(by_ex_order_id_, record.ex_order_id));
+                }
+                record.ex_order_id = ex_order_id;
+                if (ex_order_id != 0) {
+                    index_insert<&OrderRecord::ex_order_id>(by_ex_order_id_, &record - records_.data());
+                }
+            }
+
+            void OrderTable::erase(OrderRecord &record) {
+                set_ex_order_id(record, 0);
+                index_erase<&OrderRecord::order_id>(by_order_id_, find_bucket<&OrderRecord::order_id>(by_order_id_, record.order_id));
+                free_.push_back(&record - records_.data());
+            }
+
+            template<uint64_t OrderRecord::*Key>
+            size_t OrderTable::find_bucket(const std::vector<uint32_t> &index, uint64_t key) const {
+                size_t b = bucket(key);
+                while (index[b] != EMPTY and records_[index[b]].*Key != key) {
+                    b = (b + 1) & mask_;
+                }
+                return b;
+            }
+
+            template<uint64_t OrderRecord::*Key>
+            void OrderTable::index_insert(std::vector<uint32_t> &index, uint32_t slot) {
+                index[find_bucket<Key>(index, records_[slot].*Key)] = slot;
+            }
+
+            template<uint64_t OrderRecord::*Key>
+            void OrderTable::index_erase(std::vector<uint32_t> &index, size_t hole) {
+                // shift back entries of the probe run that would no longer be reachable across the hole
+                size_t b = hole;
+                for (;;) {
+                    b = (b + 1) & mask_;
+                    if (index[b] == EMPTY) {
+                        break;
+                    }
+                    size_t home = bucket(records_[index[b]].*Key);
+                    bool reachable = hole <= b ? (home > hole and home <= b) : (home > hole or home <= b);
+                    if (not reachable) {
+                        index[hole] = index[b];
+                        hole = b;
+                    }
+                }
+                index[hole] = EMPTY;
+            }
+        }
+    }
+}
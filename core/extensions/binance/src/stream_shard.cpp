@@ -0,0 +1,249 @@
+/**
+ * This is source code under the Apache License 2.0.
+ * Original Author: kx@godzilla.dev
+ * Original date: March 3, 2025
+ */
+
+#include <algorithm>
+#include <boost/asio/post.hpp>
+#include <spdlog/spdlog.h>
+#include <kungfu/yijinjing/time.h>
+#include "stream_shard.h"
+#include "type_convert_binance.h"
+
+namespace kungfu {
+    namespace wingchun {
+        namespace binance {
+            /** subscriptions coming in within this time share connections */
+            static constexpr std::chrono::milliseconds FLUSH_DELAY(100);
+            static constexpr std::chrono::seconds CHECK_INTERVAL(5);
+            static constexpr int MAX_LEGS = 4;
+
+            FeedArbiter::FeedArbiter(std::vector<LegStats> &stats): stats_(stats), last_seq_(0), recent_{}, next_(0) {}
+
+            bool FeedArbiter::arrive(size_t leg, uint64_t seq) {
+                if (seq == 0) {
+                    return true;
+                }
+                auto &stats = stats_[leg];
+                if (stats_.size() == 1) {
+                    // nothing to arbitrate, only drop what the exchange sent again
+                    if (seq <= last_seq_) {
+                        stats.late++;
+                        return false;
+                    }
+                    last_seq_ = seq;
+                    stats.wins++;
+                    return true;
+                }
+                auto time = yijinjing::time::now_in_nano();
+                if (seq <= last_seq_) {
+                    stats.late++;
+                    for (auto &arrival : recent_) {
+                        if (arrival.seq == seq) {
+                            auto lag = time - arrival.time;
+                            stats.lag_count++;
+                            stats.lag_sum += lag;
+                            stats.lag_max = std::max(stats.lag_max, lag);
+                            break;
+                        }
+                    }
+                    return false;
+                }
+                last_seq_ = seq;
+                recent_[next_] = Arrival{seq, time};
+                next_ = (next_ + 1) % RECENT;
+                stats.wins++;
+                return true;
+            }
+
+            int64_t receive_time() {
+                return from_steady_clock(binapi::ws::receive_time());
+            }
+
+            StreamLatency::StreamLatency(uint32_t instrument_id, InstrumentType instrument_type, int32_t msg_type):
+                instrument_id_(instrument_id), instrument_type_(instrument_type), msg_type_(msg_type),
+                begin_time_(yijinjing::time::now_in_nano()), skewed_(0) {}
+
+            void StreamLatency::record(int64_t exchange_time, int64_t receive_time, int64_t parse_time, int64_t write_time) {
+                // exchange clocks are synced with ours only so far, receiving before the exchange sent is skew
+                if (exchange_time > receive_time) {
+                    skewed_++;
+                } else if (exchange_time > 0) {
+                    wire_.record(receive_time - exchange_time);
+                }
+                parse_.record(parse_time - receive_time);
+                journal_.record(write_time - parse_time);
+            }
+
+            void StreamLatency::report(const yijinjing::journal::writer_ptr &writer, int64_t time) {
+                if (journal_.count() > 0) {
+                    auto &latency = writer->open_data<msg::data::MarketDataLatency>(0, msg::type::MarketDataLatency);
+                    latency.instrument_id = instrument_id_;
+                    latency.instrument_type = instrument_type_;
+                    latency.msg_type = msg_type_;
+                    latency.begin_time = begin_time_;
+                    latency.end_time = time;
+                    latency.count = static_cast<uint32_t>(journal_.count());
+                    latency.skewed = skewed_;
+                    wire_.fill(latency.wire);
+                    parse_.fill(latency.parse);
+                    journal_.fill(latency.journal);
+                    writer->close_data();
+                }
+                begin_time_ = time;
+                skewed_ = 0;
+                wire_.reset();
+                parse_.reset();
+                journal_.reset();
+            }
+
+            StreamShard::StreamShard(size_t index, const Configuration &config, yijinjing::journal::writer_ptr writer):
+                index_(index),
+                streams_per_connection_(std::max(1, std::min(config.md_streams_per_connection, 1024))),
+                writer_(std::move(writer)), flush_timer_(ioctx_), check_timer_(ioctx_), flush_scheduled_(false) {
+                auto leg_count = static_cast<size_t>(std::max(1, std::min(config.md_feed_legs, MAX_LEGS)));
+                auto host = [](const std::string &primary, const std::string &alternate, size_t leg) {
+                    return leg == 0 or alternate.empty() ? primary : alternate;
+                };
+                for (size_t leg = 0; leg < leg_count; leg++) {
+                    legs_.push_back(Leg{
+                        std::make_shared<binapi::ws::websockets>(
+                            ioctx_, host(config.spot_wss_host, config.spot_wss_alt_host, leg), std::to_string(config.spot_wss_port)),
+                        std::make_shared<binapi::ws::websockets>(
+                            ioctx_, host(config.ubase_wss_host, config.ubase_wss_alt_host, leg), std::to_string(config.ubase_wss_port)),
+                        std::make_shared<binapi::ws::websockets>(
+                            ioctx_, host(config.cbase_wss_host, config.cbase_wss_alt_host, leg), std::to_string(config.cbase_wss_port))
+                    });
+                }
+                leg_stats_.resize(leg_count);
+                leg_stats_begin_time_ = yijinjing::time::now_in_nano();
+            }
+
+            void StreamShard::run() {
+                boost::asio::io_context::work worker(ioctx_);
+                check();
+                ioctx_.run();
+            }
+
+            void StreamShard::stop() {
+                ioctx_.stop();
+            }
+
+            void StreamShard::add_stream(InstrumentType type, stream_adder adder) {
+                boost::asio::post(ioctx_, [this, type, adder = std::move(adder)]() mutable {
+                    pending_[type].push_back(std::move(adder));
+                    if (flush_scheduled_) {
+                        return;
+                    }
+                    flush_scheduled_ = true;
+                    flush_timer_.expires_after(FLUSH_DELAY);
+                    flush_timer_.async_wait([this](const boost::system::error_code &ec) {
+                        flush_scheduled_ = false;
+                        if (not ec) {
+                            flush();
+                        }
+                    });
+                });
+            }
+
+            std::shared_ptr<FeedArbiter> StreamShard::make_arbiter() {
+                return std::make_shared<FeedArbiter>(leg_stats_);
+            }
+
+            std::shared_ptr<StreamLatency> StreamShard::make_latency(uint32_t instrument_id, InstrumentType instrument_type, int32_t msg_type) {
+                auto latency = std::make_shared<StreamLatency>(instrument_id, instrument_type, msg_type);
+                boost::asio::post(ioctx_, [this, latency]() {
+                    latencies_.push_back(latency);
+                });
+                return latency;
+            }
+
+            binapi::ws::websockets &StreamShard::get_websockets(InstrumentType type, size_t leg) {
+                if (type == InstrumentType::FFuture) {
+                    return *legs_[leg].fws_ptr;
+                }
+                if (type == InstrumentType::DFuture) {
+                    return *legs_[leg].dws_ptr;
+                }
+                return *legs_[leg].ws_ptr;
+            }
+
+            void StreamShard::flush() {
+                for (auto &item : pending_) {
+                    auto &streams = item.second;
+                    for (size_t begin = 0; begin < streams.size(); begin += streams_per_connection_) {
+                        auto end = std::min(begin + streams_per_connection_, streams.size());
+                        for (size_t leg = 0; leg < legs_.size(); leg++) {
+                            connections_.push_back(Connection{item.first, leg, {streams.begin() + begin, streams.begin() + end}, nullptr});
+                            open(connections_.back());
+                        }
+                    }
+                }
+                pending_.clear();
+            }
+
+            void StreamShard::open(Connection &connection) {
+                binapi::ws::combined_streams streams;
+                for (auto &adder : connection.streams) {
+                    adder(streams, connection.leg);
+                }
+                SPDLOG_INFO("shard {} opens {} streams on one connection of leg {}", index_, streams.size(), connection.leg);
+                connection.handle = get_websockets(connection.type, connection.leg).combined(std::move(streams));
+            }
+
+            void StreamShard::check() {
+                for (auto &connection : connections_) {
+                    if (not get_websockets(connection.type, connection.leg).is_ready(connection.handle)) {
+                        SPDLOG_WARN("shard {} reconnects {} streams of leg {}", index_, connection.streams.size(), connection.leg);
+                        open(connection);
+                    }
+                }
+                report();
+                check_timer_.expires_after(CHECK_INTERVAL);
+                check_timer_.async_wait([this](const boost::system::error_code &ec) {
+                    if (not ec) {
+                        check();
+                    }
+                });
+            }
+
+            void StreamShard::report() {
+                auto time = yijinjing::time::now_in_nano();
+                for (auto &latency : latencies_) {
+                    latency->report(writer_, time);
+                }
+                uint64_t total = 0;
+                for (auto &stats : leg_stats_) {
+                    total += stats.wins;
+                }
+                for (size_t leg = 0; leg < leg_stats_.size(); leg++) {
+                    auto &stats = leg_stats_[leg];
+                    auto lag_mean = stats.lag_count > 0 ? stats.lag_sum / int64_t(stats.lag_count) : 0;
+                    if (legs_.size() > 1) {
+                        SPDLOG_INFO("shard {} leg {} won {} of {} updates, {} late by {}us on average, {}us at most",
+                                    index_, leg, stats.wins, total, stats.late, lag_mean / 1000, stats.lag_max / 1000);
+                    } else if (stats.late > 0) {
+                        SPDLOG_WARN("shard {} dropped {} updates sent again", index_, stats.late);
+                    }
+                    if (stats.wins > 0 or stats.late > 0) {
+                        auto &leg_stats = writer_->open_data<msg::data::FeedLegStats>(0, msg::type::FeedLegStats);
+                        leg_stats.shard = static_cast<uint32_t>(index_);
+                        leg_stats.leg = static_cast<uint32_t>(leg);
+                        leg_stats.legs = static_cast<uint32_t>(legs_.size());
+                        leg_stats.begin_time = leg_stats_begin_time_;
+                        leg_stats.end_time = time;
+                        leg_stats.wins = stats.wins;
+                        leg_stats.late = stats.late;
+                        leg_stats.lag_count = stats.lag_count;
+                        leg_stats.lag_mean = lag_mean;
+                        leg_stats.lag_max = stats.lag_max;
+                        writer_->close_data();
+                    }
+                    stats = LegStats{};
+                }
+                leg_stats_begin_time_ = time;
+            }
+        }
+    }
+}
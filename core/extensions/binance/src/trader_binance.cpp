@@ -6,7 +6,10 @@
 
 #include <utility>
 #include <algorithm>
+#include <cstdlib>
 #include <string>
+#include <boost/asio/post.hpp>
+#include <binapi/errors.hpp>
 #include "kungfu/wingchun/utils.h"
 #include "trader_binance.h"
 #include "type_convert_binance.h"
@@ -33,17 +36,23 @@ namespace kungfu {
                 return str;
             }
 
+            /** request failed after it may have reached binance, dropped session or no reply in time */
+            static inline bool outcome_unknown(int ec) {
+                return ec == static_cast<int>(binapi::rest::e_error::DISCONNECTED) or
+                       ec == static_cast<int>(binapi::rest::e_error::TIMEOUT);
+            }
+
             TraderBinance::TraderBinance(bool low_latency, yijinjing::data::locator_ptr locator, const std::string& account_id, const std::string& json_config):
-                Trader(low_latency, std::move(locator), SOURCE_BINANCE, account_id) {
+                Trader(low_latency, std::move(locator), SOURCE_BINANCE, account_id),
+                config_(nlohmann::json::parse(json_config).get<Configuration>()), orders_(config_.max_open_orders), open_orders_(0) {
                 yijinjing::log::copy_log_settings(get_io_device()->get_home(), SOURCE_BINANCE);
-                config_ = nlohmann::json::parse(json_config);
                 rest_ptr_ = std::make_shared<binapi::rest::api>(
                     ioctx_
                     , config_.spot_rest_host                      //"api.binance.com"
                     , std::to_string(config_.spot_rest_port)      //"443"
                     , config_.access_key
                     , config_.secret_key
-                    , 10000
+                    , RECV_WINDOW_MS
                     );
                 frest_ptr_ = std::make_shared<binapi::rest::api>(
                     ioctx_
@@ -51,12 +60,21 @@ namespace kungfu {
                     , std::to_string(config_.ubase_rest_port)      //"443"
                     , config_.access_key
                     , config_.secret_key
-                    , 10000
+                    , RECV_WINDOW_MS
                     );
                 ws_ptr_ = std::make_shared<binapi::ws::websockets>(
                     ioctx_, config_.spot_wss_host, std::to_string(config_.spot_wss_port));
                 fws_ptr_ = std::make_shared<binapi::ws::websockets>(
                     ioctx_, config_.ubase_wss_host, std::to_string(config_.ubase_wss_port));
+                if (config_.order_transport == "ws") {
+                    // requests made while a session is down go out through rest instead
+                    wsapi_ptr_ = std::make_shared<binapi::wsapi::api>(
+                        ioctx_, config_.spot_wsapi_host, std::to_string(config_.spot_wsapi_port), "/ws-api/v3",
+                        config_.access_key, config_.secret_key, RECV_WINDOW_MS, rest_ptr_);
+                    fwsapi_ptr_ = std::make_shared<binapi::wsapi::api>(
+                        ioctx_, config_.ubase_wsapi_host, std::to_string(config_.ubase_wsapi_port), "/ws-fapi/v1",
+                        config_.access_key, config_.secret_key, RECV_WINDOW_MS, frest_ptr_);
+                }
             }
 
             TraderBinance::~TraderBinance() {}
@@ -69,10 +87,21 @@ namespace kungfu {
             void TraderBinance::on_start() {
                 Trader::on_start();
                 task_thread_ = std::make_shared<std::thread>([this]() {
+                    place_thread(yijinjing::os::thread_role::IO);
                     boost::asio::io_context::work worker(this->ioctx_);
                     this->ioctx_.run();
                     return 0;
                 });
+                // orders go out on connections opened and kept warm ahead of time, not after a DNS lookup and handshake each
+                rest_ptr_->keep_alive(config_.rest_connections, "/api/v3/ping", config_.rest_keep_alive_ms);
+                frest_ptr_->keep_alive(config_.rest_connections, "/fapi/v1/ping", config_.rest_keep_alive_ms);
+                // websocket api sessions, orders fall back to rest while a session is down
+                if (wsapi_ptr_) {
+                    wsapi_ptr_->set_on_connected([this]() { resolve_unconfirmed(InstrumentType::Spot); });
+                    fwsapi_ptr_->set_on_connected([this]() { resolve_unconfirmed(InstrumentType::FFuture); });
+                    wsapi_ptr_->start();
+                    fwsapi_ptr_->start();
+                }
                 std::string runtime_folder = get_runtime_folder();
                 SPDLOG_INFO(
                     "Connecting BINANCE TD for {} at {}:{} with runtime folder {}",
@@ -94,119 +123,177 @@ namespace kungfu {
             bool TraderBinance::insert_order(const yijinjing::event_ptr& event) {
                 const OrderInput& input = event->data<OrderInput>();
                 int64_t nano = kungfu::yijinjing::time::now_in_nano();
+                // every Order frame about the input points back at it, so latency tools can join them
+                int64_t trigger_time = event->gen_time();
                 auto source = event->source();
                 msg::data::Order order{};
                 order_from_input(input, order);
                 order.insert_time = nano;
                 order.update_time = nano;
-                {
-                    std::lock_guard<std::mutex> lock(order_mtx_);
-                    order_data_.emplace(input.order_id, order_map_record(input.order_id, "", source, nano, order));
+                if (open_orders_.fetch_add(1) >= orders_.capacity()) {
+                    open_orders_--;
+                    SPDLOG_ERROR("(input){} rejected, {} orders already open", nlohmann::json(input).dump(), orders_.capacity());
+                    order.status = OrderStatus::Error;
+                    get_writer(source)->write(trigger_time, msg::type::Order, order);
+                    return false;
                 }
-                if (input.instrument_type == InstrumentType::Spot) {
-                    auto order_ptr = std::make_shared<binapi::rest::api>(
-                        ioctx_
-                        , config_.spot_rest_host                      //"api.binance.com"
-                        , std::to_string(config_.spot_rest_port)      //"443"
-                        , config_.access_key
-                        , config_.secret_key
-                        , 10000
-                        );
-                    order_ptr->new_order(
-                        to_binance_symbol(input.symbol),
-                        to_binance(input.side),
-                        to_binance(input.order_type),
-                        binapi::e_time::GTC,
-                        binapi::e_trade_resp_type::FULL,
-                        to_string(input.volume),
-                        to_string(input.price),
-                        std::to_string(input.order_id),
-                        std::string(""),
-                        std::string(""),
-                        [&, source, nano, ptr=std::move(order_ptr)](const char* fl, int ec, std::string errmsg, binapi::rest::new_order_resp_type res) {
-                            if (ec) {
-                                SPDLOG_ERROR("{} (input){} (ErrorId){}, (ErrorMsg){}", fl, nlohmann::json(input).dump(), ec, errmsg);
-                            }
-                            auto writer = get_writer(source);
-                            msg::data::Order& order = writer->open_data<msg::data::Order>(nano, msg::type::Order);
-                            order_from_input(input, order);
-                            order.insert_time = nano;
-                            order.update_time = nano;
-                            if (!res.is_valid_responce_type()) {
-                                order.status = OrderStatus::Error;
-                                writer->close_data();
-                                SPDLOG_ERROR("(input){} (ErrorId){}, (ErrorMsg){}", nlohmann::json(input).dump(), ec, errmsg);
-                                return false;
-                            } else {
-                                auto ex_order_id = res.get_order_id();
-                                strcpy(order.ex_order_id, std::to_string(ex_order_id).c_str());
-                                order.status = OrderStatus::Submitted;
-                                writer->close_data();
-                                SPDLOG_TRACE("success to insert order, (order_id){} (xtp_order_id) {}", input.order_id, ex_order_id);
-                                return true;
-                            }
-                            return true;
-                        });
-                } else if (input.instrument_type == InstrumentType::FFuture) {
-                    auto order_ptr = std::make_shared<binapi::rest::api>(
-                        ioctx_
-                        , config_.ubase_rest_host                      //"fapi.binance.com"
-                        , std::to_string(config_.ubase_rest_port)      //"443"
-                        , config_.access_key
-                        , config_.secret_key
-                        , 10000
-                        );
-                    order_ptr->future_new_order(
-                        to_binance_symbol(input.symbol),
-                        to_binance(input.side),
-                        to_binance(input.position_side),
-                        to_binance(input.order_type),
-                        std::string(""),
-                        to_string(input.price),
-                        to_string(input.volume),
-                        std::to_string(input.order_id),
-                        std::string(""),
-                        std::string(""),
-                        std::string(""),
-                        std::string(""),
-                        binapi::e_time::GTC,
-                        std::string(""),
-                        std::string(""),
-                        binapi::e_trade_resp_type::FULL,
-                        0,
-                        [&, source, nano, ptr=std::move(order_ptr)](const char* fl, int ec, std::string errmsg, binapi::rest::future_new_order_resp_t res) {
-                            if (ec) {
+                // the table takes the order before the request goes, a duplicate id never reaches binance, and an order is
+                // in the table before any reply or update about it
+                boost::asio::post(ioctx_, [this, input, source, nano, trigger_time, order]() {
+                    if (orders_.insert(order.order_id, source, nano, trigger_time, order) == nullptr) {
+                        open_orders_--;
+                        // no Order frame, it would carry the id of the order already open
+                        SPDLOG_ERROR("(input){} rejected, order {} is already open", nlohmann::json(input).dump(), order.order_id);
+                        return;
+                    }
+                    auto symbol = to_binance_symbol(input.symbol);
+                    auto volume = to_string(input.volume);
+                    auto price = to_string(input.price);
+                    auto client_order_id = std::to_string(input.order_id);
+                    if (input.instrument_type == InstrumentType::Spot) {
+                        auto cb = [this, input, source, nano, trigger_time](const char* fl, int ec, std::string errmsg, binapi::rest::new_order_resp_type res) {
+                                if (outcome_unknown(ec)) {
+                                    SPDLOG_WARN("{} order {} may have reached binance, looked up later, (ErrorId){}, (ErrorMsg){}", fl, input.order_id, ec, errmsg);
+                                    unconfirmed_.push_back(input.order_id);
+                                    return true;
+                                }
+                                if (ec) {
+                                    SPDLOG_ERROR("{} (input){} (ErrorId){}, (ErrorMsg){}", fl, nlohmann::json(input).dump(), ec, errmsg);
+                                }
                                 auto writer = get_writer(source);
-                                msg::data::Order& order = writer->open_data<msg::data::Order>(nano, msg::type::Order);
+                                msg::data::Order& order = writer->open_data<msg::data::Order>(trigger_time, msg::type::Order);
                                 order_from_input(input, order);
                                 order.insert_time = nano;
                                 order.update_time = nano;
-                                order.status = OrderStatus::Error;
-                                writer->close_data();
-                                SPDLOG_ERROR("{} (input){} (ErrorId){}, (ErrorMsg){}", fl, nlohmann::json(input).dump(), ec, errmsg);
-                            } else {
-                                std::stringstream oss;
-                                oss << res;
-                                SPDLOG_INFO("(res){}", oss.str());
-			    }
-                            return true;
-                        });
-                }
+                                order.send_time = from_steady_clock(binapi::rest::sent_time());
+                                // on error the response is default constructed, which looks like a valid ack
+                                if (ec or !res.is_valid_responce_type()) {
+                                    order.status = OrderStatus::Error;
+                                    writer->close_data();
+                                    SPDLOG_ERROR("(input){} (ErrorId){}, (ErrorMsg){}", nlohmann::json(input).dump(), ec, errmsg);
+                                    erase_order(input.order_id);
+                                    return false;
+                                } else {
+                                    auto ex_order_id = res.get_order_id();
+                                    if (auto record = orders_.find(input.order_id)) {
+                                        orders_.set_ex_order_id(*record, ex_order_id);
+                                        record->order.send_time = order.send_time;
+                                    }
+                                    strcpy(order.ex_order_id, std::to_string(ex_order_id).c_str());
+                                    order.status = OrderStatus::Submitted;
+                                    writer->close_data();
+                                    SPDLOG_TRACE("success to insert order, (order_id){} (xtp_order_id) {}", input.order_id, ex_order_id);
+                                    return true;
+                                }
+                                return true;
+                            };
+                        if (wsapi_ptr_) {
+                            wsapi_ptr_->new_order(
+                                symbol.c_str(),
+                                to_binance(input.side),
+                                to_binance(input.order_type),
+                                binapi::e_time::GTC,
+                                binapi::e_trade_resp_type::FULL,
+                                volume.c_str(),
+                                price.c_str(),
+                                client_order_id.c_str(),
+                                nullptr,
+                                nullptr,
+                                cb);
+                        } else {
+                            rest_ptr_->new_order(
+                                symbol,
+                                to_binance(input.side),
+                                to_binance(input.order_type),
+                                binapi::e_time::GTC,
+                                binapi::e_trade_resp_type::FULL,
+                                volume,
+                                price,
+                                client_order_id,
+                                std::string(""),
+                                std::string(""),
+                                cb);
+                        }
+                    } else if (input.instrument_type == InstrumentType::FFuture) {
+                        auto cb = [this, input, source, nano, trigger_time](const char* fl, int ec, std::string errmsg, binapi::rest::future_new_order_resp_t res) {
+                                if (outcome_unknown(ec)) {
+                                    SPDLOG_WARN("{} order {} may have reached binance, looked up later, (ErrorId){}, (ErrorMsg){}", fl, input.order_id, ec, errmsg);
+                                    unconfirmed_.push_back(input.order_id);
+                                } else if (ec) {
+                                    auto writer = get_writer(source);
+                                    msg::data::Order& order = writer->open_data<msg::data::Order>(trigger_time, msg::type::Order);
+                                    order_from_input(input, order);
+                                    order.insert_time = nano;
+                                    order.update_time = nano;
+                                    order.send_time = from_steady_clock(binapi::rest::sent_time());
+                                    order.status = OrderStatus::Error;
+                                    writer->close_data();
+                                    SPDLOG_ERROR("{} (input){} (ErrorId){}, (ErrorMsg){}", fl, nlohmann::json(input).dump(), ec, errmsg);
+                                    erase_order(input.order_id);
+                                } else {
+                                    // the user data stream may have reported the order already, later updates carry it
+                                    if (auto record = orders_.find(input.order_id)) {
+                                        orders_.set_ex_order_id(*record, res.orderId);
+                                        record->order.send_time = from_steady_clock(binapi::rest::sent_time());
+                                    }
+                                    std::stringstream oss;
+                                    oss << res;
+                                    SPDLOG_INFO("(res){}", oss.str());
+    			    }
+                                return true;
+                            };
+                        if (fwsapi_ptr_) {
+                            fwsapi_ptr_->future_new_order(
+                                symbol.c_str(),
+                                to_binance(input.side),
+                                to_binance(input.position_side),
+                                to_binance(input.order_type),
+                                binapi::e_time::GTC,
+                                volume.c_str(),
+                                price.c_str(),
+                                client_order_id.c_str(),
+                                cb);
+                        } else {
+                            frest_ptr_->future_new_order(
+                                symbol,
+                                to_binance(input.side),
+                                to_binance(input.position_side),
+                                to_binance(input.order_type),
+                                std::string(""),
+                                price,
+                                volume,
+                                client_order_id,
+                                std::string(""),
+                                std::string(""),
+                                std::string(""),
+                                std::string(""),
+                                binapi::e_time::GTC,
+                                std::string(""),
+                                std::string(""),
+                                binapi::e_trade_resp_type::FULL,
+                                0,
+                                cb);
+                        }
+                    }
+                });
                 return true;
             }
 
             bool TraderBinance::query_order(const yijinjing::event_ptr& event) {
-                const OrderAction& action = event->data<OrderAction>();
+                // the callback runs on the io thread once the event is gone, it keeps copies of what it needs
+                const OrderAction action = event->data<OrderAction>();
+                auto source = event->source();
+                auto trigger_time = event->gen_time();
                 std::stringstream sstream(action.ex_order_id);
                 std::size_t ex_order_id_int;
                 sstream >> ex_order_id_int;
-                auto cb = [&](const char* fl, int ec, std::string errmsg, binapi::rest::order_info_t res) {
+                auto cb = [this, action, source, trigger_time](const char* fl, int ec, std::string errmsg, binapi::rest::order_info_t res) {
                         if (ec) {
                             SPDLOG_ERROR("{} (action){} (ErrorId){}, (ErrorMsg){}", fl, nlohmann::json(action).dump(), ec, errmsg);
                             return true;
                         }
-                        auto writer = get_writer(event->source());
-                        msg::data::Order& order = writer->open_data<msg::data::Order>(event->gen_time(), msg::type::Order);
+                        auto writer = get_writer(source);
+                        msg::data::Order& order = writer->open_data<msg::data::Order>(trigger_time, msg::type::Order);
                         order.order_id = action.order_id;
                         order.insert_time = res.time;
                         order.update_time = res.updateTime;
@@ -214,6 +301,8 @@ namespace kungfu {
                         strcpy(order.exchange_id, EXCHANGE_BINANCE);
                         strcpy(order.account_id, get_account_id().c_str());
                         strcpy(order.source_id, get_source().c_str());
+                        order.instrument_type = action.instrument_type;
+                        instruments_->stamp(order);
                         order.price = res.price.convert_to<double>();
                         order.volume = res.origQty.convert_to<double>();
                         order.status = from_binance(binapi::e_status_from_string(res.status.c_str()));
@@ -224,21 +313,21 @@ namespace kungfu {
                         SPDLOG_TRACE("success to insert order, (order_id){} (binance_order_id) {}", action.order_id, action.ex_order_id);
                         return true;
                     };
+                auto symbol = to_binance_symbol(action.symbol);
+                auto client_order_id = std::to_string(action.order_id);
                 if (action.instrument_type == InstrumentType::Spot) {
-                    rest_ptr_->order_info(
-                        to_binance_symbol(action.symbol)
-                        , ex_order_id_int
-                        , std::to_string(action.order_id)
-                        , cb
-                    );
+                    if (wsapi_ptr_) {
+                        wsapi_ptr_->order_info(symbol.c_str(), ex_order_id_int, client_order_id.c_str(), cb);
+                    } else {
+                        rest_ptr_->order_info(symbol, ex_order_id_int, client_order_id, cb);
+                    }
                 } else if (action.instrument_type == InstrumentType::FFuture) {
-                    std::cout << "query: " << action.symbol << std::endl;
-                    frest_ptr_->future_order_info(
-                        to_binance_symbol(action.symbol)
-                        , ex_order_id_int
-                        , std::to_string(action.order_id)
-                        , cb
-                    );
+                    SPDLOG_TRACE("query: {}", action.symbol);
+                    if (fwsapi_ptr_) {
+                        fwsapi_ptr_->future_order_info(symbol.c_str(), ex_order_id_int, client_order_id.c_str(), cb);
+                    } else {
+                        frest_ptr_->future_order_info(symbol, ex_order_id_int, client_order_id, cb);
+                    }
                 } else {
                     SPDLOG_ERROR("fail to query order {}, unknown instrument type", static_cast<int>(action.instrument_type));
                     return false;
@@ -247,11 +336,12 @@ namespace kungfu {
             }
 
             bool TraderBinance::cancel_order(const yijinjing::event_ptr& event) {
-                const OrderAction& action = event->data<OrderAction>();
+                // the callback runs on the io thread once the event is gone
+                const OrderAction action = event->data<OrderAction>();
                 std::stringstream sstream(action.ex_order_id);
                 std::size_t ex_order_id_int;
                 sstream >> ex_order_id_int;
-                auto cb = [&](const char* fl, int ec, std::string errmsg, binapi::rest::cancel_order_info_t res) {
+                auto cb = [action](const char* fl, int ec, std::string errmsg, binapi::rest::cancel_order_info_t res) {
                         if (ec == 0 and res.orderId != 0 and res.status == "CANCELED") {
                             SPDLOG_TRACE("{} success to request cancel order {}, ex_order_id: {}, symbol: {}", fl, action.order_id, action.ex_order_id, action.symbol);
                             return true;
@@ -262,22 +352,19 @@ namespace kungfu {
                         }
                     };
                 if (action.ex_order_id != 0 or action.order_id > 0) {
-                    if (action.instrument_type == InstrumentType::Spot)
-                        rest_ptr_->cancel_order(
-                            to_binance_symbol(action.symbol)
-                            , ex_order_id_int
-                            , std::string()
-                            , std::to_string(action.order_id)
-                            , cb
-                        );
-                    else if (action.instrument_type == InstrumentType::FFuture)
-                        frest_ptr_->future_cancel_order(
-                            to_binance_symbol(action.symbol)
-                            , ex_order_id_int
-                            , std::to_string(action.order_id)
-                            , cb
-                        );
-                    else {
+                    auto symbol = to_binance_symbol(action.symbol);
+                    auto client_order_id = std::to_string(action.order_id);
+                    if (action.instrument_type == InstrumentType::Spot) {
+                        if (wsapi_ptr_)
+                            wsapi_ptr_->cancel_order(symbol.c_str(), ex_order_id_int, nullptr, client_order_id.c_str(), cb);
+                        else
+                            rest_ptr_->cancel_order(symbol, ex_order_id_int, std::string(), client_order_id, cb);
+                    } else if (action.instrument_type == InstrumentType::FFuture) {
+                        if (fwsapi_ptr_)
+                            fwsapi_ptr_->future_cancel_order(symbol.c_str(), ex_order_id_int, client_order_id.c_str(), cb);
+                        else
+                            frest_ptr_->future_cancel_order(symbol, ex_order_id_int, client_order_id, cb);
+                    } else {
                         SPDLOG_ERROR("fail to cancel order {}, unknown instrument type", static_cast<int>(action.instrument_type));
                         return true;
                     }
@@ -288,6 +375,88 @@ namespace kungfu {
                 }
             }
 
+            void TraderBinance::erase_order(uint64_t order_id) {
+                if (auto record = orders_.find(order_id)) {
+                    orders_.erase(*record);
+                    open_orders_--;
+                }
+            }
+
+            void TraderBinance::resolve_unconfirmed(InstrumentType type) {
+                std::vector<uint64_t> others;
+                std::vector<uint64_t> ready;
+                for (auto order_id : unconfirmed_) {
+                    // orders the user data stream reported finished meanwhile are gone already
+                    if (auto record = orders_.find(order_id)) {
+                        (record->order.instrument_type == type ? ready : others).push_back(order_id);
+                    }
+                }
+                unconfirmed_.swap(others);
+                for (auto order_id : ready) {
+                    query_unconfirmed(*orders_.find(order_id));
+                }
+            }
+
+            void TraderBinance::query_unconfirmed(const OrderRecord &record) {
+                auto order_id = record.order_id;
+                auto cb = [this, order_id](const char* fl, int ec, std::string errmsg, binapi::rest::order_info_t res) {
+                    auto record = orders_.find(order_id);
+                    if (record == nullptr) {
+                        return true;
+                    }
+                    // binance turns away orders arriving after their recvWindow, only then not finding one is final
+                    bool expired = kungfu::yijinjing::time::now_in_nano() - record->order.insert_time >
+                                   static_cast<int64_t>(RECV_WINDOW_MS) * time_unit::NANOSECONDS_PER_MILLISECOND;
+                    if (ec == static_cast<int>(binapi::rest::e_error::NO_SUCH_ORDER) and expired) {
+                        SPDLOG_ERROR("order {} never reached binance", order_id);
+                        auto writer = get_writer(record->source);
+                        msg::data::Order& order = writer->open_data<msg::data::Order>(record->trigger_time, msg::type::Order);
+                        order = record->order;
+                        order.update_time = kungfu::yijinjing::time::now_in_nano();
+                        order.status = OrderStatus::Error;
+                        writer->close_data();
+                        erase_order(order_id);
+                        return true;
+                    }
+                    if (ec) {
+                        SPDLOG_WARN("{} order {} still unconfirmed, (ErrorId){}, (ErrorMsg){}", fl, order_id, ec, errmsg);
+                        unconfirmed_.push_back(order_id);
+                        return true;
+                    }
+                    auto writer = get_writer(record->source);
+                    msg::data::Order& order = writer->open_data<msg::data::Order>(record->trigger_time, msg::type::Order);
+                    order = record->order;
+                    order.set_ex_order_id(std::to_string(res.orderId));
+                    order.volume_traded = res.executedQty.convert_to<double>();
+                    order.volume_left = order.volume - order.volume_traded;
+                    order.update_time = res.updateTime;
+                    order.status = from_binance(binapi::e_status_from_string(res.status.c_str()));
+                    writer->close_data();
+                    SPDLOG_INFO("order {} confirmed by lookup, (ex_order_id){} (status){}", order_id, res.orderId, res.status);
+                    if (order.status != OrderStatus::PartialFilledActive and order.status != OrderStatus::Submitted) {
+                        erase_order(order_id);
+                    } else {
+                        orders_.set_ex_order_id(*record, res.orderId);
+                    }
+                    return true;
+                };
+                auto symbol = to_binance_symbol(record.order.symbol);
+                auto client_order_id = std::to_string(order_id);
+                if (record.order.instrument_type == InstrumentType::Spot) {
+                    if (wsapi_ptr_) {
+                        wsapi_ptr_->order_info(symbol.c_str(), 0, client_order_id.c_str(), cb);
+                    } else {
+                        rest_ptr_->order_info(symbol, 0, client_order_id, cb);
+                    }
+                } else {
+                    if (fwsapi_ptr_) {
+                        fwsapi_ptr_->future_order_info(symbol.c_str(), 0, client_order_id.c_str(), cb);
+                    } else {
+                        frest_ptr_->future_order_info(symbol, 0, client_order_id, cb);
+                    }
+                }
+            }
+
             bool TraderBinance::adjust_leverage(const yijinjing::event_ptr &event) {
                 auto json_str = event->data_as_string();
                 auto source = event->source();
@@ -339,13 +508,18 @@ namespace kungfu {
                             });
                     }
                 }
+                // orders of rest requests that timed out, and lookups that failed themselves, are tried again here
+                boost::asio::post(ioctx_, [this]() {
+                    resolve_unconfirmed(InstrumentType::Spot);
+                    resolve_unconfirmed(InstrumentType::FFuture);
+                });
                 if (ws_ptr_->fetch_reconnect_flag()) {
                     _start_userdata(InstrumentType::Spot);
-                    SPDLOG_TRACE("TraderXTC::_update_order spot: {}", order_data_.size());
+                    SPDLOG_TRACE("TraderXTC::_update_order spot: {}", open_orders_.load());
                 }
                 if (fws_ptr_->fetch_reconnect_flag()) {
                     _start_userdata(InstrumentType::FFuture);
-                    SPDLOG_TRACE("TraderXTC::_update_order ffuture: {}", order_data_.size());
+                    SPDLOG_TRACE("TraderXTC::_update_order ffuture: {}", open_orders_.load());
                 }
             }
 
@@ -368,45 +542,48 @@ namespace kungfu {
                                 SPDLOG_ERROR("msg when error occurred: {}", oss.str());
                                 return true;
                             }
-                            std::size_t i_coid;
-                            std::stringstream sstream(msg.o.c);
-                            sstream >> i_coid;
-                            auto itr = order_data_.find(i_coid);
-                            if (itr != order_data_.end()) {
+                            auto record = orders_.find(std::strtoull(msg.o.c.c_str(), nullptr, 10));
+                            if (record == nullptr) {
+                                // client order id is not ours, e.g. binance names cancels it made itself
+                                record = orders_.find_by_ex_order_id(msg.o.i);
+                            }
+                            if (record != nullptr) {
                                 std::ostringstream oss;
                                 oss << msg;
-                                SPDLOG_INFO("order update: {} | {}", itr->second.source, oss.str());
-                                auto writer = get_writer(itr->second.source);
-                                msg::data::Order& order = writer->open_data<msg::data::Order>(0, msg::type::Order);
-                                order.strategy_id = itr->second.order.strategy_id;
-                                order.order_id = i_coid;
+                                SPDLOG_INFO("order update: {} | {}", record->source, oss.str());
+                                auto writer = get_writer(record->source);
+                                msg::data::Order& order = writer->open_data<msg::data::Order>(record->trigger_time, msg::type::Order);
+                                order.strategy_id = record->order.strategy_id;
+                                order.order_id = record->order_id;
                                 order.set_ex_order_id(std::to_string(msg.o.i));
                                 order.set_symbol(from_binance_symbol(msg.o.s));
-                                order.instrument_type = itr->second.order.instrument_type;
+                                order.instrument_type = record->order.instrument_type;
+                                order.instrument_id = record->order.instrument_id;
                                 order.set_exchange_id(EXCHANGE_BINANCE);
                                 order.set_account_id(get_account_id());
                                 order.set_source_id(get_source());
                                 order.set_fee_currency(msg.o.N);
-                                order.price = itr->second.order.price;
-                                order.volume = itr->second.order.volume;
+                                order.price = record->order.price;
+                                order.volume = record->order.volume;
                                 order.volume_traded = msg.o.z.convert_to<double>();
                                 order.volume_left = order.volume - order.volume_traded;
-                                order.stop_price = itr->second.order.stop_price;
+                                order.stop_price = record->order.stop_price;
                                 order.avg_price = msg.o.ap.convert_to<double>();
                                 order.fee = msg.o.n.convert_to<double>();
                                 order.status = from_binance(binapi::e_status_from_string(msg.o.X.c_str()));
-                                order.side = itr->second.order.side;
-                                order.order_type = itr->second.order.order_type;
-                                order.position_side = itr->second.order.position_side;
-                                order.insert_time = itr->second.order.insert_time;
+                                order.side = record->order.side;
+                                order.order_type = record->order.order_type;
+                                order.position_side = record->order.position_side;
+                                order.insert_time = record->order.insert_time;
+                                order.send_time = record->order.send_time;
                                 order.update_time = msg.T;
                                 order.close_pnl = msg.o.rp.convert_to<double>();
                                 writer->close_data();
-                                {
-                                    std::lock_guard<std::mutex> lock(order_mtx_);
-                                    if (order.status != OrderStatus::PartialFilledActive and order.status != OrderStatus::Submitted) {
-                                        order_data_.erase(i_coid);
-                                    }
+                                if (order.status != OrderStatus::PartialFilledActive and order.status != OrderStatus::Submitted) {
+                                    orders_.erase(*record);
+                                    open_orders_--;
+                                } else {
+                                    orders_.set_ex_order_id(*record, msg.o.i);
                                 }
                             }
                             return true;
@@ -433,45 +610,48 @@ namespace kungfu {
                                 SPDLOG_ERROR("{} (future_order_update_t) (ErrorId){}, (ErrorMsg){}", fl, ec, errmsg);
                                 return true;
                             }
-                            std::size_t i_coid;
-                            std::stringstream sstream(msg.c);
-                            sstream >> i_coid;
-                            auto itr = order_data_.find(i_coid);
-                            if (itr != order_data_.end()) {
+                            auto record = orders_.find(std::strtoull(msg.c.c_str(), nullptr, 10));
+                            if (record == nullptr) {
+                                // client order id is not ours, e.g. binance names cancels it made itself
+                                record = orders_.find_by_ex_order_id(msg.i);
+                            }
+                            if (record != nullptr) {
                                 std::ostringstream oss;
                                 oss << msg;
-                                SPDLOG_INFO("order update: {} | {}", itr->second.source, oss.str());
-                                auto writer = get_writer(itr->second.source);
-                                msg::data::Order& order = writer->open_data<msg::data::Order>(0, msg::type::Order);
-                                order.strategy_id = itr->second.order.strategy_id;
-                                order.order_id = i_coid;
+                                SPDLOG_INFO("order update: {} | {}", record->source, oss.str());
+                                auto writer = get_writer(record->source);
+                                msg::data::Order& order = writer->open_data<msg::data::Order>(record->trigger_time, msg::type::Order);
+                                order.strategy_id = record->order.strategy_id;
+                                order.order_id = record->order_id;
                                 order.set_ex_order_id(std::to_string(msg.i));
                                 order.set_symbol(from_binance_symbol(msg.s));
-                                order.instrument_type = itr->second.order.instrument_type;
+                                order.instrument_type = record->order.instrument_type;
+                                order.instrument_id = record->order.instrument_id;
                                 order.set_exchange_id(EXCHANGE_BINANCE);
                                 order.set_account_id(get_account_id());
                                 order.set_source_id(get_source());
                                 order.set_fee_currency("");
-                                order.price = itr->second.order.price;
-                                order.volume = itr->second.order.volume;
+                                order.price = record->order.price;
+                                order.volume = record->order.volume;
                                 order.volume_traded = msg.z.convert_to<double>();
                                 order.volume_left = order.volume - order.volume_traded;
-                                order.stop_price = itr->second.order.stop_price;
+                                order.stop_price = record->order.stop_price;
                                 order.avg_price = msg.Z.convert_to<double>() / order.volume_traded;
                                 order.fee = msg.n.convert_to<double>();
                                 order.status = from_binance(binapi::e_status_from_string(msg.X.c_str()));
-                                order.side = itr->second.order.side;
-                                order.order_type = itr->second.order.order_type;
-                                order.position_side = itr->second.order.position_side;
-                                order.insert_time = itr->second.order.insert_time;
+                                order.side = record->order.side;
+                                order.order_type = record->order.order_type;
+                                order.position_side = record->order.position_side;
+                                order.insert_time = record->order.insert_time;
+                                order.send_time = record->order.send_time;
                                 order.update_time = msg.T;
                                 // order.close_pnl = msg.o.rp.convert_to<double>();
                                 writer->close_data();
-                                {
-                                    std::lock_guard<std::mutex> lock(order_mtx_);
-                                    if (order.status != OrderStatus::PartialFilledActive and order.status != OrderStatus::Submitted) {
-                                        order_data_.erase(i_coid);
-                                    }
+                                if (order.status != OrderStatus::PartialFilledActive and order.status != OrderStatus::Submitted) {
+                                    orders_.erase(*record);
+                                    open_orders_--;
+                                } else {
+                                    orders_.set_ex_order_id(*record, msg.i);
                                 }
                             }
                             return true;
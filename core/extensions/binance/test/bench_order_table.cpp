@@ -0,0 +1,174 @@
+/**
+ * This is source code under the Apache License 2.0.
+ * Original Author: kx@godzilla.dev
+ * Original date: March 3, 2025
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "order_table.h"
+
+using namespace kungfu::wingchun;
+using namespace kungfu::wingchun::binance;
+
+namespace
+{
+    constexpr size_t LIVE = 10000;
+
+    /** open orders as the trader held them before OrderTable, a tree under a mutex, exchange id as a string */
+    struct map_orders
+    {
+        struct record
+        {
+            std::size_t order_id;
+            std::string ex_order_id;
+            std::size_t source;
+            std::size_t last_update;
+            msg::data::Order order;
+        };
+
+        std::map<std::size_t, record> orders;
+        std::mutex mutex;
+
+        void insert(uint64_t order_id, const msg::data::Order &order)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            orders.emplace(order_id, record{order_id, "", 1, 0, order});
+        }
+
+        void ack(uint64_t order_id, uint64_t ex_order_id)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = orders.find(order_id);
+            if (it != orders.end())
+            {
+                it->second.ex_order_id = std::to_string(ex_order_id);
+            }
+        }
+
+        size_t update(uint64_t order_id)
+        {
+            auto it = orders.find(order_id);
+            return it != orders.end() ? it->second.source : 0;
+        }
+
+        void erase(uint64_t order_id)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            orders.erase(order_id);
+        }
+    };
+
+    struct table_orders
+    {
+        OrderTable orders{LIVE * 2};
+
+        void insert(uint64_t order_id, const msg::data::Order &order)
+        { orders.insert(order_id, 1, 0, 0, order); }
+
+        void ack(uint64_t order_id, uint64_t ex_order_id)
+        {
+            if (auto record = orders.find(order_id))
+            {
+                orders.set_ex_order_id(*record, ex_order_id);
+            }
+        }
+
+        size_t update(uint64_t order_id)
+        {
+            auto record = orders.find(order_id);
+            return record ? record->source : 0;
+        }
+
+        void erase(uint64_t order_id)
+        {
+            if (auto record = orders.find(order_id))
+            {
+                orders.erase(*record);
+            }
+        }
+    };
+
+    struct report
+    {
+        double mean_ns;
+        double p99_ns;
+        double max_ns;
+    };
+
+    /**
+     * LIVE orders open, each round one of them at random is updated then closed, and a new one is inserted and acked
+     * in its place. times one round at a time
+     */
+    template<typename Orders>
+    report churn(Orders &orders, int rounds, size_t &sink)
+    {
+        std::mt19937_64 rng(20250303);
+        msg::data::Order order{};
+        std::vector<uint64_t> live(LIVE);
+        uint64_t next = 1ull << 40;
+        for (auto &order_id : live)
+        {
+            order_id = next++;
+            orders.insert(order_id, order);
+            orders.ack(order_id, order_id ^ 0x5555);
+        }
+
+        std::vector<double> samples(rounds);
+        for (int r = 0; r < rounds; r++)
+        {
+            auto &order_id = live[rng() % LIVE];
+            auto start = std::chrono::steady_clock::now();
+            sink += orders.update(order_id);
+            orders.erase(order_id);
+            order_id = next++;
+            orders.insert(order_id, order);
+            orders.ack(order_id, order_id ^ 0x5555);
+            samples[r] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        report res{};
+        for (double sample : samples)
+        {
+            res.mean_ns += sample / rounds;
+        }
+        std::sort(samples.begin(), samples.end());
+        res.p99_ns = samples[samples.size() * 99 / 100];
+        res.max_ns = samples.back();
+        return res;
+    }
+}
+
+/**
+ * times the life of an order, insert, ack, update and erase, with 10k orders open, in OrderTable against the map under
+ * a mutex it replaced
+ * usage: binance_bench_order_table [rounds, default 1000000]
+ */
+int main(int argc, char **argv)
+{
+    const int rounds = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    size_t sink = 0;
+    map_orders before;
+    auto map_report = churn(before, rounds, sink);
+    table_orders after;
+    auto table_report = churn(after, rounds, sink);
+    if (before.orders.size() != LIVE or after.orders.size() != LIVE or sink != 2 * static_cast<size_t>(rounds))
+    {
+        fprintf(stderr, "orders lost on the way, %zu and %zu open\n", before.orders.size(), after.orders.size());
+        return 1;
+    }
+
+    printf("%12s %8s %10s %10s %10s\n", "store", "live", "mean ns", "p99 ns", "max ns");
+    printf("%12s %8zu %10.1f %10.1f %10.1f\n", "map+mutex", LIVE, map_report.mean_ns, map_report.p99_ns, map_report.max_ns);
+    printf("%12s %8zu %10.1f %10.1f %10.1f\n", "OrderTable", LIVE, table_report.mean_ns, table_report.p99_ns,
+           table_report.max_ns);
+    return 0;
+}
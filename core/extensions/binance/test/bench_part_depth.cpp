@@ -0,0 +1,194 @@
+/**
+ * This is source code under the Apache License 2.0.
+ * Original Author: kx@godzilla.dev
+ * Original date: March 3, 2025
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <binapi/flatjson.hpp>
+#include <binapi/types.hpp>
+
+#include "depth_fixtures.h"
+
+using namespace binapi;
+using binapi::ws::part_depths_t;
+
+namespace
+{
+    /** levels as part_depths_t held them before fixed_type */
+    struct double_depths
+    {
+        struct depth_t
+        {
+            double_type price;
+            double_type amount;
+        };
+
+        std::size_t E;
+        std::size_t T;
+        std::size_t u;
+        std::vector<depth_t> a;
+        std::vector<depth_t> b;
+    };
+
+    template<typename T>
+    void get_or_throw(T &v, const char *member, const flatjson::fjson &j)
+    {
+        try
+        {
+            v = j.at(member).to<T>();
+        } catch (const std::exception &)
+        {
+            v = 0;
+        }
+    }
+
+    /** part_depths_t::construct as it was, at(idx) per level, a multiprecision parse per field, a throw per missing field */
+    double_depths construct_before(const flatjson::fjson &json)
+    {
+        double_depths res{};
+        get_or_throw(res.E, "E", json);
+        get_or_throw(res.T, "T", json);
+        get_or_throw(res.u, "u", json);
+        if (!res.u)
+        {
+            get_or_throw(res.u, "lastUpdateId", json);
+        }
+        flatjson::fjson a, b;
+        if (json.contains("asks"))
+        {
+            a = json.at("asks");
+            b = json.at("bids");
+        } else
+        {
+            a = json.at("a");
+            b = json.at("b");
+        }
+        for (auto idx = 0u; idx < a.size(); ++idx)
+        {
+            double_depths::depth_t item{};
+            const auto it = a.at(idx);
+            item.price.assign(it.at(0).to_string());
+            item.amount.assign(it.at(1).to_string());
+            res.a.push_back(std::move(item));
+        }
+        for (auto idx = 0u; idx < b.size(); ++idx)
+        {
+            double_depths::depth_t item{};
+            const auto it = b.at(idx);
+            item.price.assign(it.at(0).to_string());
+            item.amount.assign(it.at(1).to_string());
+            res.b.push_back(std::move(item));
+        }
+        return res;
+    }
+
+    bool same_levels(const std::vector<part_depths_t::depth_t> &after, const std::vector<double_depths::depth_t> &before)
+    {
+        static const double_type scale(fixed_type::scale);
+        if (after.size() != before.size())
+        {
+            return false;
+        }
+        for (size_t i = 0; i < after.size(); i++)
+        {
+            if (after[i].price.units != double_type(before[i].price * scale).convert_to<std::int64_t>() or
+                after[i].amount.units != double_type(before[i].amount * scale).convert_to<std::int64_t>())
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template<typename F>
+    double per_message(int rounds, F &&f)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < rounds; r++)
+        {
+            f();
+        }
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / rounds;
+    }
+}
+
+/**
+ * times part_depths_t::construct against the multiprecision path it replaced, on depth20 fixtures of spot and futures,
+ * after checking both paths read the same levels
+ * usage: binance_bench_part_depth [rounds, default 20000]
+ */
+int main(int argc, char **argv)
+{
+    const int rounds = argc > 1 ? std::atoi(argv[1]) : 20000;
+    printf("%10s %8s %12s %12s %12s %14s %14s\n", "fixture", "bytes", "tokenize us", "before us", "after us",
+           "to double bef", "to double aft");
+
+    for (const char *name : {"spot", "futures"})
+    {
+        const char *fixture = std::strcmp(name, "spot") == 0 ? test::SPOT_DEPTH20 : test::FUTURES_DEPTH20;
+        const size_t size = std::strlen(fixture);
+        flatjson::fjson json{fixture, size};
+        if (!json.is_valid())
+        {
+            fprintf(stderr, "%s: %s\n", name, json.error_string());
+            return 1;
+        }
+
+        part_depths_t after{};
+        part_depths_t::construct(json, after);
+        auto before = construct_before(json);
+        if (after.u != before.u or after.E != before.E or after.T != before.T or after.a.empty() or
+            not same_levels(after.a, before.a) or not same_levels(after.b, before.b))
+        {
+            fprintf(stderr, "%s: levels parsed differ from the multiprecision path\n", name);
+            return 1;
+        }
+
+        double sink = 0;
+        double tokenize = per_message(rounds, [&]()
+        { sink += json.reload(fixture, size); });
+        double before_us = per_message(rounds, [&]()
+        { sink += construct_before(json).a.size(); });
+        double after_us = per_message(rounds, [&]()
+        {
+            part_depths_t::construct(json, after);
+            sink += after.a.size();
+        });
+        double to_double_before = per_message(rounds, [&]()
+        {
+            for (const auto &level : before.a)
+            {
+                sink += level.price.convert_to<double>() + level.amount.convert_to<double>();
+            }
+            for (const auto &level : before.b)
+            {
+                sink += level.price.convert_to<double>() + level.amount.convert_to<double>();
+            }
+        });
+        double to_double_after = per_message(rounds, [&]()
+        {
+            for (const auto &level : after.a)
+            {
+                sink += level.price.to_double() + level.amount.to_double();
+            }
+            for (const auto &level : after.b)
+            {
+                sink += level.price.to_double() + level.amount.to_double();
+            }
+        });
+        printf("%10s %8zu %12.2f %12.2f %12.2f %14.2f %14.2f\n", name, size, tokenize, before_us, after_us,
+               to_double_before, to_double_after);
+        if (sink == 0)
+        {
+            fprintf(stderr, "nothing parsed\n");
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,43 @@
+/**
+ * This is source code under the Apache License 2.0.
+ * Original Author: kx@godzilla.dev
+ * Original date: March 3, 2025
+ */
+
+#ifndef GODZILLA_BINANCE_TEST_DEPTH_FIXTURES_H
+#define GODZILLA_BINANCE_TEST_DEPTH_FIXTURES_H
+
+namespace test
+{
+    /** payload of btcusdt@depth20@100ms on spot, levels quoted with 8 decimals */
+    static const char SPOT_DEPTH20[] =
+        "{\"lastUpdateId\":61547330528,\"bids\":[[\"84312.47000000\",\"2.43211480\"],[\"84312.45000000\",\"1.96345341\"],"
+        "[\"84312.44000000\",\"1.75602217\"],[\"84312.42000000\",\"1.57940664\"],[\"84312.41000000\",\"2.85398893\"],"
+        "[\"84312.38000000\",\"1.46240395\"],[\"84312.35000000\",\"2.84120052\"],[\"84312.33000000\",\"1.10429524\"],"
+        "[\"84312.30000000\",\"1.76901583\"],[\"84312.29000000\",\"2.37365308\"],[\"84312.28000000\",\"0.03158721\"],"
+        "[\"84312.25000000\",\"3.06956774\"],[\"84312.24000000\",\"1.51861959\"],[\"84312.21000000\",\"3.26550924\"],"
+        "[\"84312.19000000\",\"0.95889276\"],[\"84312.16000000\",\"0.49418023\"],[\"84312.15000000\",\"2.54606406\"],"
+        "[\"84312.12000000\",\"2.21872905\"],[\"84312.10000000\",\"2.06746261\"],"
+        "[\"84312.09000000\",\"1.65672956\"]],\"asks\":[[\"84312.48000000\",\"1.92124077\"],[\"84312.50000000\",\"2.53275428\"],"
+        "[\"84312.51000000\",\"1.05799930\"],[\"84312.54000000\",\"1.11678136\"],[\"84312.57000000\",\"1.89582668\"],"
+        "[\"84312.58000000\",\"0.90793255\"],[\"84312.59000000\",\"2.23834347\"],[\"84312.60000000\",\"2.43290065\"],"
+        "[\"84312.61000000\",\"2.18544163\"],[\"84312.63000000\",\"1.05420839\"],[\"84312.66000000\",\"3.25877795\"],"
+        "[\"84312.68000000\",\"1.32939690\"],[\"84312.69000000\",\"0.87534585\"],[\"84312.72000000\",\"1.66801963\"],"
+        "[\"84312.75000000\",\"3.15386851\"],[\"84312.78000000\",\"0.45564532\"],[\"84312.80000000\",\"0.47266371\"],"
+        "[\"84312.83000000\",\"0.41688441\"],[\"84312.85000000\",\"1.20412033\"],[\"84312.88000000\",\"0.48533022\"]]}";
+
+    /** payload of btcusdt@depth20@100ms on usd-m futures, which also carries E, T and the update ids of the diff stream */
+    static const char FUTURES_DEPTH20[] =
+        ""
+        "{\"e\":\"depthUpdate\",\"E\":1741003212457,\"T\":1741003212451,\"s\":\"BTCUSDT\",\"U\":6836519880211,\"u\":6836519887304,\"pu\":6836519880102,\"b\":[[\"84280.1\",\"2.153\"],"
+        "[\"84279.8\",\"2.664\"],[\"84279.7\",\"2.841\"],[\"84279.5\",\"1.787\"],[\"84279.3\",\"2.450\"],[\"84279.1\",\"1.105\"],"
+        "[\"84278.8\",\"3.040\"],[\"84278.7\",\"0.784\"],[\"84278.6\",\"1.736\"],[\"84278.4\",\"0.536\"],[\"84278.1\",\"1.056\"],"
+        "[\"84277.8\",\"1.552\"],[\"84277.6\",\"3.001\"],[\"84277.4\",\"0.581\"],[\"84277.3\",\"1.114\"],[\"84277.0\",\"3.283\"],"
+        "[\"84276.8\",\"2.102\"],[\"84276.7\",\"2.672\"],[\"84276.5\",\"3.215\"],[\"84276.3\",\"0.348\"]],\"a\":[[\"84280.2\",\"1.810\"],"
+        "[\"84280.4\",\"2.864\"],[\"84280.6\",\"0.224\"],[\"84280.9\",\"2.528\"],[\"84281.2\",\"0.161\"],[\"84281.4\",\"0.997\"],"
+        "[\"84281.6\",\"0.118\"],[\"84281.7\",\"3.260\"],[\"84281.9\",\"1.842\"],[\"84282.2\",\"1.451\"],[\"84282.4\",\"2.874\"],"
+        "[\"84282.5\",\"1.216\"],[\"84282.8\",\"1.019\"],[\"84283.1\",\"0.273\"],[\"84283.2\",\"1.704\"],[\"84283.5\",\"3.072\"],"
+        "[\"84283.8\",\"1.834\"],[\"84283.9\",\"0.622\"],[\"84284.1\",\"2.747\"],[\"84284.3\",\"2.490\"]]}";
+}
+
+#endif //GODZILLA_BINANCE_TEST_DEPTH_FIXTURES_H
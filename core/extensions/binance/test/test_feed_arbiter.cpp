@@ -0,0 +1,144 @@
+/**
+ * This is source code under the Apache License 2.0.
+ * Original Author: kx@godzilla.dev
+ * Original date: March 3, 2025
+ */
+
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "stream_shard.h"
+
+using namespace kungfu::wingchun::binance;
+
+namespace
+{
+    /** an update of a stream, u its exchange sequence id */
+    struct update
+    {
+        uint64_t u;
+    };
+
+    /** what the callback behind the arbiter got, in order */
+    struct published
+    {
+        int ec;
+        uint64_t u;
+    };
+
+    /** callback of each leg, through one arbiter, into one list */
+    struct legs
+    {
+        std::vector<LegStats> stats;
+        std::vector<published> out;
+        std::vector<std::function<bool(const char *, int, std::string, const update &)>> callbacks;
+
+        explicit legs(size_t n) : stats(n)
+        {
+            auto arbiter = std::make_shared<FeedArbiter>(stats);
+            auto cb = [this](const char *, int ec, std::string, const update &msg)
+            {
+                out.push_back({ec, msg.u});
+                return true;
+            };
+            auto seq = [](const update &msg)
+            { return msg.u; };
+            for (size_t leg = 0; leg < n; leg++)
+            {
+                callbacks.push_back(FeedArbiter::wrap(arbiter, leg, cb, seq));
+            }
+        }
+
+        void arrive(size_t leg, uint64_t u, int ec = 0)
+        { callbacks[leg](__FILE__, ec, ec ? "closed" : "", update{u}); }
+
+        std::vector<uint64_t> published_ids() const
+        {
+            std::vector<uint64_t> ids;
+            for (auto &p : out)
+            {
+                ids.push_back(p.u);
+            }
+            return ids;
+        }
+    };
+}
+
+TEST(feed_arbiter, publishes_first_copy_of_interleaved_legs)
+{
+    legs feed(2);
+    // each leg is ahead for a while, then the other
+    feed.arrive(0, 1);
+    feed.arrive(1, 1);
+    feed.arrive(0, 2);
+    feed.arrive(1, 3);
+    feed.arrive(1, 2);
+    feed.arrive(0, 3);
+    feed.arrive(1, 4);
+    feed.arrive(0, 4);
+
+    EXPECT_EQ(feed.published_ids(), (std::vector<uint64_t>{1, 2, 3, 4}));
+    EXPECT_EQ(feed.stats[0].wins, 2u);
+    EXPECT_EQ(feed.stats[1].wins, 2u);
+    EXPECT_EQ(feed.stats[0].late, 2u);
+    // leg 1 sent 2 after 3, late either way
+    EXPECT_EQ(feed.stats[1].late, 2u);
+    EXPECT_EQ(feed.stats[0].lag_count, 2u);
+    EXPECT_EQ(feed.stats[1].lag_count, 2u);
+    EXPECT_GE(feed.stats[0].lag_sum, 0);
+    EXPECT_GE(feed.stats[0].lag_max, 0);
+}
+
+TEST(feed_arbiter, drops_copy_on_second_leg)
+{
+    legs feed(2);
+    feed.arrive(0, 10);
+    feed.arrive(1, 10);
+    feed.arrive(1, 10);
+
+    EXPECT_EQ(feed.published_ids(), (std::vector<uint64_t>{10}));
+    EXPECT_EQ(feed.stats[0].wins, 1u);
+    EXPECT_EQ(feed.stats[1].wins, 0u);
+    EXPECT_EQ(feed.stats[1].late, 2u);
+    EXPECT_EQ(feed.stats[1].lag_count, 2u);
+
+    // updates without sequence id can not be arbitrated, every copy goes through
+    feed.arrive(1, 0);
+    feed.arrive(0, 0);
+    EXPECT_EQ(feed.published_ids(), (std::vector<uint64_t>{10, 0, 0}));
+}
+
+TEST(feed_arbiter, passes_errors_through)
+{
+    legs feed(2);
+    feed.arrive(0, 5);
+    // an error on either leg reaches the callback, whatever its message holds
+    feed.arrive(1, 5, 1);
+    feed.arrive(0, 0, 2);
+    ASSERT_EQ(feed.out.size(), 3u);
+    EXPECT_EQ(feed.out[1].ec, 1);
+    EXPECT_EQ(feed.out[2].ec, 2);
+    // and leaves arbitration as it was
+    EXPECT_EQ(feed.stats[1].late, 0u);
+    feed.arrive(1, 6);
+    feed.arrive(0, 6);
+    EXPECT_EQ(feed.published_ids(), (std::vector<uint64_t>{5, 5, 0, 6}));
+    EXPECT_EQ(feed.stats[1].wins, 1u);
+    EXPECT_EQ(feed.stats[0].late, 1u);
+}
+
+TEST(feed_arbiter, single_leg_drops_updates_sent_again)
+{
+    legs feed(1);
+    feed.arrive(0, 1);
+    feed.arrive(0, 2);
+    feed.arrive(0, 2);
+    feed.arrive(0, 1);
+    feed.arrive(0, 3);
+
+    EXPECT_EQ(feed.published_ids(), (std::vector<uint64_t>{1, 2, 3}));
+    EXPECT_EQ(feed.stats[0].wins, 3u);
+    EXPECT_EQ(feed.stats[0].late, 2u);
+    EXPECT_EQ(feed.stats[0].lag_count, 0u);
+}
@@ -0,0 +1,283 @@
+/**
+ * This is source code under the Apache License 2.0.
+ * Original Author: kx@godzilla.dev
+ * Original date: March 3, 2025
+ */
+
+#include <functional>
+#include <map>
+#include <random>
+#include <gtest/gtest.h>
+#include <spdlog/spdlog.h>
+
+#include "order_book.h"
+
+using namespace kungfu::wingchun;
+using namespace kungfu::wingchun::binance;
+
+namespace
+{
+    /** the obvious book, one map per side */
+    struct ReferenceBook
+    {
+        std::map<int64_t, int64_t, std::greater<>> bids;
+        std::map<int64_t, int64_t> asks;
+
+        template<class Side>
+        static void update(Side &side, int64_t price, int64_t volume)
+        {
+            if (volume == 0)
+            {
+                side.erase(price);
+            } else
+            {
+                side[price] = volume;
+            }
+        }
+
+        void apply(const binapi::ws::diff_depths_t &diff)
+        {
+            for (const auto &level : diff.b)
+            {
+                update(bids, level.price.units, level.amount.units);
+            }
+            for (const auto &level : diff.a)
+            {
+                update(asks, level.price.units, level.amount.units);
+            }
+        }
+
+        template<class Side>
+        static void expect_same(const Side &side, const std::vector<msg::data::DepthLevel> &levels)
+        {
+            ASSERT_EQ(side.size(), levels.size());
+            size_t i = 0;
+            for (const auto &level : side)
+            {
+                ASSERT_EQ(level.first, levels[i].price) << i;
+                ASSERT_EQ(level.second, levels[i].volume) << i;
+                i++;
+            }
+        }
+
+        void expect_same(const OrderBook &book) const
+        {
+            expect_same(bids, book.get_bids());
+            expect_same(asks, book.get_asks());
+        }
+    };
+
+    /** diff of a few levels on each side around 100.0, a third of them removing the level */
+    binapi::ws::diff_depths_t make_diff(std::mt19937 &rng, size_t first_update_id, size_t last_update_id)
+    {
+        binapi::ws::diff_depths_t diff{};
+        diff.U = first_update_id;
+        diff.u = last_update_id;
+        auto volume = [&]()
+        { return rng() % 3 == 0 ? 0 : static_cast<int64_t>(1 + rng() % 1000) * 1000000; };
+        for (int i = 0, n = 1 + rng() % 5; i < n; i++)
+        {
+            diff.b.push_back({binapi::fixed_type{(9800 + static_cast<int64_t>(rng() % 200)) * 1000000}, binapi::fixed_type{volume()}});
+        }
+        for (int i = 0, n = 1 + rng() % 5; i < n; i++)
+        {
+            diff.a.push_back({binapi::fixed_type{(10001 + static_cast<int64_t>(rng() % 200)) * 1000000}, binapi::fixed_type{volume()}});
+        }
+        return diff;
+    }
+
+    binapi::rest::depths_t make_snapshot(size_t last_update_id, ReferenceBook &reference)
+    {
+        binapi::rest::depths_t snapshot{};
+        snapshot.lastUpdateId = last_update_id;
+        for (int64_t i = 0; i < 20; i++)
+        {
+            int64_t bid = 9990 - i * 7;
+            int64_t ask = 10010 + i * 7;
+            snapshot.bids.push_back({binapi::double_type(fmt::format("{}.{:02}", bid / 100, bid % 100)), binapi::double_type("1.5")});
+            snapshot.asks.push_back({binapi::double_type(fmt::format("{}.{:02}", ask / 100, ask % 100)), binapi::double_type("2.5")});
+            reference.bids[bid * 1000000] = 150000000;
+            reference.asks[ask * 1000000] = 250000000;
+        }
+        return snapshot;
+    }
+}
+
+TEST(order_book, matches_reference_book)
+{
+    spdlog::set_level(spdlog::level::err);
+    std::mt19937 rng(20250303);
+    OrderBook book("btc_usdt", InstrumentType::Spot, 1);
+    ReferenceBook reference;
+
+    // diffs arrive before the snapshot, the ones it already covers are dropped when it lands
+    std::vector<binapi::ws::diff_depths_t> early;
+    size_t next_id = 1000;
+    for (int i = 0; i < 8; i++)
+    {
+        size_t last = next_id + rng() % 5;
+        early.push_back(make_diff(rng, next_id, last));
+        next_id = last + 1;
+        EXPECT_EQ(book.apply(early.back()), OrderBook::Status::Buffered);
+    }
+    size_t snapshot_id = early[3].u + 1;
+    auto snapshot = make_snapshot(snapshot_id, reference);
+    for (const auto &diff : early)
+    {
+        if (diff.u > snapshot_id)
+        {
+            reference.apply(diff);
+        }
+    }
+    ASSERT_EQ(book.apply_snapshot(snapshot), OrderBook::Status::Applied);
+    EXPECT_TRUE(book.is_synced());
+    reference.expect_same(book);
+
+    for (int i = 0; i < 20000; i++)
+    {
+        size_t last = next_id + rng() % 5;
+        auto diff = make_diff(rng, next_id, last);
+        next_id = last + 1;
+        ASSERT_EQ(book.apply(diff), OrderBook::Status::Applied);
+        reference.apply(diff);
+        if (i % 100 == 0)
+        {
+            reference.expect_same(book);
+        }
+    }
+    reference.expect_same(book);
+    EXPECT_EQ(book.get_last_update_id(), next_id - 1);
+}
+
+TEST(order_book, stale_and_gap)
+{
+    spdlog::set_level(spdlog::level::err);
+    std::mt19937 rng(1);
+    OrderBook book("btc_usdt", InstrumentType::Spot, 1);
+    ReferenceBook reference;
+    ASSERT_EQ(book.apply_snapshot(make_snapshot(100, reference)), OrderBook::Status::Applied);
+    // first diff only has to overlap the snapshot
+    EXPECT_EQ(book.apply(make_diff(rng, 95, 105)), OrderBook::Status::Applied);
+    EXPECT_EQ(book.apply(make_diff(rng, 101, 104)), OrderBook::Status::Stale);
+    EXPECT_EQ(book.apply(make_diff(rng, 106, 110)), OrderBook::Status::Applied);
+    EXPECT_EQ(book.apply(make_diff(rng, 112, 115)), OrderBook::Status::Gap);
+    EXPECT_EQ(book.get_last_update_id(), 110u);
+}
+
+TEST(order_book, backs_off_on_snapshots_older_than_diffs)
+{
+    spdlog::set_level(spdlog::level::err);
+    const int64_t second = kungfu::yijinjing::time_unit::NANOSECONDS_PER_SECOND;
+    std::mt19937 rng(2);
+    OrderBook book("btc_usdt", InstrumentType::Spot, 1);
+    ReferenceBook reference;
+    EXPECT_TRUE(book.is_snapshot_due(0));
+    EXPECT_EQ(book.apply(make_diff(rng, 200, 210)), OrderBook::Status::Buffered);
+
+    int64_t now = 1000 * second;
+    int64_t wait = second;
+    for (int i = 0; i < 8; i++)
+    {
+        book.set_snapshot_time(now);
+        EXPECT_EQ(book.apply_snapshot(make_snapshot(150, reference)), OrderBook::Status::Gap);
+        wait = std::min(wait * 2, 32 * second);
+        EXPECT_FALSE(book.is_snapshot_due(now + wait)) << i;
+        EXPECT_TRUE(book.is_snapshot_due(now + wait + 1)) << i;
+        now += wait + 1;
+    }
+
+    // a snapshot which lands brings the wait back to a second
+    book.set_snapshot_time(now);
+    EXPECT_EQ(book.apply_snapshot(make_snapshot(205, reference)), OrderBook::Status::Applied);
+    EXPECT_FALSE(book.is_snapshot_due(now + 100 * second));
+    book.reset();
+    book.set_snapshot_time(now);
+    EXPECT_FALSE(book.is_snapshot_due(now + second));
+    EXPECT_TRUE(book.is_snapshot_due(now + second + 1));
+}
+
+TEST(order_book, publishes_levels_in_ticks_and_steps)
+{
+    spdlog::set_level(spdlog::level::err);
+    // tick and step sizes as exchange info gives them for spot and futures
+    EXPECT_EQ(get_decimal_exponent(0.01), -2);
+    EXPECT_EQ(get_decimal_exponent(0.1), -1);
+    EXPECT_EQ(get_decimal_exponent(0.00001), -5);
+    EXPECT_EQ(get_decimal_exponent(0.05), -2);
+    EXPECT_EQ(get_decimal_exponent(10), 1);
+
+    OrderBook book("btc_usdt", InstrumentType::Spot, 1);
+    ReferenceBook reference;
+    ASSERT_EQ(book.apply_snapshot(make_snapshot(100, reference)), OrderBook::Status::Applied);
+    std::vector<msg::data::DepthLevel> levels(book.get_bids().size());
+
+    // as the stream quotes them until exponents are known
+    book.copy_levels(book.get_bids(), levels.size(), levels.data());
+    EXPECT_EQ(book.get_price_exponent(), OrderBook::EXPONENT);
+    EXPECT_EQ(levels[0].price, 9990000000);
+    EXPECT_EQ(levels[0].volume, 150000000);
+
+    book.set_exponents(get_decimal_exponent(0.01), get_decimal_exponent(0.00001));
+    book.copy_levels(book.get_bids(), levels.size(), levels.data());
+    EXPECT_EQ(book.get_price_exponent(), -2);
+    EXPECT_EQ(book.get_volume_exponent(), -5);
+    for (size_t i = 0; i < levels.size(); i++)
+    {
+        EXPECT_EQ(from_fixed_point(levels[i].price, -2), from_fixed_point(book.get_bids()[i].price, OrderBook::EXPONENT)) << i;
+        EXPECT_EQ(from_fixed_point(levels[i].volume, -5), from_fixed_point(book.get_bids()[i].volume, OrderBook::EXPONENT)) << i;
+    }
+    EXPECT_EQ(levels[0].price, 9990);
+    EXPECT_EQ(levels[0].volume, 150000);
+
+    // finer than the stream decimals, kept at them
+    book.set_exponents(-12, -10);
+    EXPECT_EQ(book.get_price_exponent(), OrderBook::EXPONENT);
+    EXPECT_EQ(book.get_volume_exponent(), OrderBook::EXPONENT);
+}
+
+TEST(order_book, compact_depth_round_trip)
+{
+    msg::data::Depth depth{};
+    depth.data_time = 1;
+    depth.instrument_type = InstrumentType::Spot;
+    depth.exchange_time = 2;
+    depth.receive_time = 3;
+    // bids stop at the first empty level
+    for (int i = 0; i < 7; i++)
+    {
+        depth.bid_price[i] = (9990 - i * 7) / 100.0;
+        depth.bid_volume[i] = (150000 + i * 3) / 100000.0;
+    }
+    for (int i = 0; i < 10; i++)
+    {
+        depth.ask_price[i] = (10010 + i * 7) / 100.0;
+        depth.ask_volume[i] = (250000 + i * 3) / 100000.0;
+    }
+
+    std::vector<int64_t> buffer(msg::data::CompactDepth::length(10, 10) / sizeof(int64_t) + 1);
+    auto &compact = *reinterpret_cast<msg::data::CompactDepth *>(buffer.data());
+    size_t length = msg::data::compact_from_depth(depth, 42, 0.01, 0.00001, compact);
+    EXPECT_EQ(length, msg::data::CompactDepth::length(7, 10));
+    EXPECT_EQ(compact.price_exponent, -2);
+    EXPECT_EQ(compact.volume_exponent, -5);
+    EXPECT_EQ(compact.bids()[0].price, 9990);
+    EXPECT_EQ(compact.bids()[0].volume, 150000);
+    EXPECT_EQ(compact.asks()[9].price, 10073);
+
+    msg::data::Depth back{};
+    msg::data::depth_from_compact(compact, "btc_usdt", "binance", back);
+    EXPECT_STREQ(back.symbol, "btc_usdt");
+    EXPECT_STREQ(back.exchange_id, "binance");
+    EXPECT_EQ(back.instrument_id, 42u);
+    EXPECT_EQ(back.data_time, depth.data_time);
+    EXPECT_EQ(back.instrument_type, depth.instrument_type);
+    EXPECT_EQ(back.exchange_time, depth.exchange_time);
+    EXPECT_EQ(back.receive_time, depth.receive_time);
+    for (int i = 0; i < 10; i++)
+    {
+        EXPECT_EQ(back.bid_price[i], depth.bid_price[i]) << i;
+        EXPECT_EQ(back.bid_volume[i], depth.bid_volume[i]) << i;
+        EXPECT_EQ(back.ask_price[i], depth.ask_price[i]) << i;
+        EXPECT_EQ(back.ask_volume[i], depth.ask_volume[i]) << i;
+    }
+}
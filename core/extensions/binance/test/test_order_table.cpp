@@ -0,0 +1,206 @@
+/**
+ * This is source code under the Apache License 2.0.
+ * Original Author: kx@godzilla.dev
+ * Original date: March 3, 2025
+ */
+
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "order_table.h"
+
+using namespace kungfu::wingchun;
+using namespace kungfu::wingchun::binance;
+
+namespace
+{
+    /** the obvious table, a map for each index */
+    struct ReferenceTable
+    {
+        std::unordered_map<uint64_t, OrderRecord> orders;
+        std::unordered_map<uint64_t, uint64_t> by_ex_order_id;
+
+        void expect_same(OrderTable &table, uint64_t max_order_id, uint64_t max_ex_order_id) const
+        {
+            ASSERT_EQ(table.size(), orders.size());
+            for (uint64_t order_id = 1; order_id <= max_order_id; order_id++)
+            {
+                auto record = table.find(order_id);
+                auto it = orders.find(order_id);
+                ASSERT_EQ(record != nullptr, it != orders.end()) << order_id;
+                if (record)
+                {
+                    ASSERT_EQ(record->order_id, order_id);
+                    ASSERT_EQ(record->ex_order_id, it->second.ex_order_id) << order_id;
+                    ASSERT_EQ(record->source, it->second.source) << order_id;
+                }
+            }
+            ASSERT_EQ(table.find_by_ex_order_id(0), nullptr);
+            for (uint64_t ex_order_id = 1; ex_order_id <= max_ex_order_id; ex_order_id++)
+            {
+                auto record = table.find_by_ex_order_id(ex_order_id);
+                auto it = by_ex_order_id.find(ex_order_id);
+                ASSERT_EQ(record != nullptr, it != by_ex_order_id.end()) << ex_order_id;
+                if (record)
+                {
+                    ASSERT_EQ(record->order_id, it->second) << ex_order_id;
+                }
+            }
+        }
+    };
+
+    OrderRecord *insert(OrderTable &table, uint64_t order_id, uint32_t source = 1)
+    { return table.insert(order_id, source, 0, 0, msg::data::Order{}); }
+}
+
+TEST(order_table, matches_reference_table)
+{
+    // ids from a small range and a table at most half full keep probe runs long and erases shifting them back
+    constexpr size_t CAPACITY = 64;
+    constexpr uint64_t MAX_ORDER_ID = 160;
+    constexpr uint64_t MAX_EX_ORDER_ID = 240;
+    std::mt19937 rng(20250303);
+    OrderTable table(CAPACITY);
+    ReferenceTable reference;
+    std::vector<uint64_t> live;
+
+    for (int step = 0; step < 200000; step++)
+    {
+        switch (rng() % 5)
+        {
+            case 0:
+            case 1:
+            {
+                uint64_t order_id = 1 + rng() % MAX_ORDER_ID;
+                uint32_t source = rng();
+                auto record = insert(table, order_id, source);
+                bool expected = live.size() < CAPACITY and reference.orders.count(order_id) == 0;
+                ASSERT_EQ(record != nullptr, expected) << step;
+                if (record)
+                {
+                    ASSERT_EQ(record->order_id, order_id);
+                    ASSERT_EQ(record->ex_order_id, 0u);
+                    ASSERT_EQ(record->source, source);
+                    reference.orders[order_id] = *record;
+                    live.push_back(order_id);
+                }
+                break;
+            }
+            case 2:
+            {
+                if (live.empty())
+                {
+                    break;
+                }
+                size_t i = rng() % live.size();
+                uint64_t order_id = live[i];
+                auto record = table.find(order_id);
+                ASSERT_NE(record, nullptr) << step;
+                table.erase(*record);
+                reference.by_ex_order_id.erase(reference.orders[order_id].ex_order_id);
+                reference.orders.erase(order_id);
+                live[i] = live.back();
+                live.pop_back();
+                break;
+            }
+            case 3:
+            {
+                if (live.empty())
+                {
+                    break;
+                }
+                // acks, and ids changed or cleared on a live order, each exchange id on one order at most
+                uint64_t order_id = live[rng() % live.size()];
+                uint64_t ex_order_id = rng() % 8 == 0 ? 0 : 1 + rng() % MAX_EX_ORDER_ID;
+                auto owner = reference.by_ex_order_id.find(ex_order_id);
+                if (owner != reference.by_ex_order_id.end() and owner->second != order_id)
+                {
+                    break;
+                }
+                auto record = table.find(order_id);
+                ASSERT_NE(record, nullptr) << step;
+                table.set_ex_order_id(*record, ex_order_id);
+                auto &expected = reference.orders[order_id];
+                reference.by_ex_order_id.erase(expected.ex_order_id);
+                expected.ex_order_id = ex_order_id;
+                if (ex_order_id != 0)
+                {
+                    reference.by_ex_order_id[ex_order_id] = order_id;
+                }
+                break;
+            }
+            default:
+            {
+                uint64_t order_id = 1 + rng() % MAX_ORDER_ID;
+                uint64_t ex_order_id = 1 + rng() % MAX_EX_ORDER_ID;
+                ASSERT_EQ(table.find(order_id) != nullptr, reference.orders.count(order_id) == 1) << step;
+                auto record = table.find_by_ex_order_id(ex_order_id);
+                auto owner = reference.by_ex_order_id.find(ex_order_id);
+                ASSERT_EQ(record != nullptr, owner != reference.by_ex_order_id.end()) << step;
+                if (record)
+                {
+                    ASSERT_EQ(record->order_id, owner->second) << step;
+                }
+            }
+        }
+        if (step % 97 == 0)
+        {
+            reference.expect_same(table, MAX_ORDER_ID, MAX_EX_ORDER_ID);
+        }
+    }
+    reference.expect_same(table, MAX_ORDER_ID, MAX_EX_ORDER_ID);
+}
+
+TEST(order_table, duplicate_order_id)
+{
+    OrderTable table(4);
+    auto record = insert(table, 7, 1);
+    ASSERT_NE(record, nullptr);
+    table.set_ex_order_id(*record, 70);
+
+    EXPECT_EQ(insert(table, 7, 2), nullptr);
+    EXPECT_EQ(table.size(), 1u);
+    // the live order is left as it was
+    EXPECT_EQ(table.find(7), record);
+    EXPECT_EQ(record->source, 1u);
+    EXPECT_EQ(table.find_by_ex_order_id(70), record);
+
+    // free again once the live one is gone
+    table.erase(*record);
+    EXPECT_EQ(table.find(7), nullptr);
+    EXPECT_EQ(table.find_by_ex_order_id(70), nullptr);
+    record = insert(table, 7, 2);
+    ASSERT_NE(record, nullptr);
+    EXPECT_EQ(record->source, 2u);
+    EXPECT_EQ(record->ex_order_id, 0u);
+}
+
+TEST(order_table, full_table)
+{
+    OrderTable table(3);
+    EXPECT_EQ(table.capacity(), 3u);
+    std::vector<OrderRecord *> records;
+    for (uint64_t order_id = 1; order_id <= 3; order_id++)
+    {
+        records.push_back(insert(table, order_id));
+        ASSERT_NE(records.back(), nullptr);
+    }
+    EXPECT_EQ(table.size(), 3u);
+
+    EXPECT_EQ(insert(table, 4), nullptr);
+    EXPECT_EQ(table.find(4), nullptr);
+    EXPECT_EQ(table.size(), 3u);
+
+    // an erase makes room for one more, in the slot it freed
+    table.erase(*records[1]);
+    EXPECT_EQ(table.size(), 2u);
+    auto record = insert(table, 4);
+    EXPECT_EQ(record, records[1]);
+    EXPECT_EQ(insert(table, 5), nullptr);
+    EXPECT_EQ(table.find(1), records[0]);
+    EXPECT_EQ(table.find(2), nullptr);
+    EXPECT_EQ(table.find(3), records[2]);
+    EXPECT_EQ(table.find(4), record);
+}
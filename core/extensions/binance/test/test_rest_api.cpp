@@ -0,0 +1,186 @@
+/**
+ * This is source code under the Apache License 2.0.
+ * Original Author: kx@godzilla.dev
+ * Original date: March 3, 2025
+ */
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <spdlog/spdlog.h>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/ssl/stream.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+
+#include <binapi/api.hpp>
+#include <binapi/errors.hpp>
+#include <binapi/types.hpp>
+
+#include "loopback_tls.h"
+
+namespace asio = boost::asio;
+namespace beast = boost::beast;
+
+namespace
+{
+    /** what the server does with each request it reads on a connection */
+    enum class action
+    {
+        reply,  // answers and keeps the connection open
+        drop,   // closes the connection without answering
+        hang    // never answers, waits for the client to give up
+    };
+
+    /** https server on a loopback port, plays one script of actions per connection accepted, in order */
+    class rest_server
+    {
+    public:
+        explicit rest_server(std::vector<std::vector<action>> scripts) :
+                scripts_(std::move(scripts)), ssl_(asio::ssl::context::tlsv12_server),
+                acceptor_(ioctx_, {asio::ip::make_address("127.0.0.1"), 0})
+        {
+            test::use_loopback_certificate(ssl_);
+            thread_ = std::thread([this]()
+                                  { serve(); });
+        }
+
+        /** scripts left unplayed are skipped, a connection of our own wakes the accept waiting for them */
+        ~rest_server()
+        {
+            stopping_ = true;
+            boost::system::error_code ec;
+            asio::ip::tcp::socket wake(ioctx_);
+            wake.connect(acceptor_.local_endpoint(), ec);
+            thread_.join();
+        }
+
+        std::string port() const
+        { return std::to_string(acceptor_.local_endpoint().port()); }
+
+        /** method and target without query of every request read, in order */
+        std::vector<std::string> requests()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return requests_;
+        }
+
+    private:
+        void serve()
+        {
+            for (const auto &script : scripts_)
+            {
+                try
+                {
+                    asio::ssl::stream<asio::ip::tcp::socket> stream(ioctx_, ssl_);
+                    acceptor_.accept(stream.next_layer());
+                    if (stopping_)
+                    {
+                        return;
+                    }
+                    stream.handshake(asio::ssl::stream_base::server);
+                    beast::flat_buffer buffer;
+                    for (auto next : script)
+                    {
+                        beast::http::request<beast::http::string_body> req;
+                        beast::http::read(stream, buffer, req);
+                        auto target = std::string(req.target());
+                        {
+                            std::lock_guard<std::mutex> lock(mutex_);
+                            requests_.push_back(std::string(req.method_string()) + " " + target.substr(0, target.find('?')));
+                        }
+                        if (next == action::drop)
+                        {
+                            break;
+                        }
+                        if (next == action::hang)
+                        {
+                            // returns once the client closes
+                            beast::http::read(stream, buffer, req);
+                            break;
+                        }
+                        beast::http::response<beast::http::string_body> res{beast::http::status::ok, 11};
+                        res.keep_alive(true);
+                        res.body() = R"({"listenKey":"loopback"})";
+                        res.prepare_payload();
+                        beast::http::write(stream, res);
+                    }
+                } catch (const std::exception &)
+                {
+                    // the client closing first ends the script of its connection as well
+                }
+            }
+        }
+
+        std::vector<std::vector<action>> scripts_;
+        asio::io_context ioctx_;
+        asio::ssl::context ssl_;
+        asio::ip::tcp::acceptor acceptor_;
+        std::thread thread_;
+        std::atomic<bool> stopping_{false};
+        std::mutex mutex_;
+        std::vector<std::string> requests_;
+    };
+}
+
+TEST(rest_api, request_times_out)
+{
+    spdlog::set_level(spdlog::level::off);
+    rest_server server({{action::hang}});
+    asio::io_context ioctx;
+    binapi::rest::api api(ioctx, "127.0.0.1", server.port(), "pk", "sk", 300);
+    int ec = 0;
+    auto start = std::chrono::steady_clock::now();
+    api.ping([&](const char *fl, int e, std::string message, binapi::rest::ping_t)
+             {
+                 ec = e;
+                 return true;
+             });
+    ioctx.run();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    EXPECT_EQ(ec, static_cast<int>(binapi::rest::e_error::TIMEOUT));
+    EXPECT_GE(elapsed, std::chrono::milliseconds(300));
+    EXPECT_LT(elapsed, std::chrono::seconds(5));
+    EXPECT_EQ(server.requests(), std::vector<std::string>({"GET /api/v3/ping"}));
+}
+
+TEST(rest_api, only_gets_sent_again_on_reused_connection)
+{
+    spdlog::set_level(spdlog::level::off);
+    // each connection answers once, then drops the next request, a third one would answer a POST sent again
+    rest_server server({{action::reply, action::drop}, {action::reply, action::drop}, {action::reply}});
+    asio::io_context ioctx;
+    binapi::rest::api api(ioctx, "127.0.0.1", server.port(), "pk", "sk", 5000);
+    std::vector<int> results;
+    api.ping([&](const char *, int ec, std::string, binapi::rest::ping_t)
+             {
+                 results.push_back(ec);
+                 // dropped on the first connection, answered on the second
+                 api.ping([&](const char *, int ec, std::string, binapi::rest::ping_t)
+                          {
+                              results.push_back(ec);
+                              // dropped on the second connection, may have reached the server, fails
+                              api.start_user_data_stream([&](const char *, int ec, std::string, binapi::rest::start_user_data_stream_t)
+                                                         {
+                                                             results.push_back(ec);
+                                                             return true;
+                                                         });
+                              return true;
+                          });
+                 return true;
+             });
+    ioctx.run();
+
+    ASSERT_EQ(results.size(), 3u);
+    EXPECT_EQ(results[0], 0);
+    EXPECT_EQ(results[1], 0);
+    EXPECT_NE(results[2], 0);
+    EXPECT_EQ(server.requests(), std::vector<std::string>({"GET /api/v3/ping", "GET /api/v3/ping", "GET /api/v3/ping",
+                                                           "POST /api/v3/userDataStream"}));
+}
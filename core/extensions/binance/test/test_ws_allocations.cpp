@@ -0,0 +1,232 @@
+/**
+ * This is source code under the Apache License 2.0.
+ * Original Author: kx@godzilla.dev
+ * Original date: March 3, 2025
+ */
+
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <spdlog/spdlog.h>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/ssl/stream.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/websocket.hpp>
+#include <boost/beast/websocket/ssl.hpp>
+
+#include <binapi/websocket.hpp>
+#include <binapi/types.hpp>
+
+#include "order_book.h"
+#include "depth_fixtures.h"
+#include "loopback_tls.h"
+
+using namespace kungfu::wingchun;
+using namespace kungfu::wingchun::binance;
+namespace asio = boost::asio;
+namespace beast = boost::beast;
+
+/*
+ * every malloc of the process goes through here, openssl and boost included, only the ones made by a thread while it
+ * counts are added up
+ */
+namespace
+{
+    thread_local bool counting = false;
+    thread_local size_t allocations = 0;
+}
+
+extern "C"
+{
+    void *__libc_malloc(size_t size);
+    void *__libc_calloc(size_t count, size_t size);
+    void *__libc_realloc(void *ptr, size_t size);
+
+    void *malloc(size_t size)
+    {
+        allocations += counting;
+        return __libc_malloc(size);
+    }
+
+    void *calloc(size_t count, size_t size)
+    {
+        allocations += counting;
+        return __libc_calloc(count, size);
+    }
+
+    void *realloc(void *ptr, size_t size)
+    {
+        allocations += counting;
+        return __libc_realloc(ptr, size);
+    }
+}
+
+namespace
+{
+    /** messages before the client is considered in steady state */
+    constexpr size_t WARMUP = 500;
+    constexpr size_t MESSAGES = 5000;
+
+    /**
+     * websocket server on a loopback port, sends its messages to the first client then closes, which ends the client
+     * io_context run. TLS 1.2, since openssl 3 decrypting a TLS 1.3 record allocates inside SSL_read.
+     */
+    class depth_server
+    {
+    public:
+        explicit depth_server(std::vector<std::string> messages) :
+                messages_(std::move(messages)), ssl_(asio::ssl::context::tlsv12_server),
+                acceptor_(ioctx_, {asio::ip::make_address("127.0.0.1"), 0})
+        {
+            test::use_loopback_certificate(ssl_);
+            thread_ = std::thread([this]()
+                                  { serve(); });
+        }
+
+        ~depth_server()
+        { thread_.join(); }
+
+        std::string port() const
+        { return std::to_string(acceptor_.local_endpoint().port()); }
+
+    private:
+        void serve()
+        {
+            try
+            {
+                beast::websocket::stream<asio::ssl::stream<asio::ip::tcp::socket>> ws(ioctx_, ssl_);
+                acceptor_.accept(ws.next_layer().next_layer());
+                ws.next_layer().handshake(asio::ssl::stream_base::server);
+                ws.accept();
+                ws.text(true);
+                for (const auto &message : messages_)
+                {
+                    ws.write(asio::buffer(message));
+                }
+                ws.close(beast::websocket::close_code::normal);
+            } catch (const std::exception &ex)
+            {
+                ADD_FAILURE() << "depth server: " << ex.what();
+            }
+        }
+
+        std::vector<std::string> messages_;
+        asio::io_context ioctx_;
+        asio::ssl::context ssl_;
+        asio::ip::tcp::acceptor acceptor_;
+        std::thread thread_;
+    };
+
+    /** counts allocations of the calling thread from message WARMUP to the last one, callbacks and reads between them */
+    struct allocation_meter
+    {
+        size_t messages = 0;
+        size_t counted = 0;
+
+        void on_message()
+        {
+            messages++;
+            if (messages == WARMUP)
+            {
+                allocations = 0;
+                counting = true;
+            }
+            if (messages == MESSAGES)
+            {
+                counting = false;
+                counted = allocations;
+            }
+        }
+    };
+
+    /** prices of level i on either side of 84312.47, as binance quotes them on spot */
+    std::string spot_price(bool bid, int i)
+    {
+        int64_t cents = bid ? 8431247 - i : 8431248 + i;
+        return fmt::format("{}.{:02}000000", cents / 100, cents % 100);
+    }
+}
+
+TEST(ws_allocations, part_depth_steady_state)
+{
+    spdlog::set_level(spdlog::level::err);
+    depth_server server(std::vector<std::string>(MESSAGES, test::SPOT_DEPTH20));
+    asio::io_context ioctx;
+    binapi::ws::websockets streams(ioctx, "127.0.0.1", server.port());
+    OrderBook book("btc_usdt", InstrumentType::Spot, 1, 20);
+    allocation_meter meter;
+    streams.part_depth("BTCUSDT", binapi::e_levels::_20, binapi::e_freq::_100ms,
+                       [&](const char *fl, int ec, std::string errmsg, const binapi::ws::part_depths_t &msg)
+                       {
+                           if (ec)
+                           {
+                               return false;
+                           }
+                           book.set_levels(msg.b, msg.a);
+                           meter.on_message();
+                           return true;
+                       });
+    ioctx.run();
+
+    ASSERT_EQ(meter.messages, MESSAGES);
+    EXPECT_EQ(book.get_bids().size(), 20u);
+    EXPECT_EQ(meter.counted, 0u) << "per message: " << double(meter.counted) / (MESSAGES - WARMUP);
+}
+
+TEST(ws_allocations, diff_depth_steady_state)
+{
+    spdlog::set_level(spdlog::level::err);
+    const size_t snapshot_id = 61547330528;
+    std::vector<std::string> messages;
+    for (size_t i = 0; i < MESSAGES; i++)
+    {
+        // a few of 50 levels on each side change, one in four leaves the book and comes back later
+        std::string levels[2];
+        for (int side = 0; side < 2; side++)
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                int level = (i * 7 + k * 13 + side) % 50;
+                std::string amount = (i + k) % 4 == 0 ? "0.00000000" : fmt::format("{}.{:08}", k, (i * 7919) % 100000000);
+                levels[side] += fmt::format("{}[\"{}\",\"{}\"]", k ? "," : "", spot_price(side == 0, level), amount);
+            }
+        }
+        messages.push_back(fmt::format(R"({{"e":"depthUpdate","E":{},"s":"BTCUSDT","U":{},"u":{},"b":[{}],"a":[{}]}})",
+                                       1741003212457 + i * 100, snapshot_id + 1 + i * 3, snapshot_id + 3 + i * 3,
+                                       levels[0], levels[1]));
+    }
+    depth_server server(std::move(messages));
+
+    OrderBook book("btc_usdt", InstrumentType::Spot, 1);
+    binapi::rest::depths_t snapshot{};
+    snapshot.lastUpdateId = snapshot_id;
+    for (int i = 0; i < 50; i++)
+    {
+        snapshot.bids.push_back({binapi::double_type(spot_price(true, i)), binapi::double_type("1.5")});
+        snapshot.asks.push_back({binapi::double_type(spot_price(false, i)), binapi::double_type("2.5")});
+    }
+    ASSERT_EQ(book.apply_snapshot(snapshot), OrderBook::Status::Applied);
+
+    asio::io_context ioctx;
+    binapi::ws::websockets streams(ioctx, "127.0.0.1", server.port());
+    allocation_meter meter;
+    streams.diff_depth("BTCUSDT", binapi::e_freq::_100ms,
+                       [&](const char *fl, int ec, std::string errmsg, const binapi::ws::diff_depths_t &msg)
+                       {
+                           if (ec)
+                           {
+                               return false;
+                           }
+                           EXPECT_EQ(book.apply(msg), OrderBook::Status::Applied);
+                           meter.on_message();
+                           return true;
+                       });
+    ioctx.run();
+
+    ASSERT_EQ(meter.messages, MESSAGES);
+    EXPECT_EQ(book.get_last_update_id(), snapshot_id + MESSAGES * 3);
+    EXPECT_EQ(meter.counted, 0u) << "per message: " << double(meter.counted) / (MESSAGES - WARMUP);
+}
@@ -0,0 +1,189 @@
+/**
+ * This is source code under the Apache License 2.0.
+ * Original Author: kx@godzilla.dev
+ * Original date: March 3, 2025
+ */
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <spdlog/spdlog.h>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/ssl/stream.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/websocket.hpp>
+#include <boost/beast/websocket/ssl.hpp>
+
+#include <binapi/errors.hpp>
+#include <binapi/wsapi.hpp>
+
+#include "loopback_tls.h"
+
+namespace asio = boost::asio;
+namespace beast = boost::beast;
+
+namespace
+{
+    /** what the server does after reading a request on a session */
+    enum class action
+    {
+        drop,   // closes the session without answering
+        hang    // never answers, waits for the client to close
+    };
+
+    /** websocket api server on a loopback port, plays one action per session accepted, in order */
+    class wsapi_server
+    {
+    public:
+        explicit wsapi_server(std::vector<action> sessions) :
+                sessions_(std::move(sessions)), ssl_(asio::ssl::context::tlsv12_server),
+                acceptor_(ioctx_, {asio::ip::make_address("127.0.0.1"), 0})
+        {
+            test::use_loopback_certificate(ssl_);
+            thread_ = std::thread([this]()
+                                  { serve(); });
+        }
+
+        ~wsapi_server()
+        {
+            stopping_ = true;
+            boost::system::error_code ec;
+            asio::ip::tcp::socket wake(ioctx_);
+            wake.connect(acceptor_.local_endpoint(), ec);
+            thread_.join();
+        }
+
+        std::string port() const
+        { return std::to_string(acceptor_.local_endpoint().port()); }
+
+        size_t requests() const
+        { return requests_; }
+
+    private:
+        void serve()
+        {
+            for (auto next : sessions_)
+            {
+                try
+                {
+                    beast::websocket::stream<asio::ssl::stream<asio::ip::tcp::socket>> ws(ioctx_, ssl_);
+                    acceptor_.accept(ws.next_layer().next_layer());
+                    if (stopping_)
+                    {
+                        return;
+                    }
+                    ws.next_layer().handshake(asio::ssl::stream_base::server);
+                    ws.accept();
+                    beast::flat_buffer buffer;
+                    ws.read(buffer);
+                    requests_++;
+                    if (next == action::hang)
+                    {
+                        // returns once the client closes
+                        ws.read(buffer);
+                    }
+                } catch (const std::exception &)
+                {
+                    // the client closing first ends its session as well
+                }
+            }
+        }
+
+        std::vector<action> sessions_;
+        asio::io_context ioctx_;
+        asio::ssl::context ssl_;
+        asio::ip::tcp::acceptor acceptor_;
+        std::thread thread_;
+        std::atomic<bool> stopping_{false};
+        std::atomic<size_t> requests_{0};
+    };
+
+    /** a loopback port nothing listens on */
+    std::string closed_port()
+    {
+        asio::io_context ioctx;
+        asio::ip::tcp::acceptor acceptor(ioctx, {asio::ip::make_address("127.0.0.1"), 0});
+        return std::to_string(acceptor.local_endpoint().port());
+    }
+}
+
+TEST(wsapi, request_times_out)
+{
+    spdlog::set_level(spdlog::level::off);
+    wsapi_server server({action::hang});
+    asio::io_context ioctx;
+    binapi::wsapi::api api(ioctx, "127.0.0.1", server.port(), "/ws-api/v3", "pk", "sk", 300);
+    int ec = 0;
+    std::chrono::steady_clock::time_point sent;
+    api.set_on_connected([&]()
+                         {
+                             sent = std::chrono::steady_clock::now();
+                             api.order_info("BTCUSDT", 0, "1", [&](const char *, int e, std::string, binapi::rest::order_info_t)
+                             {
+                                 ec = e;
+                                 api.stop();
+                                 return true;
+                             });
+                         });
+    api.start();
+    ioctx.run();
+
+    EXPECT_EQ(ec, static_cast<int>(binapi::rest::e_error::TIMEOUT));
+    EXPECT_GE(std::chrono::steady_clock::now() - sent, std::chrono::milliseconds(300));
+    EXPECT_EQ(server.requests(), 1u);
+}
+
+TEST(wsapi, dropped_session_fails_requests_then_reconnects)
+{
+    spdlog::set_level(spdlog::level::off);
+    wsapi_server server({action::drop, action::hang});
+    asio::io_context ioctx;
+    binapi::wsapi::api api(ioctx, "127.0.0.1", server.port(), "/ws-api/v3", "pk", "sk", 5000);
+    int ec = 0;
+    int sessions = 0;
+    api.set_on_connected([&]()
+                         {
+                             if (++sessions == 2)
+                             {
+                                 api.stop();
+                                 return;
+                             }
+                             api.order_info("BTCUSDT", 0, "1", [&](const char *, int e, std::string, binapi::rest::order_info_t)
+                             {
+                                 ec = e;
+                                 return true;
+                             });
+                         });
+    api.start();
+    ioctx.run();
+
+    EXPECT_EQ(ec, static_cast<int>(binapi::rest::e_error::DISCONNECTED));
+    EXPECT_EQ(sessions, 2);
+}
+
+TEST(wsapi, falls_back_to_rest_while_down)
+{
+    spdlog::set_level(spdlog::level::off);
+    // neither is ever connected, the error tells which of them the request went through
+    asio::io_context ioctx;
+    auto rest = std::make_shared<binapi::rest::api>(ioctx, "127.0.0.1", closed_port(), "pk", "sk", 5000);
+    binapi::wsapi::api with_fallback(ioctx, "127.0.0.1", closed_port(), "/ws-api/v3", "pk", "sk", 5000, rest);
+    binapi::wsapi::api without(ioctx, "127.0.0.1", closed_port(), "/ws-api/v3", "pk", "sk", 5000);
+    std::vector<int> results;
+    auto cb = [&](const char *, int ec, std::string, binapi::rest::cancel_order_info_t)
+    {
+        results.push_back(ec);
+        return true;
+    };
+    with_fallback.cancel_order("BTCUSDT", 0, "1", nullptr, cb);
+    without.cancel_order("BTCUSDT", 0, "1", nullptr, cb);
+    ioctx.run();
+
+    ASSERT_EQ(results.size(), 2u);
+    EXPECT_EQ(results[0], static_cast<int>(binapi::rest::e_error::DISCONNECTED));
+    EXPECT_EQ(results[1], boost::system::error_code(asio::error::connection_refused).value());
+}
@@ -98,7 +98,7 @@ def kfc(ctx, home, log_level, name):
 
     # have to keep locator alive from python side
     # https://github.com/pybind/pybind11/issues/1546
-    ctx.locator = kfj.Locator(home)
+    ctx.locator = kfj.Locator(home, ctx.settings.get('journal'), ctx.settings.get('wait'), ctx.settings.get('threads'))
     ctx.system_config_location = pyyjj.location(pyyjj.mode.LIVE, pyyjj.category.SYSTEM, 'etc', 'kungfu', ctx.locator)
     if ctx.invoked_subcommand is None:
         click.echo(kfc.get_help(ctx))
@@ -10,4 +10,6 @@ Modification date: March 3, 2025
 from . import sessions
 from . import trace
 from . import reader
-from . import inspect
\ No newline at end of file
+from . import inspect
+from . import archive
+from . import latency
@@ -0,0 +1,45 @@
+'''
+This is source code modified under the Apache License 2.0.
+Original Author: Keren Dong
+Modifier: kx@godzilla.dev
+Modification date: March 3, 2025
+'''
+import os
+import pyyjj
+import pywingchun
+import click
+from kungfu.command.journal import journal, pass_ctx_from_parent
+import kungfu.yijinjing.journal as kfj
+
+
+@journal.command()
+@click.option('-k', '--keep', type=int, default=2, help='number of latest pages to leave as journal, pages not closed are never archived')
+@click.option('-r', '--remove', is_flag=True, help='remove journal pages once archived')
+@click.pass_context
+def archive(ctx, keep, remove):
+    pass_ctx_from_parent(ctx)
+    # symbols dictionary encoded, prices and times delta encoded, in market data frames
+    pywingchun.utils.register_archive_layouts()
+    frame_bytes = 0
+    archive_bytes = 0
+    locations = kfj.collect_journal_locations(ctx)
+    for uid in locations:
+        record = locations[uid]
+        location = kfj.make_location_from_dict(ctx, record)
+        for dest in record['readers']:
+            dest_id = int(dest, 16)
+            page_ids = sorted(int(page_id) for page_id in record['readers'][dest])
+            # writer keeps the page being written and the one prepared ahead, so the latest two are usually open
+            for page_id in page_ids[:max(len(page_ids) - keep, 0)]:
+                if os.path.exists(pyyjj.get_archive_path(location, dest_id, page_id)):
+                    continue
+                try:
+                    stats = pyyjj.archive_page(location, dest_id, page_id, remove)
+                    frame_bytes += stats.frame_bytes
+                    archive_bytes += stats.archive_bytes
+                    ctx.logger.info('archived %s/%s.%d, %d frames, %d bytes into %d bytes',
+                                    record['uname'], dest, page_id, stats.frame_count, stats.frame_bytes, stats.archive_bytes)
+                except Exception as err:
+                    ctx.logger.error('failed to archive %s/%s.%d: %s', record['uname'], dest, page_id, err)
+    if archive_bytes > 0:
+        click.echo('archived {} bytes of frames into {} bytes, ratio {:.2f}'.format(frame_bytes, archive_bytes, frame_bytes / archive_bytes))
@@ -0,0 +1,139 @@
+'''
+This is source code under the Apache License 2.0.
+Original Author: kx@godzilla.dev
+Original date: March 3, 2025
+'''
+import json
+
+import click
+import pyyjj
+from tabulate import tabulate
+from kungfu.command.journal import journal, pass_ctx_from_parent
+
+import kungfu.wingchun.msg as wc_msg
+import kungfu.wingchun.constants as wc_constants
+import kungfu.yijinjing.msg as yjj_msg
+import kungfu.yijinjing.journal as kfj
+
+READ_BATCH_SIZE = 4096
+STAGES = ['tick->decision', 'decision->wire', 'wire->ack', 'tick->ack']
+PERCENTILES = [0.5, 0.9, 0.99, 0.999]
+NANO_PER_MICROSECOND = 1000
+
+
+@journal.command()
+@click.option('-i', '--session_id', type=int, required=True, help='session id of a strategy or td')
+@click.option('-f', '--tablefmt', default='simple',
+              type=click.Choice(['plain', 'simple', 'orgtbl', 'grid', 'fancy_grid', 'rst', 'textile']),
+              help='output format')
+@click.option('-p', '--pager', is_flag=True, help='show in a pager')
+@click.pass_context
+def latency(ctx, session_id, tablefmt, pager):
+    '''
+    order latency in us, from the tick that triggered an order input to binance acknowledging it.
+    tick is the trigger time of the order input, decision its gen time, wire the send time of its orders
+    and ack the gen time of its first order, orders rejected before or by the exchange are left out
+    '''
+    pass_ctx_from_parent(ctx)
+    samples = collect_samples(read_session(ctx, session_id))
+
+    headers = ['stage', 'count'] + ['p{:g}'.format(p * 100) for p in PERCENTILES] + ['max']
+    rows = [[stage, len(samples[stage])] + summarize(samples[stage]) for stage in STAGES]
+    table = tabulate(rows, headers=headers, tablefmt=tablefmt, floatfmt='.1f')
+
+    if pager:
+        click.echo_via_pager(table)
+    else:
+        click.echo(table)
+
+
+def collect_samples(frames):
+    '''latencies in ns per stage, of the order inputs among frames and the orders about them'''
+    samples = {stage: [] for stage in STAGES}
+    inputs = {}
+    orders = {}
+
+    for frame in frames:
+        if frame.msg_type == wc_msg.OrderInput:
+            data = frame.data
+            inputs[data.order_id] = (frame.trigger_time, frame.gen_time)
+        elif frame.msg_type == wc_msg.Order:
+            data = frame.data
+            if data.order_id not in inputs:
+                continue
+            order = orders.setdefault(data.order_id, {'ack': frame.gen_time, 'error': False, 'send': 0})
+            order['error'] = order['error'] or data.status == wc_constants.OrderStatus.Error
+            if order['send'] == 0:
+                order['send'] = data.send_time
+
+    for order_id, order in orders.items():
+        tick, decision = inputs[order_id]
+        if order['error']:
+            continue
+        if tick > 0:
+            samples['tick->decision'].append(decision - tick)
+            samples['tick->ack'].append(order['ack'] - tick)
+        if order['send'] > 0:
+            samples['decision->wire'].append(order['send'] - decision)
+            samples['wire->ack'].append(order['ack'] - order['send'])
+    return samples
+
+
+def summarize(values):
+    if not values:
+        return [None] * (len(PERCENTILES) + 1)
+    values = sorted(values)
+    # nearest rank, in us
+    result = [values[min(int(p * len(values)), len(values) - 1)] / NANO_PER_MICROSECOND for p in PERCENTILES]
+    return result + [values[-1] / NANO_PER_MICROSECOND]
+
+
+def read_session(ctx, session_id):
+    '''frames in and out of a session, joining the journals it asked to read from on the way like trace does'''
+    session = kfj.find_session(ctx, session_id)
+    uname = '{}/{}/{}/{}'.format(session['category'], session['group'], session['name'], session['mode'])
+    uid = pyyjj.hash_str_32(uname)
+    ctx.category = '*'
+    ctx.group = '*'
+    ctx.name = '*'
+    ctx.mode = '*'
+    locations = kfj.collect_journal_locations(ctx)
+    location = locations[uid]
+    home = kfj.make_location_from_dict(ctx, location)
+    io_device = pyyjj.io_device(home)
+    reader = io_device.open_reader_to_subscribe()
+
+    for dest in location['readers']:
+        reader.join(home, int(dest, 16), session['begin_time'])
+
+    master_home_uid = pyyjj.hash_str_32('system/master/master/live')
+    reader.join(kfj.make_location_from_dict(ctx, locations[master_home_uid]), 0, session['begin_time'])
+    master_cmd_uid = pyyjj.hash_str_32('system/master/{:08x}/live'.format(location['uid']))
+    reader.join(kfj.make_location_from_dict(ctx, locations[master_cmd_uid]), location['uid'], session['begin_time'])
+
+    while True:
+        batch = reader.read_batch(session['end_time'], READ_BATCH_SIZE)
+        if batch.empty():
+            return
+        # frames of a batch live in pages of joined journals, join set is changed after the batch is done with
+        changes = []
+        for frame in batch:
+            if frame.dest == home.uid and (frame.msg_type == yjj_msg.RequestReadFrom or frame.msg_type == yjj_msg.RequestReadFromPublic):
+                request = pyyjj.get_RequestReadFrom(frame)
+                source_location = kfj.make_location_from_dict(ctx, locations[request.source_id])
+                dest_id = location['uid'] if frame.msg_type == yjj_msg.RequestReadFrom else 0
+                changes.append(lambda source_location=source_location, dest_id=dest_id, from_time=request.from_time:
+                               join(ctx, reader, source_location, dest_id, from_time))
+            if frame.dest == home.uid and frame.msg_type == yjj_msg.Deregister:
+                loc = json.loads(frame.data_as_string)
+                changes.append(lambda uid=loc['uid']: reader.disjoin(uid))
+            yield frame
+        for change in changes:
+            change()
+
+
+def join(ctx, reader, source_location, dest_id, from_time):
+    try:
+        reader.join(source_location, dest_id, from_time)
+    except Exception as err:
+        ctx.logger.error('failed to join journal %s, exception: %s', source_location.uname, err)
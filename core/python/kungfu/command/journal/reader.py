@@ -4,6 +4,7 @@ Original Author: Keren Dong
 Modifier: kx@godzilla.dev
 Modification date: March 3, 2025
 '''
+import json
 import pyyjj
 import pywingchun
 import click
@@ -20,6 +21,8 @@ import importlib
 import os
 import kungfu.msg
 
+READ_BATCH_SIZE = 4096
+
 @journal.command()
 @click.option('-i', '--session_id', type=int, required=True, help='session id')
 @click.option('-t', '--io_type', type=click.Choice(['all', 'in', 'out']), default='all', help='input or output during this session')
@@ -86,18 +89,30 @@ def reader(ctx, session_id, io_type, from_beginning, max_messages, msg, continuo
         pp = pprint.PrettyPrinter(indent=4)
         frame_handler = pp.pprint
 
-    while True:
-        if reader.data_available() and msg_count < max_messages:
-            frame = reader.current_frame()
+    session_end = False
+    while not session_end and msg_count < max_messages:
+        batch = reader.read_batch(sys.maxsize, READ_BATCH_SIZE)
+        if batch.empty():
+            if not continuous:
+                ctx.logger.info("no data is available")
+                break
+            time.sleep(0.1)
+            continue
+        # frames of a batch live in pages of joined journals, join set is changed after the batch is done with
+        changes = []
+        for frame in batch:
             if frame.dest == home.uid and (frame.msg_type == yjj_msg.RequestReadFrom or frame.msg_type == yjj_msg.RequestReadFromPublic):
                 request = pyyjj.get_RequestReadFrom(frame)
                 source_location = kfj.make_location_from_dict(ctx, locations[request.source_id])
-                reader.join(source_location, location['uid'] if frame.msg_type == yjj_msg.RequestReadFrom else 0, request.from_time)
+                dest_id = location['uid'] if frame.msg_type == yjj_msg.RequestReadFrom else 0
+                changes.append(lambda source_location=source_location, dest_id=dest_id, from_time=request.from_time:
+                               reader.join(source_location, dest_id, from_time))
             if frame.dest == home.uid and frame.msg_type == yjj_msg.Deregister:
-                loc = json.loads(frame.data_as_string())
-                reader.disjoin(loc['uid'])
+                loc = json.loads(frame.data_as_string)
+                changes.append(lambda uid=loc['uid']: reader.disjoin(uid))
             if frame.msg_type == yjj_msg.SessionEnd:
                 ctx.logger.info("session reach end at %s", kft.strftime(frame.gen_time))
+                session_end = True
                 break
             elif frame.gen_time >= start_time and (msg == "all" or msg_type_to_read ==  frame.msg_type):
                 try:
@@ -106,14 +121,8 @@ def reader(ctx, session_id, io_type, from_beginning, max_messages, msg, continuo
                     exc_type, exc_obj, exc_tb = sys.exc_info()
                     ctx.logger.error('error [%s] %s', exc_type, traceback.format_exception(exc_type, exc_obj, exc_tb))
                 msg_count +=1
-            reader.next()
-        elif msg_count >= max_messages:
-            ctx.logger.info("reach max messages {}".format(max_messages))
-            break
-        elif not reader.data_available():
-            if not continuous:
-                ctx.logger.info("no data is available")
-                break
-            else:
-                time.sleep(0.1)
-
+                if msg_count >= max_messages:
+                    ctx.logger.info("reach max messages {}".format(max_messages))
+                    break
+        for change in changes:
+            change()
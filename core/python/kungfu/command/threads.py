@@ -0,0 +1,99 @@
+'''
+This is source code modified under the Apache License 2.0.
+Original Author: Keren Dong
+Modifier: kx@godzilla.dev
+Modification date: March 3, 2025
+'''
+import os
+import click
+import pyyjj
+from tabulate import tabulate
+from kungfu.command import kfc, pass_ctx_from_parent
+
+SCHED_POLICIES = {0: 'OTHER', 1: 'FIFO', 2: 'RR', 3: 'BATCH', 5: 'IDLE', 6: 'DEADLINE'}
+THREAD_ROLE_PREFIX = 'kf-'
+
+
+def read_file(path, default=''):
+    try:
+        with open(path) as f:
+            return f.read().strip()
+    except (IOError, OSError):
+        return default
+
+
+def read_status(path, key):
+    for line in read_file(path).splitlines():
+        if line.startswith(key + ':'):
+            return line.split(':', 1)[1].strip()
+    return ''
+
+
+def read_migrations(path):
+    for line in read_file(path).splitlines():
+        if line.startswith('se.nr_migrations'):
+            return int(line.split(':', 1)[1])
+    return ''
+
+
+def list_kungfu_pids():
+    """kungfu processes are the ones having threads named by thread placement, the log flusher at least"""
+    pids = []
+    for pid in filter(str.isdigit, os.listdir('/proc')):
+        try:
+            tids = os.listdir('/proc/{}/task'.format(pid))
+        except OSError:
+            continue
+        if any(read_file('/proc/{}/task/{}/comm'.format(pid, tid)).startswith(THREAD_ROLE_PREFIX) for tid in tids):
+            pids.append(int(pid))
+    return sorted(pids)
+
+
+def describe_thread(pid, tid, isolated):
+    task = '/proc/{}/task/{}'.format(pid, tid)
+    stat = read_file(task + '/stat')
+    # fields after the parenthesized comm, processor is field 39, rt_priority 40 and policy 41
+    fields = stat[stat.rfind(')') + 2:].split() if stat else []
+    cpu = int(fields[36]) if len(fields) > 38 else -1
+    comm = read_file(task + '/comm')
+    return [
+        pid, tid,
+        comm if tid != pid else '{} (main)'.format(comm),
+        read_status(task + '/status', 'Cpus_allowed_list'),
+        cpu,
+        pyyjj.get_numa_node(cpu) if cpu >= 0 else '',
+        'yes' if cpu in isolated else '',
+        SCHED_POLICIES.get(int(fields[38]), fields[38]) if len(fields) > 38 else '',
+        fields[37] if len(fields) > 38 else '',
+        read_migrations(task + '/sched'),
+    ]
+
+
+@kfc.command(help_priority=6)
+@click.option('-p', '--pid', type=int, multiple=True, help='process to show, all kungfu processes if not set')
+@click.option('-a', '--all', 'show_all', is_flag=True, help='show all threads, not only the placed and main ones')
+@click.option('-f', '--tablefmt', default='simple',
+              type=click.Choice(['plain', 'simple', 'orgtbl', 'grid', 'fancy_grid', 'rst', 'textile']),
+              help='output format')
+@click.pass_context
+def threads(ctx, pid, show_all, tablefmt):
+    """show where threads of kungfu processes run"""
+    pass_ctx_from_parent(ctx)
+    if not os.path.exists('/proc'):
+        click.echo('thread placement is only available on linux')
+        return
+    isolated = set(pyyjj.get_isolated_cpus())
+    rows = []
+    for p in (pid if pid else list_kungfu_pids()):
+        click.echo('{} {}'.format(p, read_file('/proc/{}/cmdline'.format(p)).replace('\0', ' ')))
+        try:
+            tids = sorted(int(tid) for tid in os.listdir('/proc/{}/task'.format(p)))
+        except OSError:
+            continue
+        for tid in tids:
+            comm = read_file('/proc/{}/task/{}/comm'.format(p, tid))
+            if show_all or tid == p or comm.startswith(THREAD_ROLE_PREFIX):
+                rows.append(describe_thread(p, tid, isolated))
+    headers = ['pid', 'tid', 'thread', 'allowed cpus', 'cpu', 'numa', 'isolated', 'policy', 'rt priority', 'migrations']
+    click.echo(tabulate(rows, headers=headers, tablefmt=tablefmt))
+    click.echo('isolated cpus: {}'.format(','.join(map(str, sorted(isolated))) if isolated else 'none'))
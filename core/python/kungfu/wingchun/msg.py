@@ -12,6 +12,9 @@ Depth = 101
 Ticker = 102
 Trade = 103
 IndexPrice = 104
+CompactDepth = 105
+MarketDataLatency = 106
+FeedLegStats = 107
 Bar = 110
 
 OrderInput = 201
@@ -45,6 +48,9 @@ Calendar = 601
 InstrumentEnd = 802
 
 Registry.register(Depth, underscore(pywingchun.Depth.__name__), pywingchun.Depth)
+Registry.register(CompactDepth, underscore(pywingchun.CompactDepth.__name__), pywingchun.CompactDepth)
+Registry.register(MarketDataLatency, underscore(pywingchun.MarketDataLatency.__name__), pywingchun.MarketDataLatency)
+Registry.register(FeedLegStats, underscore(pywingchun.FeedLegStats.__name__), pywingchun.FeedLegStats)
 Registry.register(Ticker, underscore(pywingchun.Ticker.__name__), pywingchun.Ticker)
 Registry.register(Trade, underscore(pywingchun.Trade.__name__), pywingchun.Trade)
 Registry.register(Bar, underscore(pywingchun.Bar.__name__), pywingchun.Bar)
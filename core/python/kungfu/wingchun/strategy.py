@@ -133,13 +133,13 @@ class Strategy(pywingchun.Strategy):
         def wrap_callback(event):
             callback(self.ctx, event)
 
-        self.wc_context.add_timer(nanotime, wrap_callback)
+        return self.wc_context.add_timer(nanotime, wrap_callback)
 
     def __add_time_interval(self, duration, callback):
         def wrap_callback(event):
             callback(self.ctx, event)
 
-        self.wc_context.add_time_interval(duration, wrap_callback)
+        return self.wc_context.add_time_interval(duration, wrap_callback)
 
     def pre_start(self, wc_context):
         self.ctx.logger.info("pre start")
@@ -152,6 +152,7 @@ class Strategy(pywingchun.Strategy):
         self.ctx.reload_config = self.__reload_config
         self.ctx.add_timer = self.__add_timer
         self.ctx.add_time_interval = self.__add_time_interval
+        self.ctx.cancel_timer = wc_context.cancel_timer
         self.ctx.subscribe = wc_context.subscribe
         self.ctx.unsubscribe = wc_context.unsubscribe
         self.ctx.subscribe_trade = wc_context.subscribe_trade
@@ -172,6 +173,7 @@ class Strategy(pywingchun.Strategy):
         self.ctx.get_account_book = self.__get_account_book
         self.ctx.get_inst_info = self.__get_inst_info
         self.ctx.get_market_info = self.__get_market_info
+        self.ctx.get_instrument_id = wc_context.get_instrument_id
         self.ctx.set_object = self.__set_object
         self.ctx.get_object = self.__get_object
         self.ctx.get_config = self.__get_config
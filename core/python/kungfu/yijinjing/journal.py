@@ -22,7 +22,7 @@ JOURNAL_LOCATION_REGEX = '{}{}{}{}{}{}{}{}{}{}{}'.format(
     r'(.*)', os_sep,  # name
     r'journal', os_sep,  # mode
     r'(.*)', os_sep,  # mode
-    r'(\w+).(\d+).journal',  # hash + page_id
+    r'(\w+).(\d+).(?:journal|archive)',  # hash + page_id, archived pages included
 )
 JOURNAL_LOCATION_PATTERN = re.compile(JOURNAL_LOCATION_REGEX)
 
@@ -64,10 +64,57 @@ def get_location_from_json(ctx, data):
         return None
 
 
+JOURNAL_POLICY_FIELDS = {
+    'page_size_mb': ('page_size', lambda v: int(v * 1024 * 1024)),
+    'max_pages': ('max_pages', int),
+    'max_size_mb': ('max_bytes', lambda v: int(v * 1024 * 1024)),
+    'max_age_minutes': ('max_age', lambda v: int(v * 60 * 1000000000)),
+    'cached_pages': ('cached_pages', int),
+    'populate': ('populate', bool),
+    'huge_pages': ('huge_pages', bool),
+    'numa_node': ('numa_node', int),
+}
+
+
+WAIT_POLICY_FIELDS = {
+    'spin_count': ('spin_count', int),
+    'yield_count': ('yield_count', int),
+    'park_timeout_ms': ('park_timeout', lambda v: int(v * 1000000)),
+}
+
+
+def to_cpu_list(value):
+    return pyyjj.parse_cpu_list(value) if isinstance(value, str) else [int(cpu) for cpu in ([value] if isinstance(value, int) else value)]
+
+
+THREAD_POLICY_FIELDS = {
+    'event_loop_cpus': ('event_loop_cpus', to_cpu_list),
+    'event_loop_priority': ('event_loop_priority', int),
+    'io_cpus': ('io_cpus', to_cpu_list),
+    'io_priority': ('io_priority', int),
+    'log_cpus': ('log_cpus', to_cpu_list),
+}
+
+
+def apply_settings(policy, fields, settings, keys):
+    """
+    settings are keyed by category, category/group, category/group/name and so on, more specific keys override less specific ones
+    """
+    for i in range(len(keys)):
+        for name, value in settings.get('/'.join(keys[:i + 1]), {}).items():
+            if name in fields:
+                field, convert = fields[name]
+                setattr(policy, field, convert(value))
+    return policy
+
+
 class Locator(pyyjj.locator):
-    def __init__(self, home):
+    def __init__(self, home, journal_settings=None, wait_settings=None, thread_settings=None):
         pyyjj.locator.__init__(self)
         self._home = home
+        self._journal_settings = journal_settings if journal_settings else {}
+        self._wait_settings = wait_settings if wait_settings else {}
+        self._thread_settings = thread_settings if thread_settings else {}
 
     def has_env(self, name):
         return os.getenv(name) is not None
@@ -101,22 +148,49 @@ class Locator(pyyjj.locator):
             return file
 
     def list_page_id(self, location, dest_id):
-        page_ids = []
-        for journal in glob.glob(os.path.join(self.layout_dir(location, pyyjj.layout.JOURNAL), hex(dest_id)[2:].zfill(8) + '.*.journal')):
+        page_ids = set()
+        for journal in glob_journals(os.path.join(self.layout_dir(location, pyyjj.layout.JOURNAL), hex(dest_id)[2:].zfill(8) + '.*')):
             match = JOURNAL_LOCATION_PATTERN.match(journal[len(self._home) + 1:])
             if match:
                 page_id = match.group(6)
-                page_ids.append(int(page_id))
-        page_ids.sort()
-        return page_ids
+                page_ids.add(int(page_id))
+        return sorted(page_ids)
+
+    def get_journal_policy(self, location, dest_id):
+        """
+        journal settings are keyed by category, category/group, category/group/name and category/group/name/dest,
+        e.g. {"md": {"max_pages": 8, "huge_pages": true}, "md/binance/binance/00000000": {"page_size_mb": 512, "numa_node": 1}}
+        """
+        keys = [pyyjj.get_category_name(location.category), location.group, location.name, hex(dest_id)[2:].zfill(8)]
+        return apply_settings(pyyjj.journal_policy(), JOURNAL_POLICY_FIELDS, self._journal_settings, keys)
+
+    def get_wait_policy(self, location):
+        """
+        wait settings of low latency processes are keyed by category, category/group and category/group/name,
+        e.g. {"strategy": {"spin_count": 1000, "park_timeout_ms": 100}, "td/binance": {"park_timeout_ms": 0}}
+        """
+        keys = [pyyjj.get_category_name(location.category), location.group, location.name]
+        return apply_settings(pyyjj.wait_policy(), WAIT_POLICY_FIELDS, self._wait_settings, keys)
+
+    def get_thread_policy(self, location):
+        """
+        thread settings are keyed by category, category/group and category/group/name, cpus are given as list or cpu list string,
+        e.g. {"md/binance": {"event_loop_cpus": "4", "io_cpus": [5], "io_priority": 50, "log_cpus": "0-1"}}
+        """
+        keys = [pyyjj.get_category_name(location.category), location.group, location.name]
+        return apply_settings(pyyjj.thread_policy(), THREAD_POLICY_FIELDS, self._thread_settings, keys)
+
+
+def glob_journals(pattern):
+    return glob.glob(pattern + '.journal') + glob.glob(pattern + '.archive')
 
 
 def collect_journal_locations(ctx):
 
-    search_path = os.path.join(ctx.home, ctx.category, ctx.group, ctx.name, 'journal', ctx.mode, '*.journal')
+    search_path = os.path.join(ctx.home, ctx.category, ctx.group, ctx.name, 'journal', ctx.mode, '*')
 
     locations = {}
-    for journal in glob.glob(search_path):
+    for journal in glob_journals(search_path):
         match = JOURNAL_LOCATION_PATTERN.match(journal[len(ctx.home) + 1:])
         if match:
             category = match.group(1)
@@ -129,7 +203,8 @@ def collect_journal_locations(ctx):
             uid = pyyjj.hash_str_32(uname)
             if uid in locations:
                 if dest in locations[uid]['readers']:
-                    locations[uid]['readers'][dest].append(page_id)
+                    if page_id not in locations[uid]['readers'][dest]:
+                        locations[uid]['readers'][dest].append(page_id)
                 else:
                     locations[uid]['readers'][dest] = [page_id]
             else:
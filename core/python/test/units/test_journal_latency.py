@@ -0,0 +1,49 @@
+'''
+This is source code under the Apache License 2.0.
+Original Author: kx@godzilla.dev
+Original date: March 3, 2025
+'''
+import unittest
+from types import SimpleNamespace
+
+import kungfu.wingchun.msg as wc_msg
+import kungfu.wingchun.constants as wc_constants
+from kungfu.command.journal.latency import collect_samples, summarize
+
+
+def order_input(order_id, trigger_time, gen_time):
+    return SimpleNamespace(msg_type=wc_msg.OrderInput, trigger_time=trigger_time, gen_time=gen_time,
+                           data=SimpleNamespace(order_id=order_id))
+
+
+def order(order_id, gen_time, send_time, status=wc_constants.OrderStatus.Submitted):
+    return SimpleNamespace(msg_type=wc_msg.Order, trigger_time=0, gen_time=gen_time,
+                           data=SimpleNamespace(order_id=order_id, send_time=send_time, status=status))
+
+
+class JournalLatencyTest(unittest.TestCase):
+    def test_stages_of_an_acked_order(self):
+        samples = collect_samples([order_input(1, 1000, 3000), order(1, 9000, 4000), order(1, 12000, 4000)])
+        self.assertEqual(samples, {'tick->decision': [2000], 'decision->wire': [1000], 'wire->ack': [5000], 'tick->ack': [8000]})
+
+    def test_input_without_tick_has_no_tick_stages(self):
+        samples = collect_samples([order_input(1, 0, 3000), order(1, 9000, 4000)])
+        self.assertEqual(samples, {'tick->decision': [], 'decision->wire': [1000], 'wire->ack': [5000], 'tick->ack': []})
+
+    def test_rejected_and_unknown_orders_left_out(self):
+        samples = collect_samples([
+            order_input(1, 1000, 3000), order(1, 9000, 4000), order(1, 9500, 4000, wc_constants.OrderStatus.Error),
+            order_input(2, 1000, 3000), order(2, 9000, 0, wc_constants.OrderStatus.Error),
+            # input of another session, not read
+            order(3, 9000, 4000),
+        ])
+        self.assertEqual(samples, {'tick->decision': [], 'decision->wire': [], 'wire->ack': [], 'tick->ack': []})
+
+    def test_summarize_nearest_rank_in_us(self):
+        values = [i * 1000 for i in range(1, 1001)]
+        self.assertEqual(summarize(values), [501.0, 901.0, 991.0, 1000.0, 1000.0])
+        self.assertEqual(summarize([]), [None] * 5)
+
+
+if __name__ == '__main__':
+    unittest.main()